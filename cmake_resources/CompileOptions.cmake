@@ -63,6 +63,18 @@ target_link_libraries(
                                      Threads::Threads ${LIB_RT}
 )
 
+if(${MODULE_CORE_ZSTD})
+    find_package(PkgConfig REQUIRED)
+    pkg_check_modules(ZSTD REQUIRED IMPORTED_TARGET libzstd)
+    target_link_libraries(RasrSystemDependencies INTERFACE PkgConfig::ZSTD)
+endif()
+
+if(${MODULE_CORE_LZ4})
+    find_package(PkgConfig REQUIRED)
+    pkg_check_modules(LZ4 REQUIRED IMPORTED_TARGET liblz4)
+    target_link_libraries(RasrSystemDependencies INTERFACE PkgConfig::LZ4)
+endif()
+
 add_library(RasrLapackDependencies INTERFACE)
 target_link_libraries(RasrLapackDependencies INTERFACE LAPACK::LAPACK)
 
@@ -39,6 +39,10 @@ add_module_option(MODULE_AUDIO_WAV_SYSTEM ON)
 # ****** Cache Manager integration ******
 add_module_option(MODULE_CORE_CACHE_MANAGER ON)
 
+# ****** Archive compression codecs ******
+add_module_option(MODULE_CORE_ZSTD OFF)
+add_module_option(MODULE_CORE_LZ4 OFF)
+
 # ****** Cart ******
 add_module_option(MODULE_CART ON)
 
@@ -148,4 +152,5 @@ endif()
 
 if(${MODULE_NN})
     add_tool_option(NnTrainer ON)
+    add_tool_option(SearchBenchmark ON)
 endif()
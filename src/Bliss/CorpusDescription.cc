@@ -13,16 +13,20 @@
  *  limitations under the License.
  */
 #include "CorpusDescription.hh"
+#include "CorpusImage.hh"
 #include "CorpusParser.hh"
 #include "SegmentOrdering.hh"
 
 #include <Core/Application.hh>
 #include <Core/CompressedStream.hh>
+#include <Core/Directory.hh>
 #include <Core/Hash.hh>
 #include <Core/Parameter.hh>
 #include <Core/ProgressIndicator.hh>
+#include <Core/Statistics.hh>
 #include <Core/StringUtilities.hh>
 #include <Core/TextStream.hh>
+#include <deque>
 #include <iomanip>
 
 #ifdef MODULE_PYTHON
@@ -227,6 +231,14 @@ const Core::ParameterString CorpusDescription::paramPythonSegmentOrderConfig(
         "python-segment-order-config",
         "config string, passed to the Python module init",
         "");
+const Core::ParameterInt CorpusDescription::paramSegmentLookAhead(
+        "segment-look-ahead",
+        "announce this many upcoming segments to the visitor, e.g. to read feature caches ahead (requires the corpus in memory)",
+        0, 0);
+const Core::ParameterString CorpusDescription::paramImage(
+        "image",
+        "compiled corpus image, created from the corpus file if it does not exist",
+        "");
 
 // ---------------------------------------------------------------------------
 class CorpusDescription::SegmentPartitionVisitorAdaptor : public CorpusVisitor {
@@ -467,6 +479,101 @@ public:
             pi_.finish();
         visitor_->leaveCorpus(c);
     }
+    virtual void announceSegments(const std::vector<Segment*>& segments) {
+        visitor_->announceSegments(segments);
+    }
+};
+
+// ---------------------------------------------------------------------------
+/**
+ * Delays the traversal by a fixed number of segments, so that the
+ * visitor can be told which segments follow the current one.
+ * The corpus elements must stay valid until the traversal is finished,
+ * which is the case for the copies made by SegmentOrderingVisitor.
+ */
+class CorpusDescription::SegmentLookAheadVisitorAdaptor : public CorpusVisitor {
+private:
+    enum EventType {
+        EnterCorpus,
+        LeaveCorpus,
+        EnterRecording,
+        LeaveRecording,
+        VisitSegment
+    };
+    struct Event {
+        EventType  type;
+        Corpus*    corpus;
+        Recording* recording;
+        Segment*   segment;
+        Event(EventType t, Corpus* c, Recording* r, Segment* s)
+                : type(t),
+                  corpus(c),
+                  recording(r),
+                  segment(s) {}
+    };
+
+    u32                  nSegments_;
+    CorpusVisitor*       visitor_;
+    std::deque<Event>    events_;
+    std::deque<Segment*> segments_;
+
+    void deliver(const Event& e) {
+        switch (e.type) {
+            case EnterCorpus: visitor_->enterCorpus(e.corpus); break;
+            case LeaveCorpus: visitor_->leaveCorpus(e.corpus); break;
+            case EnterRecording: visitor_->enterRecording(e.recording); break;
+            case LeaveRecording: visitor_->leaveRecording(e.recording); break;
+            case VisitSegment:
+                segments_.pop_front();
+                if (!segments_.empty())
+                    visitor_->announceSegments(std::vector<Segment*>(segments_.begin(), segments_.end()));
+                e.segment->accept(visitor_);
+                break;
+        }
+    }
+
+    /** Delivers queued events until at most @param nSegments segments are left. */
+    void flush(u32 nSegments) {
+        while (!events_.empty() && (segments_.size() > nSegments || (nSegments == 0))) {
+            Event e = events_.front();
+            events_.pop_front();
+            deliver(e);
+        }
+    }
+
+    void visit(Segment* s) {
+        events_.push_back(Event(VisitSegment, 0, 0, s));
+        segments_.push_back(s);
+        flush(nSegments_);
+    }
+
+public:
+    SegmentLookAheadVisitorAdaptor(u32 nSegments)
+            : nSegments_(nSegments),
+              visitor_(0) {}
+    void setVisitor(CorpusVisitor* v) {
+        visitor_ = v;
+    }
+    virtual void visitSegment(Segment* s) {
+        visit(s);
+    }
+    virtual void visitSpeechSegment(SpeechSegment* s) {
+        visit(s);
+    }
+    virtual void enterRecording(Recording* r) {
+        events_.push_back(Event(EnterRecording, 0, r, 0));
+    }
+    virtual void leaveRecording(Recording* r) {
+        events_.push_back(Event(LeaveRecording, 0, r, 0));
+    }
+    virtual void enterCorpus(Corpus* c) {
+        events_.push_back(Event(EnterCorpus, c, 0, 0));
+    }
+    virtual void leaveCorpus(Corpus* c) {
+        events_.push_back(Event(LeaveCorpus, c, 0, 0));
+        if (!c->level())
+            flush(0);
+    }
 };
 
 // ---------------------------------------------------------------------------
@@ -476,9 +583,16 @@ CorpusDescription::CorpusDescription(const Core::Configuration& c)
           progressChannel_(c, "progress"),
           reporter_(0),
           indicator_(0),
-          ordering_(0) {
+          ordering_(0),
+          lookAhead_(0),
+          image_(0) {
     filename_ = paramFilename(config);
 
+    std::string imageFilename = paramImage(config);
+    if (!imageFilename.empty()) {
+        loadImage(imageFilename);
+    }
+
     s32                            partitioning      = paramPartition(config);
     u32                            skipFirstSegments = paramSkipFirstSegments(config);
     const std::vector<std::string> segmentFullNames  = paramSegmentsToSkip(config);
@@ -562,6 +676,15 @@ CorpusDescription::CorpusDescription(const Core::Configuration& c)
             log("Using segment order sort-by-time-length with chunk-size %i", chunkSize);
         }
 
+        u32 segmentLookAhead = paramSegmentLookAhead(config);
+        if (segmentLookAhead) {
+            // the look-ahead keeps pointers to corpus elements, which the ordering keeps in memory
+            if (!ordering_)
+                ordering_ = new SegmentOrderingVisitor();
+            lookAhead_ = new SegmentLookAheadVisitorAdaptor(segmentLookAhead);
+            log("Announcing the next %d segments to the corpus visitor", segmentLookAhead);
+        }
+
         if (ordering_) {
             ordering_->setShortNameLookup(paramSegmentOrderLookupName(config));
         }
@@ -587,14 +710,59 @@ CorpusDescription::CorpusDescription(const Core::Configuration& c)
 }
 
 CorpusDescription::~CorpusDescription() {
+    delete image_;
+    delete lookAhead_;
     delete ordering_;
     delete selector_;
     delete reporter_;
     delete indicator_;
 }
 
+void CorpusDescription::loadImage(const std::string& imageFilename) {
+    std::string settings;
+    if (!filename_.empty()) {
+        settings = CorpusImage::settings(config, filename_);
+        if (!Core::isRegularFile(imageFilename)) {
+            log("Compiling corpus image \"%s\"", imageFilename.c_str());
+            Core::Timer timer;
+            timer.start();
+            CorpusImage::Builder    builder(CorpusDescriptionParser::paramRemoveCorpusNamePrefix(config));
+            CorpusDescriptionParser parser(config);
+            std::string             message;
+            if (parser.accept(filename_, &builder) != 0) {
+                warning("Failed to parse corpus \"%s\", corpus image not created", filename_.c_str());
+                return;
+            }
+            if (!builder.write(imageFilename, settings, message)) {
+                warning("Failed to create corpus image: %s", message.c_str());
+                return;
+            }
+            timer.stop();
+            log("Compiling corpus image took %.2fs", timer.elapsed());
+        }
+    }
+
+    image_ = new CorpusImage();
+    std::string info;
+    if (!image_->mount(imageFilename, info)) {
+        if (filename_.empty()) {
+            criticalError("Failed to mount corpus image \"%s\": %s", imageFilename.c_str(), info.c_str());
+        }
+        warning("Failed to mount corpus image \"%s\": %s. Using corpus file.", imageFilename.c_str(), info.c_str());
+        delete image_;
+        image_ = 0;
+        return;
+    }
+    if (!filename_.empty() && info != settings) {
+        warning("Corpus image \"%s\" was compiled with different settings (%s). Using corpus file.", imageFilename.c_str(), info.c_str());
+        delete image_;
+        image_ = 0;
+        return;
+    }
+    log("Mounted corpus image \"%s\" with %d segments", imageFilename.c_str(), image_->nSegments());
+}
+
 void CorpusDescription::accept(CorpusVisitor* visitor) {
-    CorpusDescriptionParser parser(config);
     if (indicator_) {
         indicator_->setVisitor(visitor);
         visitor = indicator_;
@@ -603,6 +771,10 @@ void CorpusDescription::accept(CorpusVisitor* visitor) {
         reporter_->setVisitor(visitor);
         visitor = reporter_;
     }
+    if (lookAhead_) {
+        lookAhead_->setVisitor(visitor);
+        visitor = lookAhead_;
+    }
     if (selector_) {
         selector_->setVisitor(visitor);
         visitor = selector_;
@@ -611,10 +783,22 @@ void CorpusDescription::accept(CorpusVisitor* visitor) {
         ordering_->setVisitor(visitor);
         visitor = ordering_;
     }
-    parser.accept(file(), visitor);
+    if (image_) {
+        // look-ahead needs the announced segments beyond their visit
+        if (!ordering_ || !ordering_->visitImage(*image_, lookAhead_ != 0)) {
+            image_->accept(visitor);
+        }
+    }
+    else {
+        CorpusDescriptionParser parser(config);
+        parser.accept(file(), visitor);
+    }
 }
 
 u32 CorpusDescription::totalSegmentCount() {
+    if (image_ && !selector_ && !ordering_) {
+        return image_->nSegments();
+    }
     SegmentCountingVisitor* counter = new SegmentCountingVisitor();
     counter->reset();
     // Note: An accept() call is problematic because we don't
@@ -623,8 +807,7 @@ u32 CorpusDescription::totalSegmentCount() {
     // thus we need to have our own copy here to not change the state.
     SegmentOrderingVisitor* ordering = ordering_ ? ordering_->copy() : 0;
     {
-        CorpusDescriptionParser parser(config);
-        CorpusVisitor*          visitor = counter;
+        CorpusVisitor* visitor = counter;
         if (selector_) {
             selector_->setVisitor(visitor);
             visitor = selector_;
@@ -633,7 +816,15 @@ u32 CorpusDescription::totalSegmentCount() {
             ordering->setVisitor(visitor);
             visitor = ordering;
         }
-        parser.accept(file(), visitor);
+        if (image_) {
+            if (!ordering || !ordering->visitImage(*image_, false)) {
+                image_->accept(visitor);
+            }
+        }
+        else {
+            CorpusDescriptionParser parser(config);
+            parser.accept(file(), visitor);
+        }
     }
     delete ordering;
     u32 nSegments = counter->nSegments();
@@ -21,6 +21,7 @@
 #include <Core/StringUtilities.hh>
 #include <map>
 #include <string>
+#include <vector>
 #include "Orthography.hh"
 
 namespace Bliss {
@@ -92,6 +93,7 @@ public:
 class Speaker : public NamedCorpusEntity {
     typedef NamedCorpusEntity Precursor;
     friend class SpeakerDescriptionElement;
+    friend class CorpusImage;
 
 public:
     enum Gender {
@@ -472,6 +474,7 @@ public:
 
 private:
     friend class CorpusDescriptionParser;
+    friend class CorpusImage;
 
     Speaker const* speaker_;
     std::string    lang_;
@@ -540,6 +543,14 @@ public:
      * This is rarely needed.
      */
     virtual void leaveCorpus(Corpus*) {}
+
+    /**
+     * Template method called before a segment is visited, if
+     * segment look-ahead is enabled, with the segments which will
+     * be visited next (in this order).  Implement this to prepare
+     * them, e.g. to read their features ahead of time.
+     */
+    virtual void announceSegments(const std::vector<Segment*>&) {}
 };
 
 /**
@@ -560,9 +571,12 @@ public:
  * - video-dir: path prefix for video files
  * - progress-indication: show progress meter while traversing corpus (none, local or global)
  * - progress.channel: output XML markup reflecting the structure of the corpus
+ * - segment-look-ahead: number of upcoming segments announced to the visitor
+ * - image: compiled corpus image, created from the corpus file if it does not exist
  */
 class ProgressReportingVisitorAdaptor;
 class SegmentOrderingVisitor;
+class CorpusImage;
 
 class CorpusDescription : public Core::Component {
 private:
@@ -586,6 +600,11 @@ private:
     class ProgressIndicationVisitorAdaptor;
     ProgressIndicationVisitorAdaptor* indicator_;
     SegmentOrderingVisitor*           ordering_;
+    class SegmentLookAheadVisitorAdaptor;
+    SegmentLookAheadVisitorAdaptor* lookAhead_;
+    CorpusImage*                    image_;
+
+    void loadImage(const std::string& imageFilename);
 
 public:
     static const Core::ParameterString       paramFilename;
@@ -607,6 +626,8 @@ public:
     static const Core::ParameterString       paramPythonSegmentOrderModPath;
     static const Core::ParameterString       paramPythonSegmentOrderModName;
     static const Core::ParameterString       paramPythonSegmentOrderConfig;
+    static const Core::ParameterInt          paramSegmentLookAhead;
+    static const Core::ParameterString       paramImage;
 
     CorpusDescription(const Core::Configuration&);
     ~CorpusDescription();
@@ -639,6 +660,9 @@ public:
     virtual void leaveRecording(Bliss::Recording* r);
     virtual void visitSegment(Segment* s);
     virtual void visitSpeechSegment(SpeechSegment* s);
+    virtual void announceSegments(const std::vector<Segment*>& segments) {
+        visitor_->announceSegments(segments);
+    }
 
 private:
     void openSegment(Segment* s);
@@ -0,0 +1,741 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "CorpusImage.hh"
+#include "CorpusParser.hh"
+
+#include <Core/Directory.hh>
+#include <Core/IoUtilities.hh>
+#include <Core/MD5.hh>
+#include <Core/StringUtilities.hh>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+using namespace Bliss;
+
+// ========================================================================
+// image layout
+
+struct CorpusImage::Header {
+    char magicWord[8];
+    u32  endianessMark;
+    u32  versionMark;
+    u32  nSections, nSpeakers, nConditions, nSegments, nBuckets;
+    u32  removePrefix, info;  // string offsets
+    u32  reserved;
+    u64  sections, speakers, conditions, segments, buckets, strings;
+    u64  end;
+
+    static const char* magic;
+    static const u32   endianess = 0x11223344;
+    static const u32   version   = 1;
+};
+
+const char* CorpusImage::Header::magic = "BLCI2601";
+
+namespace {
+
+enum SectionType {
+    sectionCorpus,
+    sectionRecording
+};
+
+const u32 flagAnonymous = 1;
+
+/**
+ * Orthographies are stored as one string.  Text spans are terminated
+ * by spanEnd, alternatives are enclosed in alternativesBegin and
+ * alternativesEnd and separated by alternativesSeparator.
+ */
+const char alternativesBegin     = '\x01';
+const char alternativesSeparator = '\x02';
+const char alternativesEnd       = '\x03';
+const char spanEnd               = '\x04';
+
+inline u64 padTo8(u64 n) {
+    return (n + 7) & ~u64(7);
+}
+
+}  // namespace
+
+struct CorpusImage::SectionRecord {
+    u32  parent;  // invalidIndex for the root corpus
+    u32  type;
+    u32  flags;
+    u32  name, fullName, audio, video;
+    u32  firstSegment, endSegment;  // segments of the section and its subsections
+    u32  reserved;
+    Time duration;
+};
+
+/** Speaker or acoustic condition */
+struct CorpusImage::EntityRecord {
+    u32 name;
+    u32 owner;  // defining section, invalidIndex if defined within the segment
+    u32 gender;
+    u32 flags;
+};
+
+struct CorpusImage::SegmentRecord {
+    u32     recording;
+    u32     name;
+    u32     orth, leftContextOrth, rightContextOrth;
+    u32     speaker, condition;
+    u16     type;
+    TrackId track;
+    Time    start, end;
+};
+
+// ========================================================================
+// class CorpusImage::Builder
+
+CorpusImage::Builder::Builder(const std::string& removeCorpusNamePrefix) {
+    addString(std::string());
+    removePrefix_ = addString(removeCorpusNamePrefix);
+}
+
+CorpusImage::Builder::~Builder() {}
+
+u32 CorpusImage::Builder::addString(const std::string& s) {
+    Core::StringHashMap<u32>::const_iterator i = stringIndex_.find(s);
+    if (i != stringIndex_.end()) {
+        return i->second;
+    }
+    u32 offset = strings_.size();
+    strings_.append(s.c_str(), s.size() + 1);
+    stringIndex_.insert(std::make_pair(s, offset));
+    return offset;
+}
+
+u32 CorpusImage::Builder::addOrthography(const Orthography& orth) {
+    std::string encoded;
+    encodeOrthography(orth, encoded);
+    return addString(encoded);
+}
+
+void CorpusImage::Builder::enterSection(const CorpusSection* section, Recording* recording) {
+    SectionRecord r;
+    ::memset(&r, 0, sizeof(r));
+    r.parent       = open_.empty() ? invalidIndex : open_.back().index;
+    r.type         = recording ? sectionRecording : sectionCorpus;
+    r.flags        = section->isAnonymous() ? flagAnonymous : 0;
+    r.name         = section->isAnonymous() ? 0 : addString(section->name());
+    r.fullName     = addString(section->fullName());
+    r.firstSegment = r.endSegment = segments_.size();
+    if (recording) {
+        r.audio    = addString(recording->audio());
+        r.video    = addString(recording->video());
+        r.duration = recording->duration();
+    }
+    OpenSection s;
+    s.object = section;
+    s.index  = sections_.size();
+    sections_.push_back(r);
+    open_.push_back(s);
+}
+
+void CorpusImage::Builder::leaveSection() {
+    verify(!open_.empty());
+    const OpenSection& s = open_.back();
+    sections_[s.index].endSegment = segments_.size();
+    // definitions of this section are deleted by the parser and their addresses may be reused
+    for (std::vector<const void*>::const_iterator e = s.speakers.begin(); e != s.speakers.end(); ++e) {
+        speakerIndex_.erase(*e);
+    }
+    for (std::vector<const void*>::const_iterator e = s.conditions.begin(); e != s.conditions.end(); ++e) {
+        conditionIndex_.erase(*e);
+    }
+    open_.pop_back();
+}
+
+void CorpusImage::Builder::enterCorpus(Corpus* c) {
+    enterSection(c, 0);
+}
+
+void CorpusImage::Builder::leaveCorpus(Corpus*) {
+    leaveSection();
+}
+
+void CorpusImage::Builder::enterRecording(Recording* r) {
+    enterSection(r, r);
+}
+
+void CorpusImage::Builder::leaveRecording(Recording*) {
+    leaveSection();
+}
+
+u32 CorpusImage::Builder::entity(const NamedCorpusEntity* entity, const Segment* segment, u32 gender,
+                                 std::vector<EntityRecord>& records, EntityMap& index, std::vector<const void*> OpenSection::*owned) {
+    if (!entity) {
+        return invalidIndex;
+    }
+    EntityMap::const_iterator i = index.find(entity);
+    if (i != index.end()) {
+        return i->second;
+    }
+
+    EntityRecord r;
+    r.name   = entity->isAnonymous() ? 0 : addString(entity->name());
+    r.owner  = invalidIndex;
+    r.gender = gender;
+    r.flags  = entity->isAnonymous() ? flagAnonymous : 0;
+    u32 result = records.size();
+    if (entity->parent() != segment) {
+        for (std::vector<OpenSection>::reverse_iterator s = open_.rbegin(); s != open_.rend(); ++s) {
+            if (s->object == entity->parent()) {
+                r.owner = s->index;
+                ((*s).*owned).push_back(entity);
+                index.insert(std::make_pair(entity, result));
+                break;
+            }
+        }
+    }
+    records.push_back(r);
+    return result;
+}
+
+void CorpusImage::Builder::addSegment(Segment* segment, const SpeechSegment* speech) {
+    verify(!open_.empty() && sections_[open_.back().index].type == sectionRecording);
+
+    SegmentRecord r;
+    ::memset(&r, 0, sizeof(r));
+    r.recording = open_.back().index;
+    r.name      = addString(segment->name());
+    r.type      = segment->type();
+    r.track     = segment->track();
+    r.start     = segment->start();
+    r.end       = segment->end();
+    r.condition = entity(segment->condition(), segment, 0, conditions_, conditionIndex_, &OpenSection::conditions);
+    r.speaker   = invalidIndex;
+    if (speech) {
+        r.orth             = addOrthography(speech->orthography());
+        r.leftContextOrth  = addString(speech->leftContextOrth());
+        r.rightContextOrth = addString(speech->rightContextOrth());
+        if (speech->speaker()) {
+            r.speaker = entity(speech->speaker(), segment, speech->speaker()->gender(), speakers_, speakerIndex_, &OpenSection::speakers);
+        }
+    }
+    segments_.push_back(r);
+    fullNames_.push_back(segment->fullName());
+}
+
+void CorpusImage::Builder::visitSegment(Segment* s) {
+    addSegment(s, 0);
+}
+
+void CorpusImage::Builder::visitSpeechSegment(SpeechSegment* s) {
+    addSegment(s, s);
+}
+
+bool CorpusImage::Builder::write(const std::string& filename, const std::string& info, std::string& error) {
+    if (!open_.empty()) {
+        error = "incomplete corpus";
+        return false;
+    }
+
+    // hash index: open addressing with linear probing, at most half full
+    u32 nBuckets = 1;
+    while (nBuckets < 2 * segments_.size()) {
+        nBuckets *= 2;
+    }
+    std::vector<u32> buckets(nBuckets, 0);
+    for (u32 s = 0; s < fullNames_.size(); ++s) {
+        u32 b = hash(fullNames_[s]) & (nBuckets - 1);
+        while (buckets[b]) {
+            b = (b + 1) & (nBuckets - 1);
+        }
+        buckets[b] = s + 1;
+    }
+
+    Header header;
+    ::memset(&header, 0, sizeof(header));
+    ::memcpy(header.magicWord, Header::magic, 8);
+    header.endianessMark = Header::endianess;
+    header.versionMark   = Header::version;
+    header.nSections     = sections_.size();
+    header.nSpeakers     = speakers_.size();
+    header.nConditions   = conditions_.size();
+    header.nSegments     = segments_.size();
+    header.nBuckets      = nBuckets;
+    header.removePrefix  = removePrefix_;
+    header.info          = addString(info);
+    header.sections      = padTo8(sizeof(Header));
+    header.speakers      = header.sections + sections_.size() * sizeof(SectionRecord);
+    header.conditions    = header.speakers + speakers_.size() * sizeof(EntityRecord);
+    header.segments      = header.conditions + conditions_.size() * sizeof(EntityRecord);
+    header.buckets       = header.segments + segments_.size() * sizeof(SegmentRecord);
+    header.strings       = padTo8(header.buckets + nBuckets * sizeof(u32));
+    header.end           = header.strings + strings_.size();
+
+    // write to a temporary file first, so that other processes never mount a partial image
+    std::string tmpFilename = filename + Core::form(".tmp-%d", int(getpid()));
+    int         fd          = open(tmpFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = "could not create " + tmpFilename;
+        return false;
+    }
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    bool       success    = Core::writeLargeBlock(fd, reinterpret_cast<const char*>(&header), sizeof(header)) &&
+                   Core::writeLargeBlock(fd, padding, header.sections - sizeof(header)) &&
+                   Core::writeLargeBlock(fd, reinterpret_cast<const char*>(sections_.data()), sections_.size() * sizeof(SectionRecord)) &&
+                   Core::writeLargeBlock(fd, reinterpret_cast<const char*>(speakers_.data()), speakers_.size() * sizeof(EntityRecord)) &&
+                   Core::writeLargeBlock(fd, reinterpret_cast<const char*>(conditions_.data()), conditions_.size() * sizeof(EntityRecord)) &&
+                   Core::writeLargeBlock(fd, reinterpret_cast<const char*>(segments_.data()), segments_.size() * sizeof(SegmentRecord)) &&
+                   Core::writeLargeBlock(fd, reinterpret_cast<const char*>(buckets.data()), nBuckets * sizeof(u32)) &&
+                   Core::writeLargeBlock(fd, padding, header.strings - header.buckets - nBuckets * sizeof(u32)) &&
+                   Core::writeLargeBlock(fd, strings_.data(), strings_.size());
+    success = (close(fd) == 0) && success;
+    if (success && rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+        success = false;
+    }
+    if (!success) {
+        unlink(tmpFilename.c_str());
+        error = "could not write " + filename;
+    }
+    return success;
+}
+
+// ========================================================================
+// class CorpusImage::Traversal
+
+/**
+ * Creates the corpus elements while the image is traversed.
+ * Sections are kept open on a stack.  Speakers and conditions are
+ * created when first referenced and live as long as the section
+ * defining them.
+ */
+class CorpusImage::Traversal {
+public:
+    Traversal(const CorpusImage& image, CorpusVisitor* visitor, bool keepElements)
+            : image_(image),
+              visitor_(visitor),
+              keepElements_(keepElements),
+              removePrefix_(image.string(image.header_->removePrefix)) {}
+
+    ~Traversal() {
+        verify(stack_.empty());
+        for (std::vector<NamedCorpusEntity*>::iterator e = garbage_.begin(); e != garbage_.end(); ++e) {
+            delete *e;
+        }
+    }
+
+    /** Make @param section the innermost open section, entering and leaving sections as needed. */
+    void moveTo(u32 section);
+    void visit(u32 segment);
+    void finish() {
+        while (!stack_.empty()) {
+            leave();
+        }
+    }
+
+private:
+    struct Frame {
+        u32              section;
+        CorpusSection*   object;
+        std::vector<u32> speakers, conditions;
+    };
+    typedef std::unordered_map<u32, NamedCorpusEntity*> EntityMap;
+
+    const CorpusImage&              image_;
+    CorpusVisitor*                  visitor_;
+    bool                            keepElements_;
+    std::string                     removePrefix_;
+    std::vector<Frame>              stack_;
+    EntityMap                       speakers_, conditions_;
+    std::vector<NamedCorpusEntity*> garbage_;
+    std::vector<u32>                path_;
+
+    void dispose(NamedCorpusEntity* e) {
+        if (keepElements_) {
+            garbage_.push_back(e);
+        }
+        else {
+            delete e;
+        }
+    }
+    void enter(u32 section);
+    void leave();
+
+    template<class T>
+    T* entity(u32 index, const EntityRecord* records, EntityMap& map, std::vector<u32> Frame::*owned,
+              Segment* segment, std::vector<NamedCorpusEntity*>& local);
+};
+
+void CorpusImage::Traversal::moveTo(u32 section) {
+    path_.clear();
+    for (u32 s = section; s != invalidIndex; s = image_.sections_[s].parent) {
+        path_.push_back(s);
+    }
+    std::reverse(path_.begin(), path_.end());
+    u32 depth = 0;
+    while (depth < stack_.size() && depth < path_.size() && stack_[depth].section == path_[depth]) {
+        ++depth;
+    }
+    while (stack_.size() > depth) {
+        leave();
+    }
+    for (; depth < path_.size(); ++depth) {
+        enter(path_[depth]);
+    }
+}
+
+void CorpusImage::Traversal::enter(u32 section) {
+    const SectionRecord& r = image_.sections_[section];
+    Frame                f;
+    f.section = section;
+    if (r.type == sectionRecording) {
+        verify(!stack_.empty());
+        Recording* recording = new Recording(static_cast<Corpus*>(stack_.back().object));
+        recording->setAudio(image_.string(r.audio));
+        recording->setVideo(image_.string(r.video));
+        recording->setDuration(r.duration);
+        f.object = recording;
+    }
+    else {
+        Corpus* corpus = new Corpus(stack_.empty() ? 0 : static_cast<Corpus*>(stack_.back().object));
+        corpus->setRemovePrefix(removePrefix_);
+        f.object = corpus;
+    }
+    if (!(r.flags & flagAnonymous)) {
+        f.object->setName(image_.string(r.name));
+    }
+    stack_.push_back(f);
+
+    if (r.type == sectionRecording) {
+        visitor_->enterRecording(static_cast<Recording*>(f.object));
+    }
+    else {
+        visitor_->enterCorpus(static_cast<Corpus*>(f.object));
+    }
+}
+
+void CorpusImage::Traversal::leave() {
+    Frame& f = stack_.back();
+    if (image_.sections_[f.section].type == sectionRecording) {
+        visitor_->leaveRecording(static_cast<Recording*>(f.object));
+    }
+    else {
+        visitor_->leaveCorpus(static_cast<Corpus*>(f.object));
+    }
+    for (std::vector<u32>::const_iterator s = f.speakers.begin(); s != f.speakers.end(); ++s) {
+        dispose(speakers_[*s]);
+        speakers_.erase(*s);
+    }
+    for (std::vector<u32>::const_iterator c = f.conditions.begin(); c != f.conditions.end(); ++c) {
+        dispose(conditions_[*c]);
+        conditions_.erase(*c);
+    }
+    dispose(f.object);
+    stack_.pop_back();
+}
+
+template<class T>
+T* CorpusImage::Traversal::entity(u32 index, const EntityRecord* records, EntityMap& map, std::vector<u32> Frame::*owned,
+                                  Segment* segment, std::vector<NamedCorpusEntity*>& local) {
+    if (index == invalidIndex) {
+        return 0;
+    }
+    EntityMap::const_iterator i = map.find(index);
+    if (i != map.end()) {
+        return static_cast<T*>(i->second);
+    }
+
+    const EntityRecord& r      = records[index];
+    T*                  result = new T(segment);
+    if (!(r.flags & flagAnonymous)) {
+        result->setName(image_.string(r.name));
+    }
+    Frame* owner = 0;
+    if (r.owner != invalidIndex) {
+        for (std::vector<Frame>::reverse_iterator f = stack_.rbegin(); f != stack_.rend(); ++f) {
+            if (f->section == r.owner) {
+                owner = &*f;
+                break;
+            }
+        }
+    }
+    if (owner) {
+        result->setParent(owner->object);
+        (owner->*owned).push_back(index);
+        map.insert(std::make_pair(index, result));
+    }
+    else {
+        local.push_back(result);
+    }
+    return result;
+}
+
+void CorpusImage::Traversal::visit(u32 index) {
+    const SegmentRecord& r = image_.segments_[index];
+    require(!stack_.empty() && stack_.back().section == r.recording);
+    Recording* recording = static_cast<Recording*>(stack_.back().object);
+
+    std::vector<NamedCorpusEntity*> local;
+    SpeechSegment*                  speech  = 0;
+    Segment*                        segment = 0;
+    if (r.type == Segment::typeSpeech) {
+        segment = speech = new SpeechSegment(recording);
+    }
+    else {
+        segment = new Segment(Segment::Type(r.type), recording);
+    }
+    segment->setName(image_.string(r.name));
+    segment->setStart(r.start);
+    segment->setEnd(r.end);
+    segment->setTrack(r.track);
+    segment->setCondition(entity<AcousticCondition>(r.condition, image_.conditions_, conditions_, &Frame::conditions, segment, local));
+    if (speech) {
+        Speaker* speaker = entity<Speaker>(r.speaker, image_.speakers_, speakers_, &Frame::speakers, segment, local);
+        if (speaker) {
+            CorpusImage::setGender(speaker, Speaker::Gender(image_.speakers_[r.speaker].gender));
+        }
+        speech->setSpeaker(speaker);
+
+        Orthography orth;
+        const char* s = image_.string(r.orth);
+        decodeOrthography(s, orth);
+        CorpusImage::setOrthography(speech, orth);
+        speech->setLeftContextOrth(image_.string(r.leftContextOrth));
+        speech->setRightContextOrth(image_.string(r.rightContextOrth));
+    }
+
+    segment->accept(visitor_);
+
+    for (std::vector<NamedCorpusEntity*>::iterator e = local.begin(); e != local.end(); ++e) {
+        dispose(*e);
+    }
+    dispose(segment);
+}
+
+// ========================================================================
+// class CorpusImage
+
+const u32 CorpusImage::invalidIndex;
+
+CorpusImage::CorpusImage()
+        : mmap_(0),
+          mmapSize_(0),
+          header_(0),
+          sections_(0),
+          speakers_(0),
+          conditions_(0),
+          segments_(0),
+          buckets_(0),
+          strings_(0) {}
+
+CorpusImage::~CorpusImage() {
+    if (mmap_) {
+        munmap(mmap_, mmapSize_);
+    }
+}
+
+std::string CorpusImage::settings(const Core::Configuration& config, const std::string& corpusFile) {
+    std::string corpusDir = Core::directoryName(corpusFile);
+    std::string checksum;
+    Core::MD5   md5;
+    if (md5.updateFromFile(corpusFile)) {
+        checksum = md5;
+    }
+    return Core::form("corpus=%s md5=%s audio-dir=%s video-dir=%s capitalize=%d gemenize=%d remove-prefix=%s",
+                      Core::realPath(corpusFile).c_str(),
+                      checksum.c_str(),
+                      CorpusDescriptionParser::paramAudioDir(config, corpusDir).c_str(),
+                      CorpusDescriptionParser::paramVideoDir(config, corpusDir).c_str(),
+                      int(CorpusDescriptionParser::paramCaptializeTranscriptions(config)),
+                      int(CorpusDescriptionParser::paramGemenizeTranscriptions(config)),
+                      CorpusDescriptionParser::paramRemoveCorpusNamePrefix(config).c_str());
+}
+
+bool CorpusImage::mount(const std::string& filename, std::string& info) {
+    require(!mmap_);
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        info = "could not open " + filename;
+        return false;
+    }
+    Header header;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header)) {
+        info = "could not read image header";
+        close(fd);
+        return false;
+    }
+    if (memcmp(header.magicWord, Header::magic, 8)) {
+        info = "bad magic word in image header";
+    }
+    else if (header.endianessMark != Header::endianess) {
+        info = "wrong endianess";
+    }
+    else if (header.versionMark != Header::version) {
+        info = "wrong image version";
+    }
+    else if (header.end != u64(st.st_size)) {
+        info = "image file is truncated";
+    }
+    else {
+        void* m = mmap(0, header.end, PROT_READ, MAP_SHARED, fd, 0);
+        if (m == MAP_FAILED) {
+            info = "mapping of image failed";
+        }
+        else {
+            mmap_     = static_cast<char*>(m);
+            mmapSize_ = header.end;
+        }
+    }
+    close(fd);
+    if (!mmap_) {
+        return false;
+    }
+
+    header_     = reinterpret_cast<const Header*>(mmap_);
+    sections_   = reinterpret_cast<const SectionRecord*>(mmap_ + header_->sections);
+    speakers_   = reinterpret_cast<const EntityRecord*>(mmap_ + header_->speakers);
+    conditions_ = reinterpret_cast<const EntityRecord*>(mmap_ + header_->conditions);
+    segments_   = reinterpret_cast<const SegmentRecord*>(mmap_ + header_->segments);
+    buckets_    = reinterpret_cast<const u32*>(mmap_ + header_->buckets);
+    strings_    = mmap_ + header_->strings;
+    info        = string(header_->info);
+    ensure(isMounted());
+    return true;
+}
+
+u32 CorpusImage::nSegments() const {
+    require(isMounted());
+    return header_->nSegments;
+}
+
+u64 CorpusImage::hash(const std::string& fullName) {
+    // FNV-1a
+    u64 h = 14695981039346656037ULL;
+    for (std::string::const_iterator c = fullName.begin(); c != fullName.end(); ++c) {
+        h = (h ^ u8(*c)) * 1099511628211ULL;
+    }
+    return h;
+}
+
+u32 CorpusImage::findSegment(const std::string& fullName) const {
+    require(isMounted());
+    u32 mask = header_->nBuckets - 1;
+    for (u32 b = hash(fullName) & mask; buckets_[b]; b = (b + 1) & mask) {
+        u32 s = buckets_[b] - 1;
+        if (segmentFullName(s) == fullName) {
+            return s;
+        }
+    }
+    return invalidIndex;
+}
+
+std::string CorpusImage::segmentName(u32 segment) const {
+    require(segment < nSegments());
+    return string(segments_[segment].name);
+}
+
+std::string CorpusImage::segmentFullName(u32 segment) const {
+    require(segment < nSegments());
+    const SegmentRecord& r = segments_[segment];
+    return std::string(string(sections_[r.recording].fullName)) + "/" + string(r.name);
+}
+
+Time CorpusImage::segmentDuration(u32 segment) const {
+    require(segment < nSegments());
+    return segments_[segment].end - segments_[segment].start;
+}
+
+void CorpusImage::accept(CorpusVisitor* visitor, bool keepElements) const {
+    require(isMounted());
+    Traversal traversal(*this, visitor, keepElements);
+    for (u32 s = 0; s < header_->nSections; ++s) {
+        traversal.moveTo(s);
+        if (sections_[s].type == sectionRecording) {
+            for (u32 i = sections_[s].firstSegment; i < sections_[s].endSegment; ++i) {
+                traversal.visit(i);
+            }
+        }
+    }
+    traversal.finish();
+}
+
+void CorpusImage::accept(const std::vector<u32>& segments, CorpusVisitor* visitor, bool keepElements) const {
+    require(isMounted());
+    Traversal traversal(*this, visitor, keepElements);
+    if (header_->nSections) {
+        traversal.moveTo(0);
+    }
+    for (std::vector<u32>::const_iterator s = segments.begin(); s != segments.end(); ++s) {
+        require(*s < nSegments());
+        traversal.moveTo(segments_[*s].recording);
+        traversal.visit(*s);
+    }
+    traversal.finish();
+}
+
+void CorpusImage::encodeOrthography(const Orthography& orth, std::string& result) {
+    for (Orthography::SpanList::const_iterator span = orth.spans().begin(); span != orth.spans().end(); ++span) {
+        switch (span->type()) {
+            case Orthography::Span::Type::text:
+                result += span->text();
+                result += spanEnd;
+                break;
+            case Orthography::Span::Type::alternatives: {
+                const std::vector<Orthography>& alternatives = span->alternatives();
+                result += alternativesBegin;
+                for (u32 i = 0; i < alternatives.size(); ++i) {
+                    if (i) {
+                        result += alternativesSeparator;
+                    }
+                    encodeOrthography(alternatives[i], result);
+                }
+                result += alternativesEnd;
+                break;
+            }
+        }
+    }
+}
+
+void CorpusImage::decodeOrthography(const char*& s, Orthography& orth) {
+    while (*s && *s != alternativesSeparator && *s != alternativesEnd) {
+        if (*s == alternativesBegin) {
+            std::vector<Orthography> alternatives;
+            do {
+                ++s;
+                alternatives.push_back(Orthography());
+                decodeOrthography(s, alternatives.back());
+            } while (*s == alternativesSeparator);
+            verify(*s == alternativesEnd);
+            ++s;
+            orth.appendAlternative(alternatives);
+        }
+        else {
+            const char* end = s;
+            while (*end != spanEnd) {
+                ++end;
+            }
+            orth.appendText(std::string(s, end));
+            s = end + 1;
+        }
+    }
+}
+
+void CorpusImage::setGender(Speaker* speaker, Speaker::Gender gender) {
+    speaker->gender_ = gender;
+}
+
+void CorpusImage::setOrthography(SpeechSegment* segment, const Orthography& orth) {
+    segment->orth_ = orth;
+}
@@ -0,0 +1,173 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef _BLISS_CORPUS_IMAGE_HH
+#define _BLISS_CORPUS_IMAGE_HH
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Core/Configuration.hh>
+#include <Core/Hash.hh>
+#include <Core/Types.hh>
+
+#include "CorpusDescription.hh"
+
+namespace Bliss {
+
+/**
+ * Compiled binary corpus description.
+ *
+ * The image holds flat tables of the corpus sections (corpora,
+ * subcorpora and recordings in document order), of the speakers and
+ * acoustic conditions referenced by the segments, of the segments
+ * themselves, a string pool and a hash index from full segment names
+ * to segments.  It is memory-mapped, so mounting takes constant time
+ * and the tables are shared by all processes using the same image.
+ *
+ * Traversal creates the corpus elements on the fly, like
+ * CorpusDescriptionParser does, and deletes them after they have been
+ * visited unless @c keepElements is set.
+ *
+ * Only speakers and conditions referenced by a segment are stored.
+ * The segments refer to them explicitly, so section defaults are
+ * resolved at compile time.
+ */
+class CorpusImage {
+public:
+    static const u32 invalidIndex = Core::Type<u32>::max;
+
+    class Builder;
+
+    CorpusImage();
+    ~CorpusImage();
+
+    /**
+     * Map an image file into memory.
+     * @param info on success the settings the image was compiled with,
+     * otherwise a failure message
+     */
+    bool mount(const std::string& filename, std::string& info);
+    bool isMounted() const {
+        return mmap_ != 0;
+    }
+
+    /**
+     * Description of the source file and of the parser settings,
+     * which are compiled into an image.  It contains the md5 sum of
+     * @param corpusFile, but not of the files included by it.
+     */
+    static std::string settings(const Core::Configuration& config, const std::string& corpusFile);
+
+    u32 nSegments() const;
+
+    /** @return index of the segment with the given full name or invalidIndex */
+    u32         findSegment(const std::string& fullName) const;
+    std::string segmentName(u32 segment) const;
+    std::string segmentFullName(u32 segment) const;
+    Time        segmentDuration(u32 segment) const;
+
+    /** Traverse the whole corpus in document order. */
+    void accept(CorpusVisitor* visitor, bool keepElements = false) const;
+
+    /**
+     * Traverse the given segments in the given order.
+     * Recordings and subcorpora are entered and left as needed, the
+     * root corpus is entered once.
+     */
+    void accept(const std::vector<u32>& segments, CorpusVisitor* visitor, bool keepElements = false) const;
+
+private:
+    struct Header;
+    struct SectionRecord;
+    struct EntityRecord;
+    struct SegmentRecord;
+    class Traversal;
+
+    char*                mmap_;
+    size_t               mmapSize_;
+    const Header*        header_;
+    const SectionRecord* sections_;
+    const EntityRecord*  speakers_;
+    const EntityRecord*  conditions_;
+    const SegmentRecord* segments_;
+    const u32*           buckets_;
+    const char*          strings_;
+
+    const char* string(u32 offset) const {
+        return strings_ + offset;
+    }
+    std::string sectionFullName(u32 section) const;
+
+    static u64  hash(const std::string& fullName);
+    static void encodeOrthography(const Orthography& orth, std::string& result);
+    static void decodeOrthography(const char*& s, Orthography& orth);
+    static void setGender(Speaker* speaker, Speaker::Gender gender);
+    static void setOrthography(SpeechSegment* segment, const Orthography& orth);
+};
+
+/**
+ * Collects a corpus, as delivered by CorpusDescriptionParser, and
+ * writes it as image.
+ */
+class CorpusImage::Builder : public CorpusVisitor {
+public:
+    Builder(const std::string& removeCorpusNamePrefix);
+    virtual ~Builder();
+
+    virtual void enterCorpus(Corpus*);
+    virtual void leaveCorpus(Corpus*);
+    virtual void enterRecording(Recording*);
+    virtual void leaveRecording(Recording*);
+    virtual void visitSegment(Segment*);
+    virtual void visitSpeechSegment(SpeechSegment*);
+
+    /**
+     * Write the image to a temporary file, which is renamed to
+     * @param filename when complete, so that concurrent readers never
+     * see a partial image.
+     */
+    bool write(const std::string& filename, const std::string& info, std::string& error);
+
+private:
+    struct OpenSection {
+        const CorpusSection*     object;
+        u32                      index;
+        std::vector<const void*> speakers, conditions;
+    };
+    typedef std::unordered_map<const void*, u32> EntityMap;
+
+    std::vector<SectionRecord> sections_;
+    std::vector<EntityRecord>  speakers_, conditions_;
+    std::vector<SegmentRecord> segments_;
+    std::vector<std::string>   fullNames_;
+    std::string                strings_;
+    Core::StringHashMap<u32>   stringIndex_;
+    u32                        removePrefix_;
+    std::vector<OpenSection>   open_;
+    EntityMap                  speakerIndex_, conditionIndex_;
+
+    u32  addString(const std::string& s);
+    u32  addOrthography(const Orthography& orth);
+    void enterSection(const CorpusSection* section, Recording* recording);
+    void leaveSection();
+    u32  entity(const NamedCorpusEntity* entity, const Segment* segment, u32 gender,
+                std::vector<EntityRecord>& records, EntityMap& index, std::vector<const void*> OpenSection::*owned);
+    void addSegment(Segment* segment, const SpeechSegment* speech);
+};
+
+}  // namespace Bliss
+
+#endif  // _BLISS_CORPUS_IMAGE_HH
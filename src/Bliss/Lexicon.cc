@@ -16,13 +16,16 @@
 #include <chrono>
 #include <unordered_map>
 
+#include <Core/Directory.hh>
 #include <Core/IoUtilities.hh>
 #include <Core/MD5.hh>
+#include <Core/MemoryAccounting.hh>
 #include <Core/StopWatch.hh>
 #include <Core/Utility.hh>
 #include <Fsa/AlphabetUtility.hh>
 #include "Fsa.hh"
 #include "Lexicon.hh"
+#include "LexiconImage.hh"
 #include "LexiconParser.hh"
 
 using namespace Bliss;
@@ -112,6 +115,10 @@ std::string Pronunciation::format(Core::Ref<const PhonemeInventory> phonemeInven
 
 // ===========================================================================
 ParameterString Lexicon::paramFilename("file", "name of lexicon file to load");
+ParameterString Lexicon::paramImage(
+        "image",
+        "compiled binary lexicon image, created from the XML lexicon file if missing or outdated",
+        "");
 
 struct Lexicon::Internal {
     // FSA adaptors
@@ -124,6 +131,12 @@ struct Lexicon::Internal {
     // construction helpers
     struct PronunciationSuffix;
     class PronunciationSuffixMap;
+
+    // heap growth while loading, charged to the "lexicon" account
+    Core::MemoryCharge memory_;
+
+    Internal()
+            : memory_("lexicon") {}
 };
 
 Lexicon::Lexicon(const Configuration& c)
@@ -139,21 +152,45 @@ Lexicon::~Lexicon() {
 }
 
 void Lexicon::load(const std::string& filename) {
+    // the lexicon is usually loaded before other threads allocate much memory
+    size_t heapBefore       = Core::MemoryAccounting::heapInUse();
+    auto   chargeHeapGrowth = [this, heapBefore]() {
+        size_t heap = Core::MemoryAccounting::heapInUse();
+        internal_->memory_.set(heap > heapBefore ? heap - heapBefore : 0);
+    };
+
     Core::StopWatch stopwatch;
     stopwatch.start();
 
     Core::MD5   md5;
     std::string strippedFilename = Core::FormatSet::stripQualifier(filename);
+    std::string qualifier        = Core::FormatSet::getQualifier(filename);
+    std::string imageFilename    = paramImage(config);
     if (md5.updateFromFile(strippedFilename)) {
         dependency_.setValue(md5);
     }
     else {
         warning("Could not derive md5 sum from file '%s'", strippedFilename.c_str());
+        imageFilename.clear();
     }
 
     stopwatch.stop();
     log("md5 dependency computed in %.2f seconds", stopwatch.elapsedSeconds());
 
+    // only XML lexica are compiled
+    if (!qualifier.empty() && qualifier != "xml") {
+        imageFilename.clear();
+    }
+    std::string imageSettings;
+    if (!imageFilename.empty()) {
+        imageSettings = LexiconImage::settings(config, dependency_.value());
+        if (loadImage(imageFilename, imageSettings)) {
+            chargeHeapGrowth();
+            log("dependency value: ") << dependency_.value();
+            return;
+        }
+    }
+
     std::string absFilename = Core::realPath(strippedFilename);
     log("reading lexicon from file \"%s\" (%s) ...", strippedFilename.c_str(), absFilename.c_str());
     stopwatch.reset();
@@ -161,11 +198,49 @@ void Lexicon::load(const std::string& filename) {
 
     if (!formats().read(filename, *this)) {
         error("Error while reading lexicon file.");
+        imageFilename.clear();
     }
+    chargeHeapGrowth();
 
     stopwatch.stop();
     log("parsed XML lexicon in %.2f seconds", stopwatch.elapsedSeconds());
     log("dependency value: ") << dependency_.value();
+
+    if (!imageFilename.empty()) {
+        writeImage(imageFilename, imageSettings);
+    }
+}
+
+bool Lexicon::loadImage(const std::string& filename, const std::string& settings) {
+    if (!Core::isRegularFile(filename)) {
+        return false;
+    }
+    Core::StopWatch stopwatch;
+    stopwatch.start();
+    LexiconImage image;
+    std::string  info;
+    if (!image.mount(filename, info)) {
+        warning("Failed to mount lexicon image \"%s\": %s", filename.c_str(), info.c_str());
+        return false;
+    }
+    if (info != settings) {
+        log("Lexicon image \"%s\" is outdated, it was compiled with %s", filename.c_str(), info.c_str());
+        return false;
+    }
+    image.restore(*this);
+    stopwatch.stop();
+    log("loaded lexicon image \"%s\" in %.2f seconds", filename.c_str(), stopwatch.elapsedSeconds());
+    return true;
+}
+
+void Lexicon::writeImage(const std::string& filename, const std::string& settings) const {
+    std::string message;
+    if (LexiconImage::write(*this, filename, settings, message)) {
+        log("Compiled lexicon image \"%s\"", filename.c_str());
+    }
+    else {
+        warning("Failed to create lexicon image: %s", message.c_str());
+    }
 }
 
 LexiconRef Lexicon::create(const Configuration& c) {
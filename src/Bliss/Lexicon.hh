@@ -68,6 +68,7 @@ public:
 
 private:
     friend class Lexicon;
+    friend class LexiconImage;
     Id                   id_;
     const Lemma*         lemma_;
     const Pronunciation* pronunciation_;
@@ -131,6 +132,7 @@ private:
 
 protected:
     friend class Lexicon;
+    friend class LexiconImage;
 
     Lemma();
     ~Lemma();
@@ -498,9 +500,11 @@ class LemmaToEvaluationTokenTransducer;
 class Lexicon : public Core::ReferenceCounted,
                 public Core::Component {
     static Core::ParameterString paramFilename;
+    static Core::ParameterString paramImage;
 
 protected:
     friend class LexiconElement;
+    friend class LexiconImage;
 
     Core::Dependency dependency_;
 
@@ -924,6 +928,9 @@ private:
     std::unique_ptr<Core::FormatSet> formats_;
 
     Core::FormatSet& formats();
+
+    bool loadImage(const std::string& filename, const std::string& settings);
+    void writeImage(const std::string& filename, const std::string& settings) const;
 };
 
 }  // namespace Bliss
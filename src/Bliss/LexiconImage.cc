@@ -0,0 +1,489 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "LexiconImage.hh"
+#include "LexiconParser.hh"
+
+#include <Core/Hash.hh>
+#include <Core/IoUtilities.hh>
+#include <Core/MD5.hh>
+#include <Core/StringUtilities.hh>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <unordered_map>
+
+using namespace Bliss;
+
+// ========================================================================
+// image layout
+
+struct LexiconImage::Header {
+    char magicWord[8];
+    u32  endianessMark;
+    u32  versionMark;
+    u32  flags;
+    u32  nPhonemes, nAliases, nLetters, nSyntacticTokens, nEvaluationTokens;
+    u32  nPronunciations, nLemmas, nLemmaPronunciations, nSpecialLemmas;
+    u32  nSymbols;
+    u32  info;  // string offset
+    u64  phonemes, aliases, letters, syntacticTokens, evaluationTokens;
+    u64  pronunciations, phonemeIds, lemmas, sequences, lemmaPronunciations, specialLemmas, strings;
+    u64  end;
+
+    static const char* magic;
+    static const u32   endianess = 0x11223344;
+    static const u32   version   = 1;
+};
+
+const char* LexiconImage::Header::magic = "BLLX2601";
+
+namespace {
+
+const u32 flagPhonemeInventory  = 1;  // Header
+const u32 flagContextDependent  = 1;  // PhonemeRecord
+const u32 flagNamed             = 1;  // LemmaRecord
+const u32 flagOrthographicForms = 2;
+const u32 flagSyntacticTokens   = 4;
+
+inline u64 padTo8(u64 n) {
+    return (n + 7) & ~u64(7);
+}
+
+}  // namespace
+
+struct LexiconImage::PhonemeRecord {
+    u32 symbol;
+    u32 flags;
+};
+
+/**
+ * Orthographic forms (string offsets), syntactic tokens (ids) and
+ * evaluation token sequences (each a length followed by the ids) are
+ * ranges of the sequence table.
+ */
+struct LexiconImage::LemmaRecord {
+    u32 name;
+    u32 flags;
+    u32 orth, nOrths;
+    u32 synt, nSynts;
+    u32 evals, nEvals;
+};
+
+struct LexiconImage::LemmaPronunciationRecord {
+    u32 lemma;
+    u32 pronunciation;
+    f32 score;
+};
+
+struct LexiconImage::SpecialLemmaRecord {
+    u32 name;
+    u32 lemma;
+};
+
+// ========================================================================
+// class LexiconImage::Writer
+
+/** Collects the tables of a lexicon. */
+class LexiconImage::Writer {
+public:
+    Writer() {
+        addString(std::string());
+    }
+
+    void collect(const Lexicon& lexicon);
+    bool write(const std::string& filename, const std::string& info, std::string& error);
+
+private:
+    u32                                   flags_;
+    std::vector<PhonemeRecord>            phonemes_;
+    std::vector<u32>                      aliases_, letters_, syntacticTokens_, evaluationTokens_;
+    std::vector<u32>                      pronunciations_;
+    std::vector<Phoneme::Id>              phonemeIds_;
+    std::vector<LemmaRecord>              lemmas_;
+    std::vector<u32>                      sequences_;
+    std::vector<LemmaPronunciationRecord> lemmaPronunciations_;
+    std::vector<SpecialLemmaRecord>       specialLemmas_;
+    std::string                           strings_;
+    Core::StringHashMap<u32>              stringIndex_;
+
+    u32 addString(const std::string& s);
+    template<class Sequence>
+    u32 addTokenIds(const Sequence& sequence);
+    void collectTokens(const TokenInventory& tokens, std::vector<u32>& symbols);
+};
+
+u32 LexiconImage::Writer::addString(const std::string& s) {
+    Core::StringHashMap<u32>::const_iterator i = stringIndex_.find(s);
+    if (i != stringIndex_.end()) {
+        return i->second;
+    }
+    u32 offset = strings_.size();
+    strings_.append(s.c_str(), s.size() + 1);
+    stringIndex_.insert(std::make_pair(s, offset));
+    return offset;
+}
+
+template<class Sequence>
+u32 LexiconImage::Writer::addTokenIds(const Sequence& sequence) {
+    u32 begin = sequences_.size();
+    for (typename Sequence::Iterator t = sequence.begin(); t != sequence.end(); ++t) {
+        sequences_.push_back((*t)->id());
+    }
+    return begin;
+}
+
+void LexiconImage::Writer::collectTokens(const TokenInventory& tokens, std::vector<u32>& symbols) {
+    for (TokenInventory::Iterator t = tokens.begin(); t != tokens.end(); ++t) {
+        symbols.push_back(addString((*t)->symbol().str()));
+    }
+}
+
+void LexiconImage::Writer::collect(const Lexicon& lexicon) {
+    flags_ = 0;
+    if (lexicon.phonemeInventory()) {
+        flags_ |= flagPhonemeInventory;
+        const PhonemeInventory& pi = *lexicon.phonemeInventory();
+        PhonemeInventory::PhonemeIterator p, p_end;
+        for (Core::tie(p, p_end) = pi.phonemes(); p != p_end; ++p) {
+            PhonemeRecord r;
+            r.symbol = addString((*p)->symbol().str());
+            r.flags  = (*p)->isContextDependent() ? flagContextDependent : 0;
+            phonemes_.push_back(r);
+        }
+        TokenInventory::LinkIterator l, l_end;
+        for (Core::tie(l, l_end) = pi.phonemes_.links(); l != l_end; ++l) {
+            if (::strcmp(l->first, l->second->symbol().str())) {
+                aliases_.push_back(l->second->id());
+                aliases_.push_back(addString(l->first));
+            }
+        }
+    }
+    collectTokens(lexicon.letters_, letters_);
+    collectTokens(lexicon.syntacticTokens_, syntacticTokens_);
+    collectTokens(lexicon.evaluationTokens_, evaluationTokens_);
+
+    std::unordered_map<const Pronunciation*, u32> pronunciationIndex;
+    for (Lexicon::PronunciationIterator p = lexicon.pronunciations_.begin(); p != lexicon.pronunciations_.end(); ++p) {
+        pronunciationIndex[*p] = pronunciations_.size();
+        pronunciations_.push_back(phonemeIds_.size());
+        for (u32 i = 0; i < (*p)->length(); ++i) {
+            phonemeIds_.push_back((**p)[i]);
+        }
+    }
+    pronunciations_.push_back(phonemeIds_.size());
+
+    for (TokenInventory::Iterator t = lexicon.lemmas_.begin(); t != lexicon.lemmas_.end(); ++t) {
+        const Lemma* lemma = static_cast<const Lemma*>(*t);
+        LemmaRecord  r;
+        ::memset(&r, 0, sizeof(r));
+        if (lemma->hasName()) {
+            r.flags |= flagNamed;
+            r.name = addString(lemma->name().str());
+        }
+        if (lemma->orthographicForms().valid()) {
+            r.flags |= flagOrthographicForms;
+            r.orth   = sequences_.size();
+            r.nOrths = lemma->nOrthographicForms();
+            for (OrthographicFormList::Iterator o = lemma->orthographicForms().begin(); o != lemma->orthographicForms().end(); ++o) {
+                sequences_.push_back(addString(o->str()));
+            }
+        }
+        if (lemma->hasSyntacticTokenSequence()) {
+            r.flags |= flagSyntacticTokens;
+            r.nSynts = lemma->syntacticTokenSequence().size();
+            r.synt   = addTokenIds(lemma->syntacticTokenSequence());
+        }
+        r.evals  = sequences_.size();
+        r.nEvals = lemma->nEvaluationTokenSequences();
+        Lemma::EvaluationTokenSequenceIterator e, e_end;
+        for (Core::tie(e, e_end) = lemma->evaluationTokenSequences(); e != e_end; ++e) {
+            sequences_.push_back(e->size());
+            addTokenIds(*e);
+        }
+        lemmas_.push_back(r);
+    }
+
+    for (Lexicon::LemmaPronunciationIterator lp = lexicon.lemmaPronunciationsByIndex_.begin(); lp != lexicon.lemmaPronunciationsByIndex_.end(); ++lp) {
+        LemmaPronunciationRecord r;
+        r.lemma         = (*lp)->lemma()->id();
+        r.pronunciation = pronunciationIndex[(*lp)->pronunciation()];
+        r.score         = (*lp)->pronunciationScore();
+        lemmaPronunciations_.push_back(r);
+    }
+
+    for (Lexicon::SpecialLemmaMap::const_iterator s = lexicon.specialLemmas_.begin(); s != lexicon.specialLemmas_.end(); ++s) {
+        for (const Lemma* lemma : s->second) {
+            SpecialLemmaRecord r;
+            r.name  = addString(s->first);
+            r.lemma = lemma->id();
+            specialLemmas_.push_back(r);
+        }
+    }
+}
+
+bool LexiconImage::Writer::write(const std::string& filename, const std::string& info, std::string& error) {
+    Header header;
+    ::memset(&header, 0, sizeof(header));
+    ::memcpy(header.magicWord, Header::magic, 8);
+    header.endianessMark        = Header::endianess;
+    header.versionMark          = Header::version;
+    header.flags                = flags_;
+    header.nPhonemes            = phonemes_.size();
+    header.nAliases             = aliases_.size() / 2;
+    header.nLetters             = letters_.size();
+    header.nSyntacticTokens     = syntacticTokens_.size();
+    header.nEvaluationTokens    = evaluationTokens_.size();
+    header.nPronunciations      = pronunciations_.size() - 1;
+    header.nLemmas              = lemmas_.size();
+    header.nLemmaPronunciations = lemmaPronunciations_.size();
+    header.nSpecialLemmas       = specialLemmas_.size();
+    header.nSymbols             = stringIndex_.size();
+    header.info                 = addString(info);
+
+    // every table starts at a multiple of 8
+    struct Table {
+        u64*        offset;
+        const void* data;
+        size_t      size;
+    } tables[] = {
+            {&header.phonemes, phonemes_.data(), phonemes_.size() * sizeof(PhonemeRecord)},
+            {&header.aliases, aliases_.data(), aliases_.size() * sizeof(u32)},
+            {&header.letters, letters_.data(), letters_.size() * sizeof(u32)},
+            {&header.syntacticTokens, syntacticTokens_.data(), syntacticTokens_.size() * sizeof(u32)},
+            {&header.evaluationTokens, evaluationTokens_.data(), evaluationTokens_.size() * sizeof(u32)},
+            {&header.pronunciations, pronunciations_.data(), pronunciations_.size() * sizeof(u32)},
+            {&header.phonemeIds, phonemeIds_.data(), phonemeIds_.size() * sizeof(Phoneme::Id)},
+            {&header.lemmas, lemmas_.data(), lemmas_.size() * sizeof(LemmaRecord)},
+            {&header.sequences, sequences_.data(), sequences_.size() * sizeof(u32)},
+            {&header.lemmaPronunciations, lemmaPronunciations_.data(), lemmaPronunciations_.size() * sizeof(LemmaPronunciationRecord)},
+            {&header.specialLemmas, specialLemmas_.data(), specialLemmas_.size() * sizeof(SpecialLemmaRecord)},
+            {&header.strings, strings_.data(), strings_.size()}};
+    const u32 nTables = sizeof(tables) / sizeof(Table);
+    u64       offset  = padTo8(sizeof(Header));
+    for (u32 t = 0; t < nTables; ++t) {
+        *tables[t].offset = offset;
+        offset            = padTo8(offset + tables[t].size);
+    }
+    header.end = offset;
+
+    // write to a temporary file first, so that other processes never mount a partial image
+    std::string tmpFilename = filename + Core::form(".tmp-%d", int(getpid()));
+    int         fd          = open(tmpFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = "could not create " + tmpFilename;
+        return false;
+    }
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    bool       success    = Core::writeLargeBlock(fd, reinterpret_cast<const char*>(&header), sizeof(header)) &&
+                   Core::writeLargeBlock(fd, padding, header.phonemes - sizeof(header));
+    for (u32 t = 0; success && t < nTables; ++t) {
+        u64 end = (t + 1 < nTables) ? *tables[t + 1].offset : header.end;
+        success = Core::writeLargeBlock(fd, static_cast<const char*>(tables[t].data), tables[t].size) &&
+                  Core::writeLargeBlock(fd, padding, end - *tables[t].offset - tables[t].size);
+    }
+    success = (close(fd) == 0) && success;
+    if (success && rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+        success = false;
+    }
+    if (!success) {
+        unlink(tmpFilename.c_str());
+        error = "could not write " + filename;
+    }
+    return success;
+}
+
+// ========================================================================
+// class LexiconImage
+
+LexiconImage::LexiconImage()
+        : mmap_(0),
+          mmapSize_(0),
+          header_(0) {}
+
+LexiconImage::~LexiconImage() {
+    if (mmap_) {
+        munmap(mmap_, mmapSize_);
+    }
+}
+
+std::string LexiconImage::settings(const Core::Configuration& config, const std::string& checksum) {
+    Core::Configuration vocabConfig(config, "vocab");
+    std::string         vocabFile = XmlLexiconParser::paramVocabFile(vocabConfig);
+    std::string         vocabChecksum;
+    if (!vocabFile.empty()) {
+        Core::MD5 md5;
+        if (md5.updateFromFile(vocabFile)) {
+            vocabChecksum = md5;
+        }
+    }
+    return Core::form("md5=%s normalize-pronunciation=%d vocab=%s vocab-encoding=%s vocab-md5=%s",
+                      checksum.c_str(),
+                      int(LexiconElement::paramNormalizePronunciation(config)),
+                      vocabFile.empty() ? "" : Core::realPath(vocabFile).c_str(),
+                      XmlLexiconParser::paramVocabEncoding(vocabConfig).c_str(),
+                      vocabChecksum.c_str());
+}
+
+bool LexiconImage::write(const Lexicon& lexicon, const std::string& filename, const std::string& info, std::string& error) {
+    Writer writer;
+    writer.collect(lexicon);
+    return writer.write(filename, info, error);
+}
+
+bool LexiconImage::mount(const std::string& filename, std::string& info) {
+    require(!mmap_);
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        info = "could not open " + filename;
+        return false;
+    }
+    Header      header;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header)) {
+        info = "could not read image header";
+        close(fd);
+        return false;
+    }
+    if (memcmp(header.magicWord, Header::magic, 8)) {
+        info = "bad magic word in image header";
+    }
+    else if (header.endianessMark != Header::endianess) {
+        info = "wrong endianess";
+    }
+    else if (header.versionMark != Header::version) {
+        info = "wrong image version";
+    }
+    else if (header.end != u64(st.st_size)) {
+        info = "image file is truncated";
+    }
+    else {
+        void* m = mmap(0, header.end, PROT_READ, MAP_SHARED, fd, 0);
+        if (m == MAP_FAILED) {
+            info = "mapping of image failed";
+        }
+        else {
+            mmap_     = static_cast<char*>(m);
+            mmapSize_ = header.end;
+        }
+    }
+    close(fd);
+    if (!mmap_) {
+        return false;
+    }
+
+    header_              = reinterpret_cast<const Header*>(mmap_);
+    phonemes_            = reinterpret_cast<const PhonemeRecord*>(mmap_ + header_->phonemes);
+    aliases_             = reinterpret_cast<const u32*>(mmap_ + header_->aliases);
+    letters_             = reinterpret_cast<const u32*>(mmap_ + header_->letters);
+    syntacticTokens_     = reinterpret_cast<const u32*>(mmap_ + header_->syntacticTokens);
+    evaluationTokens_    = reinterpret_cast<const u32*>(mmap_ + header_->evaluationTokens);
+    pronunciations_      = reinterpret_cast<const u32*>(mmap_ + header_->pronunciations);
+    phonemeIds_          = reinterpret_cast<const Phoneme::Id*>(mmap_ + header_->phonemeIds);
+    lemmas_              = reinterpret_cast<const LemmaRecord*>(mmap_ + header_->lemmas);
+    sequences_           = reinterpret_cast<const u32*>(mmap_ + header_->sequences);
+    lemmaPronunciations_ = reinterpret_cast<const LemmaPronunciationRecord*>(mmap_ + header_->lemmaPronunciations);
+    specialLemmas_       = reinterpret_cast<const SpecialLemmaRecord*>(mmap_ + header_->specialLemmas);
+    strings_             = mmap_ + header_->strings;
+    info                 = string(header_->info);
+    ensure(isMounted());
+    return true;
+}
+
+void LexiconImage::restore(Lexicon& lexicon) const {
+    require(isMounted());
+    require(!lexicon.phonemeInventory() && !lexicon.nLemmas());
+
+    if (header_->flags & flagPhonemeInventory) {
+        Core::Ref<PhonemeInventory> pi(new PhonemeInventory);
+        for (u32 p = 0; p < header_->nPhonemes; ++p) {
+            Phoneme* phoneme = pi->newPhoneme();
+            pi->assignSymbol(phoneme, string(phonemes_[p].symbol));
+            phoneme->setContextDependent(phonemes_[p].flags & flagContextDependent);
+        }
+        for (u32 a = 0; a < header_->nAliases; ++a) {
+            pi->assignSymbol(static_cast<Phoneme*>(pi->phonemes_[Token::Id(aliases_[2 * a])]), string(aliases_[2 * a + 1]));
+        }
+        lexicon.setPhonemeInventory(pi);
+    }
+    // Tokens are created in the order of their ids, so that all later
+    // lookups by symbol find them.  The counts are known, so the
+    // hash tables are allocated once.
+    lexicon.symbols_.reserve(header_->nSymbols);
+    lexicon.letters_.reserve(header_->nLetters);
+    lexicon.syntacticTokens_.reserve(header_->nSyntacticTokens);
+    lexicon.evaluationTokens_.reserve(header_->nEvaluationTokens);
+    lexicon.lemmas_.reserve(header_->nLemmas);
+    lexicon.pronunciations_.reserve(header_->nPronunciations);
+    lexicon.pronunciationMap_.reserve(header_->nPronunciations);
+    lexicon.lemmaPronunciationsByIndex_.reserve(header_->nLemmaPronunciations);
+    for (u32 l = 0; l < header_->nLetters; ++l) {
+        lexicon.letter(string(letters_[l]));
+    }
+    for (u32 s = 0; s < header_->nSyntacticTokens; ++s) {
+        lexicon.getOrCreateSyntacticToken(lexicon.symbols_[string(syntacticTokens_[s])]);
+    }
+    for (u32 e = 0; e < header_->nEvaluationTokens; ++e) {
+        lexicon.getOrCreateEvaluationToken(lexicon.symbols_[string(evaluationTokens_[e])]);
+    }
+
+    std::vector<Pronunciation*> pronunciations(header_->nPronunciations);
+    std::vector<Phoneme::Id>    phonemes;
+    for (u32 p = 0; p < header_->nPronunciations; ++p) {
+        phonemes.assign(phonemeIds_ + pronunciations_[p], phonemeIds_ + pronunciations_[p + 1]);
+        phonemes.push_back(Phoneme::term);
+        pronunciations[p] = lexicon.getOrCreatePronunciation(phonemes);
+    }
+
+    std::vector<Lemma*>      lemmas(header_->nLemmas);
+    std::vector<std::string> orths;
+    std::vector<Token::Id>   ids;
+    for (u32 l = 0; l < header_->nLemmas; ++l) {
+        const LemmaRecord& r     = lemmas_[l];
+        Lemma*             lemma = lemmas[l] = lexicon.newLemma();
+        if (r.flags & flagNamed) {
+            lexicon.setLemmaName(lemma, lexicon.symbols_[string(r.name)]);
+        }
+        if (r.flags & flagOrthographicForms) {
+            orths.clear();
+            for (u32 o = 0; o < r.nOrths; ++o) {
+                orths.push_back(string(sequences_[r.orth + o]));
+            }
+            // all letters exist already
+            lemma->setOrthographicForms(lexicon.symbolSequences_.add(orths));
+        }
+        if (r.flags & flagSyntacticTokens) {
+            ids.assign(sequences_ + r.synt, sequences_ + r.synt + r.nSynts);
+            lexicon.setSyntacticTokenSequence(lemma, ids);
+        }
+        const u32* e = sequences_ + r.evals;
+        for (u32 i = 0; i < r.nEvals; ++i, e += 1 + *e) {
+            ids.assign(e + 1, e + 1 + *e);
+            lexicon.addEvaluationTokenSequence(lemma, ids);
+        }
+    }
+
+    for (u32 lp = 0; lp < header_->nLemmaPronunciations; ++lp) {
+        const LemmaPronunciationRecord& r = lemmaPronunciations_[lp];
+        lexicon.addPronunciation(lemmas[r.lemma], pronunciations[r.pronunciation]);
+        const_cast<LemmaPronunciation*>(lexicon.lemmaPronunciationsByIndex_.back())->score_ = r.score;
+    }
+
+    for (u32 s = 0; s < header_->nSpecialLemmas; ++s) {
+        lexicon.defineSpecialLemma(string(specialLemmas_[s].name), lemmas[specialLemmas_[s].lemma]);
+    }
+}
@@ -0,0 +1,104 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef _BLISS_LEXICON_IMAGE_HH
+#define _BLISS_LEXICON_IMAGE_HH
+
+#include <string>
+
+#include <Core/Configuration.hh>
+#include <Core/Types.hh>
+
+#include "Lexicon.hh"
+
+namespace Bliss {
+
+/**
+ * Compiled binary lexicon.
+ *
+ * The image holds flat tables of the phonemes, letters, syntactic
+ * and evaluation tokens, pronunciations, lemmas and lemma
+ * pronunciations of a completely parsed lexicon, all in the order of
+ * their ids, together with a string pool.  The file is
+ * memory-mapped.
+ *
+ * restore() rebuilds the lexicon from the tables without any XML
+ * or whitespace processing.  All ids are identical to those of the
+ * parsed lexicon, pronunciation scores are stored as they are, so
+ * normalization is not repeated.
+ */
+class LexiconImage {
+public:
+    LexiconImage();
+    ~LexiconImage();
+
+    /**
+     * Map an image file into memory.
+     * @param info on success the settings the image was compiled with,
+     * otherwise a failure message
+     */
+    bool mount(const std::string& filename, std::string& info);
+    bool isMounted() const {
+        return mmap_ != 0;
+    }
+
+    /**
+     * Description of the source file and of the parser settings,
+     * which are compiled into an image.
+     * @param checksum md5 sum of the lexicon file
+     */
+    static std::string settings(const Core::Configuration& config, const std::string& checksum);
+
+    /** Fill the empty @param lexicon from the image. */
+    void restore(Lexicon& lexicon) const;
+
+    /**
+     * Write the image to a temporary file, which is renamed to
+     * @param filename when complete, so that concurrent readers never
+     * see a partial image.
+     */
+    static bool write(const Lexicon& lexicon, const std::string& filename, const std::string& info, std::string& error);
+
+private:
+    struct Header;
+    struct PhonemeRecord;
+    struct LemmaRecord;
+    struct LemmaPronunciationRecord;
+    struct SpecialLemmaRecord;
+    class Writer;
+
+    char*                           mmap_;
+    size_t                          mmapSize_;
+    const Header*                   header_;
+    const PhonemeRecord*            phonemes_;
+    const u32*                      aliases_;
+    const u32*                      letters_;
+    const u32*                      syntacticTokens_;
+    const u32*                      evaluationTokens_;
+    const u32*                      pronunciations_;
+    const Phoneme::Id*              phonemeIds_;
+    const LemmaRecord*              lemmas_;
+    const u32*                      sequences_;
+    const LemmaPronunciationRecord* lemmaPronunciations_;
+    const SpecialLemmaRecord*       specialLemmas_;
+    const char*                     strings_;
+
+    const char* string(u32 offset) const {
+        return strings_ + offset;
+    }
+};
+
+}  // namespace Bliss
+
+#endif  // _BLISS_LEXICON_IMAGE_HH
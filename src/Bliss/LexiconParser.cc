@@ -352,23 +352,21 @@ void LexiconElement::endLemma() {
 
 // ===========================================================================
 
-namespace {
-const Core::ParameterString paramFile(
+const Core::ParameterString XmlLexiconParser::paramVocabFile(
         "file",
         "file name",
         "");
-const Core::ParameterString paramEncoding(
+const Core::ParameterString XmlLexiconParser::paramVocabEncoding(
         "encoding",
         "encoding",
         "utf-8");
-}  // namespace
 
 void XmlLexiconParser::loadWhitelist(const Core::Configuration& config, Core::StringHashSet& whitelist) {
-    std::string filename = paramFile(config);
+    std::string filename = paramVocabFile(config);
     if (!filename.empty()) {
         Core::CompressedInputStream* cis = new Core::CompressedInputStream(filename.c_str());
         Core::TextInputStream        is(cis);
-        is.setEncoding(paramEncoding(config));
+        is.setEncoding(paramVocabEncoding(config));
         if (!is)
             criticalError("Failed to open vocab file \"%s\".", filename.c_str());
         std::string s;
@@ -60,6 +60,7 @@ class LexiconElement : public Core::XmlBuilderElement<
                                Core::CreateByContext> {
     friend class LexiconParser;
     friend class XmlLexiconParser;
+    friend class LexiconImage;
     typedef Core::XmlBuilderElement<
             Lexicon,
             Core::XmlRegularElement,
@@ -127,6 +128,10 @@ private:
     void loadWhitelist(const Core::Configuration&, Core::StringHashSet&);
 
 public:
+    /** Vocabulary whitelist, configured as "vocab" */
+    static const Core::ParameterString paramVocabFile;
+    static const Core::ParameterString paramVocabEncoding;
+
     XmlLexiconParser(const Core::Configuration& c, Lexicon*);
     bool     parseFile(const std::string& filename) override;
     Lexicon* lexicon() const override {
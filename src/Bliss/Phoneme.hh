@@ -144,6 +144,7 @@ class PhonemeAlphabet;
 class PhonemeInventory : public Core::ReferenceCounted {
 private:
     friend class PhonemeAlphabet;
+    friend class LexiconImage;
     TokenInventory phonemes_;
     struct Internal;
     Internal* internal_;
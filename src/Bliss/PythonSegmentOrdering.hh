@@ -50,6 +50,11 @@ public:
     virtual SegmentOrderingVisitor* copy();
 
     virtual void leaveCorpus(Bliss::Corpus* corpus);
+
+    /** The order is determined by the Python module from the traversed corpus. */
+    virtual bool visitImage(const CorpusImage&, bool) {
+        return false;
+    }
 };
 
 }  // namespace Bliss
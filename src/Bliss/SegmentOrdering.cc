@@ -12,10 +12,12 @@
  *  See the License for the specific language governing permissions and
  *  limitations under the License.
  */
+#include <Bliss/CorpusImage.hh>
 #include <Bliss/SegmentOrdering.hh>
 #include <Core/Application.hh>
 #include <Core/CompressedStream.hh>
 #include <Math/Random.hh>
+#include <numeric>
 
 using namespace Bliss;
 
@@ -263,6 +265,63 @@ void SegmentOrderingVisitor::leaveCorpus(Corpus* corpus) {
     finishSegmentLoop();
 }
 
+bool SegmentOrderingVisitor::visitImage(const CorpusImage& image, bool keepElements) {
+    std::vector<u32> order;
+    if (predefinedOrder_) {
+        Core::StringHashMap<u32> shortNames;
+        if (shortNameLookup_) {
+            for (u32 s = 0; s < image.nSegments(); ++s) {
+                if (!shortNames.insert(std::make_pair(image.segmentName(s), s)).second) {
+                    Core::Application::us()->error("can not add segment, because it is already present in segment list: ") << image.segmentName(s);
+                }
+            }
+        }
+        order.reserve(segmentList_.size());
+        for (std::vector<std::string>::const_iterator name = segmentList_.begin(); name != segmentList_.end(); ++name) {
+            u32 s = CorpusImage::invalidIndex;
+            if (shortNameLookup_) {
+                Core::StringHashMap<u32>::const_iterator i = shortNames.find(*name);
+                if (i != shortNames.end()) {
+                    s = i->second;
+                }
+            }
+            else {
+                s = image.findSegment(*name);
+            }
+            if (s == CorpusImage::invalidIndex) {
+                Core::Application::us()->error("segment '%s' not found", name->c_str());
+                continue;
+            }
+            order.push_back(s);
+        }
+    }
+    else {
+        order.resize(image.nSegments());
+        std::iota(order.begin(), order.end(), 0);
+    }
+
+    // same permutations as prepareSegmentLoop()
+    if (autoShuffle_)
+        std::shuffle(order.begin(), order.end(), shuffleRandomEngine_);
+    if (sortByTimeLength_) {
+        size_t n0 = 0;
+        while (n0 < order.size()) {
+            size_t n = order.size() - n0;
+            if (sortByTimeLengthChunkSize_ > 0)
+                n = std::min(n, (size_t)sortByTimeLengthChunkSize_);
+            std::stable_sort(
+                    order.begin() + n0, order.begin() + n0 + n,
+                    [&image](u32 s0, u32 s1) {
+                        return image.segmentDuration(s0) < image.segmentDuration(s1);
+                    });
+            n0 += n;
+        }
+    }
+
+    image.accept(order, visitor_, keepElements);
+    return true;
+}
+
 SegmentOrderingVisitor::CustomCorpusGuide::CustomCorpusGuide(SegmentOrderingVisitor* parent, Corpus* rootCorpus)
         : parent_(parent),
           rootCorpus_(rootCorpus),
@@ -20,6 +20,8 @@
 
 namespace Bliss {
 
+class CorpusImage;
+
 /**
  * Changes the order of processed segments according to a given
  * segment id list (full segment names).
@@ -60,6 +62,13 @@ public:
     }
     virtual void visitSpeechSegment(SpeechSegment* s);
 
+    /**
+     * Traverse the segments of a corpus image in the configured order.
+     * Unlike the corpus traversal, this does not copy the corpus.
+     * @return false if the ordering needs the corpus traversal
+     */
+    virtual bool visitImage(const CorpusImage& image, bool keepElements);
+
 private:
     class CorpusCopy;
     class RecordingCopy;
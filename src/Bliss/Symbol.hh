@@ -143,6 +143,11 @@ public:
      * Symbol is added if not already present. */
     Symbol operator[](const Symbol::String&);
 
+    /** Prepare for @param n symbols, avoids rehashing. */
+    void reserve(size_t n) {
+        map_.reserve(n);
+    }
+
     /** return void symbol if not present */
     Symbol get(const Symbol::Char*) const;
     Symbol get(const Symbol::String&) const;
@@ -209,6 +214,12 @@ public:
             delete *tt;
     }
 
+    /** Prepare for @param n tokens, avoids rehashing when their number is known in advance. */
+    void reserve(u32 n) {
+        list_.reserve(n);
+        map_.reserve(n);
+    }
+
     void insert(Token* token) {
         token->setId(list_.size());
         list_.push_back(token);
@@ -241,6 +252,13 @@ public:
         return list_.size();
     }
 
+    typedef Map::const_iterator LinkIterator;
+
+    /** All symbols linked to tokens, including additional symbols of a token. */
+    std::pair<LinkIterator, LinkIterator> links() const {
+        return std::make_pair(map_.begin(), map_.end());
+    }
+
     typedef Token* const* Iterator;
 
     Iterator begin() const {
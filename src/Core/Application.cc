@@ -28,9 +28,11 @@
 #include "Configuration.hh"
 #include "Directory.hh"
 #include "MappedArchive.hh"
+#include "MemoryAccounting.hh"
 #include "MemoryInfo.hh"
 #include "Parameter.hh"
 #include "Statistics.hh"
+#include "Tracing.hh"
 #include "Version.hh"
 
 extern char** environ;
@@ -266,6 +268,7 @@ void Application::logMemoryUsage() const {
        << XmlFull("current", info.size())
        << XmlFull("peak", info.peak())
        << XmlClose("virtual-memory");
+    MemoryAccounting::write(rc);
 }
 
 void Application::reportLowLevelError(const std::string& msg) {
@@ -402,6 +405,11 @@ int Application::main(int argc, char* argv[]) {
         std::cerr << app_->getUsage();
     }
     else {
+        Tracer::configure(Configuration(app_->getConfiguration(), "tracing"));
+        if (Tracer::isEnabled()) {
+            Tracer::setThreadName("main");
+            app_->atexit([]() { Tracer::write(); });
+        }
         status = app_->run(arguments);
 #ifdef MODULE_CORE_CACHE_MANAGER
         copyLocalCacheFiles();
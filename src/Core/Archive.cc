@@ -12,10 +12,11 @@
  *  See the License for the specific language governing permissions and
  *  limitations under the License.
  */
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <zlib.h>
 
 #include "Application.hh"
 #include "Archive.hh"
@@ -23,13 +24,62 @@
 #include "BundleArchive.hh"
 #include "DirectoryArchive.hh"
 #include "FileArchive.hh"
+#include "Tracing.hh"
 
 using namespace Core;
 
+const Choice Archive::choiceCompressionCodec(
+        "zlib", ArchiveCodecZlib,
+        "zstd", ArchiveCodecZstd,
+        "lz4", ArchiveCodecLz4,
+        Choice::endMark());
+
+const ParameterChoice Archive::paramCompressionCodec(
+        "compression-codec", &choiceCompressionCodec,
+        "codec used for files written with compression, files of all codecs can be read", ArchiveCodecZlib);
+
+const ParameterInt Archive::paramCompressionLevel(
+        "compression-level", "compression level of the codec, negative: default level of the codec", -1);
+
+const ParameterString Archive::paramZstdDictionary(
+        "zstd-dictionary", "dictionary used to compress and decompress zstd files (e.g. trained with 'zstd --train')", "");
+
 Archive::Archive(const Core::Configuration& config, const std::string& path, AccessMode access)
         : Component(config),
           path_(path),
-          access_(access) {
+          access_(access),
+          codecType_(static_cast<ArchiveCodecType>(paramCompressionCodec(config))),
+          compressionLevel_(paramCompressionLevel(config)),
+          zstdDictionaryFile_(paramZstdDictionary(config)) {
+    std::fill(codecs_, codecs_ + ArchiveCodecUnknown, static_cast<ArchiveCodec*>(0));
+    if ((access & AccessModeWrite) && !ArchiveCodec::isAvailable(codecType_))
+        error("Compression codec \"%s\" is not available in this build.", ArchiveCodec::name(codecType_));
+}
+
+Archive::~Archive() {
+    for (u32 i = 0; i < ArchiveCodecUnknown; ++i)
+        delete codecs_[i];
+}
+
+ArchiveCodec* Archive::codec(ArchiveCodecType type) const {
+    if (type >= ArchiveCodecUnknown)
+        return 0;
+    if (!codecs_[type]) {
+        std::string dictionary;
+        if (type == ArchiveCodecZstd && !zstdDictionaryFile_.empty()) {
+            std::ifstream in(zstdDictionaryFile_.c_str(), std::ios::in | std::ios::binary);
+            std::ostringstream content;
+            if (!(in && content << in.rdbuf())) {
+                error("Failed to read zstd dictionary \"%s\".", zstdDictionaryFile_.c_str());
+                return 0;
+            }
+            dictionary = content.str();
+        }
+        codecs_[type] = ArchiveCodec::create(type, compressionLevel_, dictionary);
+        if (!codecs_[type])
+            error("Compression codec \"%s\" is not available in this build.", ArchiveCodec::name(type));
+    }
+    return codecs_[type];
 }
 
 bool Archive::hasFile(const std::string& name) const {
@@ -49,7 +99,43 @@ bool Archive::removeFile(const std::string& name) {
     return result;
 }
 
+bool Archive::fileSizes(const std::string& name, Sizes& sizes) const {
+    lock();
+    bool result = discover(name, sizes);
+    release();
+    return result;
+}
+
+bool Archive::readInto(const std::string& name, const Sizes& sizes, char* buffer) const {
+    const char*                 stored = 0;
+    std::shared_ptr<const void> owner;
+    std::string                 tmp;
+    if (!view(name, stored, owner)) {
+        tmp.resize(sizes.compressed() ? sizes.compressed() : sizes.uncompressed());
+        if (!read(name, tmp))
+            return false;
+        stored = tmp.data();
+    }
+    if (!sizes.compressed()) {
+        std::copy(stored, stored + sizes.uncompressed(), buffer);
+        return true;
+    }
+
+    // files of older archives are always gzip members
+    ArchiveCodecType type = ArchiveCodec::detect(stored, sizes.compressed());
+    ArchiveCodec*    c    = codec(type == ArchiveCodecUnknown ? ArchiveCodecZlib : type);
+    std::string      msg;
+    if (!c)
+        return false;
+    if (!c->decompress(stored, sizes.compressed(), buffer, sizes.uncompressed(), msg)) {
+        error("Failed to decompress file \"%s\" (%s): %s.", name.c_str(), ArchiveCodec::name(c->type()), msg.c_str());
+        return false;
+    }
+    return true;
+}
+
 bool Archive::readFile(const std::string& name, std::string& b) {
+    TRACE_SCOPE("archive", "read");
     lock();
 
     Sizes sizes;
@@ -58,160 +144,54 @@ bool Archive::readFile(const std::string& name, std::string& b) {
         return false;
     }
 
-    /* from zlib.h:
-     *
-     * ZEXTERN int ZEXPORT uncompress OF((Bytef *dest, uLongf *destLen, const Bytef *source, uLong sourceLen));
-     *
-     * Decompresses the source buffer into the destination buffer. sourceLen
-     * is the byte length of the source buffer. Upon entry, destLen is the
-     * total size of the destination buffer, which must be large enough to
-     * hold the entire uncompressed data. (The size of the uncompressed data
-     * must have been saved previously by the compressor and transmitted to
-     * the decompressor by some mechanism outside the scope of this
-     * compression library.) Upon exit, destLen is the actual size of the
-     * compressed buffer.
-     * This function can be used to decompress a whole file at once if the
-     * input file is mmap'ed.
-     *
-     * uncompress returns Z_OK if success, Z_MEM_ERROR if there was not
-     * enough memory, Z_BUF_ERROR if there was not enough room in the output
-     * buffer, or Z_DATA_ERROR if the input data was corrupted.
-     */
-
-    bool status = false;
-    if (sizes.compressed() > 0) {
-        std::string tmp;
-        tmp.resize(sizes.compressed());
-        if (read(name, tmp)) {
-            // We might want to check the CRC32 here.
-            b.resize(sizes.uncompressed());
-            uLongf tmplen         = b.size();
-            uLongf compressedSize = tmp.size() - 10 + 2;
-
-            // check for extra gzip header data and skip it (zlib does not detect it)
-            u32 base = 10;
-            if (tmp[3] & 0x04)
-                base += (int(tmp[base]) + int(tmp[base + 1])) << 8;  // extra field
-            if (tmp[3] & 0x08) {
-                for (; (base < compressedSize) && (tmp[base]); base++)
-                    ;  // filename
-                base++;
-            }
-            if (tmp[3] & 0x10) {
-                for (; (base < compressedSize) && (tmp[base]); base++)
-                    ;  // comment
-                base++;
-            }
-            if (tmp[3] & 0x02)
-                base += 2;  // crc16
-
-            // restore bogus zlib header
-            base -= 2;
-            tmp[base]     = 0x78;
-            tmp[base + 1] = 0x9c;
-            switch (uncompress((Bytef*)&b[0], &tmplen, (Bytef*)&tmp[base], compressedSize)) {
-                case Z_MEM_ERROR:
-                    std::cerr << "no memory to decompress." << std::endl;
-                    break;
-                case Z_BUF_ERROR:
-                    std::cerr << "unpack buffer was too small (" << sizes.compressed() << ", "
-                              << sizes.uncompressed() << ", " << tmplen << ")." << std::endl;
-                    break;
-                case Z_DATA_ERROR:
-                    /* CAUTION! Zlib thinks that data was corrupted because we replaced
-                     * the adler32 checksum by a gzip compatible crc32. So we ignore the error.
-                     */
-                    // fall through
-                case Z_OK:
-                default:
-                    b.resize(tmplen);
-                    status = true;
-                    break;
-            }
-        }
-    }
-    else {
-        b.resize(sizes.uncompressed());
+    b.resize(sizes.uncompressed());
+    bool                        status = false;
+    const char*                 stored = 0;
+    std::shared_ptr<const void> owner;
+    if (!sizes.compressed() && !view(name, stored, owner))
         status = read(name, b);
-    }
+    else
+        status = readInto(name, sizes, &b[0]);
 
     release();
     return status;
 }
 
-bool Archive::writeFile(const std::string& name, const std::string& b, bool compress) {
+bool Archive::readFile(const std::string& name, char* buffer, Size bufferSize) {
+    TRACE_SCOPE("archive", "read");
     lock();
 
-    /* from zlib.h:
-     *
-     * ZEXTERN int ZEXPORT compress OF((Bytef *dest, uLongf *destLen, const Bytef *source, uLong sourceLen));
-     *
-     * Compresses the source buffer into the destination buffer. sourceLen is
-     * the byte length of the source buffer. Upon entry, destLen is the total
-     * size of the destination buffer, which must be at least 0.1% larger
-     * than sourceLen plus 12 bytes. Upon exit, destLen is the actual size
-     * of the compressed buffer.
-     * This function can be used to compress a whole file at once if the
-     * input file is mmap'ed.
-     *
-     * compress returns Z_OK if success, Z_MEM_ERROR if there was not
-     * enough memory, Z_BUF_ERROR if there was not enough room in the output
-     * buffer.
-     */
+    Sizes sizes;
+    bool  status = discover(name, sizes) && sizes.uncompressed() <= bufferSize && readInto(name, sizes, buffer);
+
+    release();
+    return status;
+}
+
+bool Archive::viewFile(const std::string& name, const char*& data, Size& size, std::shared_ptr<const void>& owner) const {
+    lock();
+
+    Sizes sizes;
+    bool  status = discover(name, sizes) && !sizes.compressed() && view(name, data, owner);
+    if (status)
+        size = sizes.uncompressed();
+
+    release();
+    return status;
+}
+
+bool Archive::writeFile(const std::string& name, const std::string& b, bool compress) {
+    TRACE_SCOPE("archive", "write");
+    lock();
 
     // compress buffer
     // we could do the compression in a separate thread, but we don't...
-    std::string compressed;
-    if (compress) {
-        size_t header_length = 10;
-        compressed.resize((unsigned int)(header_length + (b.size() + 12) * 1.02));
-        uLongf compressedSize = compressed.size();
-
-        /*
-         * CAUTION! This is a hack which assumes that the internal
-         * header added by zlib is 2 bytes long which will be
-         * overwritten by a gzip compatible header info later.  We
-         * assume that this zlib header is always 0x78 0x9c.  When
-         * unpacking we drop the gzip header and replace 0x78 0x9c
-         * instead.  Also zlib seems to add an additional 6 bytes of
-         * checksum data at the end which we simply discard after
-         * compression. These assumptions might be wrong, especially
-         * for future versions of zlib.
-         */
-        int zstatus = ::compress2((Bytef*)&compressed[header_length - 2], &compressedSize,
-                                  (const Bytef*)&(b.c_str()[0]), b.size(), Z_DEFAULT_COMPRESSION);
-        hope(compressed[header_length - 2] == 0x78 && compressed[header_length - 1] == 0x9c);
-        compressed.resize(header_length + compressedSize - 6);
-        if (zstatus != Z_OK) {
-            std::cerr << "pack buffer was too small (" << b.size() << ", " << compressedSize
-                      << ". falling back to no compression." << std::endl;
-            compressed.resize(0);
-        }
-        else {
-            // gzip header
-            compressed[0] = 0x1f;  // gzip header bytes
-            compressed[1] = 0x8b;
-            compressed[2] = 0x08;  // compression format (0x08 = deflate)
-            compressed[3] = 0;     // flags (no flags set)
-            compressed[4] = 0;     // modification time: 4 bytes (0 = no timestamp available)
-            compressed[5] = 0;
-            compressed[6] = 0;
-            compressed[7] = 0;
-            compressed[8] = 0;     // extra flags (0 here, somewhat curious)
-            compressed[9] = 0x03;  // operating system (3 = unix)
-
-            // crc and size
-            u32 crc = crc32(0L, (const Byte*)&(b.c_str()[0]), b.size());
-            compressed.push_back(crc & 0xff);
-            compressed.push_back((crc >> 8) & 0xff);
-            compressed.push_back((crc >> 16) & 0xff);
-            compressed.push_back((crc >> 24) & 0xff);
-            u32 size = b.size();
-            compressed.push_back(size & 0xff);
-            compressed.push_back((size >> 8) & 0xff);
-            compressed.push_back((size >> 16) & 0xff);
-            compressed.push_back((size >> 24) & 0xff);
-        }
+    std::string   compressed;
+    ArchiveCodec* c = compress ? codec(codecType_) : 0;
+    if (c && !c->compress(b.data(), b.size(), compressed)) {
+        warning("Failed to compress file \"%s\" with %s, falling back to no compression.",
+                name.c_str(), ArchiveCodec::name(codecType_));
+        compressed.resize(0);
     }
 
     // add file data to archive
@@ -334,10 +314,60 @@ Archive* Archive::create(const Configuration& config, const std::string& path, A
     return result;
 }
 
-ArchiveReader::ArchiveReader(Archive& a, const std::string& name) {
-    std::string buffer;
-    isOpen_ = a.readFile(name, buffer);
-    str(buffer);
+namespace {
+class ArchiveReaderBuffer : public std::streambuf {
+public:
+    void setData(const char* begin, const char* end) {
+        char* b = const_cast<char*>(begin);
+        setg(b, b, const_cast<char*>(end));
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+        if (!(which & std::ios_base::in))
+            return pos_type(off_type(-1));
+        off_type pos = off;
+        if (dir == std::ios_base::cur)
+            pos += gptr() - eback();
+        else if (dir == std::ios_base::end)
+            pos += egptr() - eback();
+        if (pos < 0 || pos > egptr() - eback())
+            return pos_type(off_type(-1));
+        setg(eback(), eback() + pos, egptr());
+        return pos_type(pos);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+}  // namespace
+
+ArchiveReader::ArchiveReader(Archive& a, const std::string& name)
+        : std::istream(new ArchiveReaderBuffer()) {
+    ArchiveReaderBuffer* buffer = static_cast<ArchiveReaderBuffer*>(rdbuf());
+    const char*          data   = 0;
+    Archive::Size        size   = 0;
+    if (a.viewFile(name, data, size, viewOwner_)) {
+        isOpen_ = true;
+        buffer->setData(data, data + size);
+    }
+    else {
+        isOpen_ = a.readFile(name, buffer_);
+        buffer->setData(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+}
+
+ArchiveReader::ArchiveReader(std::shared_ptr<const std::string> content)
+        : std::istream(new ArchiveReaderBuffer()),
+          content_(content),
+          isOpen_(content != nullptr) {
+    if (content_)
+        static_cast<ArchiveReaderBuffer*>(rdbuf())->setData(content_->data(), content_->data() + content_->size());
+}
+
+ArchiveReader::~ArchiveReader() {
+    delete rdbuf(0);
 }
 
 namespace {
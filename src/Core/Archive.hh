@@ -16,10 +16,12 @@
 #define _CORE_ARCHIVE_HH
 
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "ArchiveCodec.hh"
 #include "Component.hh"
 #include "ReferenceCounting.hh"
 #include "Thread.hh"
@@ -122,9 +124,21 @@ public:
     };
 
 private:
-    std::string   path_;
-    AccessMode    access_;
-    mutable Mutex mutex_;
+    static const Choice          choiceCompressionCodec;
+    static const ParameterChoice paramCompressionCodec;
+    static const ParameterInt    paramCompressionLevel;
+    static const ParameterString paramZstdDictionary;
+
+    std::string           path_;
+    AccessMode            access_;
+    mutable Mutex         mutex_;
+    ArchiveCodecType      codecType_;
+    s32                   compressionLevel_;
+    std::string           zstdDictionaryFile_;
+    mutable ArchiveCodec* codecs_[ArchiveCodecUnknown];
+
+    ArchiveCodec* codec(ArchiveCodecType type) const;
+    bool          readInto(const std::string& name, const Sizes& sizes, char* buffer) const;
 
 protected:
     // manipulate configuration context
@@ -144,6 +158,15 @@ protected:
     virtual bool discover(const std::string& name, Sizes& sizes) const {
         return false;
     }
+    /**
+     * Points @param data to the stored (possibly compressed) bytes of a file,
+     * if the archive can provide them without copying, e.g. because it is memory-mapped.
+     * @param owner is set if the data may be released before the archive is
+     * closed and keeps it valid (members of bundle archives).
+     **/
+    virtual bool view(const std::string& name, const char*& data, std::shared_ptr<const void>& owner) const {
+        return false;
+    }
     virtual bool read(const std::string& name, std::string& buffer) const                      = 0;
     virtual bool write(const std::string& name, const std::string& buffer, const Sizes& sizes) = 0;
     virtual bool remove(const std::string& name)                                               = 0;
@@ -154,7 +177,7 @@ protected:
     friend class BundleArchive;
 
 public:
-    virtual ~Archive() {}
+    virtual ~Archive();
 
     const std::string& path() const {
         return path_;
@@ -167,7 +190,24 @@ public:
     virtual const_iterator files() const = 0;
 
     bool hasFile(const std::string& name) const;
+    bool fileSizes(const std::string& name, Sizes& sizes) const;
     bool readFile(const std::string& name, std::string& buffer);
+    /**
+     * Reads and decompresses a file directly into @param buffer,
+     * which must hold at least sizes().uncompressed() bytes.
+     **/
+    bool readFile(const std::string& name, char* buffer, Size bufferSize);
+    /**
+     * Zero-copy access to an uncompressed file of a memory-mapped archive.
+     * Fails if the file is compressed or the archive is not mapped.
+     * The data stays valid until the archive is modified or closed, or as
+     * long as @param owner is held, if it is set.
+     **/
+    bool viewFile(const std::string& name, const char*& data, Size& size, std::shared_ptr<const void>& owner) const;
+    /**
+     * Stores a file, compressed with the codec selected by parameter
+     * compression-codec if @param compress is set.
+     **/
     bool writeFile(const std::string& name, const std::string& ufferb, bool compress = true);
     bool removeFile(const std::string& name);
     bool copyFile(const Archive& src, const std::string& name, const std::string& prefix = std::string());
@@ -199,12 +239,27 @@ public:
     static Archive* create(const Configuration& config, const std::string& path = "", AccessMode access = AccessModeReadWrite);
 };
 
-class ArchiveReader : public std::istringstream {
+/**
+ * Input stream over a file of an archive.
+ * Uncompressed files of memory-mapped archives are read in place, all
+ * others are decompressed once into a buffer owned by the reader.
+ **/
+class ArchiveReader : public std::istream {
 private:
-    bool isOpen_;
+    std::string                        buffer_;
+    std::shared_ptr<const std::string> content_;
+    std::shared_ptr<const void>        viewOwner_;
+    bool                               isOpen_;
 
 public:
     ArchiveReader(Archive& a, const std::string& name);
+    /**
+     * Reader over the content of a file that was read before,
+     * e.g. ahead of time by Archive::readFile() in another thread.
+     * The reader is not open if @param content is empty.
+     **/
+    explicit ArchiveReader(std::shared_ptr<const std::string> content);
+    ~ArchiveReader();
     bool isOpen() const {
         return isOpen_;
     }
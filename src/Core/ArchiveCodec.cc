@@ -0,0 +1,383 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <zlib.h>
+#ifdef MODULE_CORE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef MODULE_CORE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include "ArchiveCodec.hh"
+#include "Assertions.hh"
+
+using namespace Core;
+
+namespace {
+
+// ---------------------------------------------------------------------------
+class ZlibArchiveCodec : public ArchiveCodec {
+private:
+    int level_;
+
+public:
+    ZlibArchiveCodec(s32 level)
+            : level_(level < 0 ? Z_DEFAULT_COMPRESSION : std::min(level, s32(Z_BEST_COMPRESSION))) {}
+
+    virtual ArchiveCodecType type() const {
+        return ArchiveCodecZlib;
+    }
+
+    virtual bool compress(const char* data, u32 size, std::string& result) {
+        /* from zlib.h:
+         *
+         * ZEXTERN int ZEXPORT compress OF((Bytef *dest, uLongf *destLen, const Bytef *source, uLong sourceLen));
+         *
+         * Compresses the source buffer into the destination buffer. sourceLen is
+         * the byte length of the source buffer. Upon entry, destLen is the total
+         * size of the destination buffer, which must be at least 0.1% larger
+         * than sourceLen plus 12 bytes. Upon exit, destLen is the actual size
+         * of the compressed buffer.
+         *
+         * compress returns Z_OK if success, Z_MEM_ERROR if there was not
+         * enough memory, Z_BUF_ERROR if there was not enough room in the output
+         * buffer.
+         */
+        size_t header_length = 10;
+        result.resize((unsigned int)(header_length + (size + 12) * 1.02));
+        uLongf compressedSize = result.size();
+
+        /*
+         * CAUTION! This is a hack which assumes that the internal
+         * header added by zlib is 2 bytes long which will be
+         * overwritten by a gzip compatible header info later.  We
+         * assume that this zlib header is always 0x78 0x9c.  When
+         * unpacking we drop the gzip header and replace 0x78 0x9c
+         * instead.  Also zlib seems to add an additional 6 bytes of
+         * checksum data at the end which we simply discard after
+         * compression. These assumptions might be wrong, especially
+         * for future versions of zlib.
+         */
+        int zstatus = ::compress2((Bytef*)&result[header_length - 2], &compressedSize,
+                                  (const Bytef*)data, size, level_);
+        if (zstatus != Z_OK) {
+            result.resize(0);
+            return false;
+        }
+        result.resize(header_length + compressedSize - 6);
+
+        // gzip header
+        result[0] = 0x1f;  // gzip header bytes
+        result[1] = 0x8b;
+        result[2] = 0x08;  // compression format (0x08 = deflate)
+        result[3] = 0;     // flags (no flags set)
+        result[4] = 0;     // modification time: 4 bytes (0 = no timestamp available)
+        result[5] = 0;
+        result[6] = 0;
+        result[7] = 0;
+        result[8] = 0;     // extra flags (0 here, somewhat curious)
+        result[9] = 0x03;  // operating system (3 = unix)
+
+        // crc and size
+        u32 crc = crc32(0L, (const Byte*)data, size);
+        result.push_back(crc & 0xff);
+        result.push_back((crc >> 8) & 0xff);
+        result.push_back((crc >> 16) & 0xff);
+        result.push_back((crc >> 24) & 0xff);
+        result.push_back(size & 0xff);
+        result.push_back((size >> 8) & 0xff);
+        result.push_back((size >> 16) & 0xff);
+        result.push_back((size >> 24) & 0xff);
+        return true;
+    }
+
+    /*
+     * Compressed files are stored as a gzip member: a 10 byte header (plus
+     * optional fields), raw deflate data, crc32 and uncompressed size.
+     * The deflate data is inflated directly, so the stored bytes need not be
+     * modified and can be read from read-only (memory-mapped) memory.
+     */
+    virtual bool decompress(const char* data, u32 size, char* buffer, u32 bufferSize, std::string& error) {
+        const u8* s    = reinterpret_cast<const u8*>(data);
+        u32       base = 10;
+        if (size < base + 8) {
+            error = "truncated gzip member";
+            return false;
+        }
+        if (s[3] & 0x04)
+            base += 2 + (u32(s[base]) | (u32(s[base + 1]) << 8));  // extra field
+        if (s[3] & 0x08) {
+            for (; (base < size) && (s[base]); base++)
+                ;  // filename
+            base++;
+        }
+        if (s[3] & 0x10) {
+            for (; (base < size) && (s[base]); base++)
+                ;  // comment
+            base++;
+        }
+        if (s[3] & 0x02)
+            base += 2;  // crc16
+        if (base + 8 > size) {
+            error = "truncated gzip member";
+            return false;
+        }
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        stream.next_in   = const_cast<Bytef*>(s + base);
+        stream.avail_in  = size - base - 8;
+        stream.next_out  = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = bufferSize;
+        int status       = inflateInit2(&stream, -MAX_WBITS);
+        if (status == Z_OK) {
+            status = inflate(&stream, Z_FINISH);
+            inflateEnd(&stream);
+        }
+        std::ostringstream msg;
+        switch (status) {
+            case Z_STREAM_END:
+                if (stream.total_out == bufferSize)
+                    return true;
+                msg << "size mismatch (" << stream.total_out << " instead of " << bufferSize << " bytes)";
+                break;
+            case Z_OK:
+            case Z_BUF_ERROR:
+                msg << "unpack buffer was too small (" << size << ", " << bufferSize << ", " << stream.total_out << ")";
+                break;
+            case Z_MEM_ERROR:
+                msg << "no memory to decompress";
+                break;
+            default:
+                msg << "corrupted compressed data";
+                break;
+        }
+        error = msg.str();
+        return false;
+    }
+};
+
+#ifdef MODULE_CORE_ZSTD
+// ---------------------------------------------------------------------------
+class ZstdArchiveCodec : public ArchiveCodec {
+private:
+    int         level_;
+    ZSTD_CCtx*  cctx_;
+    ZSTD_DCtx*  dctx_;
+    ZSTD_CDict* cdict_;
+    ZSTD_DDict* ddict_;
+
+public:
+    ZstdArchiveCodec(s32 level, const std::string& dictionary)
+            : level_(level < 0 ? ZSTD_CLEVEL_DEFAULT : std::min(level, s32(ZSTD_maxCLevel()))),
+              cctx_(ZSTD_createCCtx()),
+              dctx_(ZSTD_createDCtx()),
+              cdict_(0),
+              ddict_(0) {
+        if (!dictionary.empty()) {
+            cdict_ = ZSTD_createCDict(dictionary.data(), dictionary.size(), level_);
+            ddict_ = ZSTD_createDDict(dictionary.data(), dictionary.size());
+        }
+    }
+
+    virtual ~ZstdArchiveCodec() {
+        ZSTD_freeDDict(ddict_);
+        ZSTD_freeCDict(cdict_);
+        ZSTD_freeDCtx(dctx_);
+        ZSTD_freeCCtx(cctx_);
+    }
+
+    virtual ArchiveCodecType type() const {
+        return ArchiveCodecZstd;
+    }
+
+    virtual bool compress(const char* data, u32 size, std::string& result) {
+        result.resize(ZSTD_compressBound(size));
+        size_t r = cdict_ ? ZSTD_compress_usingCDict(cctx_, &result[0], result.size(), data, size, cdict_)
+                          : ZSTD_compressCCtx(cctx_, &result[0], result.size(), data, size, level_);
+        if (ZSTD_isError(r)) {
+            result.resize(0);
+            return false;
+        }
+        result.resize(r);
+        return true;
+    }
+
+    virtual bool decompress(const char* data, u32 size, char* buffer, u32 bufferSize, std::string& error) {
+        if (ZSTD_getDictID_fromFrame(data, size) != 0 && !ddict_) {
+            error = "zstd frame requires a dictionary, but none is configured";
+            return false;
+        }
+        size_t r = ddict_ ? ZSTD_decompress_usingDDict(dctx_, buffer, bufferSize, data, size, ddict_)
+                          : ZSTD_decompressDCtx(dctx_, buffer, bufferSize, data, size);
+        if (ZSTD_isError(r)) {
+            error = ZSTD_getErrorName(r);
+            return false;
+        }
+        if (r != bufferSize) {
+            std::ostringstream msg;
+            msg << "size mismatch (" << r << " instead of " << bufferSize << " bytes)";
+            error = msg.str();
+            return false;
+        }
+        return true;
+    }
+};
+#endif
+
+#ifdef MODULE_CORE_LZ4
+// ---------------------------------------------------------------------------
+class Lz4ArchiveCodec : public ArchiveCodec {
+private:
+    int                         level_;
+    LZ4F_decompressionContext_t dctx_;
+
+public:
+    Lz4ArchiveCodec(s32 level)
+            : level_(level < 0 ? 0 : level),
+              dctx_(0) {
+        LZ4F_createDecompressionContext(&dctx_, LZ4F_VERSION);
+    }
+
+    virtual ~Lz4ArchiveCodec() {
+        LZ4F_freeDecompressionContext(dctx_);
+    }
+
+    virtual ArchiveCodecType type() const {
+        return ArchiveCodecLz4;
+    }
+
+    virtual bool compress(const char* data, u32 size, std::string& result) {
+        LZ4F_preferences_t preferences;
+        memset(&preferences, 0, sizeof(preferences));
+        preferences.frameInfo.contentSize = size;  // needed by directory archives
+        preferences.compressionLevel      = level_;
+        result.resize(LZ4F_compressFrameBound(size, &preferences));
+        size_t r = LZ4F_compressFrame(&result[0], result.size(), data, size, &preferences);
+        if (LZ4F_isError(r)) {
+            result.resize(0);
+            return false;
+        }
+        result.resize(r);
+        return true;
+    }
+
+    virtual bool decompress(const char* data, u32 size, char* buffer, u32 bufferSize, std::string& error) {
+        LZ4F_resetDecompressionContext(dctx_);
+        size_t in = 0, out = 0, r = 1;
+        while (r != 0 && in < size) {
+            size_t srcSize = size - in, dstSize = bufferSize - out;
+            r = LZ4F_decompress(dctx_, buffer + out, &dstSize, data + in, &srcSize, 0);
+            if (LZ4F_isError(r)) {
+                error = LZ4F_getErrorName(r);
+                return false;
+            }
+            if (srcSize == 0 && dstSize == 0)
+                break;
+            in += srcSize;
+            out += dstSize;
+        }
+        if (r != 0 || out != bufferSize) {
+            std::ostringstream msg;
+            msg << "truncated LZ4 frame or size mismatch (" << out << " instead of " << bufferSize << " bytes)";
+            error = msg.str();
+            return false;
+        }
+        return true;
+    }
+};
+#endif
+
+}  // namespace
+
+const char* ArchiveCodec::name(ArchiveCodecType type) {
+    switch (type) {
+        case ArchiveCodecZlib: return "zlib";
+        case ArchiveCodecZstd: return "zstd";
+        case ArchiveCodecLz4: return "lz4";
+        default: return "unknown";
+    }
+}
+
+bool ArchiveCodec::isAvailable(ArchiveCodecType type) {
+    switch (type) {
+        case ArchiveCodecZlib: return true;
+#ifdef MODULE_CORE_ZSTD
+        case ArchiveCodecZstd: return true;
+#endif
+#ifdef MODULE_CORE_LZ4
+        case ArchiveCodecLz4: return true;
+#endif
+        default: return false;
+    }
+}
+
+ArchiveCodecType ArchiveCodec::detect(const char* data, u32 size) {
+    const u8* s = reinterpret_cast<const u8*>(data);
+    if (size >= 2 && s[0] == 0x1f && s[1] == 0x8b)
+        return ArchiveCodecZlib;
+    if (size >= 4 && s[0] == 0x28 && s[1] == 0xb5 && s[2] == 0x2f && s[3] == 0xfd)
+        return ArchiveCodecZstd;
+    if (size >= 4 && s[0] == 0x04 && s[1] == 0x22 && s[2] == 0x4d && s[3] == 0x18)
+        return ArchiveCodecLz4;
+    return ArchiveCodecUnknown;
+}
+
+bool ArchiveCodec::frameContentSize(ArchiveCodecType type, const char* data, u32 size, u32& contentSize) {
+    switch (type) {
+#ifdef MODULE_CORE_ZSTD
+        case ArchiveCodecZstd: {
+            unsigned long long r = ZSTD_getFrameContentSize(data, size);
+            if (r == ZSTD_CONTENTSIZE_UNKNOWN || r == ZSTD_CONTENTSIZE_ERROR || r > Type<u32>::max)
+                return false;
+            contentSize = r;
+            return true;
+        }
+#endif
+#ifdef MODULE_CORE_LZ4
+        case ArchiveCodecLz4: {
+            LZ4F_decompressionContext_t dctx = 0;
+            LZ4F_frameInfo_t            info;
+            size_t                      headerSize = size;
+            if (LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION)))
+                return false;
+            size_t r = LZ4F_getFrameInfo(dctx, &info, data, &headerSize);
+            LZ4F_freeDecompressionContext(dctx);
+            if (LZ4F_isError(r) || info.contentSize == 0 || info.contentSize > Type<u32>::max)
+                return false;
+            contentSize = info.contentSize;
+            return true;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+ArchiveCodec* ArchiveCodec::create(ArchiveCodecType type, s32 level, const std::string& dictionary) {
+    switch (type) {
+        case ArchiveCodecZlib: return new ZlibArchiveCodec(level);
+#ifdef MODULE_CORE_ZSTD
+        case ArchiveCodecZstd: return new ZstdArchiveCodec(level, dictionary);
+#endif
+#ifdef MODULE_CORE_LZ4
+        case ArchiveCodecLz4: return new Lz4ArchiveCodec(level);
+#endif
+        default: return 0;
+    }
+}
@@ -0,0 +1,86 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef _CORE_ARCHIVE_CODEC_HH
+#define _CORE_ARCHIVE_CODEC_HH
+
+#include <string>
+
+#include "Types.hh"
+
+namespace Core {
+
+/**
+ * Compression formats of archive files.
+ * The values are stored in the entry header of file archives and must not change.
+ **/
+enum ArchiveCodecType {
+    ArchiveCodecZlib = 0,  // gzip member, the only format of older archives
+    ArchiveCodecZstd = 1,
+    ArchiveCodecLz4  = 2,
+    ArchiveCodecUnknown
+};
+
+/**
+ * Compresses and decompresses single archive files.
+ *
+ * Every codec writes a self-describing frame (gzip member, zstd frame,
+ * LZ4 frame), so the codec of a stored file is recognized by its magic
+ * number and archives can mix files of different codecs.
+ * Codecs keep their (de)compression contexts and are not thread-safe;
+ * archives use them only while holding their lock.
+ **/
+class ArchiveCodec {
+public:
+    virtual ~ArchiveCodec() {}
+
+    virtual ArchiveCodecType type() const = 0;
+
+    /** Compresses @param size bytes of @param data into @param result. */
+    virtual bool compress(const char* data, u32 size, std::string& result) = 0;
+
+    /**
+     * Decompresses @param size bytes into @param buffer, which must
+     * hold exactly @param bufferSize bytes of uncompressed data.
+     **/
+    virtual bool decompress(const char* data, u32 size, char* buffer, u32 bufferSize, std::string& error) = 0;
+
+    static const char* name(ArchiveCodecType type);
+
+    /** @return false if RASR was built without support for the codec */
+    static bool isAvailable(ArchiveCodecType type);
+
+    /** Determines the codec of stored data from its magic number. */
+    static ArchiveCodecType detect(const char* data, u32 size);
+
+    /**
+     * Extracts the uncompressed size from the beginning of a zstd or LZ4 frame.
+     * (The size of gzip members is stored at their end.)
+     **/
+    static bool frameContentSize(ArchiveCodecType type, const char* data, u32 size, u32& contentSize);
+
+    /** Maximum number of bytes needed by frameContentSize(). */
+    static const u32 maxFrameHeaderSize = 32;
+
+    /**
+     * Creates a codec, or returns 0 if it is not available.
+     * @param level compression level, negative values select the default of the codec
+     * @param dictionary zstd dictionary (raw content or trained dictionary), ignored by other codecs
+     **/
+    static ArchiveCodec* create(ArchiveCodecType type, s32 level = -1, const std::string& dictionary = std::string());
+};
+
+}  // namespace Core
+
+#endif  // _CORE_ARCHIVE_CODEC_HH
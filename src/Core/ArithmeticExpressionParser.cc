@@ -0,0 +1,1389 @@
+// A Bison parser, made by GNU Bison 3.8.2.
+
+// Skeleton implementation for Bison LALR(1) parsers in C++
+
+// Copyright (C) 2002-2015, 2018-2021 Free Software Foundation, Inc.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// As a special exception, you may create a larger work that contains
+// part or all of the Bison parser skeleton and distribute that work
+// under terms of your choice, so long as that work isn't itself a
+// parser generator using the skeleton or a modified version thereof
+// as a parser skeleton.  Alternatively, if you modify or redistribute
+// the parser skeleton itself, you may (at your option) remove this
+// special exception, which will cause the skeleton and the resulting
+// Bison output files to be licensed under the GNU General Public
+// License without this special exception.
+
+// This special exception was added by the Free Software Foundation in
+// version 2.2 of Bison.
+
+// DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+// especially those whose name start with YY_ or yy_.  They are
+// private implementation details that can be changed or removed.
+
+
+// Take the name prefix into account.
+#define yylex   BisonParserlex
+
+
+
+#include "ArithmeticExpressionParser.hh"
+
+// Second part of user prologue.
+#line 83 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+
+
+namespace {
+#ifndef BISON_VERSION_1
+    int yylex(BISON_SEMANTIC_TYPE *yylval,
+              BISON_LOCATION_TYPE *yyloc,
+              Core::ArithmeticExpressionParserDriver *driver);
+#else
+    int yylex(BISON_SEMANTIC_TYPE *yylval,
+              BISON_LOCATION_TYPE *yyloc);
+    Core::ArithmeticExpressionParserDriver *driver;
+    // old bison parsers need global variables :(
+#endif
+}
+
+#line 63 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+
+
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> // FIXME: INFRINGES ON USER NAME SPACE.
+#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(msgid) msgid
+# endif
+#endif
+
+
+// Whether we are compiled with exception support.
+#ifndef YY_EXCEPTIONS
+# if defined __GNUC__ && !defined __EXCEPTIONS
+#  define YY_EXCEPTIONS 0
+# else
+#  define YY_EXCEPTIONS 1
+# endif
+#endif
+
+#define YYRHSLOC(Rhs, K) ((Rhs)[K].location)
+/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
+   If N is 0, then set CURRENT to the empty location which ends
+   the previous symbol: RHS[0] (always defined).  */
+
+# ifndef YYLLOC_DEFAULT
+#  define YYLLOC_DEFAULT(Current, Rhs, N)                               \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).begin  = YYRHSLOC (Rhs, 1).begin;                   \
+          (Current).end    = YYRHSLOC (Rhs, N).end;                     \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).begin = (Current).end = YYRHSLOC (Rhs, 0).end;      \
+        }                                                               \
+    while (false)
+# endif
+
+
+// Enable debugging if requested.
+#if BISONPARSERDEBUG
+
+// A pseudo ostream that takes yydebug_ into account.
+# define YYCDEBUG if (yydebug_) (*yycdebug_)
+
+# define YY_SYMBOL_PRINT(Title, Symbol)         \
+  do {                                          \
+    if (yydebug_)                               \
+    {                                           \
+      *yycdebug_ << Title << ' ';               \
+      yy_print_ (*yycdebug_, Symbol);           \
+      *yycdebug_ << '\n';                       \
+    }                                           \
+  } while (false)
+
+# define YY_REDUCE_PRINT(Rule)          \
+  do {                                  \
+    if (yydebug_)                       \
+      yy_reduce_print_ (Rule);          \
+  } while (false)
+
+# define YY_STACK_PRINT()               \
+  do {                                  \
+    if (yydebug_)                       \
+      yy_stack_print_ ();                \
+  } while (false)
+
+#else // !BISONPARSERDEBUG
+
+# define YYCDEBUG if (false) std::cerr
+# define YY_SYMBOL_PRINT(Title, Symbol)  YY_USE (Symbol)
+# define YY_REDUCE_PRINT(Rule)           static_cast<void> (0)
+# define YY_STACK_PRINT()                static_cast<void> (0)
+
+#endif // !BISONPARSERDEBUG
+
+#define yyerrok         (yyerrstatus_ = 0)
+#define yyclearin       (yyla.clear ())
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYRECOVERING()  (!!yyerrstatus_)
+
+namespace BisonParser {
+#line 156 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+
+  /// Build a parser object.
+  ArithmeticExpressionParser::ArithmeticExpressionParser (Core::ArithmeticExpressionParserDriver *driver_yyarg)
+#if BISONPARSERDEBUG
+    : yydebug_ (false),
+      yycdebug_ (&std::cerr),
+#else
+    :
+#endif
+      driver (driver_yyarg)
+  {}
+
+  ArithmeticExpressionParser::~ArithmeticExpressionParser ()
+  {}
+
+  ArithmeticExpressionParser::syntax_error::~syntax_error () YY_NOEXCEPT YY_NOTHROW
+  {}
+
+  /*---------.
+  | symbol.  |
+  `---------*/
+
+  // basic_symbol.
+  template <typename Base>
+  ArithmeticExpressionParser::basic_symbol<Base>::basic_symbol (const basic_symbol& that)
+    : Base (that)
+    , value (that.value)
+    , location (that.location)
+  {}
+
+
+  /// Constructor for valueless symbols.
+  template <typename Base>
+  ArithmeticExpressionParser::basic_symbol<Base>::basic_symbol (typename Base::kind_type t, YY_MOVE_REF (location_type) l)
+    : Base (t)
+    , value ()
+    , location (l)
+  {}
+
+  template <typename Base>
+  ArithmeticExpressionParser::basic_symbol<Base>::basic_symbol (typename Base::kind_type t, YY_RVREF (value_type) v, YY_RVREF (location_type) l)
+    : Base (t)
+    , value (YY_MOVE (v))
+    , location (YY_MOVE (l))
+  {}
+
+
+  template <typename Base>
+  ArithmeticExpressionParser::symbol_kind_type
+  ArithmeticExpressionParser::basic_symbol<Base>::type_get () const YY_NOEXCEPT
+  {
+    return this->kind ();
+  }
+
+
+  template <typename Base>
+  bool
+  ArithmeticExpressionParser::basic_symbol<Base>::empty () const YY_NOEXCEPT
+  {
+    return this->kind () == symbol_kind::S_YYEMPTY;
+  }
+
+  template <typename Base>
+  void
+  ArithmeticExpressionParser::basic_symbol<Base>::move (basic_symbol& s)
+  {
+    super_type::move (s);
+    value = YY_MOVE (s.value);
+    location = YY_MOVE (s.location);
+  }
+
+  // by_kind.
+  ArithmeticExpressionParser::by_kind::by_kind () YY_NOEXCEPT
+    : kind_ (symbol_kind::S_YYEMPTY)
+  {}
+
+#if 201103L <= YY_CPLUSPLUS
+  ArithmeticExpressionParser::by_kind::by_kind (by_kind&& that) YY_NOEXCEPT
+    : kind_ (that.kind_)
+  {
+    that.clear ();
+  }
+#endif
+
+  ArithmeticExpressionParser::by_kind::by_kind (const by_kind& that) YY_NOEXCEPT
+    : kind_ (that.kind_)
+  {}
+
+  ArithmeticExpressionParser::by_kind::by_kind (token_kind_type t) YY_NOEXCEPT
+    : kind_ (yytranslate_ (t))
+  {}
+
+
+
+  void
+  ArithmeticExpressionParser::by_kind::clear () YY_NOEXCEPT
+  {
+    kind_ = symbol_kind::S_YYEMPTY;
+  }
+
+  void
+  ArithmeticExpressionParser::by_kind::move (by_kind& that)
+  {
+    kind_ = that.kind_;
+    that.clear ();
+  }
+
+  ArithmeticExpressionParser::symbol_kind_type
+  ArithmeticExpressionParser::by_kind::kind () const YY_NOEXCEPT
+  {
+    return kind_;
+  }
+
+
+  ArithmeticExpressionParser::symbol_kind_type
+  ArithmeticExpressionParser::by_kind::type_get () const YY_NOEXCEPT
+  {
+    return this->kind ();
+  }
+
+
+
+  // by_state.
+  ArithmeticExpressionParser::by_state::by_state () YY_NOEXCEPT
+    : state (empty_state)
+  {}
+
+  ArithmeticExpressionParser::by_state::by_state (const by_state& that) YY_NOEXCEPT
+    : state (that.state)
+  {}
+
+  void
+  ArithmeticExpressionParser::by_state::clear () YY_NOEXCEPT
+  {
+    state = empty_state;
+  }
+
+  void
+  ArithmeticExpressionParser::by_state::move (by_state& that)
+  {
+    state = that.state;
+    that.clear ();
+  }
+
+  ArithmeticExpressionParser::by_state::by_state (state_type s) YY_NOEXCEPT
+    : state (s)
+  {}
+
+  ArithmeticExpressionParser::symbol_kind_type
+  ArithmeticExpressionParser::by_state::kind () const YY_NOEXCEPT
+  {
+    if (state == empty_state)
+      return symbol_kind::S_YYEMPTY;
+    else
+      return YY_CAST (symbol_kind_type, yystos_[+state]);
+  }
+
+  ArithmeticExpressionParser::stack_symbol_type::stack_symbol_type ()
+  {}
+
+  ArithmeticExpressionParser::stack_symbol_type::stack_symbol_type (YY_RVREF (stack_symbol_type) that)
+    : super_type (YY_MOVE (that.state), YY_MOVE (that.value), YY_MOVE (that.location))
+  {
+#if 201103L <= YY_CPLUSPLUS
+    // that is emptied.
+    that.state = empty_state;
+#endif
+  }
+
+  ArithmeticExpressionParser::stack_symbol_type::stack_symbol_type (state_type s, YY_MOVE_REF (symbol_type) that)
+    : super_type (s, YY_MOVE (that.value), YY_MOVE (that.location))
+  {
+    // that is emptied.
+    that.kind_ = symbol_kind::S_YYEMPTY;
+  }
+
+#if YY_CPLUSPLUS < 201103L
+  ArithmeticExpressionParser::stack_symbol_type&
+  ArithmeticExpressionParser::stack_symbol_type::operator= (const stack_symbol_type& that)
+  {
+    state = that.state;
+    value = that.value;
+    location = that.location;
+    return *this;
+  }
+
+  ArithmeticExpressionParser::stack_symbol_type&
+  ArithmeticExpressionParser::stack_symbol_type::operator= (stack_symbol_type& that)
+  {
+    state = that.state;
+    value = that.value;
+    location = that.location;
+    // that is emptied.
+    that.state = empty_state;
+    return *this;
+  }
+#endif
+
+  template <typename Base>
+  void
+  ArithmeticExpressionParser::yy_destroy_ (const char* yymsg, basic_symbol<Base>& yysym) const
+  {
+    if (yymsg)
+      YY_SYMBOL_PRINT (yymsg, yysym);
+
+    // User destructor.
+    YY_USE (yysym.kind ());
+  }
+
+#if BISONPARSERDEBUG
+  template <typename Base>
+  void
+  ArithmeticExpressionParser::yy_print_ (std::ostream& yyo, const basic_symbol<Base>& yysym) const
+  {
+    std::ostream& yyoutput = yyo;
+    YY_USE (yyoutput);
+    if (yysym.empty ())
+      yyo << "empty symbol";
+    else
+      {
+        symbol_kind_type yykind = yysym.kind ();
+        yyo << (yykind < YYNTOKENS ? "token" : "nterm")
+            << ' ' << yysym.name () << " ("
+            << yysym.location << ": ";
+        switch (yykind)
+    {
+      case symbol_kind::S_NUMBER: // "number"
+#line 104 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                 { debug_stream() << (yysym.value.fval);  }
+#line 386 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+        break;
+
+      case symbol_kind::S_5_expression_: // "expression"
+#line 104 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                 { debug_stream() << (yysym.value.fval);  }
+#line 392 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+        break;
+
+      default:
+        break;
+    }
+        yyo << ')';
+      }
+  }
+#endif
+
+  void
+  ArithmeticExpressionParser::yypush_ (const char* m, YY_MOVE_REF (stack_symbol_type) sym)
+  {
+    if (m)
+      YY_SYMBOL_PRINT (m, sym);
+    yystack_.push (YY_MOVE (sym));
+  }
+
+  void
+  ArithmeticExpressionParser::yypush_ (const char* m, state_type s, YY_MOVE_REF (symbol_type) sym)
+  {
+#if 201103L <= YY_CPLUSPLUS
+    yypush_ (m, stack_symbol_type (s, std::move (sym)));
+#else
+    stack_symbol_type ss (s, sym);
+    yypush_ (m, ss);
+#endif
+  }
+
+  void
+  ArithmeticExpressionParser::yypop_ (int n) YY_NOEXCEPT
+  {
+    yystack_.pop (n);
+  }
+
+#if BISONPARSERDEBUG
+  std::ostream&
+  ArithmeticExpressionParser::debug_stream () const
+  {
+    return *yycdebug_;
+  }
+
+  void
+  ArithmeticExpressionParser::set_debug_stream (std::ostream& o)
+  {
+    yycdebug_ = &o;
+  }
+
+
+  ArithmeticExpressionParser::debug_level_type
+  ArithmeticExpressionParser::debug_level () const
+  {
+    return yydebug_;
+  }
+
+  void
+  ArithmeticExpressionParser::set_debug_level (debug_level_type l)
+  {
+    yydebug_ = l;
+  }
+#endif // BISONPARSERDEBUG
+
+  ArithmeticExpressionParser::state_type
+  ArithmeticExpressionParser::yy_lr_goto_state_ (state_type yystate, int yysym)
+  {
+    int yyr = yypgoto_[yysym - YYNTOKENS] + yystate;
+    if (0 <= yyr && yyr <= yylast_ && yycheck_[yyr] == yystate)
+      return yytable_[yyr];
+    else
+      return yydefgoto_[yysym - YYNTOKENS];
+  }
+
+  bool
+  ArithmeticExpressionParser::yy_pact_value_is_default_ (int yyvalue) YY_NOEXCEPT
+  {
+    return yyvalue == yypact_ninf_;
+  }
+
+  bool
+  ArithmeticExpressionParser::yy_table_value_is_error_ (int yyvalue) YY_NOEXCEPT
+  {
+    return yyvalue == yytable_ninf_;
+  }
+
+  int
+  ArithmeticExpressionParser::operator() ()
+  {
+    return parse ();
+  }
+
+  int
+  ArithmeticExpressionParser::parse ()
+  {
+    int yyn;
+    /// Length of the RHS of the rule being reduced.
+    int yylen = 0;
+
+    // Error handling.
+    int yynerrs_ = 0;
+    int yyerrstatus_ = 0;
+
+    /// The lookahead symbol.
+    symbol_type yyla;
+
+    /// The locations where the error started and ended.
+    stack_symbol_type yyerror_range[3];
+
+    /// The return value of parse ().
+    int yyresult;
+
+#if YY_EXCEPTIONS
+    try
+#endif // YY_EXCEPTIONS
+      {
+    YYCDEBUG << "Starting parse\n";
+
+
+    /* Initialize the stack.  The initial state will be set in
+       yynewstate, since the latter expects the semantical and the
+       location values to have been already stored, initialize these
+       stacks with a primary value.  */
+    yystack_.clear ();
+    yypush_ (YY_NULLPTR, 0, YY_MOVE (yyla));
+
+  /*-----------------------------------------------.
+  | yynewstate -- push a new symbol on the stack.  |
+  `-----------------------------------------------*/
+  yynewstate:
+    YYCDEBUG << "Entering state " << int (yystack_[0].state) << '\n';
+    YY_STACK_PRINT ();
+
+    // Accept?
+    if (yystack_[0].state == yyfinal_)
+      YYACCEPT;
+
+    goto yybackup;
+
+
+  /*-----------.
+  | yybackup.  |
+  `-----------*/
+  yybackup:
+    // Try to take a decision without lookahead.
+    yyn = yypact_[+yystack_[0].state];
+    if (yy_pact_value_is_default_ (yyn))
+      goto yydefault;
+
+    // Read a lookahead token.
+    if (yyla.empty ())
+      {
+        YYCDEBUG << "Reading a token\n";
+#if YY_EXCEPTIONS
+        try
+#endif // YY_EXCEPTIONS
+          {
+            yyla.kind_ = yytranslate_ (yylex (&yyla.value, &yyla.location, driver));
+          }
+#if YY_EXCEPTIONS
+        catch (const syntax_error& yyexc)
+          {
+            YYCDEBUG << "Caught exception: " << yyexc.what() << '\n';
+            error (yyexc);
+            goto yyerrlab1;
+          }
+#endif // YY_EXCEPTIONS
+      }
+    YY_SYMBOL_PRINT ("Next token is", yyla);
+
+    if (yyla.kind () == symbol_kind::S_YYerror)
+    {
+      // The scanner already issued an error message, process directly
+      // to error recovery.  But do not keep the error token as
+      // lookahead, it is too special and may lead us to an endless
+      // loop in error recovery. */
+      yyla.kind_ = symbol_kind::S_YYUNDEF;
+      goto yyerrlab1;
+    }
+
+    /* If the proper action on seeing token YYLA.TYPE is to reduce or
+       to detect an error, take that action.  */
+    yyn += yyla.kind ();
+    if (yyn < 0 || yylast_ < yyn || yycheck_[yyn] != yyla.kind ())
+      {
+        goto yydefault;
+      }
+
+    // Reduce or error.
+    yyn = yytable_[yyn];
+    if (yyn <= 0)
+      {
+        if (yy_table_value_is_error_ (yyn))
+          goto yyerrlab;
+        yyn = -yyn;
+        goto yyreduce;
+      }
+
+    // Count tokens shifted since error; after three, turn off error status.
+    if (yyerrstatus_)
+      --yyerrstatus_;
+
+    // Shift the lookahead token.
+    yypush_ ("Shifting", state_type (yyn), YY_MOVE (yyla));
+    goto yynewstate;
+
+
+  /*-----------------------------------------------------------.
+  | yydefault -- do the default action for the current state.  |
+  `-----------------------------------------------------------*/
+  yydefault:
+    yyn = yydefact_[+yystack_[0].state];
+    if (yyn == 0)
+      goto yyerrlab;
+    goto yyreduce;
+
+
+  /*-----------------------------.
+  | yyreduce -- do a reduction.  |
+  `-----------------------------*/
+  yyreduce:
+    yylen = yyr2_[yyn];
+    {
+      stack_symbol_type yylhs;
+      yylhs.state = yy_lr_goto_state_ (yystack_[yylen].state, yyr1_[yyn]);
+      /* If YYLEN is nonzero, implement the default value of the
+         action: '$$ = $1'.  Otherwise, use the top of the stack.
+
+         Otherwise, the following line sets YYLHS.VALUE to garbage.
+         This behavior is undocumented and Bison users should not rely
+         upon it.  */
+      if (yylen)
+        yylhs.value = yystack_[yylen - 1].value;
+      else
+        yylhs.value = yystack_[0].value;
+
+      // Default location.
+      {
+        stack_type::slice range (yystack_, yylen);
+        YYLLOC_DEFAULT (yylhs.location, range, yylen);
+        yyerror_range[1].location = yylhs.location;
+      }
+
+      // Perform the reduction.
+      YY_REDUCE_PRINT (yyn);
+#if YY_EXCEPTIONS
+      try
+#endif // YY_EXCEPTIONS
+        {
+          switch (yyn)
+            {
+  case 2: // unit: exp
+#line 108 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+           { driver->setResult((yystack_[0].value.fval)); }
+#line 645 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+  case 3: // exp: "number"
+#line 115 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                            { (yylhs.value.fval) = (yystack_[0].value.fval); }
+#line 651 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+  case 4: // exp: "function" '(' exp ')'
+#line 116 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                            { (yylhs.value.fval) = (*(yystack_[3].value.func))((yystack_[1].value.fval)); }
+#line 657 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+  case 5: // exp: exp '+' exp
+#line 117 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                            { (yylhs.value.fval) = (yystack_[2].value.fval) + (yystack_[0].value.fval); }
+#line 663 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+  case 6: // exp: exp '-' exp
+#line 118 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                            { (yylhs.value.fval) = (yystack_[2].value.fval) - (yystack_[0].value.fval); }
+#line 669 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+  case 7: // exp: exp '*' exp
+#line 119 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                            { (yylhs.value.fval) = (yystack_[2].value.fval) * (yystack_[0].value.fval); }
+#line 675 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+  case 8: // exp: exp '/' exp
+#line 120 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                            { (yylhs.value.fval) = (yystack_[2].value.fval) / (yystack_[0].value.fval); }
+#line 681 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+  case 9: // exp: '-' exp
+#line 121 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                            { (yylhs.value.fval) = -(yystack_[0].value.fval); }
+#line 687 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+  case 10: // exp: exp '^' exp
+#line 122 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                            { (yylhs.value.fval) = std::pow((yystack_[2].value.fval), (yystack_[0].value.fval)); }
+#line 693 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+  case 11: // exp: '(' exp ')'
+#line 123 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+                            { (yylhs.value.fval) = (yystack_[1].value.fval); }
+#line 699 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+    break;
+
+
+#line 703 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+
+            default:
+              break;
+            }
+        }
+#if YY_EXCEPTIONS
+      catch (const syntax_error& yyexc)
+        {
+          YYCDEBUG << "Caught exception: " << yyexc.what() << '\n';
+          error (yyexc);
+          YYERROR;
+        }
+#endif // YY_EXCEPTIONS
+      YY_SYMBOL_PRINT ("-> $$ =", yylhs);
+      yypop_ (yylen);
+      yylen = 0;
+
+      // Shift the result of the reduction.
+      yypush_ (YY_NULLPTR, YY_MOVE (yylhs));
+    }
+    goto yynewstate;
+
+
+  /*--------------------------------------.
+  | yyerrlab -- here on detecting error.  |
+  `--------------------------------------*/
+  yyerrlab:
+    // If not already recovering from an error, report this error.
+    if (!yyerrstatus_)
+      {
+        ++yynerrs_;
+        context yyctx (*this, yyla);
+        std::string msg = yysyntax_error_ (yyctx);
+        error (yyla.location, YY_MOVE (msg));
+      }
+
+
+    yyerror_range[1].location = yyla.location;
+    if (yyerrstatus_ == 3)
+      {
+        /* If just tried and failed to reuse lookahead token after an
+           error, discard it.  */
+
+        // Return failure if at end of input.
+        if (yyla.kind () == symbol_kind::S_YYEOF)
+          YYABORT;
+        else if (!yyla.empty ())
+          {
+            yy_destroy_ ("Error: discarding", yyla);
+            yyla.clear ();
+          }
+      }
+
+    // Else will try to reuse lookahead token after shifting the error token.
+    goto yyerrlab1;
+
+
+  /*---------------------------------------------------.
+  | yyerrorlab -- error raised explicitly by YYERROR.  |
+  `---------------------------------------------------*/
+  yyerrorlab:
+    /* Pacify compilers when the user code never invokes YYERROR and
+       the label yyerrorlab therefore never appears in user code.  */
+    if (false)
+      YYERROR;
+
+    /* Do not reclaim the symbols of the rule whose action triggered
+       this YYERROR.  */
+    yypop_ (yylen);
+    yylen = 0;
+    YY_STACK_PRINT ();
+    goto yyerrlab1;
+
+
+  /*-------------------------------------------------------------.
+  | yyerrlab1 -- common code for both syntax error and YYERROR.  |
+  `-------------------------------------------------------------*/
+  yyerrlab1:
+    yyerrstatus_ = 3;   // Each real token shifted decrements this.
+    // Pop stack until we find a state that shifts the error token.
+    for (;;)
+      {
+        yyn = yypact_[+yystack_[0].state];
+        if (!yy_pact_value_is_default_ (yyn))
+          {
+            yyn += symbol_kind::S_YYerror;
+            if (0 <= yyn && yyn <= yylast_
+                && yycheck_[yyn] == symbol_kind::S_YYerror)
+              {
+                yyn = yytable_[yyn];
+                if (0 < yyn)
+                  break;
+              }
+          }
+
+        // Pop the current state because it cannot handle the error token.
+        if (yystack_.size () == 1)
+          YYABORT;
+
+        yyerror_range[1].location = yystack_[0].location;
+        yy_destroy_ ("Error: popping", yystack_[0]);
+        yypop_ ();
+        YY_STACK_PRINT ();
+      }
+    {
+      stack_symbol_type error_token;
+
+      yyerror_range[2].location = yyla.location;
+      YYLLOC_DEFAULT (error_token.location, yyerror_range, 2);
+
+      // Shift the error token.
+      error_token.state = state_type (yyn);
+      yypush_ ("Shifting", YY_MOVE (error_token));
+    }
+    goto yynewstate;
+
+
+  /*-------------------------------------.
+  | yyacceptlab -- YYACCEPT comes here.  |
+  `-------------------------------------*/
+  yyacceptlab:
+    yyresult = 0;
+    goto yyreturn;
+
+
+  /*-----------------------------------.
+  | yyabortlab -- YYABORT comes here.  |
+  `-----------------------------------*/
+  yyabortlab:
+    yyresult = 1;
+    goto yyreturn;
+
+
+  /*-----------------------------------------------------.
+  | yyreturn -- parsing is finished, return the result.  |
+  `-----------------------------------------------------*/
+  yyreturn:
+    if (!yyla.empty ())
+      yy_destroy_ ("Cleanup: discarding lookahead", yyla);
+
+    /* Do not reclaim the symbols of the rule whose action triggered
+       this YYABORT or YYACCEPT.  */
+    yypop_ (yylen);
+    YY_STACK_PRINT ();
+    while (1 < yystack_.size ())
+      {
+        yy_destroy_ ("Cleanup: popping", yystack_[0]);
+        yypop_ ();
+      }
+
+    return yyresult;
+  }
+#if YY_EXCEPTIONS
+    catch (...)
+      {
+        YYCDEBUG << "Exception caught: cleaning lookahead and stack\n";
+        // Do not try to display the values of the reclaimed symbols,
+        // as their printers might throw an exception.
+        if (!yyla.empty ())
+          yy_destroy_ (YY_NULLPTR, yyla);
+
+        while (1 < yystack_.size ())
+          {
+            yy_destroy_ (YY_NULLPTR, yystack_[0]);
+            yypop_ ();
+          }
+        throw;
+      }
+#endif // YY_EXCEPTIONS
+  }
+
+  void
+  ArithmeticExpressionParser::error (const syntax_error& yyexc)
+  {
+    error (yyexc.location, yyexc.what ());
+  }
+
+  /* Return YYSTR after stripping away unnecessary quotes and
+     backslashes, so that it's suitable for yyerror.  The heuristic is
+     that double-quoting is unnecessary unless the string contains an
+     apostrophe, a comma, or backslash (other than backslash-backslash).
+     YYSTR is taken from yytname.  */
+  std::string
+  ArithmeticExpressionParser::yytnamerr_ (const char *yystr)
+  {
+    if (*yystr == '"')
+      {
+        std::string yyr;
+        char const *yyp = yystr;
+
+        for (;;)
+          switch (*++yyp)
+            {
+            case '\'':
+            case ',':
+              goto do_not_strip_quotes;
+
+            case '\\':
+              if (*++yyp != '\\')
+                goto do_not_strip_quotes;
+              else
+                goto append;
+
+            append:
+            default:
+              yyr += *yyp;
+              break;
+
+            case '"':
+              return yyr;
+            }
+      do_not_strip_quotes: ;
+      }
+
+    return yystr;
+  }
+
+  std::string
+  ArithmeticExpressionParser::symbol_name (symbol_kind_type yysymbol)
+  {
+    return yytnamerr_ (yytname_[yysymbol]);
+  }
+
+
+
+  // ArithmeticExpressionParser::context.
+  ArithmeticExpressionParser::context::context (const ArithmeticExpressionParser& yyparser, const symbol_type& yyla)
+    : yyparser_ (yyparser)
+    , yyla_ (yyla)
+  {}
+
+  int
+  ArithmeticExpressionParser::context::expected_tokens (symbol_kind_type yyarg[], int yyargn) const
+  {
+    // Actual number of expected tokens
+    int yycount = 0;
+
+    const int yyn = yypact_[+yyparser_.yystack_[0].state];
+    if (!yy_pact_value_is_default_ (yyn))
+      {
+        /* Start YYX at -YYN if negative to avoid negative indexes in
+           YYCHECK.  In other words, skip the first -YYN actions for
+           this state because they are default actions.  */
+        const int yyxbegin = yyn < 0 ? -yyn : 0;
+        // Stay within bounds of both yycheck and yytname.
+        const int yychecklim = yylast_ - yyn + 1;
+        const int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+        for (int yyx = yyxbegin; yyx < yyxend; ++yyx)
+          if (yycheck_[yyx + yyn] == yyx && yyx != symbol_kind::S_YYerror
+              && !yy_table_value_is_error_ (yytable_[yyx + yyn]))
+            {
+              if (!yyarg)
+                ++yycount;
+              else if (yycount == yyargn)
+                return 0;
+              else
+                yyarg[yycount++] = YY_CAST (symbol_kind_type, yyx);
+            }
+      }
+
+    if (yyarg && yycount == 0 && 0 < yyargn)
+      yyarg[0] = symbol_kind::S_YYEMPTY;
+    return yycount;
+  }
+
+
+
+
+
+
+  int
+  ArithmeticExpressionParser::yy_syntax_error_arguments_ (const context& yyctx,
+                                                 symbol_kind_type yyarg[], int yyargn) const
+  {
+    /* There are many possibilities here to consider:
+       - If this state is a consistent state with a default action, then
+         the only way this function was invoked is if the default action
+         is an error action.  In that case, don't check for expected
+         tokens because there are none.
+       - The only way there can be no lookahead present (in yyla) is
+         if this state is a consistent state with a default action.
+         Thus, detecting the absence of a lookahead is sufficient to
+         determine that there is no unexpected or expected token to
+         report.  In that case, just report a simple "syntax error".
+       - Don't assume there isn't a lookahead just because this state is
+         a consistent state with a default action.  There might have
+         been a previous inconsistent state, consistent state with a
+         non-default action, or user semantic action that manipulated
+         yyla.  (However, yyla is currently not documented for users.)
+       - Of course, the expected token list depends on states to have
+         correct lookahead information, and it depends on the parser not
+         to perform extra reductions after fetching a lookahead from the
+         scanner and before detecting a syntax error.  Thus, state merging
+         (from LALR or IELR) and default reductions corrupt the expected
+         token list.  However, the list is correct for canonical LR with
+         one exception: it will still contain any token that will not be
+         accepted due to an error action in a later state.
+    */
+
+    if (!yyctx.lookahead ().empty ())
+      {
+        if (yyarg)
+          yyarg[0] = yyctx.token ();
+        int yyn = yyctx.expected_tokens (yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+        return yyn + 1;
+      }
+    return 0;
+  }
+
+  // Generate an error message.
+  std::string
+  ArithmeticExpressionParser::yysyntax_error_ (const context& yyctx) const
+  {
+    // Its maximum.
+    enum { YYARGS_MAX = 5 };
+    // Arguments of yyformat.
+    symbol_kind_type yyarg[YYARGS_MAX];
+    int yycount = yy_syntax_error_arguments_ (yyctx, yyarg, YYARGS_MAX);
+
+    char const* yyformat = YY_NULLPTR;
+    switch (yycount)
+      {
+#define YYCASE_(N, S)                         \
+        case N:                               \
+          yyformat = S;                       \
+        break
+      default: // Avoid compiler warnings.
+        YYCASE_ (0, YY_("syntax error"));
+        YYCASE_ (1, YY_("syntax error, unexpected %s"));
+        YYCASE_ (2, YY_("syntax error, unexpected %s, expecting %s"));
+        YYCASE_ (3, YY_("syntax error, unexpected %s, expecting %s or %s"));
+        YYCASE_ (4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
+        YYCASE_ (5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
+#undef YYCASE_
+      }
+
+    std::string yyres;
+    // Argument number.
+    std::ptrdiff_t yyi = 0;
+    for (char const* yyp = yyformat; *yyp; ++yyp)
+      if (yyp[0] == '%' && yyp[1] == 's' && yyi < yycount)
+        {
+          yyres += symbol_name (yyarg[yyi++]);
+          ++yyp;
+        }
+      else
+        yyres += *yyp;
+    return yyres;
+  }
+
+
+  const signed char ArithmeticExpressionParser::yypact_ninf_ = -7;
+
+  const signed char ArithmeticExpressionParser::yytable_ninf_ = -1;
+
+  const signed char
+  ArithmeticExpressionParser::yypact_[] =
+  {
+      10,    -5,    -7,    10,    10,     6,    28,    10,     4,    12,
+      -7,    10,    10,    10,    10,    10,    20,    -7,    -6,    -6,
+       4,     4,     4,    -7
+  };
+
+  const signed char
+  ArithmeticExpressionParser::yydefact_[] =
+  {
+       0,     0,     3,     0,     0,     0,     2,     0,     9,     0,
+       1,     0,     0,     0,     0,     0,     0,    11,     5,     6,
+       7,     8,    10,     4
+  };
+
+  const signed char
+  ArithmeticExpressionParser::yypgoto_[] =
+  {
+      -7,    -7,    -3
+  };
+
+  const signed char
+  ArithmeticExpressionParser::yydefgoto_[] =
+  {
+       0,     5,     6
+  };
+
+  const signed char
+  ArithmeticExpressionParser::yytable_[] =
+  {
+       8,     9,    13,    14,    16,    15,    10,     7,    18,    19,
+      20,    21,    22,     1,     2,    15,     0,     3,    11,    12,
+      13,    14,     4,    15,     0,    17,    11,    12,    13,    14,
+       0,    15,     0,    23,    11,    12,    13,    14,     0,    15
+  };
+
+  const signed char
+  ArithmeticExpressionParser::yycheck_[] =
+  {
+       3,     4,     8,     9,     7,    11,     0,    12,    11,    12,
+      13,    14,    15,     3,     4,    11,    -1,     7,     6,     7,
+       8,     9,    12,    11,    -1,    13,     6,     7,     8,     9,
+      -1,    11,    -1,    13,     6,     7,     8,     9,    -1,    11
+  };
+
+  const signed char
+  ArithmeticExpressionParser::yystos_[] =
+  {
+       0,     3,     4,     7,    12,    15,    16,    12,    16,    16,
+       0,     6,     7,     8,     9,    11,    16,    13,    16,    16,
+      16,    16,    16,    13
+  };
+
+  const signed char
+  ArithmeticExpressionParser::yyr1_[] =
+  {
+       0,    14,    15,    16,    16,    16,    16,    16,    16,    16,
+      16,    16
+  };
+
+  const signed char
+  ArithmeticExpressionParser::yyr2_[] =
+  {
+       0,     2,     1,     1,     4,     3,     3,     3,     3,     2,
+       3,     3
+  };
+
+
+#if BISONPARSERDEBUG || 1
+  // YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+  // First, the terminals, then, starting at \a YYNTOKENS, nonterminals.
+  const char*
+  const ArithmeticExpressionParser::yytname_[] =
+  {
+  "\"end of string\"", "error", "\"invalid token\"", "\"function\"",
+  "\"number\"", "\"expression\"", "'+'", "'-'", "'*'", "'/'", "NEG", "'^'",
+  "'('", "')'", "$accept", "unit", "exp", YY_NULLPTR
+  };
+#endif
+
+
+#if BISONPARSERDEBUG
+  const signed char
+  ArithmeticExpressionParser::yyrline_[] =
+  {
+       0,   108,   108,   115,   116,   117,   118,   119,   120,   121,
+     122,   123
+  };
+
+  void
+  ArithmeticExpressionParser::yy_stack_print_ () const
+  {
+    *yycdebug_ << "Stack now";
+    for (stack_type::const_iterator
+           i = yystack_.begin (),
+           i_end = yystack_.end ();
+         i != i_end; ++i)
+      *yycdebug_ << ' ' << int (i->state);
+    *yycdebug_ << '\n';
+  }
+
+  void
+  ArithmeticExpressionParser::yy_reduce_print_ (int yyrule) const
+  {
+    int yylno = yyrline_[yyrule];
+    int yynrhs = yyr2_[yyrule];
+    // Print the symbols being reduced, and their result.
+    *yycdebug_ << "Reducing stack by rule " << yyrule - 1
+               << " (line " << yylno << "):\n";
+    // The symbols being reduced.
+    for (int yyi = 0; yyi < yynrhs; yyi++)
+      YY_SYMBOL_PRINT ("   $" << yyi + 1 << " =",
+                       yystack_[(yynrhs) - (yyi + 1)]);
+  }
+#endif // BISONPARSERDEBUG
+
+  ArithmeticExpressionParser::symbol_kind_type
+  ArithmeticExpressionParser::yytranslate_ (int t) YY_NOEXCEPT
+  {
+    // YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to
+    // TOKEN-NUM as returned by yylex.
+    static
+    const signed char
+    translate_table[] =
+    {
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+      12,    13,     8,     6,     2,     7,     2,     9,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,    11,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,    10
+    };
+    // Last valid token kind.
+    const int code_max = 261;
+
+    if (t <= 0)
+      return symbol_kind::S_YYEOF;
+    else if (t <= code_max)
+      return static_cast <symbol_kind_type> (translate_table[t]);
+    else
+      return symbol_kind::S_YYUNDEF;
+  }
+
+} // BisonParser
+#line 1225 "/root/repo/src/Core/ArithmeticExpressionParser.cc"
+
+#line 125 "/root/repo/src/Core/ArithmeticExpressionParser.yy"
+
+
+// ========================================================================
+
+#ifndef BISON_VERSION_1
+void BISON_NAMESPACE::ArithmeticExpressionParser::error(
+  const BISON_LOCATION_TYPE &loc,
+  const std::string &msg)
+{
+    driver->error(loc, msg);
+}
+#else
+/* Bison 1.xx declares these functions but never defines them */
+void BISON_NAMESPACE::ArithmeticExpressionParser::error_()
+{}
+void BISON_NAMESPACE::ArithmeticExpressionParser::print_()
+{}
+#endif
+
+
+// ========================================================================
+
+#include <cstdio>
+#include "StringUtilities.hh"
+using namespace Core;
+
+ArithmeticExpressionParserDriver::ArithmeticExpressionParserDriver()
+{
+    initializeFunctions();
+}
+
+void ArithmeticExpressionParserDriver::initializeFunctions()
+{
+    functions_["log"] = std::log;
+    functions_["exp"] = std::exp;
+    functions_["sin"] = std::sin;
+    functions_["cos"] = std::cos;
+    functions_["sqrt"] = std::sqrt;
+}
+
+bool ArithmeticExpressionParserDriver::parse(
+    const std::string &input, double &result)
+{
+    input_ = new LexerInput(input);
+#ifndef BISON_VERSION_1
+    BISON_NAMESPACE::ArithmeticExpressionParser parser(this);
+#else
+    BISON_LOCATION_TYPE l;
+    driver = this;
+    BISON_NAMESPACE::ArithmeticExpressionParser parser(false, l, this);
+#endif
+    bool error (parser.parse() != 0);
+    delete input_;
+    result = result_;
+    return !error;
+}
+
+ArithmeticExpressionParserDriver::LexerInput*
+ArithmeticExpressionParserDriver::getLexerInput() const {
+    return input_;
+}
+
+void ArithmeticExpressionParserDriver::setResult(double r) {
+    result_ = r;
+}
+
+void ArithmeticExpressionParserDriver::error(
+    const BISON_NAMESPACE::BISON_LOCATION &loc, const std::string &msg) {
+    lastError_ = form("%d-%d: %s", loc.begin.column, loc.end.column, msg.c_str());
+}
+
+std::string ArithmeticExpressionParserDriver::getLastError() const {
+    return lastError_;
+}
+
+ArithmeticExpressionParserDriver::MathFunc
+ArithmeticExpressionParserDriver::getFunction(const std::string &function) {
+    std::map<std::string, MathFunc>::const_iterator i;
+    i = functions_.find(function);
+    if (i == functions_.end())
+        return 0;
+    else
+        return i->second;
+}
+
+
+// ========================================================================
+
+
+ArithmeticExpressionParserDriver::LexerInput::LexerInput(const std::string &s)
+    : str_(s), pos_(0) {}
+
+char ArithmeticExpressionParserDriver::LexerInput::get() const {
+    return (pos_ < str_.size() ? str_[pos_] : '\0');
+}
+
+const char * ArithmeticExpressionParserDriver::LexerInput::getString() const {
+    return (pos_ < str_.size() ? str_.c_str() + pos_ : 0);
+}
+
+ArithmeticExpressionParserDriver::LexerInput&
+ArithmeticExpressionParserDriver::LexerInput::operator++() {
+    ++pos_;
+    return *this;
+}
+
+ArithmeticExpressionParserDriver::LexerInput&
+ArithmeticExpressionParserDriver::LexerInput::operator+=(int p) {
+    pos_ += p;
+    return *this;
+}
+
+
+// ========================================================================
+
+namespace {
+#ifndef BISON_VERSION_1
+int yylex(BISON_SEMANTIC_TYPE *yylval,
+          BISON_LOCATION_TYPE *yyloc,
+          ArithmeticExpressionParserDriver *driver)
+#else
+int yylex(BISON_SEMANTIC_TYPE *yylval,
+          BISON_LOCATION_TYPE *yyloc)
+#endif
+{
+    char c;
+    ArithmeticExpressionParserDriver::LexerInput *input = driver->getLexerInput();
+
+    while((c = input->get()) == ' ' || c == '\t') {
+        ++*input;
+        yyloc->columns(1);
+    }
+    yyloc->step();
+    if (c == '\0') {
+        return BISON_TOKEN(END);
+    }
+    if (c == '.' || isdigit(c)) {
+        int read;
+        sscanf(input->getString(), "%lf%n", &yylval->fval, &read);
+        *input += read;
+        yyloc->columns(read);
+        return BISON_TOKEN(NUMBER);
+    }
+    if (isalpha(c)) {
+        std::string buffer;
+        do {
+            buffer += input->get();
+            ++*input;
+        } while (isalnum(input->get()));
+        yyloc->columns(buffer.size());
+        yylval->func = driver->getFunction(buffer);
+        if (yylval->func == 0) {
+            driver->error(*yyloc, std::string("unknown function: ") + buffer);
+            yylval->fval = 0;
+            return BISON_TOKEN(NUMBER);
+        }
+        return BISON_TOKEN(FUNCTION);
+    }
+    ++*input;
+    yyloc->columns(1);
+    return static_cast<BISON_TOKEN_TYPE>(c);
+}
+}
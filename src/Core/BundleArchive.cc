@@ -36,16 +36,14 @@ public:
             : a_(a) {
         iterArchive_ = a_.archiveFiles_.begin();
         if (iterArchive_ != a_.archiveFiles_.end()) {
-            curArchive_ = Archive::create(a_.config, *iterArchive_, Archive::AccessModeRead);
+            curArchive_ = ArchiveRef(Archive::create(a_.config, *iterArchive_, Archive::AccessModeRead));
             verify(curArchive_);
             iterFile_ = curArchive_->files();
             name_     = iterFile_.name();
             sizes_    = iterFile_.sizes();
         }
     }
-    virtual ~_const_iterator() {
-        delete curArchive_;
-    }
+    virtual ~_const_iterator() {}
     virtual _const_iterator& operator++() {
         if (iterArchive_ == a_.archiveFiles_.end() || !iterFile_)
             return *this;
@@ -53,8 +51,7 @@ public:
         if (!iterFile_) {
             ++iterArchive_;
             if (iterArchive_ != a_.archiveFiles_.end()) {
-                delete curArchive_;
-                curArchive_ = Archive::create(a_.config, *iterArchive_, Archive::AccessModeRead);
+                curArchive_ = ArchiveRef(Archive::create(a_.config, *iterArchive_, Archive::AccessModeRead));
                 iterFile_   = curArchive_->files();
             }
             else {
@@ -98,11 +95,7 @@ Core::BundleArchive::BundleArchive(const Configuration& config, const std::strin
     }
 }
 
-Core::BundleArchive::~BundleArchive() {
-    for (ArchiveCache::iterator i = archiveCache_.begin(); i != archiveCache_.end(); ++i) {
-        delete i->second;
-    }
-}
+Core::BundleArchive::~BundleArchive() {}
 
 std::string Core::BundleArchive::indexFile(const std::string& archiveFile) {
     return archiveFile + ".idx.gz";
@@ -180,15 +173,14 @@ BundleArchive::ArchiveRef Core::BundleArchive::getArchive(const std::string& fil
     }
     ArchiveCache::const_iterator archive = archiveCache_.find(idx->second);
     if (archive == archiveCache_.end()) {
-        ArchiveRef archive = Archive::create(config, archiveFiles_[idx->second], AccessModeRead);
+        ArchiveRef archive(Archive::create(config, archiveFiles_[idx->second], AccessModeRead));
         verify(archive);
-        archiveCache_[idx->second] = ArchiveRef(archive);
+        archiveCache_[idx->second] = archive;
 
-        // Keep track of open archives and destroy the least recently used
-        // if maximal allowed number is exceeded.
+        // Keep track of open archives and close the least recently used
+        // if maximal allowed number is exceeded (as soon as no view uses it).
         lruQueue_.push(idx->second);
         if (lruQueue_.size() > maxOpenFiles_) {
-            delete archiveCache_[lruQueue_.front()];
             archiveCache_.erase(lruQueue_.front());
             lruQueue_.pop();
         }
@@ -204,6 +196,17 @@ bool Core::BundleArchive::discover(const std::string& name, Sizes& sizes) const
     return archive->discover(name, sizes);
 }
 
+bool Core::BundleArchive::view(const std::string& name, const char*& data, std::shared_ptr<const void>& owner) const {
+    ArchiveRef archive = getArchive(name);
+    if (!archive || !archive->view(name, data, owner)) {
+        return false;
+    }
+    if (!owner) {
+        owner = archive;
+    }
+    return true;
+}
+
 bool Core::BundleArchive::read(const std::string& name, std::string& b) const {
     ArchiveRef archive = getArchive(name);
     if (!archive)
@@ -16,6 +16,7 @@
 #define _CORE_BUNDLE_ARCHIVE_HH
 
 #include <iostream>
+#include <memory>
 #include <queue>
 
 #include "Archive.hh"
@@ -27,8 +28,9 @@ class BundleArchive : public virtual Archive {
 private:
     class FileInfo;
 
-    std::vector<std::string>          archiveFiles_;
-    typedef Archive*                  ArchiveRef;
+    std::vector<std::string> archiveFiles_;
+    // shared with the views of their files, which may outlive the cache entry
+    typedef std::shared_ptr<Archive>  ArchiveRef;
     typedef std::map<u32, ArchiveRef> ArchiveCache;
     mutable ArchiveCache              archiveCache_;
     StringHashMap<u32>                fileMap_;
@@ -56,6 +58,7 @@ private:
 
 protected:
     virtual bool discover(const std::string& name, Sizes& sizes) const;
+    virtual bool view(const std::string& name, const char*& data, std::shared_ptr<const void>& owner) const;
     virtual bool read(const std::string& name, std::string& b) const;
     virtual bool write(const std::string& name, const std::string& b, const Sizes& sizes);
     virtual bool remove(const std::string& name);
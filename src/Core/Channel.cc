@@ -16,15 +16,23 @@
 
 #include "Channel.hh"
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unistd.h>
 
 #include <Core/Application.hh>
 #include <Core/CompressedStream.hh>
 #include <Core/Parameter.hh>
 #include <Core/TextStream.hh>
+#include <Core/readerwriterqueue.h>
 
 using namespace Core;
 
@@ -42,12 +50,15 @@ public:
     static const Core::ParameterInt    paramIndentation;
     static const Core::ParameterBool   paramCompressed;
     static const Core::ParameterBool   paramAddSprintTags;
+    static const Core::ParameterBool   paramAsynchronous;
 
 private:
     void open(const std::string&);
     void setup();
     bool isTty_, shouldBeLineBuffered_;
 
+    AsyncWriter* asyncWriter_;
+
     XmlWriter       xml_;
     bool            isXmlDocument_;
     std::streambuf* defaultStreamBuf_;
@@ -61,6 +72,17 @@ public:
     }
     void block(u32 bufferLimit);
     void unblock();
+
+    bool isAsynchronous() const {
+        return paramAsynchronous(config);
+    }
+    /** Writer of an asynchronous target, 0 for synchronous targets. */
+    AsyncWriter* asyncWriter() const {
+        return asyncWriter_;
+    }
+    void setAsyncWriter(AsyncWriter* writer) {
+        asyncWriter_ = writer;
+    }
 };
 
 const Core::ParameterString Channel::Target::paramFilename(
@@ -100,10 +122,15 @@ const Core::ParameterBool Channel::Target::paramAddSprintTags(
         "add-sprint-tags",
         "write <sprint> tags into channel",
         true);
+const Core::ParameterBool Channel::Target::paramAsynchronous(
+        "asynchronous",
+        "format and write output on a background thread",
+        false);
 
 Channel::Target::Target(const Core::Configuration& c, bool isXmlDocument, const std::string& defaultFilename, std::streambuf* defaultStreamBuf)
         : Core::Configurable(c),
           isTty_(false),
+          asyncWriter_(0),
           xml_(*this),
           isXmlDocument_(isXmlDocument),
           defaultStreamBuf_(defaultStreamBuf) {
@@ -140,6 +167,7 @@ public:
 Channel::Target::Target(const Core::Configuration& c, bool isXmlDocument, std::ostream* defaultStream)
         : Core::Configurable(c),
           isTty_(false),
+          asyncWriter_(0),
           xml_(*this),
           isXmlDocument_(isXmlDocument),
           defaultStreamBuf_(defaultStream->rdbuf()) {
@@ -233,6 +261,254 @@ void Channel::Target::unblock() {
     setBufferSize(0);
 }
 
+// ===========================================================================
+/**
+ * Background writer of asynchronous channel targets.
+ *
+ * Each thread writing to asynchronous targets owns a Producer, which
+ * collects its output in one open block per target.  Full blocks are
+ * passed to the writer through a lock-free single-producer queue.  The
+ * writer regularly takes over the open blocks of the producers as well,
+ * so that the output of idle threads does not get stuck.  The producer
+ * lock only guards the open blocks against this takeover and is hardly
+ * ever contended.
+ */
+class Channel::AsyncWriter {
+public:
+    enum OverflowPolicy {
+        overflowBlock,
+        overflowDrop
+    };
+    static const u32 blockSize = 4096;
+
+private:
+    struct Block {
+        Target*     target;
+        std::string data;
+    };
+
+    struct Producer {
+        moodycamel::ReaderWriterQueue<Block> queue;
+        std::vector<Block>                   open;
+        std::atomic<bool>                    busy;
+        std::atomic<bool>                    exited;
+
+        Producer(u32 queueSize)
+                : queue(queueSize), busy(false), exited(false) {}
+        void lock() {
+            while (busy.exchange(true, std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+        bool tryLock() {
+            return !busy.exchange(true, std::memory_order_acquire);
+        }
+        void release() {
+            busy.store(false, std::memory_order_release);
+        }
+    };
+
+    /** Per-thread reference to the producer of the current writer. */
+    struct ProducerHandle {
+        u64                       writerId;
+        std::shared_ptr<Producer> producer;
+
+        ProducerHandle()
+                : writerId(0) {}
+        ~ProducerHandle() {
+            if (producer)
+                producer->exited.store(true, std::memory_order_release);
+        }
+    };
+
+    static std::atomic<u64> nextId_;
+
+    const u64            id_;
+    const u32            queueSize_;
+    const OverflowPolicy policy_;
+    const u32            flushInterval_;
+
+    std::vector<std::shared_ptr<Producer>> producers_;
+    std::atomic<bool>                      pending_;
+    std::atomic<u64>                       droppedBytes_;
+    bool                                   stop_;
+    u64                                    flushRequested_, flushed_;
+    std::mutex                             mutex_;
+    std::condition_variable                wakeup_;
+    std::condition_variable                done_;
+    std::thread                            thread_;
+
+    Producer* producer();
+    void      enqueue(Producer* p, Block& block);
+    void      wake();
+    void      drain(Producer* p);
+    void      run();
+
+public:
+    AsyncWriter(u32 queueSize, OverflowPolicy policy, u32 flushInterval);
+    ~AsyncWriter();
+
+    void put(Target* target, const char* s, std::streamsize n);
+
+    /** Pass the open blocks of the calling thread to the writer. */
+    void publish();
+
+    /** Wait until the output published so far has been written. */
+    void flush();
+
+    u64 droppedBytes() const {
+        return droppedBytes_;
+    }
+};
+
+std::atomic<u64> Channel::AsyncWriter::nextId_(1);
+
+Channel::AsyncWriter::AsyncWriter(u32 queueSize, OverflowPolicy policy, u32 flushInterval)
+        : id_(nextId_++),
+          queueSize_(queueSize),
+          policy_(policy),
+          flushInterval_(flushInterval),
+          pending_(false),
+          droppedBytes_(0),
+          stop_(false),
+          flushRequested_(0),
+          flushed_(0) {
+    thread_ = std::thread(&AsyncWriter::run, this);
+}
+
+Channel::AsyncWriter::~AsyncWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wakeup_.notify_one();
+    thread_.join();
+}
+
+Channel::AsyncWriter::Producer* Channel::AsyncWriter::producer() {
+    static thread_local ProducerHandle handle;
+    if (handle.writerId != id_) {
+        if (handle.producer)
+            handle.producer->exited.store(true, std::memory_order_release);
+        handle.producer = std::make_shared<Producer>(queueSize_);
+        handle.writerId = id_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        producers_.push_back(handle.producer);
+    }
+    return handle.producer.get();
+}
+
+void Channel::AsyncWriter::wake() {
+    pending_.store(true, std::memory_order_release);
+    wakeup_.notify_one();
+}
+
+void Channel::AsyncWriter::enqueue(Producer* p, Block& block) {
+    if (p->queue.try_enqueue(std::move(block))) {
+        wake();
+        return;
+    }
+    if (policy_ == overflowDrop) {
+        droppedBytes_ += block.data.size();
+        return;
+    }
+    wake();
+    while (!p->queue.try_enqueue(std::move(block)))
+        std::this_thread::yield();
+}
+
+void Channel::AsyncWriter::put(Target* target, const char* s, std::streamsize n) {
+    Producer* p = producer();
+    p->lock();
+    std::vector<Block>::iterator b = p->open.begin();
+    while (b != p->open.end() && b->target != target)
+        ++b;
+    if (b == p->open.end()) {
+        p->open.push_back(Block());
+        b         = p->open.end() - 1;
+        b->target = target;
+        b->data.reserve(blockSize);
+    }
+    b->data.append(s, n);
+    if (b->data.size() >= blockSize) {
+        enqueue(p, *b);
+        *b = std::move(p->open.back());
+        p->open.pop_back();
+    }
+    p->release();
+}
+
+void Channel::AsyncWriter::publish() {
+    Producer* p = producer();
+    p->lock();
+    for (std::vector<Block>::iterator b = p->open.begin(); b != p->open.end(); ++b)
+        enqueue(p, *b);
+    p->open.clear();
+    p->release();
+}
+
+void Channel::AsyncWriter::flush() {
+    publish();
+    std::unique_lock<std::mutex> lock(mutex_);
+    u64                          request = ++flushRequested_;
+    wakeup_.notify_one();
+    done_.wait(lock, [this, request] { return flushed_ >= request; });
+}
+
+/**
+ * Write the queued blocks of @param p and, if the producer is not busy,
+ * its open blocks.  Open blocks are newer than all queued blocks, so the
+ * queue is emptied while the open blocks are taken.
+ */
+void Channel::AsyncWriter::drain(Producer* p) {
+    std::vector<Block> blocks;
+    Block              block;
+    if (p->tryLock()) {
+        while (p->queue.try_dequeue(block))
+            blocks.push_back(std::move(block));
+        for (std::vector<Block>::iterator b = p->open.begin(); b != p->open.end(); ++b)
+            blocks.push_back(std::move(*b));
+        p->open.clear();
+        p->release();
+    }
+    else {
+        while (p->queue.try_dequeue(block))
+            blocks.push_back(std::move(block));
+    }
+    for (std::vector<Block>::iterator b = blocks.begin(); b != blocks.end(); ++b) {
+        Target* t = b->target;
+        t->lock();
+        t->rdbuf()->sputn(b->data.data(), b->data.size());
+        t->release();
+    }
+}
+
+void Channel::AsyncWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        bool                                   stop      = stop_;
+        u64                                    requested = flushRequested_;
+        std::vector<std::shared_ptr<Producer>> producers(producers_);
+        lock.unlock();
+        for (std::vector<std::shared_ptr<Producer>>::iterator p = producers.begin(); p != producers.end(); ++p) {
+            bool exited = (*p)->exited.load(std::memory_order_acquire);
+            drain(p->get());
+            if (exited) {
+                lock.lock();
+                producers_.erase(std::find(producers_.begin(), producers_.end(), *p));
+                lock.unlock();
+            }
+        }
+        lock.lock();
+        flushed_ = requested;
+        done_.notify_all();
+        if (stop)
+            break;
+        wakeup_.wait_for(lock, std::chrono::milliseconds(flushInterval_), [this, requested] {
+            return stop_ || flushRequested_ != requested || pending_.exchange(false, std::memory_order_acquire);
+        });
+    }
+}
+
 // ===========================================================================
 class Channel::Dispatcher : public std::streambuf {
 private:
@@ -241,6 +517,7 @@ private:
 protected:
     virtual int             overflow(int c);
     virtual std::streamsize xsputn(const char* s, std::streamsize num);
+    virtual int             sync();
 
 public:
     Dispatcher() {}
@@ -258,6 +535,11 @@ int Channel::Dispatcher::overflow(int c) {
     if (c != EOF) {
         for (std::vector<Target*>::iterator it = targets_.begin(); it != targets_.end(); it++) {
             Target* t(*it);
+            if (t->asyncWriter()) {
+                char ch = c;
+                t->asyncWriter()->put(t, &ch, 1);
+                continue;
+            }
             t->lock();
             int w = t->rdbuf()->sputc(c);
             if (w != c)
@@ -272,6 +554,10 @@ std::streamsize Channel::Dispatcher::xsputn(const char* s, std::streamsize num)
     std::streamsize min = num;
     for (std::vector<Target*>::iterator it = targets_.begin(); it != targets_.end(); it++) {
         Target* t(*it);
+        if (t->asyncWriter()) {
+            t->asyncWriter()->put(t, s, num);
+            continue;
+        }
         t->lock();
         std::streamsize n = t->rdbuf()->sputn(s, num);
         if (n < min)
@@ -281,16 +567,46 @@ std::streamsize Channel::Dispatcher::xsputn(const char* s, std::streamsize num)
     return min;
 }
 
+int Channel::Dispatcher::sync() {
+    for (std::vector<Target*>::iterator it = targets_.begin(); it != targets_.end(); it++) {
+        if ((*it)->asyncWriter())
+            (*it)->asyncWriter()->publish();
+    }
+    return 0;
+}
+
 // ===========================================================================
 const Core::ParameterInt Channel::Manager::paramBlockedTargetBufferLimit(
         "blocked-buffer-limit",
         "maximum number of bytes to be held back in blocked channel targets",
         64 * 1024, 0);
 
+const Core::ParameterInt Channel::Manager::paramAsyncQueueSize(
+        "async-queue-size",
+        "maximum number of pending 4 KiB blocks per thread for asynchronous channel targets",
+        256, 1);
+
+const Core::Choice Channel::Manager::choiceAsyncOverflow(
+        "block", Channel::AsyncWriter::overflowBlock,
+        "drop", Channel::AsyncWriter::overflowDrop,
+        Core::Choice::endMark());
+
+const Core::ParameterChoice Channel::Manager::paramAsyncOverflow(
+        "async-overflow",
+        &choiceAsyncOverflow,
+        "what a thread does if its queue of asynchronous output is full: wait for the writer or drop the output",
+        Channel::AsyncWriter::overflowBlock);
+
+const Core::ParameterInt Channel::Manager::paramAsyncFlushInterval(
+        "async-flush-interval",
+        "maximum delay of asynchronous output of idle threads in milliseconds",
+        100, 1);
+
 Channel::Manager* Channel::Manager::singleton_ = 0;
 
 Channel::Manager::Manager(const Core::Configuration& c, bool outputXmlHeader)
-        : Core::Configurable(c) {
+        : Core::Configurable(c),
+          asyncWriter_(0) {
     require(!singleton_);
     lock();
     singleton_ = this;
@@ -303,6 +619,8 @@ Channel::Manager::Manager(const Core::Configuration& c, bool outputXmlHeader)
     targets_["stdout"]   = stdoutTarget;
     targets_["stderr"]   = stderrTarget;
     targets_["nil"]      = 0;
+    setupAsynchronous(stdoutTarget);
+    setupAsynchronous(stderrTarget);
 
     if (stdoutTarget->isTty())
         ttyTargets_.push_back(stdoutTarget);
@@ -331,6 +649,15 @@ Channel::Manager::~Manager() {
     std::clog.rdbuf(originalStreamBuffers[2]);
 
     flushAll();
+    if (asyncWriter_) {
+        u64 dropped = asyncWriter_->droppedBytes();
+        delete asyncWriter_;
+        asyncWriter_ = 0;
+        if (dropped) {
+            std::cerr << "channel warning: " << dropped
+                      << " bytes of asynchronous output were dropped" << std::endl;
+        }
+    }
     for (TargetMap::iterator t = targets_.begin(); t != targets_.end(); ++t)
         delete t->second;
 
@@ -340,6 +667,8 @@ Channel::Manager::~Manager() {
 
 void Channel::Manager::flushAll() {
     lock();
+    if (asyncWriter_)
+        asyncWriter_->flush();
     for (TargetMap::const_iterator t = targets_.begin(); t != targets_.end(); ++t)
         if (t->second)
             t->second->flush();
@@ -381,12 +710,24 @@ Channel::Target* Channel::Manager::createTarget(TargetType type, const Core::Con
             break;
         default: defect();
     }
+    setupAsynchronous(result);
     if (result->isTty())
         ttyTargets_.push_back(result);
     release();
     return result;
 }
 
+void Channel::Manager::setupAsynchronous(Channel::Target* target) {
+    if (!target->isAsynchronous())
+        return;
+    if (!asyncWriter_) {
+        asyncWriter_ = new AsyncWriter(paramAsyncQueueSize(config),
+                                       static_cast<AsyncWriter::OverflowPolicy>(paramAsyncOverflow(config)),
+                                       paramAsyncFlushInterval(config));
+    }
+    target->setAsyncWriter(asyncWriter_);
+}
+
 Channel::Target* Channel::Manager::get(TargetType type, const std::string& name) {
     Target* result = 0;
     lock();
@@ -90,6 +90,16 @@ namespace Core {
  * -# zlib compression can be activated using the "compressed" parameter.
  *    The filename will be extended by the suffix ".gz" if not already
  *    present
+ * -# Setting "asynchronous" moves encoding conversion, formatting and
+ *    file output of the target to a background thread.  Writing
+ *    threads only append to a per-thread block, which is handed to
+ *    the writer through a lock-free queue.  Output of each thread
+ *    keeps its order, output of different threads is interleaved in
+ *    blocks of 4 KiB.  The number of pending blocks per thread is
+ *    limited by the manager parameter "async-queue-size"; when it is
+ *    reached the thread waits for the writer or drops the output,
+ *    depending on "async-overflow".  Output of idle threads appears
+ *    after at most "async-flush-interval" milliseconds.
  *
  * You can check whether a channel's output is actually used by calling
  * isOpen().  Make use of this especially if your output needs additional
@@ -121,6 +131,7 @@ private:
     class Target;
     class XmlTarget;
     class Dispatcher;
+    class AsyncWriter;
     bool isOpen_;
 
 public:
@@ -160,7 +171,11 @@ public:
 class Channel::Manager : public Configurable,
                          private Core::Mutex {
 private:
-    static const Core::ParameterInt paramBlockedTargetBufferLimit;
+    static const Core::ParameterInt    paramBlockedTargetBufferLimit;
+    static const Core::ParameterInt    paramAsyncQueueSize;
+    static const Core::Choice          choiceAsyncOverflow;
+    static const Core::ParameterChoice paramAsyncOverflow;
+    static const Core::ParameterInt    paramAsyncFlushInterval;
 
     static Manager*                         singleton_;
     u32                                     blockedTargetBufferLimit_;
@@ -169,7 +184,9 @@ private:
     TargetMap                               targets_;
     typedef std::list<Channel::Target*>     TargetList;
     TargetList                              ttyTargets_;
+    Channel::AsyncWriter*                   asyncWriter_;
     Channel::Target*                        createTarget(TargetType, const Core::Configuration&, const std::string& defaultFilename);
+    void                                    setupAsynchronous(Channel::Target*);
 
 public:
     Manager(const Core::Configuration&, bool outputXmlHeader);
@@ -182,6 +199,7 @@ public:
 
     /**
      * Write any pending output on all channels.
+     * Waits for the output of asynchronous targets published so far.
      **/
     void flushAll();
 
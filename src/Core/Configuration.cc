@@ -75,8 +75,37 @@ void Configuration::Resource::writeUsage(XmlWriter& os) const {
     }
 }
 
+/**
+ * Node of the resource name trie.  The path from the root spells the
+ * components of a resource name.
+ */
+struct Configuration::ResourceDataBase::Node {
+    std::unordered_map<std::string, std::unique_ptr<Node>> children;
+    std::unique_ptr<Node>                                  wildcard;
+    const Resource*                                        resource;  // resource named by the path, if any
+    s32                                                    specific;  // number of non-wildcard components on the path
+
+    Node(s32 _specific)
+            : resource(0),
+              specific(_specific) {}
+};
+
+namespace {
+
+std::vector<std::string> splitParameter(const std::string& parameter) {
+    std::vector<std::string> components;
+    StringTokenizer          tokenizer(parameter, Configuration::resource_separation_string);
+    for (StringTokenizer::Iterator token = tokenizer.begin(); token != tokenizer.end(); ++token) {
+        components.push_back(*token);
+    }
+    return components;
+}
+
+}  // namespace
+
 Configuration::ResourceDataBase::ResourceDataBase()
-        : noResource_("DEFAULT", "DEFAULT", 0) {
+        : noResource_("DEFAULT", "DEFAULT", 0),
+          root_(new Node(0)) {
     isLogging_ = false;
 }
 
@@ -95,49 +124,101 @@ void Configuration::ResourceDataBase::set(
     // delete existing resources with the same name
     resources.erase(res);
 
-    bool isInserted = resources.insert(res).second;
+    std::set<Resource>::iterator it;
+    bool                         isInserted;
+    Core::tie(it, isInserted) = resources.insert(res);
 
     ensure(isInserted);
-}
-
-const Configuration::Resource* Configuration::ResourceDataBase::find(
-        const std::string& parameter) const {
-    require(isWellFormedParameterName(parameter));
 
-    // split parameter string into components
-    std::vector<std::string> components;
-    StringTokenizer          tokenizer(parameter, resource_separation_string);
+    Node*           node = root_.get();
+    StringTokenizer tokenizer(name, resource_separation_string);
     for (StringTokenizer::Iterator token = tokenizer.begin(); token != tokenizer.end(); ++token) {
-        components.push_back(*token);
+        std::string            component  = *token;
+        bool                   isWildcard = (component == resource_wildcard_string);
+        std::unique_ptr<Node>& next       = isWildcard ? node->wildcard : node->children[component];
+        if (!next) {
+            next.reset(new Node(node->specific + (isWildcard ? 0 : 1)));
+        }
+        node = next.get();
     }
+    node->resource = &*it;
 
-    s32             specific = 0;
-    u32             ties     = 0;
-    const Resource* result   = 0;
-
-    // try all resources to find best (most specific) match
-    std::set<Resource>::const_iterator it;
-
-    // debug
-    // std::cerr << "match " << parameter << "(" << resources.size() << "):" << std::endl;
+    std::lock_guard<std::mutex> lock(matchCacheMutex_);
+    matchCache_.clear();
+}
 
-    for (it = resources.begin(); it != resources.end(); it++) {
-        s32 m = it->match(components);
+/**
+ * Equivalent to calling Resource::match() for all resources: a
+ * resource matches with the number of its non-wildcard components.
+ * The first (by name) of the most specific resources is chosen, the
+ * other equally specific ones are counted as ties.
+ **/
+Configuration::ResourceDataBase::Match Configuration::ResourceDataBase::match(
+        const std::vector<std::string>& components) const {
+    Match result = {0, 0, 0};
+
+    // depth-first search over (node, number of consumed components),
+    // a wildcard consumes any number of components including none
+    typedef std::pair<const Node*, u32> State;
+    std::vector<State>                  stack(1, State(root_.get(), 0));
+    std::set<State>                     visited;
+    while (!stack.empty()) {
+        State state = stack.back();
+        stack.pop_back();
+        if (!visited.insert(state).second) {
+            continue;
+        }
+        const Node* node = state.first;
+        u32         pos  = state.second;
+        if (pos == components.size() && node->resource) {
+            if (node->specific > result.specific) {
+                result.resource = node->resource;
+                result.specific = node->specific;
+                result.ties     = 0;
+            }
+            else if (node->specific == result.specific && result.resource) {
+                ++result.ties;
+                if (*node->resource < *result.resource) {
+                    result.resource = node->resource;
+                }
+            }
+        }
+        if (node->wildcard) {
+            for (u32 p = pos; p <= components.size(); ++p) {
+                stack.push_back(State(node->wildcard.get(), p));
+            }
+        }
+        if (pos < components.size()) {
+            std::unordered_map<std::string, std::unique_ptr<Node>>::const_iterator child = node->children.find(components[pos]);
+            if (child != node->children.end()) {
+                stack.push_back(State(child->second.get(), pos + 1));
+            }
+        }
+    }
+    return result;
+}
 
-        // debug
-        // if (m > 0) std::cerr << it->getName() << " matches with score " << m << std::endl;
+const Configuration::Resource* Configuration::ResourceDataBase::find(
+        const std::string& parameter) const {
+    require(isWellFormedParameterName(parameter));
 
-        if (m > specific) {
-            specific = m;
-            ties     = 0;
-            result   = &(*it);
-        }
-        else if (m == specific) {
-            ++ties;
+    // find best (most specific) match, memorized per parameter
+    Match best;
+    {
+        std::lock_guard<std::mutex> lock(matchCacheMutex_);
+        MatchCache::const_iterator  cached = matchCache_.find(parameter);
+        if (cached == matchCache_.end()) {
+            cached = matchCache_.insert(std::make_pair(parameter, match(splitParameter(parameter)))).first;
         }
+        best = cached->second;
     }
+    s32             specific = best.specific;
+    u32             ties     = best.ties;
+    const Resource* result   = best.resource;
 
     if (ties > 0) {
+        std::vector<std::string>           components = splitParameter(parameter);
+        std::set<Resource>::const_iterator it;
         std::cerr << "configuration warning: \""
                   << parameter << "\" is matched by "
                   << (ties + 1) << " equally specific resources:" << std::endl;
@@ -19,7 +19,10 @@
 
 #include <iostream>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include <string.h>
 #include <sys/stat.h>
@@ -399,6 +402,12 @@ public:
 
 /**
  * Central storage place for all resources.
+ *
+ * For lookup the resource names are additionally kept in a trie over
+ * their components, in which wildcards have an edge of their own.
+ * A lookup follows all edges matching the parameter components, so
+ * only the resources actually matching are visited.  Lookup results
+ * are memorized per parameter until the next change of the resources.
  */
 class Configuration::ResourceDataBase : public ReferenceCounted {
 private:
@@ -406,6 +415,20 @@ private:
     Resource           noResource_;
     bool               isLogging_;
 
+    struct Node;
+    struct Match {
+        const Resource* resource;
+        s32             specific;
+        u32             ties;
+    };
+    typedef std::unordered_map<std::string, Match> MatchCache;
+
+    std::unique_ptr<Node> root_;
+    mutable MatchCache    matchCache_;
+    mutable std::mutex    matchCacheMutex_;
+
+    Match match(const std::vector<std::string>& components) const;
+
     typedef std::list<SourceDescriptor*> SourceList;
     SourceList                           sources_;
 
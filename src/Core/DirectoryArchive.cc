@@ -52,11 +52,14 @@ bool DirectoryArchive::probe(const std::string& file, const struct stat64& state
     if (!fp)
         return false;
 
-    u8 tmp[4];
+    u8  tmp[ArchiveCodec::maxFrameHeaderSize];
+    u32 n = fread(tmp, 1, sizeof(tmp), fp);
+    u32 contentSize;
     sizes.setCompressed(0);
     sizes.setUncompressed(0);
-    if (fread(tmp, 1, 2, fp) == 2) {
-        if ((tmp[0] == 0x1f) && (tmp[1] == 0x8b)) {
+    if (n >= 2) {
+        ArchiveCodecType codec = ArchiveCodec::detect(reinterpret_cast<const char*>(tmp), n);
+        if (codec == ArchiveCodecZlib) {
             // assume gzip compressed file
             fseek(fp, -4, SEEK_END);
             if (fread(tmp, 1, 4, fp) == 4) {
@@ -64,9 +67,17 @@ bool DirectoryArchive::probe(const std::string& file, const struct stat64& state
                 sizes.setUncompressed(tmp[0] | (u32(tmp[1]) << 8) | (u32(tmp[2]) << 16) | (u32(tmp[3]) << 24));
             }
         }
+        else if (codec != ArchiveCodecUnknown &&
+                 ArchiveCodec::frameContentSize(codec, reinterpret_cast<const char*>(tmp), n, contentSize)) {
+            // zstd and lz4 frames written by Archive store the uncompressed size in their header
+            sizes.setCompressed(state.st_size);
+            sizes.setUncompressed(contentSize);
+        }
         else
             sizes.setUncompressed(state.st_size);
     }
+    else
+        sizes.setUncompressed(state.st_size);
     fclose(fp);
     return true;
 }
@@ -21,6 +21,7 @@
 #include "CompressedStream.hh"
 #include "Directory.hh"
 #include "FileArchive.hh"
+#include "MappedArchive.hh"
 
 using namespace Core;
 
@@ -40,7 +41,8 @@ using namespace Core;
  *   ?   bytes              path + filename: 4 byte string size + string without '\0'
  *   4   bytes              size of compressed file
  *   4   bytes              size of uncompressed file (0 = no compression)
- *   4   bytes              checksum (unused)
+ *   4   bytes              codec of compressed file (0 = zlib, 1 = zstd, 2 = lz4),
+ *                          formerly an unused checksum field which was always 0
  *   ...                    data
  *   4   bytes              0x55aa55aa recovery tag
  *
@@ -87,6 +89,9 @@ static const u32  recoveryEndTag   = 0x55aa55aa;
 const ParameterBool FileArchive::paramOverwrite(
         "allow-overwrite", "allow overwriting of existing files", false);
 
+const ParameterBool FileArchive::paramMemoryMap(
+        "memory-map", "memory-map archives opened read-only and read files without seeking and copying", false);
+
 // ===========================================================================
 struct FileArchive::FileInfo {
     std::string name;
@@ -151,7 +156,7 @@ public:
 FileArchive::FileInfo* FileArchive::file(const std::string& name) {
     // Check consistency, since '//', '/./' are normalized by directory archive but are not by file archive.
     require(normalizePath(name) == name);
-    std::map<std::string, u32>::iterator i = hashedFiles_.find(name);
+    std::unordered_map<std::string, u32>::iterator i = hashedFiles_.find(name);
     return (i == hashedFiles_.end() ? 0 : &files_[i->second]);
 }
 
@@ -159,7 +164,7 @@ const FileArchive::FileInfo* FileArchive::file(const std::string& name) const {
     // Check consistency, since '//', '/./' are normalized by directory archive but are not by file archive.
     if (normalizePath(name) != name)
         criticalError("Filename \"%s\" contains special character(e.g. \"//\") sequences that will cause different behaviour of file and directory archives.", name.c_str());
-    std::map<std::string, u32>::const_iterator i = hashedFiles_.find(name);
+    std::unordered_map<std::string, u32>::const_iterator i = hashedFiles_.find(name);
     return (i == hashedFiles_.end() ? 0 : &files_[i->second]);
 }
 
@@ -167,6 +172,7 @@ FileArchive::FileArchive(const Configuration& c, const std::string& p, AccessMod
         : Archive(c, p, access),
           allowOverwrite_(paramOverwrite(c)),
           stream_(0),
+          mapped_(0),
           open_(false),
           changed_(false) {
     // create file archive if necessary
@@ -215,10 +221,14 @@ FileArchive::FileArchive(const Configuration& c, const std::string& p, AccessMod
         open_ = true;
 
         readFileInfoTable();
+
+        if (!(access & AccessModeWrite) && paramMemoryMap(c))
+            mapArchive();
     }
 }
 
 FileArchive::~FileArchive() {
+    delete mapped_;
     if (open_) {
         writeFileInfoTable();
         if (stream_)
@@ -226,7 +236,27 @@ FileArchive::~FileArchive() {
     }
 }
 
+void FileArchive::mapArchive() {
+    mapped_ = new MMappedFile();
+    if (!mapped_->load(path())) {
+        warning("Failed to memory-map archive file \"%s\", reading it through the stream.", path().c_str());
+        delete mapped_;
+        mapped_ = 0;
+    }
+}
+
+const char* FileArchive::mappedData(const FileInfo& fi) const {
+    // skip size, compressed size and codec
+    u64 begin = fi.position + 3 * sizeof(u32);
+    u64 size  = (fi.sizes.compressed() ? fi.sizes.compressed() : fi.sizes.uncompressed());
+    if (begin + size > mapped_->size())
+        return 0;
+    return mapped_->data<char>(begin);
+}
+
 bool FileArchive::clear() {
+    delete mapped_;
+    mapped_ = 0;
     if (stream_)
         delete stream_;
     files_.clear();
@@ -252,7 +282,7 @@ bool FileArchive::add(const FileInfo& info) {
 bool FileArchive::remove(const std::string& name) {
     /*! @todo merge empty segments
      */
-    std::map<std::string, u32>::iterator i = hashedFiles_.find(name);
+    std::unordered_map<std::string, u32>::iterator i = hashedFiles_.find(name);
     if (i == hashedFiles_.end())
         return false;
     verify(i->second < files_.size() && i->second >= 0);
@@ -281,7 +311,7 @@ bool FileArchive::remove(const std::string& name) {
 
         size += info.name.size();
         *stream_ << size;
-        *stream_ << u32(0) << u32(0);  // compressed, checksum
+        *stream_ << u32(0) << u32(0);  // compressed, codec
         std::streampos curpos = stream_->BinaryOutputStream::position();
         stream_->BinaryInputStream::seek(curpos + std::streampos(size), std::ios::beg);
         *stream_ >> tag;
@@ -374,12 +404,12 @@ bool FileArchive::scanArchive() {
             continue;
         }
         std::string name;
-        u32         size, compressed, checksum;
+        u32         size, compressed, codec;
         *stream_ >> name;
         std::streampos pos = stream_->BinaryInputStream::position();
         *stream_ >> size;
         *stream_ >> compressed;
-        *stream_ >> checksum;
+        *stream_ >> codec;
         if (name.empty()) {
             // empty file
             stream_->BinaryInputStream::seek(size, std::ios::cur);
@@ -462,9 +492,11 @@ bool FileArchive::writeFileInfoTable() {
     return true;
 }
 
-u32 FileArchive::getChecksum(const std::string& b) const {
-    u32 checksum = 0;
-    return checksum;
+u32 FileArchive::codec(const std::string& b, const Sizes& sizes) const {
+    if (!sizes.compressed())
+        return 0;
+    ArchiveCodecType type = ArchiveCodec::detect(b.data(), b.size());
+    return type == ArchiveCodecUnknown ? ArchiveCodecZlib : type;
 }
 
 bool FileArchive::discover(const std::string& name, Sizes& sizes) const {
@@ -475,6 +507,16 @@ bool FileArchive::discover(const std::string& name, Sizes& sizes) const {
     return true;
 }
 
+bool FileArchive::view(const std::string& name, const char*& data, std::shared_ptr<const void>& owner) const {
+    if (!mapped_ || !open_)
+        return false;
+    const FileInfo* fi = file(name);
+    if (!fi)
+        return false;
+    data = mappedData(*fi);
+    return data != 0;
+}
+
 bool FileArchive::read(const std::string& name, std::string& b) const {
     require(hasAccess(AccessModeRead));
     if (!open_)
@@ -483,22 +525,24 @@ bool FileArchive::read(const std::string& name, std::string& b) const {
     if (!fi)
         return false;
 
+    if (mapped_) {
+        const char* data = mappedData(*fi);
+        if (!data)
+            return false;
+        std::copy(data, data + (fi->sizes.compressed() ? fi->sizes.compressed() : fi->sizes.uncompressed()), &b[0]);
+        return true;
+    }
+
     stream_->clear();
     stream_->BinaryInputStream::seek(fi->position);
     u32 tmp;
     *stream_ >> tmp;  // read size
     *stream_ >> tmp;  // read compressed
-    *stream_ >> tmp;  // read checksum
-    bool ok;
+    *stream_ >> tmp;  // read codec, the data itself identifies the codec
     if (fi->sizes.compressed())
-        ok = stream_->read(&b[0], fi->sizes.compressed());
+        return stream_->read(&b[0], fi->sizes.compressed());
     else
-        ok = stream_->read(&b[0], fi->sizes.uncompressed());
-    // check if checksum is ok
-    if (getChecksum(b) != tmp)
-        ok = false;
-
-    return ok;
+        return stream_->read(&b[0], fi->sizes.uncompressed());
 }
 
 bool FileArchive::write(const std::string& name, const std::string& b, const Sizes& sizes) {
@@ -551,7 +595,7 @@ bool FileArchive::write(const std::string& name, const std::string& b, const Siz
     std::streampos pos = stream_->BinaryOutputStream::position();
     *stream_ << u32(sizes.uncompressed());
     *stream_ << u32(sizes.compressed());
-    *stream_ << getChecksum(b);
+    *stream_ << codec(b, sizes);
     stream_->write((const char*)&(b.c_str())[0], b.size());
     tmp = recoveryEndTag;
     *stream_ << tmp;
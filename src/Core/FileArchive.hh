@@ -16,26 +16,31 @@
 #define _CORE_FILE_ARCHIVE_HH
 
 #include <iostream>
+#include <unordered_map>
 #include "Archive.hh"
 #include "BinaryStream.hh"
 
 namespace Core {
 
+class MMappedFile;
+
 class FileArchive : public virtual Archive {
 private:
     static const ParameterBool paramOverwrite;
+    static const ParameterBool paramMemoryMap;
     bool                       allowOverwrite_;
 
 private:
     struct FileInfo;
 
-    BinaryStream*              stream_;
-    bool                       open_;
-    bool                       changed_;
-    std::streampos             endOfArchive_;
-    std::map<std::string, u32> hashedFiles_;
-    std::vector<FileInfo>      files_;
-    std::vector<FileInfo>      emptyFiles_;
+    BinaryStream*                        stream_;
+    MMappedFile*                         mapped_;  // only for archives opened read-only
+    bool                                 open_;
+    bool                                 changed_;
+    std::streampos                       endOfArchive_;
+    std::unordered_map<std::string, u32> hashedFiles_;
+    std::vector<FileInfo>                files_;
+    std::vector<FileInfo>                emptyFiles_;
 
     class _const_iterator;
     friend class _const_iterator;
@@ -44,19 +49,22 @@ private:
     bool add(const FileInfo&);
     bool readFileInfoTable();
     bool writeFileInfoTable();
-    u32  getChecksum(const std::string& b) const;
+    u32  codec(const std::string& b, const Sizes& sizes) const;
 
     FileInfo*       file(const std::string& name);
     const FileInfo* file(const std::string& name) const;
 
-    void setChanged();
-    bool scanArchive();
+    void        setChanged();
+    bool        scanArchive();
+    void        mapArchive();
+    const char* mappedData(const FileInfo& fi) const;
 
     friend class Archive;
     static bool test(const std::string& path);
 
 protected:
     virtual bool discover(const std::string& name, Sizes& sizes) const;
+    virtual bool view(const std::string& name, const char*& data, std::shared_ptr<const void>& owner) const;
     virtual bool read(const std::string& name, std::string& b) const;
     virtual bool write(const std::string& name, const std::string& b, const Sizes& sizes);
     virtual bool remove(const std::string& name);
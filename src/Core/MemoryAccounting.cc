@@ -0,0 +1,128 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "MemoryAccounting.hh"
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <Core/MemoryInfo.hh>
+
+using namespace Core;
+
+void MemoryAccount::add(s64 bytes) {
+    s64 value = current_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    s64 peak  = peak_.load(std::memory_order_relaxed);
+    while (value > peak && !peak_.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {
+    }
+}
+
+MemoryCharge::MemoryCharge(const std::string& account)
+        : account_(&MemoryAccounting::account(account)),
+          bytes_(0) {}
+
+MemoryCharge::MemoryCharge(const MemoryCharge& other)
+        : account_(other.account_),
+          bytes_(0) {
+    set(other.bytes_);
+}
+
+MemoryCharge& MemoryCharge::operator=(const MemoryCharge& other) {
+    if (account_ != other.account_) {
+        set(0);
+        account_ = other.account_;
+    }
+    set(other.bytes_);
+    return *this;
+}
+
+namespace {
+
+struct Registry {
+    std::mutex                                            mutex;
+    std::map<std::string, std::unique_ptr<MemoryAccount>> accounts;  // ordered by name for the report
+};
+
+Registry& registry() {
+    // never destroyed: owners may release their memory during static destruction
+    static Registry* r = new Registry;
+    return *r;
+}
+
+/** Peak resident set size of the process since start or the last resetPeakResidentSetSize(), 0 if unknown. */
+u64 peakResidentSetSize() {
+    std::ifstream is("/proc/self/status");
+    std::string   line;
+    while (std::getline(is, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoull(line.substr(6)) * 1024;  // in kB
+        }
+    }
+    return 0;
+}
+
+void resetPeakResidentSetSize() {
+    std::ofstream os("/proc/self/clear_refs");
+    os << "5";
+}
+
+}  // namespace
+
+MemoryAccount& MemoryAccounting::account(const std::string& name) {
+    Registry&                   r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::unique_ptr<MemoryAccount>& a = r.accounts[name];
+    if (!a) {
+        a.reset(new MemoryAccount(name));
+    }
+    return *a;
+}
+
+void MemoryAccounting::resetPeaks() {
+    Registry&                   r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& a : r.accounts) {
+        a.second->resetPeak();
+    }
+    resetPeakResidentSetSize();
+}
+
+size_t MemoryAccounting::heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+void MemoryAccounting::write(XmlWriter& os) {
+    MemoryInfo info;
+    os << XmlOpen("memory-accounting") + XmlAttribute("unit", "bytes");
+    {
+        Registry&                   r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& a : r.accounts) {
+            os << XmlEmpty("account") + XmlAttribute("name", a.first) + XmlAttribute("current", a.second->current()) + XmlAttribute("peak", a.second->peak());
+        }
+    }
+    os << XmlFull("heap", heapInUse())
+       << XmlEmpty("rss") + XmlAttribute("current", info.residentSetSize()) + XmlAttribute("peak", peakResidentSetSize())
+       << XmlClose("memory-accounting");
+}
@@ -0,0 +1,128 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef _CORE_MEMORY_ACCOUNTING_HH
+#define _CORE_MEMORY_ACCOUNTING_HH
+
+#include <atomic>
+#include <string>
+
+#include <Core/Types.hh>
+#include <Core/XmlStream.hh>
+
+namespace Core {
+
+/**
+ * Memory held by one subsystem, e.g. the history cache of the LM.
+ *
+ * The owners of the memory report the bytes they allocate and
+ * release; the account keeps the current total and its peak since the
+ * last resetPeak().  Thread-safe.
+ */
+class MemoryAccount {
+public:
+    const std::string& name() const {
+        return name_;
+    }
+
+    void allocate(size_t bytes) {
+        add(s64(bytes));
+    }
+    void release(size_t bytes) {
+        add(-s64(bytes));
+    }
+    void add(s64 bytes);
+
+    s64 current() const {
+        return current_.load(std::memory_order_relaxed);
+    }
+    s64 peak() const {
+        return peak_.load(std::memory_order_relaxed);
+    }
+    void resetPeak() {
+        peak_.store(current(), std::memory_order_relaxed);
+    }
+
+private:
+    friend class MemoryAccounting;
+
+    std::string      name_;
+    std::atomic<s64> current_;
+    std::atomic<s64> peak_;
+
+    MemoryAccount(const std::string& name)
+            : name_(name),
+              current_(0),
+              peak_(0) {}
+};
+
+/**
+ * Bytes held by one object, charged to a MemoryAccount.
+ *
+ * For owners which measure their memory rather than track each
+ * allocation: set() replaces the previous amount.  The charge is
+ * released on destruction, a copy charges the account again.  Not
+ * thread-safe itself.
+ */
+class MemoryCharge {
+public:
+    explicit MemoryCharge(const std::string& account);
+    MemoryCharge(const MemoryCharge& other);
+    ~MemoryCharge() {
+        set(0);
+    }
+    MemoryCharge& operator=(const MemoryCharge& other);
+
+    void set(size_t bytes) {
+        account_->add(s64(bytes) - s64(bytes_));
+        bytes_ = bytes;
+    }
+    size_t bytes() const {
+        return bytes_;
+    }
+
+private:
+    MemoryAccount* account_;
+    size_t         bytes_;
+};
+
+/**
+ * Registry of the memory accounts of the process.
+ *
+ * Accounts are identified by name and live until the process
+ * terminates.  write() reports current and peak bytes of all accounts
+ * together with the process totals; resetPeaks() starts a new
+ * interval, e.g. per segment.
+ */
+class MemoryAccounting {
+public:
+    /** Account @param name, created on first use. */
+    static MemoryAccount& account(const std::string& name);
+
+    /** Starts a new peak interval for all accounts and the resident set size of the process. */
+    static void resetPeaks();
+
+    /**
+     * Bytes allocated from the heap by the whole process, 0 if
+     * unknown.  Owners without own bookkeeping may charge the
+     * difference before and after building their data.
+     */
+    static size_t heapInUse();
+
+    static void write(XmlWriter& os);
+};
+
+}  // namespace Core
+
+#endif  // _CORE_MEMORY_ACCOUNTING_HH
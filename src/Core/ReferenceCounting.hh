@@ -91,6 +91,86 @@ public:
     void free() const;
 };
 
+/**
+ * Base class for reference-counted objects whose references are
+ * only copied and released by one thread at a time, e.g. the traces
+ * of a search.  The reference count is not atomic, which makes
+ * copying a Ref considerably cheaper.  Handing objects over to
+ * another thread requires synchronization as for any other
+ * non-atomic data.  Weak references are not supported.
+ *
+ * The count of the sentinel (the void reference, which is shared by
+ * all threads) is never changed.
+ */
+class UnsynchronizedReferenceCounted {
+private:
+    template<class T>
+    friend class Ref;
+
+    class Count {
+    public:
+        Count(u32 n, u32 step)
+                : n_(n), step_(step) {}
+        Count& operator++() {
+            n_ += step_;
+            return *this;
+        }
+        u32 operator--() {
+            return n_ -= step_;
+        }
+        operator u32() const {
+            return n_;
+        }
+
+    private:
+        u32 n_;
+        u32 step_;  // 0 for the sentinel
+    };
+
+    mutable Count referenceCount_;
+
+    explicit UnsynchronizedReferenceCounted(u32 rc)
+            : referenceCount_(rc, 0) {}
+
+    static inline UnsynchronizedReferenceCounted* sentinel() {
+        static UnsynchronizedReferenceCounted sentinel_(1);
+        return &sentinel_;
+    }
+    static bool isSentinel(const UnsynchronizedReferenceCounted* object) {
+        return object == sentinel();
+    }
+    static bool isNotSentinel(const UnsynchronizedReferenceCounted* object) {
+        return object != sentinel();
+    }
+
+protected:
+    virtual ~UnsynchronizedReferenceCounted() {}
+
+public:
+    UnsynchronizedReferenceCounted()
+            : referenceCount_(0, 1) {}
+    UnsynchronizedReferenceCounted(const UnsynchronizedReferenceCounted&)
+            : referenceCount_(0, 1) {}
+    UnsynchronizedReferenceCounted& operator=(const UnsynchronizedReferenceCounted&) {
+        return *this;
+    }
+
+    u32 refCount() const {
+        return referenceCount_;
+    }
+    void acquireReference() const {
+        ++referenceCount_;
+    }
+    bool releaseReference() const {
+        return (!--referenceCount_);
+    }
+    void free() const {
+        require_(!referenceCount_);
+        verify_(!isSentinel(this));
+        delete this;
+    }
+};
+
 template<class>
 class WeakRef;
 
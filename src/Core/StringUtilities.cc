@@ -207,3 +207,21 @@ void Core::replaceAll(std::string& str, const std::string& from, const std::stri
         start_pos += to.length();
     }
 }
+
+std::string Core::jsonString(const std::string& s) {
+    std::string result("\"");
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        }
+        else if (c < 0x20) {
+            result += form("\\u%04x", c);
+        }
+        else {
+            result += c;
+        }
+    }
+    result += '"';
+    return result;
+}
@@ -113,6 +113,13 @@ bool startsWith(const std::string& string, const std::string& search);
  */
 void replaceAll(std::string& str, const std::string& from, const std::string& to);
 
+/**
+ * Quote a string for JSON output.
+ * Quotes and backslashes are escaped, control characters are
+ * written as \uXXXX; other bytes (e.g. UTF-8) are kept as they are.
+ */
+std::string jsonString(const std::string& s);
+
 /**
  * Convinient functions to parse strings.
  *
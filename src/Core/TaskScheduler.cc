@@ -0,0 +1,339 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "TaskScheduler.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+
+#include <Core/Application.hh>
+#include <Core/Tracing.hh>
+
+using namespace Core;
+
+const Choice TaskScheduler::affinityChoice(
+        "none", affinityNone,
+        "compact", affinityCompact,
+        "scatter", affinityScatter,
+        Choice::endMark());
+
+const ParameterChoice TaskScheduler::paramAffinity(
+        "affinity", &affinityChoice,
+        "pinning of the worker threads: none, compact (fill one NUMA node after the other) or scatter (round-robin over the NUMA nodes)",
+        affinityNone);
+
+const ParameterInt TaskScheduler::paramCoreBudget(
+        "core-budget",
+        "number of cores the process may keep busy, including the calling thread (0: all processors the process may run on)",
+        0, 0);
+
+struct TaskScheduler::Queue {
+    std::mutex       mutex;
+    std::deque<Task> tasks;
+    u32              node;
+
+    Queue()
+            : node(0) {}
+};
+
+namespace {
+
+thread_local const TaskScheduler* currentScheduler = 0;
+thread_local s32                  currentWorker    = -1;
+
+/** Parses a kernel cpu list like "0-3,8-11". */
+std::vector<u32> parseCpuList(const std::string& list) {
+    std::vector<u32>  cpus;
+    std::stringstream ss(list);
+    std::string       range;
+    while (std::getline(ss, range, ',')) {
+        u32 first = 0, last = 0;
+        int n     = sscanf(range.c_str(), "%u-%u", &first, &last);
+        if (n < 1) {
+            continue;
+        }
+        if (n == 1) {
+            last = first;
+        }
+        for (u32 cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+/**
+ * Processors the process may run on, grouped by NUMA node.  Nodes
+ * without such processors are left out; without NUMA information
+ * there is one node.
+ */
+std::vector<std::vector<u32>> numaNodes() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        for (u32 cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+            CPU_SET(cpu, &allowed);
+        }
+    }
+    std::vector<std::vector<u32>> nodes;
+    for (u32 node = 0;; ++node) {
+        std::ifstream is("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string   list;
+        if (!is || !std::getline(is, list)) {
+            break;
+        }
+        std::vector<u32> cpus;
+        for (u32 cpu : parseCpuList(list)) {
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+                CPU_CLR(cpu, &allowed);
+            }
+        }
+        if (!cpus.empty()) {
+            nodes.push_back(cpus);
+        }
+    }
+    std::vector<u32> rest;
+    for (u32 cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            rest.push_back(cpu);
+        }
+    }
+    if (!rest.empty() || nodes.empty()) {
+        nodes.push_back(rest.empty() ? std::vector<u32>(1, 0) : rest);
+    }
+    return nodes;
+}
+
+u32 nCpus(const std::vector<std::vector<u32>>& nodes) {
+    u32 n = 0;
+    for (const std::vector<u32>& node : nodes) {
+        n += node.size();
+    }
+    return std::max(n, 1u);
+}
+
+Configuration globalConfiguration() {
+    return Application::us() ? Configuration(Application::us()->getConfiguration(), "task-scheduler") : Configuration();
+}
+
+}  // namespace
+
+TaskScheduler::TaskScheduler(const Configuration& config)
+        : Component(config),
+          nextQueue_(0),
+          nQueued_(0),
+          nPending_(0),
+          nSleeping_(0),
+          terminate_(false),
+          nWaiting_(0),
+          epoch_(0) {
+    std::vector<std::vector<u32>> nodes  = numaNodes();
+    u32                           budget = paramCoreBudget(config);
+    if (budget == 0) {
+        budget = nCpus(nodes);
+    }
+    u32 nWorkers = budget - 1;
+
+    // processors in the order in which they are assigned to workers
+    Affinity         affinity = Affinity(paramAffinity(config));
+    std::vector<u32> cpus, cpuNodes;
+    for (u32 i = 0; cpus.size() < nCpus(nodes); ++i) {
+        for (u32 n = 0; n < nodes.size(); ++n) {
+            if (affinity == affinityScatter && i < nodes[n].size()) {
+                cpus.push_back(nodes[n][i]);
+                cpuNodes.push_back(n);
+            }
+            else if (affinity != affinityScatter && i == 0) {
+                cpus.insert(cpus.end(), nodes[n].begin(), nodes[n].end());
+                cpuNodes.insert(cpuNodes.end(), nodes[n].size(), n);
+            }
+        }
+    }
+
+    for (u32 w = 0; w < std::max(nWorkers, 1u); ++w) {
+        queues_.emplace_back(new Queue);
+        if (affinity != affinityNone) {
+            queues_.back()->node = cpuNodes[w % cpus.size()];
+        }
+    }
+    for (u32 w = 0; w < nWorkers; ++w) {
+        s32 cpu = (affinity != affinityNone) ? s32(cpus[w % cpus.size()]) : -1;
+        workers_.emplace_back(&TaskScheduler::work, this, w, cpu);
+    }
+    log("task scheduler with %u worker threads on %zu NUMA nodes", nWorkers, nodes.size());
+}
+
+TaskScheduler::~TaskScheduler() {
+    helpWhile([this]() { return nPending_ > 0; });
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        terminate_ = true;
+    }
+    wakeUp_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::global() {
+    // never destroyed: destructors of other static objects may still spawn tasks
+    static TaskScheduler* scheduler = new TaskScheduler(globalConfiguration());
+    return *scheduler;
+}
+
+u32 TaskScheduler::coreBudget() {
+    static u32 budget = 0;
+    static std::once_flag once;
+    std::call_once(once, []() {
+        budget = paramCoreBudget(globalConfiguration());
+        if (budget == 0) {
+            budget = nCpus(numaNodes());
+        }
+    });
+    return budget;
+}
+
+u32 TaskScheduler::threadsWithinCoreBudget(u32 nThreads) {
+    return (nThreads == 0) ? coreBudget() : std::min(nThreads, coreBudget());
+}
+
+void TaskScheduler::spawn(Task task) {
+    ++nPending_;
+    Queue& queue = (currentScheduler == this && currentWorker >= 0)
+                           ? *queues_[currentWorker]
+                           : *queues_[nextQueue_++ % queues_.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    ++nQueued_;
+    if (nSleeping_ > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex_); }
+        wakeUp_.notify_one();
+    }
+    if (nWaiting_ > 0) {
+        { std::lock_guard<std::mutex> lock(waitMutex_); }
+        progress_.notify_all();
+    }
+}
+
+void TaskScheduler::helpWhile(const std::function<bool()>& busy) {
+    s32 self = (currentScheduler == this) ? currentWorker : -1;
+    while (true) {
+        // a change of busy() after this point changes the epoch, so the
+        // wait below does not miss it
+        u32 epoch = epoch_;
+        if (!busy()) {
+            return;
+        }
+        if (runTask(self)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(waitMutex_);
+        ++nWaiting_;
+        progress_.wait(lock, [this, epoch]() { return epoch_ != epoch || nQueued_ > 0; });
+        --nWaiting_;
+    }
+}
+
+void TaskScheduler::notifyWaiters() {
+    ++epoch_;
+    if (nWaiting_ > 0) {
+        { std::lock_guard<std::mutex> lock(waitMutex_); }
+        progress_.notify_all();
+    }
+}
+
+/**
+ * Takes the newest task of the own queue, otherwise steals the oldest
+ * task of another queue, visiting the queues of the own NUMA node
+ * first.
+ **/
+bool TaskScheduler::popTask(s32 self, Task& task) {
+    if (nQueued_ == 0) {
+        return false;
+    }
+    if (self >= 0) {
+        Queue&                      queue = *queues_[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            --nQueued_;
+            return true;
+        }
+    }
+    u32 n     = queues_.size();
+    u32 start = (self >= 0) ? self + 1 : nextQueue_.load();
+    u32 node  = (self >= 0) ? queues_[self]->node : 0;
+    for (u32 pass = 0; pass < 2; ++pass) {
+        for (u32 i = 0; i < n; ++i) {
+            Queue& queue = *queues_[(start + i) % n];
+            if ((self >= 0 && &queue == queues_[self].get()) || ((queue.node == node) != (pass == 0))) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                --nQueued_;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::runTask(s32 self) {
+    Task task;
+    if (!popTask(self, task)) {
+        return false;
+    }
+    task();
+    --nPending_;
+    notifyWaiters();
+    return true;
+}
+
+void TaskScheduler::work(u32 id, s32 cpu) {
+    currentScheduler = this;
+    currentWorker    = id;
+    if (Tracer::isEnabled()) {
+        Tracer::setThreadName("task-scheduler worker " + std::to_string(id));
+    }
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            warning("failed to pin worker thread %u to processor %d", id, cpu);
+        }
+    }
+    while (true) {
+        if (runTask(id)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        ++nSleeping_;
+        wakeUp_.wait(lock, [this]() { return nQueued_ > 0 || terminate_; });
+        --nSleeping_;
+        if (terminate_ && nQueued_ == 0) {
+            return;
+        }
+    }
+}
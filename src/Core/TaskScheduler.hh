@@ -0,0 +1,233 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef _CORE_TASK_SCHEDULER_HH
+#define _CORE_TASK_SCHEDULER_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <Core/Component.hh>
+#include <Core/Parameter.hh>
+#include <Core/Types.hh>
+
+namespace Core {
+
+/**
+ * Work-stealing task scheduler.
+ *
+ * Each worker thread owns a task queue.  Tasks spawned by a worker
+ * are pushed to its own queue and taken back in LIFO order, idle
+ * workers steal the oldest tasks of other workers, preferring workers
+ * on the same NUMA node.  Tasks submitted from other threads are
+ * distributed round-robin.
+ *
+ * Threads waiting for a result (get(), parallelFor(),
+ * parallelReduce()) execute pending tasks in the meantime, so tasks
+ * may wait for tasks they spawned, and the calling thread counts as
+ * one of the cores: a scheduler with a budget of n cores has n - 1
+ * workers.  With a budget of one core all tasks run on the waiting
+ * threads.  If there is no task to run, waiting threads block until
+ * a task is queued or finished.
+ *
+ * The core budget of the process (core-budget of the global
+ * scheduler) also bounds the OpenMP threads of Math and the ONNX
+ * thread pools, so that the subsystems do not oversubscribe the
+ * machine together.
+ */
+class TaskScheduler : public Component {
+public:
+    enum Affinity {
+        affinityNone,
+        affinityCompact,
+        affinityScatter
+    };
+    static const Choice          affinityChoice;
+    static const ParameterChoice paramAffinity;
+    static const ParameterInt    paramCoreBudget;
+
+    typedef std::function<void()> Task;
+
+    TaskScheduler(const Configuration& config);
+    virtual ~TaskScheduler();
+
+    /**
+     * Scheduler of the process, configured by the selection
+     * "task-scheduler" of the application.  Created on first use.
+     */
+    static TaskScheduler& global();
+
+    /**
+     * Number of cores the process may keep busy: core-budget of the
+     * global scheduler, by default the number of processors the
+     * process may run on.  Does not create the global scheduler.
+     */
+    static u32 coreBudget();
+
+    /**
+     * Thread count for a thread pool outside of the scheduler (OpenMP,
+     * ONNX runtime): @param nThreads limited to the core budget, the
+     * whole core budget if 0.
+     */
+    static u32 threadsWithinCoreBudget(u32 nThreads);
+
+    u32 budget() const {
+        return nWorkers() + 1;
+    }
+    u32 nWorkers() const {
+        return workers_.size();
+    }
+
+    /** Run @param task asynchronously. */
+    void spawn(Task task);
+
+    /** Run @param f asynchronously, the future holds its result. */
+    template<class F>
+    std::future<std::invoke_result_t<F>> submit(F f);
+
+    /**
+     * Wait for @param future, running pending tasks in the meantime.
+     * The future must be fulfilled by a task of this scheduler, e.g.
+     * one of submit().
+     */
+    template<class R>
+    R get(std::future<R>& future);
+
+    /**
+     * Calls @param f(b, e) for consecutive ranges [b, e) covering
+     * [begin, end), each of at most @param grain elements, and returns
+     * when all calls are done.
+     */
+    template<class F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F f);
+
+    /**
+     * Combines the results of @param map(b, e) over ranges as in
+     * parallelFor() with @param combine, starting with @param identity.
+     * The results are combined in the order of the ranges.
+     */
+    template<class T, class Map, class Combine>
+    T parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map map, Combine combine);
+
+    /**
+     * Run pending tasks as long as @param busy returns true.  Without
+     * pending tasks the calling thread blocks until a task is queued or
+     * finished, so busy() is only re-evaluated then: changes of its
+     * result within a running task must be announced by notifyWaiters().
+     */
+    void helpWhile(const std::function<bool()>& busy);
+
+    /** Wakes the threads blocked in helpWhile() to re-evaluate their condition. */
+    void notifyWaiters();
+
+private:
+    struct Queue;
+
+    std::vector<std::unique_ptr<Queue>> queues_;  // one per worker, at least one
+    std::vector<std::thread>            workers_;
+    std::atomic<u32>                    nextQueue_;
+    std::atomic<u32>                    nQueued_;   // tasks in the queues
+    std::atomic<u32>                    nPending_;  // tasks queued or running
+    std::atomic<u32>                    nSleeping_;
+    std::atomic<bool>                   terminate_;
+    std::mutex                          sleepMutex_;
+    std::condition_variable             wakeUp_;
+    std::atomic<u32>                    nWaiting_;  // threads blocked in helpWhile()
+    std::atomic<u32>                    epoch_;     // incremented by notifyWaiters()
+    std::mutex                          waitMutex_;
+    std::condition_variable             progress_;
+
+    void work(u32 id, s32 cpu);
+    bool runTask(s32 self);
+    bool popTask(s32 self, Task& task);
+
+    TaskScheduler(const TaskScheduler&);
+    void operator=(const TaskScheduler&);
+};
+
+template<class F>
+std::future<std::invoke_result_t<F>> TaskScheduler::submit(F f) {
+    typedef std::invoke_result_t<F>          R;
+    std::shared_ptr<std::packaged_task<R()>> task(new std::packaged_task<R()>(std::move(f)));
+    std::future<R>                           result = task->get_future();
+    spawn([task]() { (*task)(); });
+    return result;
+}
+
+template<class R>
+R TaskScheduler::get(std::future<R>& future) {
+    helpWhile([&future]() { return future.wait_for(std::chrono::seconds(0)) != std::future_status::ready; });
+    return future.get();
+}
+
+template<class F>
+void TaskScheduler::parallelFor(size_t begin, size_t end, size_t grain, F f) {
+    parallelReduce(begin, end, grain, 0, [&f](size_t b, size_t e) { f(b, e); return 0; }, [](int, int) { return 0; });
+}
+
+template<class T, class Map, class Combine>
+T TaskScheduler::parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map map, Combine combine) {
+    if (begin >= end) {
+        return identity;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+    size_t nRanges = (end - begin + grain - 1) / grain;
+    if (nRanges == 1 || workers_.empty()) {
+        T result = identity;
+        for (size_t b = begin; b < end; b += grain) {
+            result = combine(result, map(b, std::min(end, b + grain)));
+        }
+        return result;
+    }
+    // ranges are claimed from a shared counter by the calling thread and
+    // by at most one helper task per worker; the results are wrapped,
+    // so that they are separate objects even for T = bool
+    struct Result {
+        T value;
+    };
+    std::vector<Result> results(nRanges, Result{identity});
+    std::atomic<size_t> next(0), done(0);
+    auto                run = [&]() {
+        for (size_t r = next++; r < nRanges; r = next++) {
+            size_t b         = begin + r * grain;
+            results[r].value = map(b, std::min(end, b + grain));
+            ++done;
+        }
+    };
+    std::atomic<u32> nHelpers(std::min<size_t>(nRanges - 1, workers_.size()));
+    for (u32 h = nHelpers; h > 0; --h) {
+        spawn([&]() { run(); --nHelpers; });
+    }
+    run();
+    helpWhile([&]() { return done < nRanges || nHelpers > 0; });
+    T result = identity;
+    for (size_t r = 0; r < nRanges; ++r) {
+        result = combine(result, results[r].value);
+    }
+    return result;
+}
+
+}  // namespace Core
+
+#endif  // _CORE_TASK_SCHEDULER_HH
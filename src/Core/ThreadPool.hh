@@ -16,24 +16,26 @@
 #define _CORE_THREAD_POOL_HH
 
 #include <deque>
+#include <mutex>
 #include <vector>
 
 #include <Core/Assertions.hh>
-#include <Core/Thread.hh>
+#include <Core/TaskScheduler.hh>
 #include <Core/Types.hh>
 
 namespace Core {
 
 /**
- * A basic thread pool implementation offering a very simple shared memory
- * Map-Reduce framework.
- *
- * The threads are created once and live as long as the pool lives.
+ * A very simple shared memory Map-Reduce framework.
  *
  * The idea is that a list of task gets processed by a number of Mapper
  * objects and the results of the Mappers are afterwards combined with a
  * Reducer object. The mapper should store the intermediate results.
- * Each mapper runs in a separate thread. Only one reducer will be used.
+ * Each mapper processes one task at a time. Only one reducer will be used.
+ *
+ * The pool owns no threads: the mappers run as tasks of a TaskScheduler,
+ * so the number of mappers bounds the parallelism of the pool, while
+ * the scheduler bounds the number of busy threads of the process.
  *
  * See ThreadPool.
  */
@@ -54,184 +56,6 @@ public:
     void reset() {}
 };
 
-template<class Pool>
-class ThreadPoolThread : public Thread {
-public:
-    typedef typename Pool::Mapper Mapper;
-
-    ThreadPoolThread(Pool* pool, Mapper* mapper)
-            : pool_(pool),
-              mapper_(mapper) {}
-    virtual ~ThreadPoolThread() {}
-
-    void run() {
-        while (pool_->executeTask(mapper_))
-            ;
-        pool_->threadTerminated(this);
-    }
-    Mapper* getMapper() {
-        return mapper_;
-    }
-
-private:
-    Pool*   pool_;
-    Mapper* mapper_;
-};
-
-/**
- * Thread pool implementation used by ThreadPool.
- * Implementation is inspired and partly adapted from
- * thread_pool in the Boost library.
- */
-template<class T, class M, class R>
-class ThreadPoolImpl {
-public:
-    typedef T                       Task;
-    typedef M                       Mapper;
-    typedef R                       Reducer;
-    typedef ThreadPoolImpl<T, M, R> Self;
-    typedef ThreadPoolThread<Self>  WorkerThread;
-
-    ThreadPoolImpl()
-            : active_threads_(0),
-              running_threads_(0),
-              terminate_(false) {}
-    ~ThreadPoolImpl() {
-        for (typename std::vector<WorkerThread*>::iterator t = threads_.begin(); t != threads_.end(); ++t) {
-            delete (*t)->getMapper();
-            delete *t;
-        }
-    }
-
-    void init(u32 num_threads, const Mapper& mapper) volatile {
-        LockingPointer<Self> self(*this, monitor_);
-        verify_eq(self->threads_.size(), 0);
-        active_threads_ = 0;
-        for (u32 t = 0; t < num_threads; ++t) {
-            self->threads_.push_back(new WorkerThread(const_cast<Self*>(this), mapper.clone()));
-            self->threads_.back()->getMapper()->reset();
-            ++active_threads_;
-            ++running_threads_;
-            self->threads_.back()->start();
-        }
-    }
-
-    void reset() volatile {
-        wait();
-        LockingPointer<Self> self(*this, monitor_);
-        for (u32 t = 0; t < self->threads_.size(); ++t) {
-            self->threads_[t]->getMapper()->reset();
-        }
-    }
-
-    void submit(const Task& task) volatile {
-        LockingPointer<Self> self(*this, monitor_);
-        self->tasks_.push_back(task);
-        self->new_task_.signal();
-    }
-
-    void wait() const volatile {
-        // remove the volatile flag from this
-        LockingPointer<const Self> self(*this, monitor_);
-        while (self->active_threads_ > 0 || !self->tasks_.empty()) {
-            self->thread_idle_.wait(self.getMutex());
-        }
-    }
-
-    void shutdown() {
-        wait();
-        terminateThreads();
-    }
-
-    /**
-     * execute the given task.
-     * called by the worker threads.
-     */
-    bool executeTask(Mapper* mapper) volatile {
-        Task task;
-        bool have_task = false;
-        {
-            LockingPointer<Self> self(*this, monitor_);
-            if (self->terminate_)
-                return false;
-
-            while (self->tasks_.empty()) {
-                if (self->terminate_) {
-                    return false;
-                }
-                else {
-                    --active_threads_;
-                    self->thread_idle_.broadcast();
-                    self->new_task_.wait(self.getMutex());
-                    ++active_threads_;
-                }
-            }
-            task = self->tasks_.front();
-            self->tasks_.pop_front();
-            have_task = true;
-        }
-        if (have_task) {
-            mapper->map(task);
-        }
-        return true;
-    }
-
-    void threadTerminated(WorkerThread*) volatile {
-        LockingPointer<Self> self(*this, monitor_);
-        --active_threads_;
-        --running_threads_;
-        self->thread_idle_.broadcast();
-    }
-
-    void combine(Reducer* reducer) {
-        wait();
-        for (u32 t = 0; t < threads_.size(); ++t) {
-            reducer->reduce(threads_[t]->getMapper());
-        }
-    }
-
-    u32 numRunningThreads() const volatile {
-        return active_threads_;
-    }
-
-    u32 numWaitingTasks() const volatile {
-        LockingPointer<Self> self(*this, monitor_);
-        return self->tasks_.size();
-    }
-
-    bool empty() const volatile {
-        LockingPointer<Self> self(*this, monitor_);
-        return self->tasks_.empty();
-    }
-
-private:
-    void terminateThreads() volatile {
-        LockingPointer<Self> self(*this, monitor_);
-        self->terminate_ = true;
-        self->new_task_.broadcast();
-        while (running_threads_ > 0) {
-            self->thread_idle_.wait(self.getMutex());
-        }
-        for (typename std::vector<WorkerThread*>::iterator t = self->threads_.begin(); t != self->threads_.end(); ++t) {
-            (*t)->wait();
-        }
-    }
-
-    std::vector<WorkerThread*> threads_;
-    std::deque<Task>           tasks_;
-    // active threads is accessed by multiple threads
-    volatile u32      active_threads_;
-    volatile u32      running_threads_;
-    bool              terminate_;
-    mutable Mutex     monitor_;
-    mutable Condition thread_idle_;
-    mutable Condition new_task_;
-
-private:
-    ThreadPoolImpl(const ThreadPoolImpl&);
-    void operator=(const ThreadPoolImpl&);
-};
-
 /**
  * The class Task (T) should carry the input data. It has no required members.
  * Task can either be a type or a pointer to the task type. In the latter case
@@ -259,56 +83,128 @@ private:
 template<class T, class M = NullMapper<T>, class R = NullReducer<M>>
 class ThreadPool {
 public:
-    typedef ThreadPoolImpl<T, M, R> Impl;
-    typedef typename Impl::Task     Task;
-    typedef typename Impl::Mapper   Mapper;
-    typedef typename Impl::Reducer  Reducer;
+    typedef T Task;
+    typedef M Mapper;
+    typedef R Reducer;
 
-    ThreadPool()
-            : impl_(new Impl()) {}
+    ThreadPool(TaskScheduler& scheduler = TaskScheduler::global())
+            : scheduler_(scheduler),
+              nActive_(0) {}
     virtual ~ThreadPool() {
-        impl_->shutdown();
-        delete impl_;
+        wait();
+        for (typename std::vector<Mapper*>::iterator m = mappers_.begin(); m != mappers_.end(); ++m) {
+            delete *m;
+        }
     }
 
     /**
-     * initialize the pool with the given number of threads and copies of
-     * of the given prototype Mapper.
+     * initialize the pool with the given number of mappers, i.e. the
+     * maximum number of tasks processed in parallel, as copies of the
+     * given prototype Mapper.
      */
     void init(u32 num_threads, const Mapper& mapper = Mapper()) {
-        impl_->init(num_threads, mapper);
+        verify_eq(mappers_.size(), 0);
+        for (u32 t = 0; t < num_threads; ++t) {
+            mappers_.push_back(mapper.clone());
+            mappers_.back()->reset();
+        }
+        idle_ = mappers_;
     }
     /**
      * reset all mappers.
      * waits for all tasks to be finished before resetting the mappers.
      */
     void reset() {
-        impl_->reset();
+        wait();
+        for (u32 t = 0; t < mappers_.size(); ++t) {
+            mappers_[t]->reset();
+        }
     }
     /**
      * submit a new task to be processed by a mapper.
      */
     void submit(const Task& task) {
-        impl_->submit(task);
+        Mapper* mapper = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(task);
+            if (!idle_.empty()) {
+                mapper = idle_.back();
+                idle_.pop_back();
+                ++nActive_;
+            }
+        }
+        if (mapper) {
+            scheduler_.spawn([this, mapper]() { process(mapper); });
+        }
     }
     /**
      * wait for all tasks to be completed.
      */
     void wait() {
-        impl_->wait();
+        scheduler_.helpWhile([this]() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return nActive_ > 0;
+        });
+    }
+    /**
+     * wait until at most the given number of submitted tasks is not yet
+     * taken by a mapper, running pending tasks in the meantime.
+     * bounds the tasks queued by a producer, also with a scheduler
+     * without workers.
+     */
+    void waitForWaitingTasks(u32 maxWaiting) {
+        scheduler_.helpWhile([this, maxWaiting]() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return tasks_.size() > maxWaiting;
+        });
+    }
+    /**
+     * number of submitted tasks not yet taken by a mapper.
+     */
+    u32 numWaitingTasks() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tasks_.size();
     }
     /**
      * combine the results of the mappers using the given reducer.
      * waits for all tasks to be finished before applying the reducer.
      */
     void combine(Reducer* reducer) {
-        impl_->combine(reducer);
+        wait();
+        for (u32 t = 0; t < mappers_.size(); ++t) {
+            reducer->reduce(mappers_[t]);
+        }
     }
 
-protected:
-    Impl* impl_;
-
 private:
+    /** scheduler task: processes tasks with @param mapper until the queue is empty */
+    void process(Mapper* mapper) {
+        while (true) {
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (tasks_.empty()) {
+                    idle_.push_back(mapper);
+                    --nActive_;
+                    return;
+                }
+                task = tasks_.front();
+                tasks_.pop_front();
+            }
+            // for waitForWaitingTasks()
+            scheduler_.notifyWaiters();
+            mapper->map(task);
+        }
+    }
+
+    TaskScheduler&       scheduler_;
+    std::vector<Mapper*> mappers_;
+    std::vector<Mapper*> idle_;
+    std::deque<Task>     tasks_;
+    u32                  nActive_;  // mappers processing tasks
+    mutable std::mutex   mutex_;
+
     ThreadPool(const ThreadPool&);
     void operator=(const ThreadPool&);
 };
@@ -0,0 +1,265 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "Tracing.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+#include <unistd.h>
+
+#include <Core/Application.hh>
+#include <Core/MemoryAccounting.hh>
+
+using namespace Core;
+
+const ParameterString Tracer::paramFile(
+        "file",
+        "Chrome trace (JSON) file written when the application terminates, tracing is disabled if empty",
+        "");
+
+const ParameterInt Tracer::paramBufferSize(
+        "buffer-size",
+        "number of events kept per thread, older events are overwritten",
+        1 << 16, 1);
+
+std::atomic<bool> Tracer::enabled_(false);
+
+struct Tracer::Event {
+    enum Type {
+        span,
+        counter
+    };
+    const char* category;
+    const char* name;
+    u64         start;
+    union {
+        u64 duration;
+        f64 value;
+    };
+    Type type;
+};
+
+struct Tracer::Buffer {
+    std::vector<Event> events;
+    std::atomic<u64>   nRecorded;  // including overwritten events
+    u32                thread;
+    std::string        threadName;
+
+    Buffer(size_t size, u32 _thread)
+            : events(size),
+              nRecorded(0),
+              thread(_thread) {}
+
+    Event& next() {
+        return events[nRecorded.load(std::memory_order_relaxed) % events.size()];
+    }
+    void commit() {
+        nRecorded.store(nRecorded.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+struct Tracer::State {
+    std::mutex                           mutex;
+    std::vector<std::unique_ptr<Buffer>> buffers;      // never freed
+    std::vector<Buffer*>                 freeBuffers;  // of terminated threads
+    std::unordered_set<std::string>      strings;
+    size_t                               bufferSize;
+    std::string                          file;
+    u64                                  origin;
+
+    State()
+            : bufferSize(paramBufferSize.defaultValue()),
+              origin(0) {}
+};
+
+Tracer::State& Tracer::state() {
+    // never destroyed: threads may record events during static destruction
+    static State* s = new State;
+    return *s;
+}
+
+namespace {
+
+void writeString(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; ++s) {
+        unsigned char c = *s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', f);
+            fputc(c, f);
+        }
+        else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        }
+        else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+}  // namespace
+
+void Tracer::configure(const Configuration& config) {
+    State&                      s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.file       = paramFile(config);
+    s.bufferSize = paramBufferSize(config);
+    if (s.origin == 0) {
+        s.origin = now();
+    }
+    enabled_ = !s.file.empty();
+}
+
+u64 Tracer::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* Tracer::intern(const std::string& str) {
+    State&                      s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.strings.insert(str).first->c_str();
+}
+
+/**
+ * Buffer of the calling thread.  The buffer of a terminated thread is
+ * taken over by the next new thread (if it still has the configured
+ * size), so that short-lived threads do not accumulate buffers; their
+ * events share one track in the trace.
+ */
+Tracer::Buffer& Tracer::threadBuffer() {
+    struct Owner {
+        Buffer* buffer = 0;
+        ~Owner() {
+            if (buffer) {
+                std::lock_guard<std::mutex> lock(state().mutex);
+                state().freeBuffers.push_back(buffer);
+            }
+        }
+    };
+    static thread_local Owner owner;
+    if (!owner.buffer) {
+        State&                      s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto reusable = std::find_if(s.freeBuffers.begin(), s.freeBuffers.end(), [&s](Buffer* b) { return b->events.size() == s.bufferSize; });
+        if (reusable != s.freeBuffers.end()) {
+            owner.buffer = *reusable;
+            s.freeBuffers.erase(reusable);
+        }
+        else {
+            s.buffers.emplace_back(new Buffer(s.bufferSize, s.buffers.size()));
+            MemoryAccounting::account("tracing").allocate(s.bufferSize * sizeof(Event));
+            owner.buffer = s.buffers.back().get();
+        }
+    }
+    return *owner.buffer;
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    Buffer&                     buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(state().mutex);
+    buffer.threadName = name;
+}
+
+void Tracer::recordSpan(const char* category, const char* name, u64 start, u64 end) {
+    Buffer& buffer = threadBuffer();
+    Event&  e      = buffer.next();
+    e.category     = category;
+    e.name         = name;
+    e.start        = start;
+    e.duration     = end - start;
+    e.type         = Event::span;
+    buffer.commit();
+}
+
+void Tracer::recordCounter(const char* category, const char* name, f64 value) {
+    Buffer& buffer = threadBuffer();
+    Event&  e      = buffer.next();
+    e.category     = category;
+    e.name         = name;
+    e.start        = now();
+    e.value        = value;
+    e.type         = Event::counter;
+    buffer.commit();
+}
+
+s64 Tracer::write(const std::string& filename) {
+    State&                      s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    FILE*                       f = fopen(filename.c_str(), "w");
+    if (!f) {
+        return -1;
+    }
+    int  pid     = getpid();
+    s64  nEvents = 0;
+    bool first   = true;
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (const std::unique_ptr<Buffer>& buffer : s.buffers) {
+        if (!buffer->threadName.empty()) {
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", pid, buffer->thread);
+            writeString(f, buffer->threadName.c_str());
+            fprintf(f, "}}");
+            first = false;
+        }
+        u64 end   = buffer->nRecorded.load(std::memory_order_acquire);
+        u64 begin = (end > buffer->events.size()) ? end - buffer->events.size() : 0;
+        for (u64 i = begin; i < end; ++i) {
+            const Event& e = buffer->events[i % buffer->events.size()];
+            fprintf(f, "%s{\"name\":", first ? "" : ",\n");
+            writeString(f, e.name);
+            fprintf(f, ",\"cat\":");
+            writeString(f, e.category);
+            // timestamps in microseconds since configure()
+            double ts = (s64(e.start) - s64(s.origin)) / 1000.0;
+            if (e.type == Event::span) {
+                fprintf(f, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}", ts, e.duration / 1000.0, pid, buffer->thread);
+            }
+            else {
+                fprintf(f, ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u,\"args\":{\"value\":%.17g}}", ts, pid, buffer->thread, e.value);
+            }
+            first = false;
+            ++nEvents;
+        }
+    }
+    fprintf(f, "\n]}\n");
+    bool ok = !ferror(f);
+    ok      = (fclose(f) == 0) && ok;
+    return ok ? nEvents : -1;
+}
+
+void Tracer::write() {
+    if (!isEnabled()) {
+        return;
+    }
+    std::string file;
+    {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        file = state().file;
+    }
+    s64 nEvents = write(file);
+    if (!Application::us()) {
+        return;
+    }
+    if (nEvents < 0) {
+        Application::us()->warning("failed to write trace file \"%s\"", file.c_str());
+    }
+    else {
+        Application::us()->log("wrote %lld trace events to \"%s\"", (long long)nEvents, file.c_str());
+    }
+}
@@ -0,0 +1,135 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef _CORE_TRACING_HH
+#define _CORE_TRACING_HH
+
+#include <atomic>
+#include <string>
+
+#include <Core/Parameter.hh>
+#include <Core/Types.hh>
+
+namespace Core {
+
+/**
+ * Event tracing for latency analysis.
+ *
+ * Spans (a named interval on one thread) and counters (a named value
+ * at one point in time) are recorded with nanosecond timestamps into
+ * ring buffers, one per thread, so that recording needs no locking.
+ * When a buffer is full, the oldest events of the thread are
+ * overwritten.  write() dumps all buffers in the Chrome trace event
+ * format (JSON), which can be viewed with chrome://tracing or
+ * https://ui.perfetto.dev.
+ *
+ * Tracing is configured with the selection "tracing" of the
+ * application and the trace is written when the application
+ * terminates.  When tracing is disabled, a span or counter costs one
+ * relaxed atomic load; the name expression is not evaluated.
+ *
+ * Categories and names must stay valid until the trace is written,
+ * i.e. they are string literals or interned with intern().
+ *
+ * Usage:
+ * @code
+ *   TRACE_SCOPE("search", "decode-step");
+ *   TRACE_COUNTER("search", "active-hyps", hyps.size());
+ * @endcode
+ */
+class Tracer {
+public:
+    static const ParameterString paramFile;
+    static const ParameterInt    paramBufferSize;
+
+    /** Enables tracing if a trace file is configured. */
+    static void configure(const Configuration& config);
+
+    static bool isEnabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /** Monotonic time in nanoseconds. */
+    static u64 now();
+
+    /** Permanent copy of @param s, equal strings share one copy. */
+    static const char* intern(const std::string& s);
+
+    /** Name of the calling thread in the trace. */
+    static void setThreadName(const std::string& name);
+
+    static void recordSpan(const char* category, const char* name, u64 start, u64 end);
+    static void recordCounter(const char* category, const char* name, f64 value);
+
+    /**
+     * Writes the recorded events of all threads as Chrome trace JSON.
+     * Threads should not record events meanwhile.
+     * @return number of written events, -1 on failure
+     */
+    static s64 write(const std::string& filename);
+
+    /** Writes to the configured trace file, if tracing is enabled. */
+    static void write();
+
+private:
+    struct Event;
+    struct Buffer;
+    struct State;
+
+    static std::atomic<bool> enabled_;
+
+    static State&  state();
+    static Buffer& threadBuffer();
+};
+
+/** Records a span from construction to destruction, nothing if @c name is null. */
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name)
+            : category_(category),
+              name_(name),
+              start_(name ? Tracer::now() : 0) {}
+    ~TraceSpan() {
+        if (name_) {
+            Tracer::recordSpan(category_, name_, start_, Tracer::now());
+        }
+    }
+
+private:
+    const char* category_;
+    const char* name_;
+    u64         start_;
+
+    TraceSpan(const TraceSpan&);
+    void operator=(const TraceSpan&);
+};
+
+}  // namespace Core
+
+#define TRACE_CONCATENATE_(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_(a, b)
+
+/** Traces the enclosing scope as span @c name; @c name is evaluated only if tracing is enabled. */
+#define TRACE_SCOPE(category, name) \
+    Core::TraceSpan TRACE_CONCATENATE(traceSpan_, __LINE__)(category, Core::Tracer::isEnabled() ? (name) : nullptr)
+
+/** Records the current @c value of counter @c name; @c value is evaluated only if tracing is enabled. */
+#define TRACE_COUNTER(category, name, value)                     \
+    do {                                                         \
+        if (Core::Tracer::isEnabled()) {                         \
+            Core::Tracer::recordCounter(category, name, value); \
+        }                                                        \
+    } while (false)
+
+#endif  // _CORE_TRACING_HH
@@ -13,6 +13,7 @@
  *  limitations under the License.
  */
 #include "RecognizerV2.hh"
+#include <Core/MemoryAccounting.hh>
 #include <Core/XmlStream.hh>
 #include <Fsa/Sort.hh>
 #include <Fsa/Types.hh>
@@ -33,7 +34,8 @@ RecognizerNodeV2::RecognizerNodeV2(const std::string& name, const Core::Configur
           segmentResultBuffer_(),
           latticeHandler_(Flf::Module::instance().createLatticeHandler(config)),
           searchAlgorithm_(Search::Module::instance().createSearchAlgorithmV2(select("search-algorithm"))),
-          modelCombination_() {
+          modelCombination_(),
+          memoryChannel_(config, "memory-usage") {
     latticeHandler_->setLexicon(Lexicon::us());
     Core::Configuration featureExtractionConfig(config, "feature-extraction");
     DataSourceRef       dataSource = DataSourceRef(Speech::Module::instance().createDataSource(featureExtractionConfig));
@@ -47,6 +49,10 @@ void RecognizerNodeV2::recognizeSegment(const Bliss::SpeechSegment* segment) {
                << Core::XmlClose("orth");
     }
 
+    if (memoryChannel_.isOpen()) {
+        Core::MemoryAccounting::resetPeaks();
+    }
+
     // Initialize recognizer and feature extractor
     searchAlgorithm_->enterSegment();
 
@@ -102,6 +108,10 @@ void RecognizerNodeV2::recognizeSegment(const Bliss::SpeechSegment* segment) {
 
     clog() << Core::XmlOpen("flf-recognizer-time") + Core::XmlAttribute("unit", "milliseconds") << duration << Core::XmlClose("flf-recognizer-time");
     clog() << Core::XmlOpen("flf-recognizer-rtf") << (duration / signalDuration) << Core::XmlClose("flf-recognizer-rtf");
+
+    if (memoryChannel_.isOpen()) {
+        Core::MemoryAccounting::write(memoryChannel_);
+    }
 }
 
 void RecognizerNodeV2::work() {
@@ -61,6 +61,7 @@ private:
     std::unique_ptr<Search::SearchAlgorithmV2> searchAlgorithm_;
     Core::Ref<Speech::ModelCombination>        modelCombination_;
     SegmentwiseFeatureExtractorRef             featureExtractor_;
+    Core::XmlChannel                           memoryChannel_;  // per-segment memory accounting
 };
 
 /*
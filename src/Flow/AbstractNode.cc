@@ -19,7 +19,7 @@ using namespace Flow;
 /*****************************************************************************/
 
 const Core::ParameterBool AbstractNode::paramThreaded(
-        "threaded", "enable separeted thread for node", false);
+        "threaded", "run the node in its own thread, connected to its successors by bounded queues", false);
 const Core::ParameterBool AbstractNode::paramIgnoreUnknownParameters(
         "ignore-unknown-parameters",
         "Controls if error is generated when setting the value of unknown parameters.",
@@ -29,9 +29,9 @@ const Core::ParameterBool AbstractNode::paramIgnoreUnknownParameters(
 
 AbstractNode::AbstractNode(const Core::Configuration& c)
         : Component(c),
-          // Thread(),
           threaded_(false),
-          ignoreUnknownParameters_(paramIgnoreUnknownParameters(c)) {
+          ignoreUnknownParameters_(paramIgnoreUnknownParameters(c)),
+          traceName_(Core::Tracer::intern(fullName())) {
     setThreaded(paramThreaded(c));
 }
 
@@ -48,6 +48,10 @@ bool AbstractNode::checkAndSetParameter(const std::string& name, const std::stri
         ignoreUnknownParameters_ = paramIgnoreUnknownParameters(value);
         return true;
     }
+    else if (paramThreaded.match(name)) {
+        setThreaded(paramThreaded(value));
+        return true;
+    }
     else {
         std::string staticValue;  /// It would be better to make sure that checkAndSetParameter is only called when parameters _changed_
         if (config.get(name, staticValue) && staticValue.size()) {
@@ -113,29 +117,20 @@ bool AbstractNode::setNetworkParameter(const std::string& parameterName,
 
 /******************************************************************************/
 
-void AbstractNode::Run() {
-    // infinite loop until filter has any input data
-    while (1) {
-        // loop over all connected output ports
-        for (PortId i = 0; i < nOutputs(); i++) {
-            if (nOutputLinks(i) > 0)
-                work(i);
-        }
-    }
-}
-
-/******************************************************************************/
-
-#if 0
-void AbstractNode::startThread() {
-        if (isThreaded()) start();
-}
+void AbstractNode::announceNetworkParameter(const std::string& parameterName,
+                                            const std::string& networkParameterName,
+                                            const std::string& networkParameterValue) {
+    Parameters::const_iterator p = parameters_.find(parameterName);
+    verify(p != parameters_.end());
 
+    Core::StringExpression expression(p->second);
+    if (!expression.setVariable(networkParameterName, networkParameterValue))
+        defect();
 
-void AbstractNode::stopThread() {
-        stop();
+    std::string v;
+    if (expression.value(v))
+        announceParameter(parameterName, v);
 }
-#endif
 
 /******************************************************************************/
 
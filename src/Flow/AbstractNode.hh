@@ -19,6 +19,7 @@
 #include <Core/Hash.hh>
 #include <Core/Parameter.hh>
 #include <Core/StringExpression.hh>
+#include <Core/Tracing.hh>
 
 #include "Data.hh"
 #include "Link.hh"
@@ -34,9 +35,11 @@ namespace Flow {
  *   - unresolvedParameters_ : map<string,string> - stores the attributes
  *   - addUnresolvedAttribute(key, value) - adds a new attribute
  *   - unresolvedAttributes() - returns the stored attributes
+ *
+ * A threaded node (parameter "threaded") runs in its own thread as a
+ * pipeline stage, see Node::requestOutput().
  */
-class AbstractNode : public virtual Core::Component  //, public Core::Thread
-{
+class AbstractNode : public virtual Core::Component {
     friend class Network;
 
 public:
@@ -51,6 +54,7 @@ private:
     bool                 ignoreUnknownParameters_;
     Parameters           parameters_;
     UnresolvedAttributes dumpParameters_;
+    const char*          traceName_;
 
     /** setNetworkParameter is called by the Network
      * if a network parameter gets a new value.
@@ -67,6 +71,16 @@ private:
                              const std::string& networkParameterName,
                              const std::string& networkParameterValue);
 
+    /** announceNetworkParameter is called by the Network
+     * if a network parameter will get a new value soon.
+     *
+     * It resolves the parameter with the announced value and calls
+     * announceParameter, without changing the current value.
+     */
+    void announceNetworkParameter(const std::string& parameterName,
+                                  const std::string& networkParameterName,
+                                  const std::string& networkParameterValue);
+
     /**
      * Calls setParameter; return true if parameter is succesfully set or
      * unknown parameters are allowed
@@ -109,10 +123,23 @@ protected:
             d.reset();
             return false;
         }
+        if (!l->isFast()) {
+            // the from node runs in its own thread
+            if (!l->isDataAvailable() && !l->getFromNode()->requestOutput(l)) {
+                d.reset();
+                return false;
+            }
+            return l->getData(d);
+        }
         if (l->isDataAvailable()) {
             return l->getData(d);
         }
-        if (l->getFromNode()->work(l->getFromPort())) {
+        bool hasData;
+        {
+            TRACE_SCOPE("flow", l->getFromNode()->traceName_);
+            hasData = l->getFromNode()->work(l->getFromPort());
+        }
+        if (hasData) {
             return l->getData(d);
         }
         l->getData(d);
@@ -124,13 +151,29 @@ protected:
         return false;
     }
 
+    const char* traceName() const {
+        return traceName_;
+    }
+
+    /**
+     * Asks a threaded node to produce the next stream on output link
+     * @param l, i.e. the packets up to the next EOS or OOD.  Called by
+     * the consumer of @c l when it is empty.
+     * @return false if the node cannot run in its own thread
+     */
+    virtual bool requestOutput(Link* l) {
+        return true;
+    }
+    /**
+     * Waits for the thread of a threaded node to terminate.  The
+     * output links must have been closed, @see Network::stopThreads().
+     */
+    virtual void stopThread() {}
+
 public:
     AbstractNode(const Core::Configuration& c);
     virtual ~AbstractNode() {}
 
-    // threads
-    virtual void Run();
-
     // external configuration
     void setThreaded(bool threaded = true) {
         threaded_ = threaded;
@@ -157,6 +200,13 @@ public:
     virtual bool setParameter(const std::string& name, const std::string& value) {
         return false;
     }
+    /** Announce a future value of a node specific parameter.
+     * The parameter will be set to @c value later on, e.g. when the
+     * corpus visitor reaches the corresponding segment.
+     * Implement this function to prepare for it, e.g. by reading data ahead.
+     * Announcements are hints: they may be dropped or not be followed
+     * by the corresponding setParameter call. */
+    virtual void announceParameter(const std::string& name, const std::string& value) {}
     /** Erases attributes of all output links recursively over all successor nodes.
      *  Signals that node needs the get reconfigured.
      */
@@ -13,17 +13,179 @@
  *  limitations under the License.
  */
 #include "Cache.hh"
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
 #include <Core/Directory.hh>
+#include <Core/MemoryAccounting.hh>
 #include "Datatype.hh"
 #include "Registry.hh"
 
 using namespace Flow;
 
+/*
+ * Reads archive files of upcoming segments on a background thread.
+ *
+ * Segments are read in the order they are requested. A segment requested
+ * by the network before the background thread started to read it is
+ * dropped and read directly, a segment which is being read is waited for.
+ * Buffered segments are released once a later segment is processed.
+ */
+class Flow::CacheReadAhead {
+private:
+    typedef std::shared_ptr<const std::string> Content;
+
+    enum State {
+        Queued,
+        Reading,
+        Ready
+    };
+    struct Entry {
+        std::string name;
+        State       state;
+        Content     data, attributes;
+        Entry(const std::string& n)
+                : name(n),
+                  state(Queued) {}
+    };
+    typedef std::list<Entry> Entries;
+
+    Core::Archive&          archive_;
+    Core::MemoryAccount&    memory_;  // buffered contents
+    u32                     maxEntries_;
+    Entries                 entries_;  // in order of requests
+    bool                    stop_;
+    std::mutex              mutex_;
+    std::condition_variable queued_;
+    std::condition_variable finished_;
+    std::thread             thread_;
+
+    Entries::iterator find(const std::string& name) {
+        for (Entries::iterator e = entries_.begin(); e != entries_.end(); ++e)
+            if (e->name == name)
+                return e;
+        return entries_.end();
+    }
+
+    Entries::iterator nextQueued() {
+        for (Entries::iterator e = entries_.begin(); e != entries_.end(); ++e)
+            if (e->state == Queued)
+                return e;
+        return entries_.end();
+    }
+
+    Content read(const std::string& file) {
+        std::string* content = new std::string();
+        if (archive_.readFile(file, *content)) {
+            // the content may outlive the read-ahead buffer, accounts are never destroyed
+            Core::MemoryAccount* memory = &memory_;
+            memory->allocate(content->capacity());
+            return Content(content, [memory](const std::string* c) {
+                memory->release(c->capacity());
+                delete c;
+            });
+        }
+        delete content;
+        return Content();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            queued_.wait(lock, [this] { return stop_ || nextQueued() != entries_.end(); });
+            if (stop_)
+                return;
+            Entries::iterator e    = nextQueued();
+            std::string       name = e->name;
+            e->state               = Reading;
+            lock.unlock();
+            Content data       = read(name);
+            Content attributes = read(name + ".attribs");
+            lock.lock();
+            e = find(name);  // may have been released in the meantime
+            if (e != entries_.end() && e->state == Reading) {
+                e->data       = data;
+                e->attributes = attributes;
+                e->state      = Ready;
+            }
+            finished_.notify_all();
+        }
+    }
+
+public:
+    CacheReadAhead(Core::Archive& archive, u32 maxEntries)
+            : archive_(archive),
+              memory_(Core::MemoryAccounting::account("flow-cache-read-ahead")),
+              maxEntries_(maxEntries),
+              stop_(false) {
+        thread_ = std::thread(&CacheReadAhead::run, this);
+    }
+
+    ~CacheReadAhead() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        queued_.notify_all();
+        thread_.join();
+    }
+
+    void request(const std::string& name) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (find(name) != entries_.end())
+                return;
+            entries_.push_back(Entry(name));
+            // keep the entry in use plus maxEntries_ upcoming ones
+            while (entries_.size() > maxEntries_ + 1)
+                entries_.pop_front();
+        }
+        queued_.notify_one();
+    }
+
+    /** Releases all entries requested before @param name. */
+    void advance(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entries::iterator           e = find(name);
+        if (e != entries_.end())
+            entries_.erase(entries_.begin(), e);
+    }
+
+    /** @return the content of @param file if it was read ahead */
+    Content get(const std::string& file) {
+        static const std::string suffix = ".attribs";
+        bool                     isAttributes =
+                file.size() > suffix.size() && file.compare(file.size() - suffix.size(), suffix.size(), suffix) == 0;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        Entries::iterator            e = find(file);
+        if (e == entries_.end() && isAttributes)
+            e = find(file.substr(0, file.size() - suffix.size()));
+        else
+            isAttributes = false;
+        if (e == entries_.end())
+            return Content();
+        if (e->state == Queued) {
+            // reading it directly is faster than waiting for the entries in front of it
+            entries_.erase(e);
+            return Content();
+        }
+        std::string name = e->name;
+        finished_.wait(lock, [&] { e = find(name); return e == entries_.end() || e->state == Ready; });
+        if (e == entries_.end())
+            return Content();
+        return isAttributes ? e->attributes : e->data;
+    }
+};
+
+/******************************************************************************/
+
 /******************************************************************************/
 
 CacheReader::CacheReader(Cache* cache, const std::string& name)
         : Cached(cache, name),
-          reader(*cache->archive_, name) {
+          reader(cache->newArchiveReader(name)) {
     data_.resize(0);
     position_ = 0;
 }
@@ -31,8 +193,8 @@ CacheReader::CacheReader(Cache* cache, const std::string& name)
 u32 CacheNode::peekCachedDataLen() const {
     require(archive_);
     require(!id_.empty());
-    Core::ArchiveReader     reader(*archive_, id_);
-    Core::BinaryInputStream b(reader);
+    std::unique_ptr<Core::ArchiveReader> reader(newArchiveReader(id_));
+    Core::BinaryInputStream              b(*reader);
     std::string             datatypeName;
     if (!(b >> datatypeName))
         return 0;
@@ -45,7 +207,7 @@ u32 CacheNode::peekCachedDataLen() const {
 /******************************************************************************/
 
 void CacheReader::readData() {
-    Core::BinaryInputStream b(reader);
+    Core::BinaryInputStream b(*reader);
     std::string             datatypeName;
     if (b >> datatypeName) {
         const Datatype* datatype = Flow::Registry::instance().getDatatype(datatypeName);
@@ -129,16 +291,19 @@ Core::ParameterString Cache::paramPrefix("prefix", "prefix for files within the
 Core::ParameterInt    Cache::paramGather("gather", "number of data packets to gather before writing", Core::Type<u32>::max);
 Core::ParameterBool   Cache::paramCompress("compress", "compress data written to archive", false);
 Core::ParameterString Cache::paramCast("cast", "datatype casted to before writing to archive");
+Core::ParameterInt    Cache::paramReadAhead("read-ahead", "number of upcoming segments read on a background thread (0 = disabled)", 0, 0);
 
 Cache::Cache(const Core::Configuration& c)
         : Core::Component(c),
           archive_(0),
-          attributesParser_(select("attributes-parser")) {
+          attributesParser_(select("attributes-parser")),
+          readAheadBuffer_(0) {
     setPath(paramPath(config));
     setPrefix(paramPrefix(config));
     setGather(paramGather(config));
     setCompress(paramCompress(config));
     setCast(paramCast(config));
+    setReadAhead(paramReadAhead(config));
 }
 
 Cache::~Cache() {
@@ -164,6 +329,8 @@ bool Cache::open(Core::Archive::AccessMode _access) {
 void Cache::close() {
     if (!isOpen())
         return;
+    delete readAheadBuffer_;
+    readAheadBuffer_ = 0;
     delete archive_;
     archive_ = 0;
 }
@@ -182,6 +349,28 @@ CacheReader* Cache::newReader(const std::string& name) {
 
 /******************************************************************************/
 
+Core::ArchiveReader* Cache::newArchiveReader(const std::string& file) const {
+    require(archive_);
+    if (readAheadBuffer_) {
+        std::shared_ptr<const std::string> content = readAheadBuffer_->get(file);
+        if (content)
+            return new Core::ArchiveReader(content);
+    }
+    return new Core::ArchiveReader(*archive_, file);
+}
+
+/******************************************************************************/
+
+void Cache::readAhead(const std::string& name) {
+    if (!readAhead_ || !hasAccess(Core::Archive::AccessModeRead))
+        return;
+    if (!readAheadBuffer_)
+        readAheadBuffer_ = new CacheReadAhead(*archive_, readAhead_);
+    readAheadBuffer_->request(name);
+}
+
+/******************************************************************************/
+
 CacheWriter* Cache::newWriter(const std::string& name) {
     if (isOpen()) {
         CacheWriter* writer = new CacheWriter(this, name);
@@ -217,6 +406,8 @@ CacheNode::~CacheNode() {
 
 bool CacheNode::createContext(const std::string& id) {
     id_ = prefix_ + id;
+    if (readAheadBuffer_)
+        readAheadBuffer_->advance(id_);
     delete reader_;
     reader_ = 0;
     delete writer_;
@@ -277,6 +468,8 @@ bool CacheNode::setParameter(const std::string& name, const std::string& value)
         setCompress(paramCompress(value));
     else if (paramCast.match(name))
         setCast(paramCast(value));
+    else if (paramReadAhead.match(name))
+        setReadAhead(paramReadAhead(value));
     else
         return false;
     return true;
@@ -284,6 +477,16 @@ bool CacheNode::setParameter(const std::string& name, const std::string& value)
 
 /******************************************************************************/
 
+void CacheNode::announceParameter(const std::string& name, const std::string& value) {
+    if (name != "id" || !readAhead_ || !hasOutput_)
+        return;
+    if (!isOpen() && !open(Core::Archive::AccessModeRead))
+        return;
+    readAhead(prefix_ + value);
+}
+
+/******************************************************************************/
+
 PortId CacheNode::getInput(const std::string& name) {
     if (!hasInput_) {
         hasInput_ = true;
@@ -308,10 +511,10 @@ bool CacheNode::configure() {
     std::shared_ptr<const Attributes> attributes;
 
     if (isCached_) {
-        Core::ArchiveReader r(*archive_, id_ + ".attribs");
-        if (r.isOpen()) {
+        std::unique_ptr<Core::ArchiveReader> r(newArchiveReader(id_ + ".attribs"));
+        if (r->isOpen()) {
             auto ca = std::make_shared<Attributes>();
-            if (attributesParser_.buildFromStream(*ca, r)) {
+            if (attributesParser_.buildFromStream(*ca, *r)) {
                 std::string datatype = ca->get("datatype");
                 if (!datatype.empty()) {
                     datatype_ = Flow::Registry::instance().getDatatype(datatype);
@@ -26,6 +26,7 @@
  *
  */
 
+#include <memory>
 #include <string>
 
 #include <Core/Archive.hh>
@@ -40,6 +41,7 @@
 namespace Flow {
 
 class Cache;
+class CacheReadAhead;
 class Cached {
 protected:
     std::string name_;
@@ -58,8 +60,8 @@ public:
 
 class CacheReader : public Cached {
 private:
-    size_t              position_;
-    Core::ArchiveReader reader;
+    size_t                               position_;
+    std::unique_ptr<Core::ArchiveReader> reader;
 
 public:
     CacheReader(Cache* cache, const std::string& name);
@@ -68,7 +70,7 @@ public:
     Data* getData();
 
     bool isOpen() const {
-        return reader.isOpen();
+        return reader->isOpen();
     }
 };
 
@@ -111,6 +113,7 @@ protected:
     static Core::ParameterInt    paramGather;
     static Core::ParameterBool   paramCompress;
     static Core::ParameterString paramCast;
+    static Core::ParameterInt    paramReadAhead;
 
     Core::Archive*     archive_;
     Attributes::Parser attributesParser_;
@@ -119,6 +122,11 @@ protected:
     u32                gather_;
     bool               compress_;
     std::string        cast_;
+    u32                readAhead_;
+    CacheReadAhead*    readAheadBuffer_;
+
+    /** Opens archive file @param file, using its content if it was read ahead. */
+    Core::ArchiveReader* newArchiveReader(const std::string& file) const;
 
 public:
     Cache(const Core::Configuration&);
@@ -143,6 +151,9 @@ public:
     void setCast(const std::string& cast) {
         cast_ = cast;
     }
+    void setReadAhead(u32 readAhead) {
+        readAhead_ = readAhead;
+    }
 
     bool hasAccess(Core::Archive::AccessMode a) const {
         return (archive_) ? archive_->hasAccess(a) : false;
@@ -155,6 +166,12 @@ public:
 
     CacheReader* newReader(const std::string& name);
     CacheWriter* newWriter(const std::string& name);
+
+    /**
+     * Reads the data and attributes of @param name on a background thread,
+     * if read-ahead is enabled. At most read-ahead entries are buffered.
+     **/
+    void readAhead(const std::string& name);
 };
 
 class CacheNode : public Node, public Cache {
@@ -179,6 +196,7 @@ public:
     virtual ~CacheNode();
 
     virtual bool   setParameter(const std::string& name, const std::string& value);
+    virtual void   announceParameter(const std::string& name, const std::string& value);
     virtual PortId getInput(const std::string& name);
     virtual PortId getOutput(const std::string& name);
     virtual bool   configure();
@@ -41,6 +41,7 @@ class Data : public Core::ThreadSafeReferenceCounted {
     friend class Datatype;
     friend class Link;
     friend class Node;
+    friend class StageQueue;
 
 private:
     const Datatype* datatype_;
@@ -27,10 +27,13 @@ Link::Link() {
     from_port_ = IllegalPortId;
     to_node_   = 0;
     to_port_   = IllegalPortId;
-    is_fast_   = false;
+    is_fast_   = true;
     buffer_    = 0;
     datatype_  = 0;
     fast_data_ = sentinelEmpty();
+
+    nStreamsReceived_ = 0;
+    endOfStream_      = false;
 }
 
 /******************************************************************************/
@@ -50,6 +53,17 @@ void Link::clear() {
         }
         fast_data_ = sentinelEmpty();
     }
+    if (stageQueue_)
+        resetStageQueue();
+}
+
+/******************************************************************************/
+
+void Link::resetStageQueue() {
+    require(!is_fast_);
+    stageQueue_.reset(new StageQueue(buffer_ ? buffer_ : defaultStageBuffer));
+    nStreamsReceived_ = 0;
+    endOfStream_      = false;
 }
 
 /******************************************************************************/
@@ -85,8 +99,13 @@ std::ostream& Flow::operator<<(std::ostream& o, const Link& l) {
 
 void Link::configure() {
     if (getFromNode()) {
-        is_fast_ = !getFromNode()->isThreaded();
+        // only nodes run in their own thread, a threaded network threads the nodes feeding its outputs
+        is_fast_ = !getFromNode()->isThreaded() || !dynamic_cast<Node*>(getFromNode());
     }
+    if (is_fast_)
+        stageQueue_.reset();
+    else if (!stageQueue_)
+        resetStageQueue();
 }
 
 /******************************************************************************/
@@ -15,6 +15,7 @@
 #ifndef _FLOW_LINK_HH
 #define _FLOW_LINK_HH
 
+#include <memory>
 #include <ostream>
 
 #include <Core/Assertions.hh>
@@ -26,6 +27,15 @@
 namespace Flow {
 
 class AbstractNode;
+
+/**
+ * Connection from an output port of one node to an input port of another.
+ *
+ * If the from node is threaded, i.e. runs in its own thread as a
+ * pipeline stage, the link buffers up to getBuffer() packets (or
+ * defaultStageBuffer) in a StageQueue; otherwise, the packets are
+ * generated on demand in the thread of the to node.
+ */
 class Link {
 private:
     // connection
@@ -45,6 +55,11 @@ private:
     std::shared_ptr<const Attributes> attributes_;
     Data*                             fast_data_;
 
+    // threaded from node
+    std::unique_ptr<StageQueue> stageQueue_;
+    u32                         nStreamsReceived_;  // consumer side
+    bool                        endOfStream_;       // producer side
+
     /** Represents the status of fast_data_.
      *  fast_data_ can be either "empty" or occupied by a data or also by a
      *  non-data object. Link does not differentiate data and non-data objects.
@@ -58,6 +73,8 @@ private:
     }
 
 public:
+    static const u32 defaultStageBuffer = 64;
+
     Link();
     ~Link();
 
@@ -65,7 +82,7 @@ public:
     inline bool isDataAvailable() {
         if (is_fast_)
             return (!isEmpty(fast_data_) || (!queue_.isEmpty()));
-        return (!queue_.isEmptyAtomar());
+        return !stageQueue_->isEmpty();
     }
     template<class T>
     inline bool getData(DataPtr<T>& d) {
@@ -82,7 +99,16 @@ public:
             }
         }
         else {
-            queue_.getBlocking(d);
+            Data* p = stageQueue_->get();
+            if (!p) {
+                // the network is stopping its threads
+                p = Data::ood();
+                p->increment();
+            }
+            else if (p == Data::eos() || p == Data::ood()) {
+                ++nStreamsReceived_;
+            }
+            d.take(p);
         }
 
         return d;
@@ -125,14 +151,38 @@ public:
             require(!isEmpty(fast_data_) or !queue_.isEmpty());
             return true;
         }
-        if (d != Data::ood() or queue_.isEmpty()) {
-            queue_.putAtomar(d);
+        if (!stageQueue_->put(d)) {
+            endOfStream_ = true;
+            if (d->refCount() == 0)
+                d->free();
+            return false;
         }
-
-        require(!isEmpty(fast_data_) or !queue_.isEmpty());
+        endOfStream_ = (d == Data::eos() || d == Data::ood());
         return true;
     }
 
+    /** Number of streams (packets up to EOS or OOD) received from a threaded from node. */
+    u32 nStreamsReceived() const {
+        return nStreamsReceived_;
+    }
+    /** True if the last packet put on a link from a threaded node ended a stream or failed. */
+    bool endOfStream() const {
+        return endOfStream_;
+    }
+    void clearEndOfStream() {
+        endOfStream_ = false;
+    }
+    bool isStageQueueClosed() const {
+        return stageQueue_ && stageQueue_->isClosed();
+    }
+    /** Wakes up and fails all waiting and further put and get calls, @see Network::stopThreads(). */
+    void closeStageQueue() {
+        if (stageQueue_)
+            stageQueue_->close();
+    }
+    /** Replaces a closed queue by an empty one. */
+    void resetStageQueue();
+
     /** Datatype as advertised by source node. */
     const Datatype* datatype() const {
         return datatype_;
@@ -80,7 +80,7 @@ Network::~Network() {
         if (!dump(true, dumpChannel_))
             warning("dump of '%s' failed!", typeName_.c_str());
     }
-    // if (started_) stopThread();
+    stopThreads();
     for (std::list<Link*>::const_iterator it = links_.begin(); it != links_.end();
          it++)
         delete *it;
@@ -477,6 +477,7 @@ bool Network::putAttributes(PortId in, std::shared_ptr<const Attributes> attribu
     Port& port = inputs_[in];
     verify(port.linkConnected());
 
+    stopThreads();
     port.link()->setAttributes(attributes);
     port.link()->clear();
     port.link()->configure();
@@ -504,47 +505,79 @@ const std::string Network::getAttribute(PortId out, const std::string& name) {
 
 /******************************************************************************/
 
-#if 0
-void Network::startThread() {
-    // if network is threaded, mark all output nodes threaded
-    if (isThreaded()) {
-        for (u32 i = 0; i < outputs_.size(); i++) {
-            outputs_[i].link()->getFromNode()->setThreaded(true);
-        }
-    }
+void Network::stopThreads() {
+    std::vector<Link*>         links;
+    std::vector<AbstractNode*> nodes;
+    collectThreads(links, nodes);
+    if (nodes.empty())
+        return;
+    // all queues are closed before waiting for any thread, since a thread may wait for any other
+    for (std::vector<Link*>::iterator l = links.begin(); l != links.end(); ++l)
+        (*l)->closeStageQueue();
+    for (std::vector<AbstractNode*>::iterator n = nodes.begin(); n != nodes.end(); ++n)
+        (*n)->stopThread();
+    for (std::vector<Link*>::iterator l = links.begin(); l != links.end(); ++l)
+        (*l)->resetStageQueue();
+}
 
-    // start all nodes
-    for (std::list<AbstractNode*>::iterator it = nodes_.begin(); it != nodes_.end(); it++) {
-        (*it)->startThread();
-    }
+/******************************************************************************/
 
-    started_ = true;
+void Network::collectThreads(std::vector<Link*>& links, std::vector<AbstractNode*>& nodes) {
+    for (std::list<Link*>::const_iterator l = links_.begin(); l != links_.end(); ++l) {
+        if (!(*l)->isFast())
+            links.push_back(*l);
+    }
+    for (std::list<AbstractNode*>::const_iterator n = nodes_.begin(); n != nodes_.end(); ++n) {
+        Network* network = dynamic_cast<Network*>(*n);
+        if (network)
+            network->collectThreads(links, nodes);
+        else if ((*n)->isThreaded())
+            nodes.push_back(*n);
+    }
 }
 
 /******************************************************************************/
 
-void Network::stopThread() {
-  // stop all nodes
-  for (std::list<AbstractNode*>::iterator it = nodes_.begin(); it != nodes_.end(); it++) {
-      (*it)->stopThread();
-  }
-
-#if 0
-  // clear all queues
-  for (u32 i = 0; i < links_.size(); i++) links_[i]->clear();
-#endif
-      started_ = false;
+void Network::setOutputNodesThreaded() {
+    for (std::vector<Port>::iterator port = outputs_.begin(); port != outputs_.end(); ++port) {
+        AbstractNode* node = port->node();
+        if (!node)
+            continue;
+        u32 nLinks = 0;
+        for (PortId i = 0; i < node->nOutputs(); ++i)
+            nLinks += node->nOutputLinks(i);
+        if (nLinks == 1)
+            node->setThreaded(true);
+        else
+            warning("Node '%s' has more than one output link and is not threaded.", node->name().c_str());
+    }
 }
-#endif
 
 /******************************************************************************/
 
 bool Network::setParameter(const std::string& name, const std::string& value) {
+    // nodes are not thread-safe, a new value of a parameter starts new streams anyway
+    stopThreads();
     return setUserDefinedParameter(name, value);
 }
 
 /******************************************************************************/
 
+void Network::announceParameter(const std::string& name, const std::string& value) {
+    // announcements are made between segments, when the threads are idle
+    stopThreads();
+    for (std::list<Network::Parameter>::iterator it = params_.begin(); it != params_.end(); it++) {
+        if ((*it).name() == name) {
+            const std::vector<Parameter::Use>& list(it->getUses());
+            for (std::vector<Parameter::Use>::const_iterator used = list.begin(); used != list.end(); ++used)
+                used->by->announceNetworkParameter(used->as, name, value);
+            return;
+        }
+    }
+}
+
+/******************************************************************************/
+
 bool Network::setUserDefinedParameter(const std::string& name, const std::string& value) {
     Network::Parameter* found = 0;
     for (std::list<Network::Parameter>::iterator it = params_.begin();
@@ -682,6 +715,7 @@ ssize_t Network::getRemainingDataLen(PortId out) {
 /******************************************************************************/
 
 void Network::reset() {
+    stopThreads();
     for (std::vector<Port>::iterator inputPort = inputs_.begin();
          inputPort != inputs_.end(); ++inputPort) {
         inputPort->node()->eraseOutputAttributes();
@@ -696,15 +730,10 @@ void Network::reset() {
 /******************************************************************************/
 
 void Network::go() {
-    /*
-        for (list<AbstractNode*>::const_iterator n = nodes_.begin(); n != nodes_.end(); n++) {
-                (*n)->Start();
-        }
-        */
-    // gather sinks
+    // gather sinks, threaded nodes upstream run in their own threads
     std::list<AbstractNode*> sinks;
     for (std::list<AbstractNode*>::const_iterator n = nodes_.begin(); n != nodes_.end(); n++) {
-        if (((*n)->nOutputs() == 0) && (!(*n)->isThreaded()))
+        if ((*n)->nOutputs() == 0)
             sinks.push_back(*n);
     }
 
@@ -942,5 +971,8 @@ bool NetworkTemplate::createNetwork(Network& network) const {
             builder_->error("could not add link to network");
     }
 
+    if (network.isThreaded())
+        network.setOutputNodesThreaded();
+
     return true;
 }
@@ -52,6 +52,16 @@ namespace Flow {
  *   dump-channel.add-sprint-tags = false
  *   ---------------------------------------------------------
  *   </pre>
+ *
+ * Pipeline execution:
+ * Threaded nodes (node attribute or parameter threaded=true) run in
+ * their own threads; a threaded network (<network threaded="true">)
+ * threads the nodes feeding its outputs.  All nodes between two
+ * threaded nodes run in the thread of the downstream one, so the
+ * threaded nodes partition the network into pipeline stages.  A
+ * threaded node must have a single output link, the stages must not
+ * share nodes and must not be fed through the inputs of the network.  The threads are stopped before parameters change,
+ * i.e. at segment boundaries, and on reset().
  */
 class Network : public AbstractNode {
     typedef AbstractNode Precursor;
@@ -259,6 +269,9 @@ private:
     /** Configures the part of the network used by the output port @param out. */
     bool configureOutputPort(Port& out);
 
+    /** Collects the queued links and threaded nodes of this network and its sub-networks. */
+    void collectThreads(std::vector<Link*>& links, std::vector<AbstractNode*>& nodes);
+
     /** Sets the value of parameter @c name in each node which uses it. */
     bool setUserDefinedParameter(const std::string& name, const std::string& value);
 
@@ -377,7 +390,6 @@ public:
         if (!started_) {
             if ((!l->areAttributesAvailable()) && (!configureOutputPort(port)))
                 return NULL;
-            // startThread();
         }
         return l;
     }
@@ -397,6 +409,8 @@ public:
     const std::string getAttribute(PortId out, const std::string& name);
 
     virtual bool setParameter(const std::string& name, const std::string& value);
+    /** Announces a future value of parameter @c name to each node which uses it. */
+    virtual void announceParameter(const std::string& name, const std::string& value);
 
     /** Creates empy input attibutes for input ports without one an attribute. */
     virtual bool configure();
@@ -409,6 +423,16 @@ public:
     /** Resets all links and nodes. */
     void reset();
 
+    /**
+     * Stops the threads of all threaded nodes, including those of
+     * sub-networks, and discards the packets in their output queues.
+     * The threads are started again on demand.
+     */
+    void stopThreads();
+
+    /** Runs the nodes feeding the outputs in their own threads, if they have a single output link. */
+    void setOutputNodesThreaded();
+
     void configureAll() {
         for (auto n : nodes_) {
             auto* network = dynamic_cast<Flow::Network*>(n);
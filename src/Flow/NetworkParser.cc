@@ -157,7 +157,6 @@ void NetworkParser::start_output(const XmlAttributes atts) {
 void NetworkParser::start_node(const XmlAttributes atts) {
     const char* name   = atts["name"];
     const char* filter = atts["filter"];
-    // const char *threaded = atts["threaded"];
 
     if (!name) {
         error("network node has no name");
@@ -13,19 +13,50 @@
  *  limitations under the License.
  */
 #include "Node.hh"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <Core/Application.hh>
+#include <Core/Tracing.hh>
 #include "Datatype.hh"
 #include "Registry.hh"
 
 using namespace Flow;
 
+struct Node::Stage {
+    std::thread             thread;
+    std::mutex              mutex;
+    std::condition_variable wakeUp;
+    std::atomic<u32>        nRequested;  // streams asked for since the thread was started
+    bool                    terminate;
+
+    Stage()
+            : nRequested(0),
+              terminate(false) {}
+};
+
 Node::Node(const Core::Configuration& c)
         : Component(c),
           Precursor(c),
           filter_(0),
           datatype_(0),
           attributesChannel_(c, "dump-attributes", Core::Channel::disabled),
-          dataChannel_(c, "dump-data", Core::Channel::disabled) {}
+          dataChannel_(c, "dump-data", Core::Channel::disabled),
+          stage_(new Stage) {}
+
+/******************************************************************************/
+
+Node::~Node() {
+    if (stage_->thread.joinable()) {
+        // not stopped by the network
+        for (size_t out = 0; out < outputs_.size(); ++out) {
+            for (size_t i = 0; i < outputs_[out].size(); ++i)
+                outputs_[out][i]->closeStageQueue();
+        }
+        stopThread();
+    }
+}
 
 /******************************************************************************/
 
@@ -285,3 +316,70 @@ void SinkNode::Run()
     while (work(0));
 }
 #endif
+
+/******************************************************************************/
+
+bool Node::requestOutput(Link* l) {
+    Stage& s = *stage_;
+    u32    n = l->nStreamsReceived() + 1;
+    if (n <= s.nRequested)
+        return true;
+    std::lock_guard<std::mutex> lock(s.mutex);
+    // a closed queue means that the network is stopping the thread
+    if (n <= s.nRequested || l->isStageQueueClosed())
+        return true;
+    if (!s.thread.joinable()) {
+        u32 nLinks = 0;
+        for (PortId i = 0; i < nOutputs(); ++i)
+            nLinks += nOutputLinks(i);
+        if (nLinks > 1) {
+            error("Threaded node '%s' must not have more than one output link.", name().c_str());
+            return false;
+        }
+        s.thread = std::thread(&Node::runStage, this, l->getFromPort(), l);
+    }
+    s.nRequested = n;
+    s.wakeUp.notify_one();
+    return true;
+}
+
+/******************************************************************************/
+
+void Node::stopThread() {
+    Stage& s = *stage_;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.thread.joinable())
+            return;
+        s.terminate = true;
+    }
+    s.wakeUp.notify_one();
+    s.thread.join();
+    s.terminate  = false;
+    s.nRequested = 0;
+}
+
+/******************************************************************************/
+
+void Node::runStage(PortId out, Link* link) {
+    if (Core::Tracer::isEnabled())
+        Core::Tracer::setThreadName(fullName());
+    Stage& s = *stage_;
+    for (u32 nCompleted = 0;; ++nCompleted) {
+        {
+            std::unique_lock<std::mutex> lock(s.mutex);
+            s.wakeUp.wait(lock, [&]() { return s.terminate || s.nRequested > nCompleted; });
+            if (s.terminate)
+                return;
+        }
+        link->clearEndOfStream();
+        bool failed = false;
+        while (!failed && !link->endOfStream()) {
+            TRACE_SCOPE("flow", traceName());
+            failed = !work(out);
+        }
+        // the consumer must not wait for a stream which is never completed
+        if (failed && !link->endOfStream())
+            link->putData(Data::ood());
+    }
+}
@@ -21,6 +21,7 @@
 #include <Core/StringExpression.hh>
 #include <Core/Types.hh>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <unistd.h>
 #include "AbstractNode.hh"
@@ -50,6 +51,12 @@ private:
 
     Core::XmlChannel attributesChannel_, dataChannel_;
 
+    struct Stage;
+    std::unique_ptr<Stage> stage_;
+
+    /** Main loop of the own thread of a threaded node. */
+    void runStage(PortId out, Link* link);
+
 protected:
     /** Connect link to input port.
      * Do not connect more than one link to an input, will return
@@ -148,9 +155,23 @@ protected:
     /** Erases attributes of all output links recursively. */
     void eraseOutputAttributes();
 
+    /**
+     * Starts the own thread of a threaded node if necessary and lets it
+     * produce streams until link @param l has received the next one.
+     * The thread calls work() on the single output link and puts the
+     * packets into its bounded queue, overlapping with the consumer.
+     * It pauses after each EOS or OOD until the consumer asks for
+     * more, so that nothing of the next segment is computed before the
+     * parameters of the segment are set.
+     * Fails if the node has more than one output link: consumers of
+     * several links could block each other on full queues.
+     */
+    virtual bool requestOutput(Link* l);
+    virtual void stopThread();
+
 public:
     Node(const Core::Configuration& c);
-    virtual ~Node() {}
+    virtual ~Node();
 
     virtual PortId getInput(const std::string& name) {
         return IllegalPortId;
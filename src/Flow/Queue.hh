@@ -15,27 +15,21 @@
 #ifndef _FLOW_QUEUE_HH
 #define _FLOW_QUEUE_HH
 
+#include <atomic>
 #include <queue>
 
-#include <Core/Thread.hh>
+#include <Core/Assertions.hh>
+#include <Core/readerwriterqueue.h>
 #include "Data.hh"
 
 namespace Flow {
 
+/** Packets of a link between nodes running in the same thread. */
 class Queue {
 private:
-    mutable Core::Mutex       m_;
     std::queue<DataPtr<Data>> l_;
-    mutable Core::Condition   c_;
 
 public:
-    inline void lock() const {
-        m_.lock();
-    }
-    inline void release() const {
-        m_.release();
-    }
-
     inline void clear() {
         while (l_.size())
             l_.pop();
@@ -46,40 +40,95 @@ public:
     inline bool isEmpty() const {
         return (l_.size() == 0);
     }
-    inline bool isEmptyAtomar() const {
-        lock();
-        bool is_empty = isEmpty();
-        release();
-        return is_empty;
-    }
 
     inline void put(Data* d) {
         l_.push(DataPtr<Data>(d));
     }
-    inline void putAtomar(Data* d) {
-        lock();
-        l_.push(DataPtr<Data>(d));
-        release();
-        c_.signal(true);
-    }
     template<class T>
     inline void get(DataPtr<T>& d) {
         d = l_.front();
         l_.pop();
     }
-    template<class T>
-    inline void getBlocking(DataPtr<T>& d) {
-        if (isEmptyAtomar())
-            c_.wait();
-        d = l_.front();
-        l_.pop();
-#if 0
-        lock();
-        while (isEmpty()) { release(); usleep(10000); lock(); }
-        get(d);
-        release();
+};
+
+/**
+ * Packets of a link from a node running in its own thread.
+ *
+ * Bounded single-producer single-consumer queue: the producer blocks
+ * while the queue is full, the consumer while it is empty.  Apart
+ * from blocking, neither side takes a lock.  close() wakes up both
+ * sides and makes all further put() and get() calls fail; a closed
+ * queue is not reopened but replaced.
+ */
+class StageQueue {
+private:
+    typedef moodycamel::spsc_sema::LightweightSemaphore Semaphore;
+
+    moodycamel::ReaderWriterQueue<Data*> queue_;  // each packet holds one reference
+    Semaphore                            slots_, packets_;
+    std::atomic<bool>                    closed_;
+    u32                                  capacity_;
+
+public:
+    StageQueue(u32 capacity)
+            : queue_(capacity),
+              slots_(capacity),
+              packets_(0),
+              closed_(false),
+              capacity_(capacity) {
+        require(capacity > 0);
+    }
+    ~StageQueue() {
+        Data* d;
+        while (queue_.try_dequeue(d)) {
+            if (d->decrement())
+                d->free();
+        }
+    }
+
+    u32 capacity() const {
+        return capacity_;
+    }
+    /** Consumer side. */
+    bool isEmpty() const {
+        return queue_.size_approx() == 0;
+    }
+    bool isClosed() const {
+        return closed_;
+    }
+
+    /** @return false if the queue has been closed, @c d is not queued then */
+    bool put(Data* d) {
+        slots_.wait();
+        if (closed_) {
+            slots_.signal();  // for the next call
+            return false;
+        }
+        d->increment();
+        if (!queue_.try_enqueue(d))
+            defect();  // slots_ limits the size to the capacity
+        packets_.signal();
         return true;
-#endif
+    }
+
+    /** @return the next packet with one reference to take over, 0 if the queue has been closed */
+    Data* get() {
+        packets_.wait();
+        if (closed_) {
+            packets_.signal();
+            return 0;
+        }
+        Data* d = 0;
+        if (!queue_.try_dequeue(d))
+            defect();
+        slots_.signal();
+        return d;
+    }
+
+    void close() {
+        closed_ = true;
+        slots_.signal();
+        packets_.signal();
     }
 };
 
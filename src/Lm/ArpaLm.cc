@@ -18,8 +18,10 @@
 #include <Core/CompressedStream.hh>
 #include <Core/MD5.hh>
 #include <Core/ProgressIndicator.hh>
+#include <Core/Statistics.hh>
 #include <Core/StringUtilities.hh>
 #include <Core/TextStream.hh>
+#include <Core/ThreadPool.hh>
 #include <Fsa/Arithmetic.hh>
 #include <Fsa/Compose.hh>
 #include <cstdio>
@@ -44,6 +46,10 @@ const Core::ParameterBool ArpaLm::paramReverseLm(
         "reverse the LM in-place (temporarily needs a lot of memory)"
         "",
         false);
+const Core::ParameterInt ArpaLm::paramNumThreads(
+        "num-threads",
+        "number of threads for parsing the n-gram sections in chunks and sorting the n-grams",
+        1, 1);
 
 /**
  * Since log(0) (minus infinity) has no portable representation,
@@ -98,10 +104,101 @@ public:
     }
 };
 
-void ArpaLm::read() {
-    static const f64 ln10           = 2.30258509299404568402;
+/**
+ * Converts n-gram lines to init items.
+ * Unknown words and malformed lines are only collected, they are
+ * reported by the caller, so that several parsers can work on
+ * different parts of the file concurrently.
+ */
+class ArpaLm::NGramParser {
+public:
     static const u32 maxNGramLength = 32;
 
+    InitData                                 data;
+    u32                                      nNGrams;
+    std::vector<std::pair<std::string, u32>> unknownTokens; /**< first occurrence of each unknown word */
+    std::vector<u32>                         badLines;
+
+    NGramParser(const ArpaLm& lm, bool includeZeroProb)
+            : nNGrams(0), lm_(lm), includeZeroProb_(includeZeroProb) {}
+
+    void parse(const std::string& line, u32 nGram, u32 lineNumber);
+
+private:
+    const ArpaLm&                   lm_;
+    bool                            includeZeroProb_;
+    std::unordered_set<std::string> unknown_;
+};
+
+void ArpaLm::NGramParser::parse(const std::string& line, u32 nGram, u32 lineNumber) {
+    static const f64 ln10 = 2.30258509299404568402;
+
+    std::istringstream lis(line);
+    f64                score;
+    std::string        word;
+    Token              tokens[maxNGramLength];
+    u32                n;
+    if (!(lis >> score))
+        badLines.push_back(lineNumber);
+    hope(nGram <= maxNGramLength);
+    for (n = 0; n < nGram; ++n) {
+        if (lis >> word) {
+            Core::normalizeWhitespace(word);
+            Core::suppressTrailingBlank(word);
+            Token t = lm_.getToken(word);
+            if (t) {
+                tokens[n] = t;
+            }
+            else {
+                if (unknown_.insert(word).second)
+                    unknownTokens.push_back(std::make_pair(word, lineNumber));
+                break;
+            }
+        }
+    }
+    if (n == nGram) {
+        std::reverse(tokens, tokens + n);
+        if (includeZeroProb_ || !Core::isAlmostEqual(score, InfScore, 0.1))
+            data.addScore(&tokens[1], &tokens[n], tokens[0], -ln10 * score);
+        if (lis >> score)
+            data.addBackOffScore(&tokens[0], &tokens[n], -ln10 * score);
+        ++nNGrams;
+    }
+}
+
+/** Consecutive lines of one n-gram section, parsed as one task of the thread pool */
+struct ArpaLm::NGramChunk {
+    static const u32 maxLines = 1 << 16;
+
+    u32                      nGram;
+    std::vector<std::string> lines;
+    std::vector<u32>         lineNumbers;
+    NGramParser              parser;
+
+    NGramChunk(const ArpaLm& lm, bool includeZeroProb, u32 nGram)
+            : nGram(nGram), parser(lm, includeZeroProb) {}
+};
+
+namespace {
+
+template<class Chunk>
+class NGramChunkMapper {
+public:
+    NGramChunkMapper* clone() const {
+        return new NGramChunkMapper();
+    }
+    void map(Chunk* chunk) {
+        for (u32 i = 0; i < chunk->lines.size(); ++i)
+            chunk->parser.parse(chunk->lines[i], chunk->nGram, chunk->lineNumbers[i]);
+        std::vector<std::string>().swap(chunk->lines);
+        std::vector<u32>().swap(chunk->lineNumbers);
+    }
+    void reset() {}
+};
+
+}  // namespace
+
+void ArpaLm::read() {
     std::string filename(paramFilename(config));
     log("reading ARPA language model from file \"%s\" ...", filename.c_str());
 
@@ -122,12 +219,34 @@ void ArpaLm::read() {
         return;
     }
     const bool includeZeroProb = !(paramSkipInfScore(config));
+    const u32  nThreads        = paramNumThreads(config);
+
+    // with a single thread all lines go to one parser, otherwise they are parsed in chunks by the pool
+    typedef Core::ThreadPool<NGramChunk*, NGramChunkMapper<NGramChunk>> ParserPool;
+    NGramParser*             parser = (nThreads > 1) ? nullptr : new NGramParser(*this, includeZeroProb);
+    ParserPool*              pool   = nullptr;
+    std::vector<NGramChunk*> chunks;
+    NGramChunk*              chunk = nullptr;
+    if (nThreads > 1) {
+        pool = new ParserPool();
+        pool->init(nThreads);
+    }
+    auto submitChunk = [&]() {
+        if (!chunk)
+            return;
+        // bound the number of unparsed lines in memory
+        pool->waitForWaitingTasks(4 * nThreads);
+        pool->submit(chunk);
+        chunks.push_back(chunk);
+        chunk = nullptr;
+    };
 
-    InitData* data = new InitData;
+    Core::Timer timer;
+    timer.start();
 
     Core::MD5   md5;
     std::string line;
-    u32         lineNumber = 0, totalNGrams = 0, expectedTotalNGrams = 0, maxTotalNGrams = 0;
+    u32         lineNumber = 0, expectedTotalNGrams = 0, maxTotalNGrams = 0;
     enum {
         preamble,
         sizes,
@@ -135,16 +254,16 @@ void ArpaLm::read() {
         postamble,
         unknown
     } state = preamble;
-    u32                             nGram, n;
-    Token                           tokens[maxNGramLength];
-    std::unordered_set<std::string> unknownSyntacticTokenMap;
-    Core::ProgressIndicator         pi("reading ARPA lm", "n-grams");
+    u32                     nGram;
+    Core::ProgressIndicator pi("reading ARPA lm", "n-grams");
     pi.start();
     while (!std::getline(is, line).eof()) {
         ++lineNumber;
         if (line.size() == 0)
             continue;
-        else if (line[0] == '\\')
+        else if (line[0] == '\\') {
+            if (pool)
+                submitChunk();
             switch (state) {  // handle section header
                 case preamble: {
                     if (line == "\\data\\")
@@ -165,6 +284,7 @@ void ArpaLm::read() {
                 case postamble: break;
                 default: defect();
             }
+        }
         else
             switch (state) {  // handle other lines
                 case preamble: break;
@@ -183,49 +303,58 @@ void ArpaLm::read() {
                         // data->reserve(expectedTotalNGrams, expectedTotalNGrams - nNGrams / fraction);
                         // fraction *= 3;
                         expectedTotalNGrams += nNGrams;
-                        data->reserve(expectedTotalNGrams, expectedTotalNGrams - nNGrams);
+                        if (parser)
+                            parser->data.reserve(expectedTotalNGrams, expectedTotalNGrams - nNGrams);
                     }
                     pi.setTotal(expectedTotalNGrams);
                 } break;
                 case ngrams: {
                     md5.update(line);
-                    std::istringstream lis(line);
-                    f64                score;
-                    std::string        word;
-                    if (!(lis >> score))
-                        error("Expected float value in line %d", lineNumber);
-                    hope(nGram <= maxNGramLength);
-                    for (n = 0; n < nGram; ++n) {
-                        if (lis >> word) {
-                            Core::normalizeWhitespace(word);
-                            Core::suppressTrailingBlank(word);
-                            Token t = getToken(word);
-                            if (t) {
-                                tokens[n] = t;
-                            }
-                            else {
-                                if (unknownSyntacticTokenMap.find(word) == unknownSyntacticTokenMap.end()) {
-                                    unknownSyntacticTokenMap.insert(word);
-                                    warning("unknown syntactic token '%s' in line %d", word.c_str(), lineNumber);
-                                }
-                                break;
-                            }
-                        }
+                    if (parser) {
+                        parser->parse(line, nGram, lineNumber);
                     }
-                    if (n == nGram) {
-                        std::reverse(tokens, tokens + n);
-                        if (includeZeroProb || !Core::isAlmostEqual(score, InfScore, 0.1))
-                            data->addScore(&tokens[1], &tokens[n], tokens[0], -ln10 * score);
-                        if (lis >> score)
-                            data->addBackOffScore(&tokens[0], &tokens[n], -ln10 * score);
-                        ++totalNGrams;
+                    else {
+                        if (!chunk)
+                            chunk = new NGramChunk(*this, includeZeroProb, nGram);
+                        chunk->lines.push_back(line);
+                        chunk->lineNumbers.push_back(lineNumber);
+                        if (chunk->lines.size() >= NGramChunk::maxLines)
+                            submitChunk();
                     }
                     pi.notify();
                 } break;
                 default: defect();
             }
     }
+    if (pool) {
+        submitChunk();
+        pool->wait();
+        delete pool;
+    }
     pi.finish();
+    timer.stop();
+    log("reading and parsing with %d threads took %.2fs", nThreads, timer.elapsed());
+
+    // chunks are in file order, so messages and items are the same as with a single parser
+    std::vector<NGramParser*> parsers;
+    if (parser)
+        parsers.push_back(parser);
+    for (NGramChunk* c : chunks)
+        parsers.push_back(&c->parser);
+
+    std::unordered_set<std::string> unknownSyntacticTokenMap;
+    u32                             totalNGrams = 0;
+    size_t                          nItems      = 0;
+    for (const NGramParser* p : parsers) {
+        for (u32 badLine : p->badLines)
+            error("Expected float value in line %d", badLine);
+        for (const std::pair<std::string, u32>& unknownToken : p->unknownTokens) {
+            if (unknownSyntacticTokenMap.insert(unknownToken.first).second)
+                warning("unknown syntactic token '%s' in line %d", unknownToken.first.c_str(), unknownToken.second);
+        }
+        totalNGrams += p->nNGrams;
+        nItems += p->data.items.size();
+    }
     log("Unknown syntactic tokens in total: %lu", unknownSyntacticTokenMap.size());
     if (state != postamble)
         error("Premature end of language model file.");
@@ -233,8 +362,23 @@ void ArpaLm::read() {
     /*
       log("%d/%d/%d loaded/expected/all n-grams", totalNGrams, expectedTotalNGrams, maxTotalNGrams);
     */
-    initialize(&*data->items.begin(), &(*(data->items.end() - 1)) + 1);
-    delete data;
+
+    if (parser) {
+        initialize(&*parser->data.items.begin(), &(*(parser->data.items.end() - 1)) + 1);
+    }
+    else {
+        // the histories stay in the obstacks of the chunks until the tree is built
+        std::vector<InitItem> items;
+        items.reserve(nItems);
+        for (NGramChunk* c : chunks) {
+            items.insert(items.end(), c->parser.data.items.begin(), c->parser.data.items.end());
+            std::vector<InitItem>().swap(c->parser.data.items);
+        }
+        initialize(&*items.begin(), &(*(items.end() - 1)) + 1, nThreads);
+    }
+    delete parser;
+    for (NGramChunk* c : chunks)
+        delete c;
 }
 
 ArpaClassLm::ArpaClassLm(const Core::Configuration& c, Bliss::LexiconRef l)
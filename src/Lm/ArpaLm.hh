@@ -70,10 +70,13 @@ namespace Lm {
 class ArpaLm : public BackingOffLm {
 private:
     class InitData;
+    class NGramParser;
+    struct NGramChunk;
     static const Core::ParameterString paramFilename;
     static const Core::ParameterString paramEncoding;
     static const Core::ParameterBool   paramSkipInfScore;
     static const Core::ParameterBool   paramReverseLm;
+    static const Core::ParameterInt    paramNumThreads;
     static const f64                   InfScore;
     virtual void                       read();
 
@@ -18,8 +18,10 @@
 #include <Bliss/SyntacticTokenMap.hh>
 #include <Core/Directory.hh>
 #include <Core/IoUtilities.hh>
+#include <Core/Statistics.hh>
 #include <Fsa/Sort.hh>
 #include <numeric>
+#include <thread>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -78,10 +80,72 @@ struct BackingOffLm::Internal::InitItemOrdering {
     }
 };
 
+/**
+ * Total order of init items by their complete history (recent-most
+ * word first), back-off items before word scores of the same history.
+ * A range sorted this way is sorted by InitItemOrdering in every node
+ * of the tree, so buildNode() does not need to sort any more.
+ */
+struct BackingOffLm::Internal::InitItemLexicalOrdering {
+    bool operator()(const InitItem& a, const InitItem& b) const {
+        const Token *ha = a.history, *hb = b.history;
+        for (; *ha && *hb; ++ha, ++hb) {
+            if ((*ha)->id() != (*hb)->id())
+                return ((*ha)->id() < (*hb)->id());
+        }
+        if (*ha || *hb)
+            return (!*ha);
+        if (a.token && b.token)
+            return (a.token->id() < b.token->id());
+        return (!a.token && b.token);
+    }
+};
+
+namespace {
+
+/** Merge sort with the initial runs and the merges of each round distributed over threads */
+template<class Item, class Ordering>
+void parallelSort(Item* begin, Item* end, Ordering ordering, u32 nThreads) {
+    size_t nItems = end - begin;
+    if (nThreads <= 1 || nItems < 2 * size_t(nThreads)) {
+        std::sort(begin, end, ordering);
+        return;
+    }
+
+    std::vector<Item*> bounds;
+    for (u32 t = 0; t <= nThreads; ++t)
+        bounds.push_back(begin + t * nItems / nThreads);
+
+    std::vector<std::thread> threads;
+    for (u32 t = 0; t < nThreads; ++t)
+        threads.emplace_back([&bounds, &ordering, t]() { std::sort(bounds[t], bounds[t + 1], ordering); });
+    for (std::thread& thread : threads)
+        thread.join();
+
+    while (bounds.size() > 2) {
+        std::vector<Item*> merged;
+        threads.clear();
+        for (size_t r = 0; r + 1 < bounds.size(); r += 2) {
+            merged.push_back(bounds[r]);
+            if (r + 2 < bounds.size())
+                threads.emplace_back([&bounds, &ordering, r]() { std::inplace_merge(bounds[r], bounds[r + 1], bounds[r + 2], ordering); });
+        }
+        merged.push_back(bounds.back());
+        for (std::thread& thread : threads)
+            thread.join();
+        bounds.swap(merged);
+    }
+}
+
+}  // namespace
+
 BackingOffLm::Internal::Internal() {
     nodes_ = nodesTail_ = nodesEnd_ = NULL;
     wordScores_ = wordScoresTail_ = wordScoresEnd_ = NULL;
     mmap_                                          = NULL;
+    compact_                                       = NULL;
+    init_                                          = NULL;
+    initSorted_                                    = false;
 }
 
 void BackingOffLm::Internal::changeNodeCapacity(NodeIndex newCapacity) {
@@ -146,6 +210,7 @@ void BackingOffLm::Internal::reserve(
 };
 
 BackingOffLm::Internal::~Internal() {
+    delete compact_;
     if (isMapped()) {
         munmap(mmap_, mmapSize_);
     }
@@ -169,8 +234,9 @@ void BackingOffLm::Internal::makeRoot() {
     root->parent_       = 0;
 }
 
-void BackingOffLm::Internal::build(InitItem* begin, InitItem* end) {
-    init_ = new std::vector<InitItemRange>;
+void BackingOffLm::Internal::build(InitItem* begin, InitItem* end, bool sorted) {
+    init_       = new std::vector<InitItemRange>;
+    initSorted_ = sorted;
     makeRoot();
     InitItemRange init;
     init.begin = begin;
@@ -217,7 +283,8 @@ void BackingOffLm::Internal::buildNode(NodeIndex ni) {
     Node*     n = &nodes_[ni];
     InitItem *i = (*init_)[ni].begin, *end = (*init_)[ni].end;
 
-    std::sort(i, end, InitItemOrdering());
+    if (!initSorted_)
+        std::sort(i, end, InitItemOrdering());
 
     n->firstWordScore_ = nWordScores();
     for (; i < end && i->history[0] == 0; ++i) {
@@ -624,34 +691,13 @@ bool BackingOffLm::Internal::writeImage(int fd, const std::string& info) const {
     return header.write(fd);
 }
 
-/**
- * @param info on success the info string from the header is returned
- * in @c info.  On failure a failure message is stored in info
- * @return true if successful
- */
-
-bool BackingOffLm::Internal::mountImage(
-        int fd, std::string& info,
+void BackingOffLm::Internal::mountImageTokenTable(
+        const char* str, u64 nTokens,
         const Bliss::TokenInventory& inventory, bool mapOovToUnk) {
-    ImageHeader header(0);
-    if (!header.read(fd, info))
-        return false;
-    ::free(nodes_);
-    ::free(wordScores_);
-
-    mmap_ = (char*)mmap(0, mmapSize_ = header.end(), PROT_READ, MAP_SHARED, fd, 0);
-    if (mmap_ == MAP_FAILED) {
-        info = "mapping of image failed";
-        return false;
-    }
-
-    info = std::string(mmap_ + header.size());
-
     // lexicon and LM tokenId mapping: allow different lexicon for image building
     verify(lexiconMapping_->size() == inventory.size());
-    tokens_.resize(header.nTokens());
-    char* str = mmap_ + header.tokensOffset();
-    for (TokenIndex ti = 0; ti < TokenIndex(header.nTokens()); ++ti) {
+    tokens_.resize(nTokens);
+    for (TokenIndex ti = 0; ti < TokenIndex(nTokens); ++ti) {
         const Bliss::Token* token = 0;
         if (*str) {
             token = inventory[str];
@@ -676,6 +722,32 @@ bool BackingOffLm::Internal::mountImage(
                 oovTokens_.insert(tId);
             }
     }
+}
+
+/**
+ * @param info on success the info string from the header is returned
+ * in @c info.  On failure a failure message is stored in info
+ * @return true if successful
+ */
+
+bool BackingOffLm::Internal::mountImage(
+        int fd, std::string& info,
+        const Bliss::TokenInventory& inventory, bool mapOovToUnk) {
+    ImageHeader header(0);
+    if (!header.read(fd, info))
+        return false;
+    ::free(nodes_);
+    ::free(wordScores_);
+
+    mmap_ = (char*)mmap(0, mmapSize_ = header.end(), PROT_READ, MAP_SHARED, fd, 0);
+    if (mmap_ == MAP_FAILED) {
+        info = "mapping of image failed";
+        return false;
+    }
+
+    info = std::string(mmap_ + header.size());
+
+    mountImageTokenTable(mmap_ + header.tokensOffset(), header.nTokens(), inventory, mapOovToUnk);
 
     nodes_     = (Node*)(mmap_ + header.nodesOffset());
     nodesTail_ = nodesEnd_ = nodes_ + header.nNodes();
@@ -689,10 +761,245 @@ bool BackingOffLm::Internal::mountImage(
     return true;
 }
 
+// ---------------------------------------------------------------------------
+// Compact memory-mapped image
+
+/*
+  Compact image file structure
+
+    0                 ... HS-1  header
+    HS                ...       info string (zero-terminated)
+    tokensOffset      ...       token string table
+    codebooksOffset   ...       back-off weight codebooks, then word score codebooks
+    nodesOffset       ...       bit-packed node records (including sentinel)
+    wordScoresOffset  ...       bit-packed word score records
+    end
+
+  HS = sizeof(CompactImageHeader)
+
+  See CompactTrie for the layout of the records.
+*/
+
+namespace BackingOffPrivate {
+
+struct CompactImageHeader {
+    char                magicWord[8];
+    u32                 endianessMark;
+    u32                 versionMark;
+    CompactTrie::Layout layout;
+    u64                 nTokens;
+    u64                 nNodes;       // excluding sentinel
+    u64                 nWordScores;  // excluding sentinel
+    u64                 tokensOffset;
+    u64                 codebooksOffset;
+    u64                 nodesOffset;
+    u64                 wordScoresOffset;
+    u64                 end;
+
+    static const char* magic;
+    static const u32   endianess = 0x11223344;
+    static const u32   version   = 1;
+};
+
+const char* CompactImageHeader::magic = "MBCT2601";
+
+bool padTo8(int fd, off_t& position) {
+    if ((position = lseek(fd, 0, SEEK_CUR)) == (off_t)-1)
+        return false;
+    off_t pad = (8 - position % 8) % 8;
+    return (position = lseek(fd, pad, SEEK_CUR)) != (off_t)-1;
+}
+
+}  // namespace BackingOffPrivate
+
+bool BackingOffLm::Internal::isCompactImage(int fd) {
+    char magicWord[8];
+    return (pread(fd, magicWord, 8, 0) == 8) && !memcmp(magicWord, CompactImageHeader::magic, 8);
+}
+
+/**
+ * Write compact image, scores are quantized to @c quantizationBits bits
+ * with one codebook per order.
+ * @return true if successful
+ */
+bool BackingOffLm::Internal::writeCompactImage(int fd, const std::string& info, u32 quantizationBits) const {
+    require(!isCompact());
+
+    CompactTrie::Layout layout;
+    layout.maxDepth = 0;
+    for (const Node* n = nodes_; n != nodesTail_; ++n)
+        layout.maxDepth = std::max<u32>(layout.maxDepth, n->depth());
+    layout.tokenBits        = bitWidth(tokens_.size());  // node tokens are stored with an offset of one
+    layout.depthBits        = bitWidth(layout.maxDepth);
+    layout.nodeBits         = bitWidth(nNodes());
+    layout.wordScoreBits    = bitWidth(nWordScores());
+    layout.quantizationBits = quantizationBits;
+
+    // per-order codebooks
+    std::vector<std::vector<Score>> backOffValues(layout.maxDepth + 1), wordScoreValues(layout.maxDepth + 1);
+    for (const Node* n = nodes_; n != nodesTail_; ++n) {
+        backOffValues[n->depth()].push_back(n->backOffScore());
+        for (const WordScore* ws = scoresBegin(n); ws != scoresEnd(n); ++ws)
+            wordScoreValues[n->depth()].push_back(ws->score());
+    }
+    std::vector<ScoreQuantizer> backOffQuantizers, wordScoreQuantizers;
+    std::vector<Score>          codebooks;
+    for (u32 d = 0; d <= layout.maxDepth; ++d) {
+        backOffQuantizers.emplace_back(backOffValues[d], quantizationBits);
+        codebooks.insert(codebooks.end(), backOffQuantizers.back().codebook().begin(), backOffQuantizers.back().codebook().end());
+        std::vector<Score>().swap(backOffValues[d]);
+    }
+    for (u32 d = 0; d <= layout.maxDepth; ++d) {
+        wordScoreQuantizers.emplace_back(wordScoreValues[d], quantizationBits);
+        codebooks.insert(codebooks.end(), wordScoreQuantizers.back().codebook().begin(), wordScoreQuantizers.back().codebook().end());
+        std::vector<Score>().swap(wordScoreValues[d]);
+    }
+
+    // pack node records, including sentinel
+    u32              nodeBits = layout.nodeRecordBits();
+    std::vector<u64> packedNodes(PackedRecords::nWords(nNodes() + 1, nodeBits), 0);
+    for (NodeIndex ni = 0; ni < nNodes(); ++ni) {
+        const Node* n      = &nodes_[ni];
+        u32         offset = 0;
+        PackedRecords::set(packedNodes, nodeBits, ni, offset, layout.tokenBits, n->token() + 1);
+        PackedRecords::set(packedNodes, nodeBits, ni, offset += layout.tokenBits, layout.depthBits, n->depth());
+        PackedRecords::set(packedNodes, nodeBits, ni, offset += layout.depthBits, layout.nodeBits, n->parent() ? nodeIndex(n->parent()) : 0);
+        PackedRecords::set(packedNodes, nodeBits, ni, offset += layout.nodeBits, layout.nodeBits, ni + n->firstChild_);
+        PackedRecords::set(packedNodes, nodeBits, ni, offset += layout.nodeBits, layout.wordScoreBits, n->firstWordScore_);
+        PackedRecords::set(packedNodes, nodeBits, ni, offset += layout.wordScoreBits, layout.quantizationBits, backOffQuantizers[n->depth()].encode(n->backOffScore()));
+    }
+    PackedRecords::set(packedNodes, nodeBits, nNodes(), layout.tokenBits + layout.depthBits + layout.nodeBits, layout.nodeBits, nNodes());
+    PackedRecords::set(packedNodes, nodeBits, nNodes(), layout.tokenBits + layout.depthBits + 2 * layout.nodeBits, layout.wordScoreBits, nWordScores());
+
+    // pack word score records
+    u32              wordScoreBits = layout.wordScoreRecordBits();
+    std::vector<u64> packedWordScores(PackedRecords::nWords(nWordScores(), wordScoreBits), 0);
+    for (const Node* n = nodes_; n != nodesTail_; ++n) {
+        for (const WordScore* ws = scoresBegin(n); ws != scoresEnd(n); ++ws) {
+            WordScoreIndex i = ws - wordScores_;
+            PackedRecords::set(packedWordScores, wordScoreBits, i, 0, layout.tokenBits, ws->token());
+            PackedRecords::set(packedWordScores, wordScoreBits, i, layout.tokenBits, layout.quantizationBits, wordScoreQuantizers[n->depth()].encode(ws->score()));
+        }
+    }
+
+    CompactImageHeader header;
+    ::memset(&header, 0, sizeof(header));
+    ::memcpy(header.magicWord, CompactImageHeader::magic, 8);
+    header.endianessMark = CompactImageHeader::endianess;
+    header.versionMark   = CompactImageHeader::version;
+    header.layout        = layout;
+    header.nTokens       = tokens_.size();
+    header.nNodes        = nNodes();
+    header.nWordScores   = nWordScores();
+
+    // write phony header
+    ssize_t nBytes = sizeof(header);
+    if (write(fd, &header, nBytes) != nBytes)
+        return false;
+
+    // write info
+    nBytes = info.size() + 1;
+    if (write(fd, info.c_str(), nBytes) != nBytes)
+        return false;
+
+    off_t position;
+    if ((position = lseek(fd, 0, SEEK_CUR)) == (off_t)-1)
+        return false;
+    header.tokensOffset = position;
+    if (!writeImageTokenTable(fd))
+        return false;
+
+    if (!padTo8(fd, position))
+        return false;
+    header.codebooksOffset = position;
+    if (!Core::writeLargeBlock(fd, reinterpret_cast<const char*>(codebooks.data()), codebooks.size() * sizeof(Score)))
+        return false;
+
+    if (!padTo8(fd, position))
+        return false;
+    header.nodesOffset = position;
+    if (!Core::writeLargeBlock(fd, reinterpret_cast<const char*>(packedNodes.data()), packedNodes.size() * sizeof(u64)))
+        return false;
+
+    if (!padTo8(fd, position))
+        return false;
+    header.wordScoresOffset = position;
+    if (!Core::writeLargeBlock(fd, reinterpret_cast<const char*>(packedWordScores.data()), packedWordScores.size() * sizeof(u64)))
+        return false;
+
+    if ((position = lseek(fd, 0, SEEK_CUR)) == (off_t)-1)
+        return false;
+    header.end = position;
+
+    // write header
+    if (lseek(fd, 0, SEEK_SET) == (off_t)-1)
+        return false;
+    nBytes = sizeof(header);
+    return write(fd, &header, nBytes) == nBytes;
+}
+
+/**
+ * @param info on success the info string from the header is returned
+ * in @c info.  On failure a failure message is stored in info
+ * @return true if successful
+ */
+bool BackingOffLm::Internal::mountCompactImage(
+        int fd, std::string& info,
+        const Bliss::TokenInventory& inventory, bool mapOovToUnk) {
+    CompactImageHeader header;
+    ssize_t            nBytes = sizeof(header);
+    if (::read(fd, &header, nBytes) != nBytes) {
+        info = "failed to read compact image header";
+        return false;
+    }
+    if (memcmp(header.magicWord, CompactImageHeader::magic, 8)) {
+        info = "bad magic word in compact image header";
+        return false;
+    }
+    if (header.endianessMark != CompactImageHeader::endianess) {
+        info = "image has incompatible byte order";
+        return false;
+    }
+    if (header.versionMark != CompactImageHeader::version) {
+        info = Core::form("compact image has unknown version %d", header.versionMark);
+        return false;
+    }
+    if (header.end == 0) {
+        info = "image seems to be incomplete";
+        return false;
+    }
+    ::free(nodes_);
+    ::free(wordScores_);
+    nodes_ = nodesTail_ = nodesEnd_ = NULL;
+    wordScores_ = wordScoresTail_ = wordScoresEnd_ = NULL;
+
+    mmap_ = (char*)mmap(0, mmapSize_ = header.end, PROT_READ, MAP_SHARED, fd, 0);
+    if (mmap_ == MAP_FAILED) {
+        info = "mapping of image failed";
+        return false;
+    }
+
+    info = std::string(mmap_ + sizeof(header));
+
+    mountImageTokenTable(mmap_ + header.tokensOffset, header.nTokens, inventory, mapOovToUnk);
+
+    const Score* codebooks = (const Score*)(mmap_ + header.codebooksOffset);
+    compact_               = new CompactTrie(
+            header.layout, header.nNodes, header.nWordScores,
+            codebooks, codebooks + (header.layout.maxDepth + 1) * header.layout.codebookSize(),
+            (const u64*)(mmap_ + header.nodesOffset),
+            (const u64*)(mmap_ + header.wordScoresOffset));
+    verify(nNodes() == header.nNodes);
+    verify(nWordScores() == header.nWordScores);
+
+    ensure(isMapped() && isCompact());
+    return true;
+}
+
 // ===========================================================================
 // decendants interface
 
-void BackingOffLm::initialize(InitItem* begin, InitItem* end) {
+void BackingOffLm::initialize(InitItem* begin, InitItem* end, u32 nThreads) {
     internal_       = Core::ref(new Internal);
     historyManager_ = internal_.get();
 
@@ -712,7 +1019,18 @@ void BackingOffLm::initialize(InitItem* begin, InitItem* end) {
     }
     nNodes += 2;  // nNodes is just an educated guess, not a constraint
     internal_->reserve(nNodes, nWordScores);
-    internal_->build(begin, end);
+
+    Core::Timer timer;
+    if (nThreads > 1) {
+        timer.start();
+        parallelSort(begin, end, Internal::InitItemLexicalOrdering(), nThreads);
+        timer.stop();
+        log("sorting %zd items with %d threads took %.2fs", end - begin, nThreads, timer.elapsed());
+    }
+    timer.start();
+    internal_->build(begin, end, nThreads > 1);
+    timer.stop();
+    log("building back-off tree took %.2fs", timer.elapsed());
 
     logInitialization();
 }
@@ -749,6 +1067,21 @@ const Core::ParameterString BackingOffLm::paramImage(
         "image",
         "create and/or use language model binary image file");
 
+const Core::Choice BackingOffLm::choiceImageFormat(
+        "full", imageFormatFull,
+        "compact", imageFormatCompact,
+        Core::Choice::endMark());
+
+const Core::ParameterChoice BackingOffLm::paramImageFormat(
+        "image-format", &choiceImageFormat,
+        "format of newly created image files; existing images are mounted in the format they were written in",
+        imageFormatFull);
+
+const Core::ParameterInt BackingOffLm::paramImageQuantizationBits(
+        "image-quantization-bits",
+        "number of bits of the quantized scores in compact images (one codebook per order)",
+        8, 1, 16);
+
 void BackingOffLm::load() {
     std::string image = paramImage(config);
     if (!image.size()) {
@@ -762,6 +1095,8 @@ void BackingOffLm::load() {
         if (hasFatalErrors())
             return;
         log("writing image file to \"%s\" ...", image.c_str());
+        Core::Timer timer;
+        timer.start();
         int fd = open(image.c_str(),
                       O_CREAT | O_WRONLY | O_TRUNC,
                       S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
@@ -769,7 +1104,15 @@ void BackingOffLm::load() {
             error("Failed to open image file \"%s\" for writing", image.c_str());
             return;
         }
-        if (!internal_->writeImage(fd, dependency_.value())) {
+        bool success;
+        if (paramImageFormat(config) == imageFormatCompact) {
+            log("using compact image format with %d bit scores", int(paramImageQuantizationBits(config)));
+            success = internal_->writeCompactImage(fd, dependency_.value(), paramImageQuantizationBits(config));
+        }
+        else {
+            success = internal_->writeImage(fd, dependency_.value());
+        }
+        if (!success) {
             error("failed to write image file");
             close(fd);
             return;
@@ -778,6 +1121,8 @@ void BackingOffLm::load() {
             error("failed to write image file");
             return;
         }
+        timer.stop();
+        log("writing image file took %.2fs", timer.elapsed());
     }
     else {
         internal_ = Core::ref(new Internal);
@@ -793,7 +1138,13 @@ void BackingOffLm::load() {
         return;
     }
     std::string info;
-    if (!internal_->mountImage(fd, info, tokenInventory(), mapOovToUnk_)) {
+    if (Internal::isCompactImage(fd)) {
+        if (!internal_->mountCompactImage(fd, info, tokenInventory(), mapOovToUnk_)) {
+            error("failed to mount compact image file: ") << info;
+            return;
+        }
+    }
+    else if (!internal_->mountImage(fd, info, tokenInventory(), mapOovToUnk_)) {
         error("failed to mount image file: ") << info;
         return;
     }
@@ -801,7 +1152,25 @@ void BackingOffLm::load() {
     initialize(internal_);
 }
 
+namespace {
+
+/*
+ * Histories of compact images are identified by node index.
+ * The index is shifted by one so that no history has a null handle.
+ */
+inline HistoryHandle compactHandle(NodeIndex n) {
+    return reinterpret_cast<HistoryHandle>(uintptr_t(n) + 1);
+}
+
+inline NodeIndex compactNode(const History& h) {
+    return reinterpret_cast<uintptr_t>(h.handle()) - 1;
+}
+
+}  // namespace
+
 Score BackingOffLm::sentenceBeginScore() const {
+    if (internal_->isCompact())
+        return score(history(compactHandle(0)), sentenceBeginToken());
     return score(history(internal_->root()), sentenceBeginToken());
 }
 
@@ -814,7 +1183,14 @@ const BackingOffLm::Node* BackingOffLm::Internal::startHistory(TokenIndex w) con
     return n;
 }
 
+NodeIndex BackingOffLm::Internal::compactStartHistory(TokenIndex w) const {
+    w = lexiconMapping_->at(w);
+    return compact_->findChild(0, w);  // root if not found
+}
+
 History BackingOffLm::startHistory() const {
+    if (internal_->isCompact())
+        return history(compactHandle(internal_->compactStartHistory(sentenceBeginToken()->id())));
     return history(internal_->startHistory(sentenceBeginToken()->id()));
 }
 
@@ -837,11 +1213,39 @@ const BackingOffLm::Node* BackingOffLm::Internal::extendedHistory(const Node* ol
     return result;
 }
 
+NodeIndex BackingOffLm::Internal::compactExtendedHistory(NodeIndex old, TokenIndex w) const {
+    w = lexiconMapping_->at(w);
+
+    Node::Depth depth = compact_->depth(old);
+    TokenIndex  hist[depth + 1];
+    for (NodeIndex n = old; n; n = compact_->parent(n))
+        hist[compact_->depth(n)] = compact_->token(n);
+    hist[0] = w;
+
+    NodeIndex result = 0;
+    for (Node::Depth d = 0; d <= depth; ++d) {
+        NodeIndex n = compact_->findChild(result, hist[d]);
+        if (!n)
+            break;
+        result = n;
+    }
+    return result;
+}
+
 History BackingOffLm::extendedHistory(const History& h, Token w) const {
+    if (internal_->isCompact())
+        return history(compactHandle(internal_->compactExtendedHistory(compactNode(h), w->id())));
     return history(internal_->extendedHistory(descriptor<Self>(h), w->id()));
 }
 
 History BackingOffLm::reducedHistory(const History& h, u32 limit) const {
+    if (internal_->isCompact()) {
+        const CompactTrie& trie = internal_->compact();
+        NodeIndex          n    = compactNode(h);
+        while (trie.depth(n) > limit)
+            n = trie.parent(n);
+        return history(compactHandle(n));
+    }
     const Node* n = descriptor<Self>(h);
     while (n->depth() > limit)
         n = n->parent();
@@ -849,6 +1253,15 @@ History BackingOffLm::reducedHistory(const History& h, u32 limit) const {
 }
 
 History BackingOffLm::reduceHistoryByN(const History& h, u32 n) const {
+    if (internal_->isCompact()) {
+        const CompactTrie& trie = internal_->compact();
+        NodeIndex          node = compactNode(h);
+        while (n > 0 && node != 0) {
+            node = trie.parent(node);
+            n -= 1;
+        }
+        return history(compactHandle(node));
+    }
     const Node* node = descriptor<Self>(h);
     while (n > 0 && node->depth() > 0) {
         node = node->parent();
@@ -870,7 +1283,22 @@ std::string BackingOffLm::Internal::formatHistory(const Node* h) {
     return result;
 }
 
+std::string BackingOffLm::Internal::formatCompactHistory(NodeIndex h) const {
+    std::string result;
+    for (NodeIndex n = h; n; n = compact_->parent(n)) {
+        Token tok = token(compact_->token(n));
+        if (tok) {
+            if (n != h)
+                result += utf8::blank;
+            result += std::string(tok->symbol());
+        }
+    }
+    return result;
+}
+
 std::string BackingOffLm::formatHistory(const History& h) const {
+    if (internal_->isCompact())
+        return internal_->formatCompactHistory(compactNode(h));
     return internal_->formatHistory(descriptor<Self>(h));
 }
 
@@ -887,7 +1315,26 @@ Lm::Score BackingOffLm::Internal::score(const Node* h, TokenIndex w) const {
     return backOffScore;
 }
 
+Lm::Score BackingOffLm::Internal::compactScore(NodeIndex h, TokenIndex w) const {
+    w = lexiconMapping_->at(w);
+
+    Score     backOffScore = 0.0;
+    NodeIndex n            = h;
+    while (true) {
+        WordScoreIndex ws = compact_->findWordScore(n, w);
+        if (ws != CompactTrie::invalidWordScore)
+            return backOffScore + compact_->wordScore(ws, compact_->depth(n));
+        backOffScore += compact_->backOffScore(n);
+        if (!n)
+            break;
+        n = compact_->parent(n);
+    }
+    return backOffScore;
+}
+
 Lm::Score BackingOffLm::score(const History& h, Token w) const {
+    if (internal_->isCompact())
+        return internal_->compactScore(compactNode(h), w->id());
     return internal_->score(descriptor<Self>(h), w->id());
 }
 
@@ -895,6 +1342,10 @@ void BackingOffLm::getBatch(
         const History&              history,
         const CompiledBatchRequest* cbr,
         std::vector<f32>&           result) const {
+    if (internal_->isCompact()) {
+        getCompactBatch(history, cbr, result);
+        return;
+    }
     const Node* hn = descriptor<Self>(history);
     const Node* nodes[hn->depth() + 1];
     Score       backOffScore[hn->depth() + 2];
@@ -950,6 +1401,68 @@ void BackingOffLm::getBatch(
     }
 }
 
+void BackingOffLm::getCompactBatch(
+        const History&              history,
+        const CompiledBatchRequest* cbr,
+        std::vector<f32>&           result) const {
+    const CompactTrie& trie  = internal_->compact();
+    NodeIndex          hn    = compactNode(history);
+    Node::Depth        depth = trie.depth(hn);
+    NodeIndex          nodes[depth + 1];
+    Score              backOffScore[depth + 2];
+    backOffScore[depth + 1] = 0.0;
+    for (NodeIndex n = hn;; n = trie.parent(n)) {
+        Node::Depth d   = trie.depth(n);
+        nodes[d]        = n;
+        backOffScore[d] = trie.backOffScore(n) + backOffScore[d + 1];
+        if (!n)
+            break;
+    }
+
+    Bliss::SyntacticTokenMap<Score> scores(lexicon());
+    scores.fill(backOffScore[0]);
+    for (Node::Depth d = 0; d <= depth; ++d) {
+        NodeIndex n = nodes[d];
+        for (WordScoreIndex ws = trie.scoresBegin(n); ws != trie.scoresEnd(n); ++ws) {
+            Token tok = internal_->token(trie.wordToken(ws));
+            if (!tok) {
+                continue;
+            }
+            const Bliss::SyntacticToken* syntacticToken = static_cast<const Bliss::SyntacticToken*>(tok);
+            scores[syntacticToken]                      = trie.wordScore(ws, d) + backOffScore[d + 1];
+        }
+    }
+
+    for (TokenSet::const_iterator iter = internal_->oovTokens_.begin(); iter != internal_->oovTokens_.end(); ++iter) {
+        scores[*iter] = scores[internal_->unkTokenId_];
+    }
+
+    const NonCompiledBatchRequest* ncbr = required_cast(const NonCompiledBatchRequest*, cbr);
+    const BatchRequest&            request(ncbr->request);
+    for (BatchRequest::const_iterator r = request.begin(); r != request.end(); ++r) {
+        Score score = 0.0;
+        if (r->tokens.length() >= 1) {
+            score += scores[r->tokens[0]];
+            if (r->tokens.length() > 1) {
+                NodeIndex h = internal_->compactExtendedHistory(hn, r->tokens[0]->id());
+                for (u32 ti = 1;; ++ti) {
+                    const Bliss::SyntacticToken* st = r->tokens[ti];
+                    score += internal_->compactScore(h, st->id());
+                    if (ti + 1 >= r->tokens.length())
+                        break;
+                    h = internal_->compactExtendedHistory(h, st->id());
+                }
+            }
+        }
+
+        score *= ncbr->scale();
+        score += r->offset;
+
+        if (result[r->target] > score)
+            result[r->target] = score;
+    }
+}
+
 bool BackingOffLm::fixedHistory(s32 limit) const {
     return limit == 0;
 }
@@ -965,6 +1478,8 @@ bool BackingOffLm::isSparse(const History& h) const {
 }
 
 HistorySuccessors BackingOffLm::getHistorySuccessors(const History& h) const {
+    if (internal_->isCompact())
+        return getCompactHistorySuccessors(h);
     BackOffScores     backoff = getBackOffScores(h, 0);
     size_t            size    = ((size_t)backoff.end - (size_t)backoff.start) / sizeof(WordScore);
     HistorySuccessors res;
@@ -997,12 +1512,63 @@ HistorySuccessors BackingOffLm::getHistorySuccessors(const History& h) const {
     return res;
 }
 
+HistorySuccessors BackingOffLm::getCompactHistorySuccessors(const History& h) const {
+    const CompactTrie& trie = internal_->compact();
+    NodeIndex          n    = compactNode(h);
+    WordScoreIndex     end  = trie.scoresEnd(n);
+    HistorySuccessors  res;
+    res.backOffScore = trie.backOffScore(n);
+    if (trie.scoresBegin(n) == end) {
+        return res;
+    }
+
+    bool  oov2unk  = mapOovToUnk_ && !internal_->oovTokens_.empty();
+    Score unkScore = Core::Type<Score>::max;
+
+    Node::Depth depth = trie.depth(n);
+    res.reserve(end - trie.scoresBegin(n) + (oov2unk ? internal_->oovTokens_.size() : 0));
+    for (WordScoreIndex ws = trie.scoresBegin(n); ws != end; ++ws) {
+        Bliss::Token::Id tok   = reverseMapToken(trie.wordToken(ws));
+        Score            score = trie.wordScore(ws, depth);
+        res.emplace_back(tok, score);
+        if (oov2unk && tok == internal_->unkTokenId_) {
+            unkScore = score;
+        }
+    }
+
+    if (oov2unk && unkScore != Core::Type<Score>::max) {
+        for (TokenSet::const_iterator iter = internal_->oovTokens_.begin(); iter != internal_->oovTokens_.end(); ++iter) {
+            res.emplace_back(*iter, unkScore);
+        }
+    }
+
+    return res;
+}
+
+bool BackingOffLm::isThreadSafe() const {
+    // the tree is read-only after initialization and histories are statically allocated nodes
+    return true;
+}
+
 Score BackingOffLm::getBackOffScore(const History& h) const {
+    if (internal_->isCompact())
+        return internal_->compact().backOffScore(compactNode(h));
     return getBackOffScores(h, 0).backOffScore;
 }
 
 void BackingOffLm::historyTokens(const History& h, const Bliss::Token** target, u32& size, u32 arraySize) const {
     size = 0;
+    if (internal_->isCompact()) {
+        const CompactTrie& trie = internal_->compact();
+        for (NodeIndex n = compactNode(h); n && size < arraySize; n = trie.parent(n)) {
+            Token tok = internal_->token(trie.token(n));
+            if (tok) {
+                target[size] = tok;
+                ++size;
+            }
+        }
+        return;
+    }
     for (const Node* n = descriptor<Self>(h); n; (n = n->parent()) && size < arraySize) {
         Token tok = internal_->token(n->token());
         if (tok) {
@@ -1013,6 +1579,8 @@ void BackingOffLm::historyTokens(const History& h, const Bliss::Token** target,
 }
 
 u32 BackingOffLm::historyLength(const Lm::History& h) const {
+    if (internal_->isCompact())
+        return internal_->compact().depth(compactNode(h));
     const Node* n = descriptor<Self>(h);
     if (!n) {
         return 0;
@@ -1021,6 +1589,8 @@ u32 BackingOffLm::historyLength(const Lm::History& h) const {
 }
 
 BackingOffLm::BackOffScores BackingOffLm::getBackOffScores(const Lm::History& history, int depth) const {
+    if (internal_->isCompact())
+        criticalError("direct access to the stored scores is not supported for compact images");
     const Node* hn = descriptor<Self>(history);
     const Node* nodes[hn->depth() + 1];
     for (const Node* n = hn; n; n = n->parent()) {
@@ -1044,6 +1614,17 @@ BackingOffLm::BackOffScores BackingOffLm::getBackOffScores(const Lm::History& hi
 }
 
 Score BackingOffLm::getAccumulatedBackOffScore(const History& history, int limit) const {
+    if (internal_->isCompact()) {
+        const CompactTrie& trie = internal_->compact();
+        Score              ret  = 0;
+        for (NodeIndex n = compactNode(history);; n = trie.parent(n)) {
+            if (trie.depth(n) >= limit)
+                ret += trie.backOffScore(n);
+            if (!n)
+                break;
+        }
+        return ret;
+    }
     const Node* hn  = descriptor<Self>(history);
     Score       ret = 0;
     for (const Node* n = hn; n; n = n->parent())
@@ -1149,6 +1730,64 @@ public:
     }
 };
 
+class BackingOffLm::CompactAutomaton : public LanguageModelAutomaton {
+private:
+    Core::Ref<Internal> internal_;
+    NodeIndex           initial_;
+    TokenIndex          sentenceEndToken_;
+
+public:
+    CompactAutomaton(Core::Ref<const BackingOffLm> lm)
+            : LanguageModelAutomaton(static_cast<Core::Ref<const LanguageModel>>(lm)),
+              internal_(lm->internal_) {
+        addProperties(Fsa::PropertySortedByInput);
+        setProperties(Fsa::PropertyLinear, Fsa::PropertyNone);
+        setProperties(Fsa::PropertyAcyclic, Fsa::PropertyNone);
+        initial_          = internal_->compactStartHistory(lm->sentenceBeginToken()->id());
+        sentenceEndToken_ = lm->sentenceEndToken()->id();
+    }
+    virtual ~CompactAutomaton() {}
+
+    virtual Fsa::StateId initialStateId() const {
+        return initial_;
+    }
+
+    virtual Fsa::ConstStateRef getState(Fsa::StateId s) const {
+        const CompactTrie& trie  = internal_->compact();
+        Fsa::State*        state = new Fsa::State(s);
+
+        // back-off
+        Score backOffScore = trie.backOffScore(s);
+        if (backOffScore < Core::Type<Score>::max) {
+            hope(s != 0);  // zero-gram backing-off not supported
+            state->newArc(trie.parent(s), Fsa::Weight(backOffScore), backOffLabel_);
+        }
+
+        Node::Depth depth = trie.depth(s);
+        for (WordScoreIndex ws = trie.scoresBegin(s); ws != trie.scoresEnd(s); ++ws) {
+            Score      score = trie.wordScore(ws, depth);
+            TokenIndex token = trie.wordToken(ws);
+            if (score >= Core::Type<Score>::max)
+                continue;
+            if (token == sentenceEndToken_) {
+                state->setFinal(Fsa::Weight(score));
+            }
+            else {
+                state->newArc(
+                        internal_->compactExtendedHistory(s, token),
+                        Fsa::Weight(score),
+                        internal_->token(token)->id());
+            }
+        }
+
+        state->sort(Fsa::byInput());
+
+        return Fsa::ConstStateRef(state);
+    }
+};
+
 Fsa::ConstAutomatonRef BackingOffLm::getFsa() const {
+    if (internal_->isCompact())
+        return Fsa::ConstAutomatonRef(new CompactAutomaton(Core::ref(this)));
     return Fsa::ConstAutomatonRef(new Automaton(Core::ref(this)));
 }
@@ -40,10 +40,18 @@ public:
     typedef std::unordered_set<Bliss::Token::Id> TokenSet;
 
 protected:
+    enum ImageFormat {
+        imageFormatFull,
+        imageFormatCompact
+    };
     static const Core::ParameterString paramImage;
+    static const Core::Choice          choiceImageFormat;
+    static const Core::ParameterChoice paramImageFormat;
+    static const Core::ParameterInt    paramImageQuantizationBits;
     friend class Internal;
     Core::Ref<Internal> internal_;
     class Automaton;
+    class CompactAutomaton;
     void logInitialization() const;
 
     BackingOffLm(const Core::Configuration&, Bliss::LexiconRef);
@@ -72,8 +80,10 @@ protected:
      * Should be called from read().  The input data may be
      * modified during the call, and is no longer needed
      * afterwards.
+     * With @c nThreads > 1 the items are sorted up front by a
+     * parallel merge sort, so that building the tree is linear.
      */
-    void initialize(InitItem* begin, InitItem* end);
+    void initialize(InitItem* begin, InitItem* end, u32 nThreads = 1);
 
     /**
      * Alternative initialization method.
@@ -108,6 +118,7 @@ public:
     virtual bool                   isSparse(const History& h) const;
     virtual HistorySuccessors      getHistorySuccessors(const History& h) const;
     virtual Score                  getBackOffScore(const History& h) const;
+    virtual bool                   isThreadSafe() const;
 
     /**
      * Writes all tokens stored in the given history into the given vector
@@ -131,6 +142,7 @@ public:
 
     /**
      * Directly returns the scores stored in the LM for the given context history.
+     * Not available for compact images, since they don't store WordScore arrays.
      */
     BackOffScores getBackOffScores(const History& history, int depth = 0) const;
     /**
@@ -147,6 +159,9 @@ protected:
 
     void             initTokenMapping(bool build = false);
     Bliss::Token::Id reverseMapToken(Bliss::Token::Id tIdx) const;
+
+    void              getCompactBatch(const History&, const CompiledBatchRequest*, std::vector<f32>& result) const;
+    HistorySuccessors getCompactHistorySuccessors(const History& h) const;
 };
 
 }  // namespace Lm
@@ -18,6 +18,7 @@
 #define _LM_BACKINGOFF_INTERNAL_HH
 
 #include "BackingOff.hh"
+#include "CompactBackingOffTrie.hh"
 #include "HistoryManager.hh"
 
 /** Internal data structures of BackingOffLm */
@@ -122,10 +123,12 @@ protected:
     WordScore* newWordScore();
 
     struct InitItemOrdering;
+    struct InitItemLexicalOrdering;
     struct InitItemRange {
         InitItem *begin, *end;
     };
     std::vector<InitItemRange>* init_;
+    bool                        initSorted_;
     void                        buildNode(NodeIndex);
     void                        makeRoot();
     void                        finalize();
@@ -133,6 +136,9 @@ protected:
     char*  mmap_;
     size_t mmapSize_;
     bool   writeImageTokenTable(int fd) const;
+    void   mountImageTokenTable(const char* str, u64 nTokens, const Bliss::TokenInventory&, bool mapOovToUnk);
+
+    BackingOffPrivate::CompactTrie* compact_;
 
     // token mapping & processing
     std::vector<TokenIndex>*    lexiconMapping_;
@@ -145,18 +151,28 @@ public:
     ~Internal();
     void mapToken(TokenIndex, Token);
     void reserve(NodeIndex nNodes, WordScoreIndex nWordScores);
-    void build(InitItem*, InitItem*);
+    void build(InitItem*, InitItem*, bool sorted = false);
     bool writeImage(int fd, const std::string& info) const;
     bool mountImage(int fd, std::string& info, const Bliss::TokenInventory&, bool mapOovToUnk);
-    bool isMapped() const {
+    bool writeCompactImage(int fd, const std::string& info, u32 quantizationBits) const;
+    bool mountCompactImage(int fd, std::string& info, const Bliss::TokenInventory&, bool mapOovToUnk);
+    static bool isCompactImage(int fd);
+    bool        isMapped() const {
         return (mmap_ != NULL);
     }
+    bool isCompact() const {
+        return (compact_ != NULL);
+    }
+    const BackingOffPrivate::CompactTrie& compact() const {
+        require_(isCompact());
+        return *compact_;
+    }
 
     u32 nNodes() const {
-        return nodesTail_ - nodes_;
+        return isCompact() ? compact_->nNodes() : nodesTail_ - nodes_;
     }
     u32 nWordScores() const {
-        return wordScoresTail_ - wordScores_;
+        return isCompact() ? compact_->nWordScores() : wordScoresTail_ - wordScores_;
     }
     void draw(std::ostream&, const std::string& title) const;
 
@@ -175,6 +191,12 @@ public:
     }
     Score score(const Node*, TokenIndex) const;
 
+    // Same as above for the compact image, where histories are identified by node index
+    NodeIndex   compactStartHistory(TokenIndex w) const;
+    NodeIndex   compactExtendedHistory(NodeIndex old, TokenIndex w) const;
+    std::string formatCompactHistory(NodeIndex h) const;
+    Score       compactScore(NodeIndex h, TokenIndex w) const;
+
     Token token(TokenIndex ti) const {
         require_(-1 <= ti && ti < TokenIndex(tokens_.size()));
         return (ti >= 0) ? tokens_[ti] : 0;
@@ -14,11 +14,17 @@
  */
 #include "CombineLm.hh"
 
+#include <atomic>
+#include <unordered_map>
+
 #include <Core/MurmurHash.hh>
 #include <Math/Utilities.hh>
 #include "Module.hh"
 
 namespace {
+// ids are never reused, so that stale thread-local batch cache entries of destroyed instances can not be hit
+std::atomic<u64> nextInstanceId(0ul);
+
 class CombineHistoryManager : public Lm::HistoryManager {
 public:
     CombineHistoryManager(size_t numLms)
@@ -98,7 +104,7 @@ CombineLanguageModel::CombineLanguageModel(Core::Configuration const& c, Bliss::
           linear_combination_(paramLinearCombination(c)),
           lookahead_lm_(paramLookaheadLM(config)),
           recombination_lm_(paramRecombinationLM(config)),
-          staticRequestSize_(0) {
+          instanceId_(nextInstanceId++) {
     size_t num_lms = paramNumLms(c);
     for (size_t i = 0ul; i < num_lms; i++) {
         Core::Configuration sub_config = select(std::string("lm-") + std::to_string(i + 1));
@@ -225,7 +231,8 @@ Score CombineLanguageModel::sentenceEndScore(const History& history) const {
 }
 
 void CombineLanguageModel::getBatch(const History& h, const CompiledBatchRequest* cbr, std::vector<f32>& result) const {
-    if (cacheHist_.empty() || cacheScores_.empty() || !matchCacheHistory(h)) {
+    BatchCache& cache = batchCache();
+    if (cache.hist.empty() || cache.scores.empty() || !matchCacheHistory(cache, h)) {
         Precursor::getBatch(h, cbr, result);
         return;
     }
@@ -242,7 +249,7 @@ void CombineLanguageModel::getBatch(const History& h, const CompiledBatchRequest
         backoff = std::numeric_limits<Score>::infinity();
     }
     for (u32 i = 0; i < lms_.size(); ++i) {
-        if (cacheHist_[i].isValid()) {
+        if (cache.hist[i].isValid()) {
             continue;
         }
         HistorySuccessors subSuccessors = unscaled_lms_[i]->getHistorySuccessors(hist[i]);
@@ -258,17 +265,17 @@ void CombineLanguageModel::getBatch(const History& h, const CompiledBatchRequest
     }
 
     // non-existing tokens' scores based on cached scores and backoff
-    verify(result.size() == cacheScores_.size());
+    verify(result.size() == cache.scores.size());
     if (linear_combination_) {
-        result = cacheScores_;  // assume 0-prob. here
+        result = cache.scores;  // assume 0-prob. here
     }
     else {
-        std::transform(cacheScores_.begin(), cacheScores_.end(), result.begin(), std::bind(std::plus<f32>(), std::placeholders::_1, backoff * ncbr->scale()));
+        std::transform(cache.scores.begin(), cache.scores.end(), result.begin(), std::bind(std::plus<f32>(), std::placeholders::_1, backoff * ncbr->scale()));
     }
 
     // full combined score for these existing tokens (Note: further simplified to first token only)
     for (std::unordered_set<u32>::const_iterator tokId = tokens.begin(); tokId != tokens.end(); ++tokId) {
-        std::vector<u32>& rqsts    = token2Requests_.at(*tokId);
+        std::vector<u32>& rqsts    = cache.token2Requests.at(*tokId);
         Score             tokScore = score(h, request[rqsts.front()].tokens[0]) * ncbr->scale();
         for (std::vector<u32>::const_iterator reqId = rqsts.begin(); reqId != rqsts.end(); ++reqId) {
             const Request& r   = request[*reqId];
@@ -367,6 +374,28 @@ void CombineLanguageModel::setSegment(Bliss::SpeechSegment const* s) {
     }
 }
 
+bool CombineLanguageModel::isThreadSafe() const {
+    for (size_t i = 0ul; i < lms_.size(); i++) {
+        if (not lms_[i]->isThreadSafe()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CombineLanguageModel::BatchCache& CombineLanguageModel::batchCache() const {
+    thread_local std::unordered_map<u64, BatchCache*> threadCaches;
+
+    auto iter = threadCaches.find(instanceId_);
+    if (iter != threadCaches.end()) {
+        return *iter->second;
+    }
+    std::lock_guard<std::mutex> lock(batchCachesMutex_);
+    batchCaches_.emplace_back(new BatchCache());
+    threadCaches[instanceId_] = batchCaches_.back().get();
+    return *batchCaches_.back();
+}
+
 void CombineLanguageModel::startFrame(Search::TimeframeIndex time) const {
     for (auto lm : ssa_lms_) {
         if (lm) {
@@ -500,36 +529,37 @@ Score CombineLanguageModel::score_(const History& history, Token w, const std::v
 
 template<bool linear>
 void CombineLanguageModel::cacheBatch_(const History& h, const CompiledBatchRequest* cbr, u32 size) const {
-    cacheHist_.clear();
-    cacheScores_.clear();
-    verify(matchCacheHistory(h));
+    BatchCache& cache = batchCache();
+    cache.hist.clear();
+    cache.scores.clear();
+    verify(matchCacheHistory(cache, h));
     // partial non-sparse LMs to be cached
     std::vector<u32> cacheLmIds;
     for (u32 i = 0; i < lms_.size(); ++i) {
-        if (cacheHist_[i].isValid()) {
+        if (cache.hist[i].isValid()) {
             cacheLmIds.push_back(i);
         }
     }
     if (cacheLmIds.empty() || cacheLmIds.size() == lms_.size()) {
-        cacheHist_.clear();
+        cache.hist.clear();
         return;
     }
 
     // cached LMs combined scoring + token to request mapping
     const NonCompiledBatchRequest* ncbr    = required_cast(const NonCompiledBatchRequest*, cbr);
     const BatchRequest&            request = ncbr->request;
-    cacheScores_.resize(size, Core::Type<Score>::max);
+    cache.scores.resize(size, Core::Type<Score>::max);
 
     u32 startIdx = 0;
-    if (token2Requests_.empty() && staticToken2Requests_.empty()) {
-        staticRequestSize_ = request.size();
+    if (cache.token2Requests.empty() && staticToken2Requests_.empty()) {
+        cache.staticRequestSize = request.size();
     }
     else if (!staticToken2Requests_.empty()) {
-        verify(staticRequestSize_ > 0 && request.size() >= staticRequestSize_);
-        token2Requests_ = staticToken2Requests_;
-        startIdx        = staticRequestSize_;
+        verify(cache.staticRequestSize > 0 && request.size() >= cache.staticRequestSize);
+        cache.token2Requests = staticToken2Requests_;
+        startIdx             = cache.staticRequestSize;
     }
-    token2Requests_.resize(lexicon()->nSyntacticTokens());
+    cache.token2Requests.resize(lexicon()->nSyntacticTokens());
 
     for (u32 idx = 0; idx < request.size(); ++idx) {
         const Request& r   = request[idx];
@@ -537,7 +567,7 @@ void CombineLanguageModel::cacheBatch_(const History& h, const CompiledBatchRequ
         if (r.tokens.length() >= 1) {
             // first token only: mostly should be just single mapping
             if (idx >= startIdx) {
-                token2Requests_.at(r.tokens[0]->id()).push_back(idx);
+                cache.token2Requests.at(r.tokens[0]->id()).push_back(idx);
             }
             sco += score_<linear>(h, r.tokens[0], cacheLmIds);
             if (r.tokens.length() > 1) {
@@ -554,27 +584,27 @@ void CombineLanguageModel::cacheBatch_(const History& h, const CompiledBatchRequ
         }
         sco *= ncbr->scale();
         sco += r.offset;
-        if (cacheScores_[r.target] > sco) {
-            cacheScores_[r.target] = sco;
+        if (cache.scores[r.target] > sco) {
+            cache.scores[r.target] = sco;
         }
     }
 }
 
-bool CombineLanguageModel::matchCacheHistory(const History& h) const {
+bool CombineLanguageModel::matchCacheHistory(BatchCache& cache, const History& h) const {
     const History* hist = reinterpret_cast<const History*>(h.handle());
-    if (cacheHist_.empty()) {
+    if (cache.hist.empty()) {
         for (u32 i = 0; i < lms_.size(); ++i) {
             if (unscaled_lms_[i]->isSparse(hist[i])) {
-                cacheHist_.emplace_back();
+                cache.hist.emplace_back();
             }
             else {
-                cacheHist_.emplace_back(hist[i]);
+                cache.hist.emplace_back(hist[i]);
             }
         }
     }
     else {
         for (u32 i = 0; i < lms_.size(); ++i) {
-            if (!unscaled_lms_[i]->isSparse(hist[i]) && !(hist[i] == cacheHist_[i])) {
+            if (!unscaled_lms_[i]->isSparse(hist[i]) && !(hist[i] == cache.hist[i])) {
                 return false;
             }
         }
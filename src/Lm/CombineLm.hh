@@ -16,6 +16,7 @@
 #define _LM_COMBINE_LM_HH
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "HistoryManager.hh"
@@ -61,6 +62,7 @@ public:
     virtual Core::Ref<const LanguageModel> recombinationLanguageModel() const;
 
     virtual void setSegment(Bliss::SpeechSegment const* s);
+    virtual bool isThreadSafe() const;
 
     virtual void startFrame(Search::TimeframeIndex time) const;
     virtual void setInfo(History const& hist, SearchSpaceInformation const& info) const;
@@ -78,9 +80,25 @@ protected:
     template<bool linear>
     void cacheBatch_(const History& h, const CompiledBatchRequest* cbr, u32 size) const;
 
-    bool matchCacheHistory(const History& h) const;
-
 private:
+    // cached scores for partial sparse lookahead (so far only single history cache: unigram)
+    struct BatchCache {
+        std::vector<History> hist;
+        std::vector<Score>   scores;
+        // lexicon tokenId to requests mapping
+        std::vector<std::vector<u32>> token2Requests;
+
+        u32 staticRequestSize = 0u;
+    };
+
+    /**
+     * Batch cache of the calling thread, so that a shared instance can be used by several decoders.
+     * The caches are owned by this instance, threads only keep a pointer to theirs.
+     */
+    BatchCache& batchCache() const;
+
+    bool matchCacheHistory(BatchCache& cache, const History& h) const;
+
     std::vector<Core::Ref<ScaledLanguageModel>>       lms_;
     std::vector<Core::Ref<const LanguageModel>>       unscaled_lms_;
     std::vector<SearchSpaceAwareLanguageModel const*> ssa_lms_;
@@ -92,13 +110,9 @@ private:
 
     std::vector<u32> lmIds_;
 
-    // cached scores for partial sparse lookahead (so far only single history cache: unigram)
-    mutable std::vector<History> cacheHist_;
-    mutable std::vector<Score>   cacheScores_;
-    // lexicon tokenId to requests mapping
-    mutable std::vector<std::vector<u32>> token2Requests_;
-
-    mutable u32 staticRequestSize_;
+    const u64                                        instanceId_;
+    mutable std::mutex                               batchCachesMutex_;
+    mutable std::vector<std::unique_ptr<BatchCache>> batchCaches_;
 
     std::vector<History>          staticCacheHist_;
     std::vector<Score>            staticCacheScores_;
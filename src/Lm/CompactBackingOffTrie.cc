@@ -0,0 +1,149 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "CompactBackingOffTrie.hh"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace BackingOffPrivate;
+
+void PackedRecords::set(std::vector<u64>& data, u32 recordBits, u64 record, u32 offset, u32 width, u64 value) {
+    require_(width == 64 || value < (u64(1) << width));
+    u64 bit   = record * recordBits + offset;
+    u64 word  = bit >> 6;
+    u32 shift = bit & 63;
+    data[word] |= value << shift;
+    if (shift + width > 64) {
+        data[word + 1] |= value >> (64 - shift);
+    }
+}
+
+u32 BackingOffPrivate::bitWidth(u64 maxValue) {
+    u32 width = 1;
+    while (width < 64 && (maxValue >> width)) {
+        ++width;
+    }
+    return width;
+}
+
+ScoreQuantizer::ScoreQuantizer(std::vector<Lm::Score>& values, u32 bits) {
+    require(bits > 0 && bits <= 16);
+    size_t nCodes = size_t(1) << bits;
+
+    std::sort(values.begin(), values.end());
+    bool hasInfinity = false;
+    while (!values.empty() && values.back() == Core::Type<Lm::Score>::max) {
+        values.pop_back();
+        hasInfinity = true;
+    }
+    if (hasInfinity) {
+        --nCodes;
+    }
+
+    std::vector<Lm::Score> distinct;
+    std::unique_copy(values.begin(), values.end(), std::back_inserter(distinct));
+    if (distinct.size() <= nCodes) {
+        codebook_.swap(distinct);
+    }
+    else {
+        // equal-frequency bins, each represented by its mean
+        for (size_t b = 0; b < nCodes; ++b) {
+            size_t begin = b * values.size() / nCodes, end = (b + 1) * values.size() / nCodes;
+            f64    sum   = 0.0;
+            for (size_t i = begin; i < end; ++i) {
+                sum += values[i];
+            }
+            codebook_.push_back(sum / (end - begin));
+        }
+    }
+    if (hasInfinity || codebook_.empty()) {
+        codebook_.push_back(Core::Type<Lm::Score>::max);
+    }
+    codebook_.resize(size_t(1) << bits, codebook_.back());
+}
+
+u32 ScoreQuantizer::encode(Lm::Score value) const {
+    std::vector<Lm::Score>::const_iterator i = std::lower_bound(codebook_.begin(), codebook_.end(), value);
+    if (i == codebook_.end()) {
+        --i;
+    }
+    else if (i != codebook_.begin() && (value - *(i - 1)) < (*i - value)) {
+        --i;
+    }
+    return i - codebook_.begin();
+}
+
+CompactTrie::CompactTrie(const Layout&    layout,
+                         NodeIndex        nNodes,
+                         WordScoreIndex   nWordScores,
+                         const Lm::Score* backOffCodebooks,
+                         const Lm::Score* wordScoreCodebooks,
+                         const u64*       nodes,
+                         const u64*       wordScores)
+        : layout_(layout),
+          nNodes_(nNodes),
+          nWordScores_(nWordScores),
+          codebookSize_(layout.codebookSize()),
+          backOffCodebooks_(backOffCodebooks),
+          wordScoreCodebooks_(wordScoreCodebooks),
+          nodes_(nodes, layout.nodeRecordBits()),
+          wordScores_(wordScores, layout.wordScoreRecordBits()) {
+    tokenOffset_          = 0;
+    depthOffset_          = tokenOffset_ + layout_.tokenBits;
+    parentOffset_         = depthOffset_ + layout_.depthBits;
+    firstChildOffset_     = parentOffset_ + layout_.nodeBits;
+    firstWordScoreOffset_ = firstChildOffset_ + layout_.nodeBits;
+    backOffOffset_        = firstWordScoreOffset_ + layout_.wordScoreBits;
+}
+
+CompactTrie::NodeIndex CompactTrie::findChild(NodeIndex n, TokenIndex t) const {
+    // tokens are stored with an offset of one in node records, see token()
+    u64       key = t + 1;
+    NodeIndex l = childrenBegin(n), r = childrenEnd(n);
+    while (l < r) {
+        NodeIndex m = l + (r - l) / 2;
+        u64       k = nodes_.get(m, tokenOffset_, layout_.tokenBits);
+        if (k < key) {
+            l = m + 1;
+        }
+        else if (k > key) {
+            r = m;
+        }
+        else {
+            return m;
+        }
+    }
+    return 0;
+}
+
+CompactTrie::WordScoreIndex CompactTrie::findWordScore(NodeIndex n, TokenIndex t) const {
+    u64            key = t;
+    WordScoreIndex l = scoresBegin(n), r = scoresEnd(n);
+    while (l < r) {
+        WordScoreIndex m = l + (r - l) / 2;
+        u64            k = wordScores_.get(m, 0, layout_.tokenBits);
+        if (k < key) {
+            l = m + 1;
+        }
+        else if (k > key) {
+            r = m;
+        }
+        else {
+            return m;
+        }
+    }
+    return invalidWordScore;
+}
@@ -0,0 +1,204 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _LM_COMPACT_BACKINGOFF_TRIE_HH
+#define _LM_COMPACT_BACKINGOFF_TRIE_HH
+
+#include <vector>
+
+#include <Core/Types.hh>
+
+#include "LanguageModel.hh"
+
+namespace BackingOffPrivate {
+
+/**
+ * Unsigned fixed-width fields packed into records of equal bit length.
+ * The storage is an array of 64-bit words which is padded by one word,
+ * so that a field crossing a word boundary can be read with two loads.
+ */
+class PackedRecords {
+public:
+    PackedRecords()
+            : data_(0), recordBits_(0) {}
+    PackedRecords(const u64* data, u32 recordBits)
+            : data_(data), recordBits_(recordBits) {}
+
+    u64 get(u64 record, u32 offset, u32 width) const {
+        u64        bit   = record * recordBits_ + offset;
+        const u64* word  = data_ + (bit >> 6);
+        u32        shift = bit & 63;
+        u64        value = word[0] >> shift;
+        if (shift + width > 64) {
+            value |= word[1] << (64 - shift);
+        }
+        return value & ((u64(1) << width) - 1);
+    }
+
+    /** Number of 64-bit words needed for @c nRecords records, including padding */
+    static u64 nWords(u64 nRecords, u32 recordBits) {
+        return (nRecords * recordBits + 63) / 64 + 1;
+    }
+
+    static void set(std::vector<u64>& data, u32 recordBits, u64 record, u32 offset, u32 width, u64 value);
+
+private:
+    const u64* data_;
+    u32        recordBits_;
+};
+
+/** Number of bits needed to represent all values in [0, maxValue] */
+u32 bitWidth(u64 maxValue);
+
+/**
+ * Scalar quantizer with a sorted codebook of at most 2^bits entries.
+ *
+ * If there are no more distinct values than codebook entries, the codebook
+ * contains exactly these values and quantization is lossless. Otherwise the
+ * sorted values are split into bins of equal frequency and every bin is
+ * represented by its mean. The maximum score (used as "infinity") always
+ * gets an entry of its own.
+ */
+class ScoreQuantizer {
+public:
+    ScoreQuantizer(std::vector<Lm::Score>& values, u32 bits);
+
+    u32 encode(Lm::Score value) const;
+
+    const std::vector<Lm::Score>& codebook() const {
+        return codebook_;
+    }
+
+private:
+    std::vector<Lm::Score> codebook_;
+};
+
+/**
+ * Compact read-only representation of the back-off tree of BackingOffLm.
+ *
+ * Nodes and word scores are stored in the same order as in the
+ * full-precision representation, but as bit-packed records whose field
+ * widths are just large enough for the respective value range: token
+ * indices, child and word score offsets are absolute indices and
+ * scores are replaced by their code in a per-order codebook.
+ * Back-off weights use the codebook of the depth of their node, word
+ * scores the one of the depth of the node they are attached to.
+ *
+ * Node records are followed by a sentinel record, so that the children
+ * and word scores of node n are given by the ranges
+ * [firstChild(n), firstChild(n+1)) and [firstWordScore(n), firstWordScore(n+1)).
+ * Children and word scores are sorted by token, so they can be searched
+ * by bisection. Node 0 is the root; since it is never a child, 0 is used
+ * as "not found" by findChild().
+ */
+class CompactTrie {
+public:
+    typedef u32 NodeIndex;
+    typedef u32 WordScoreIndex;
+    typedef s32 TokenIndex;
+    typedef u16 Depth;
+
+    static const WordScoreIndex invalidWordScore = Core::Type<u32>::max;
+
+    /** Field widths and offsets of the records */
+    struct Layout {
+        u32 tokenBits;
+        u32 depthBits;
+        u32 nodeBits;
+        u32 wordScoreBits;
+        u32 quantizationBits;
+        u32 maxDepth;
+
+        u32 nodeRecordBits() const {
+            return tokenBits + depthBits + 2 * nodeBits + wordScoreBits + quantizationBits;
+        }
+        u32 wordScoreRecordBits() const {
+            return tokenBits + quantizationBits;
+        }
+        u32 codebookSize() const {
+            return 1u << quantizationBits;
+        }
+    };
+
+    CompactTrie(const Layout&    layout,
+                NodeIndex        nNodes,
+                WordScoreIndex   nWordScores,
+                const Lm::Score* backOffCodebooks,
+                const Lm::Score* wordScoreCodebooks,
+                const u64*       nodes,
+                const u64*       wordScores);
+
+    NodeIndex nNodes() const {
+        return nNodes_;
+    }
+    WordScoreIndex nWordScores() const {
+        return nWordScores_;
+    }
+    const Layout& layout() const {
+        return layout_;
+    }
+
+    /** Least recent word of the history represented by node @c n, -1 for the root */
+    TokenIndex token(NodeIndex n) const {
+        return TokenIndex(nodes_.get(n, tokenOffset_, layout_.tokenBits)) - 1;
+    }
+    Depth depth(NodeIndex n) const {
+        return nodes_.get(n, depthOffset_, layout_.depthBits);
+    }
+    NodeIndex parent(NodeIndex n) const {
+        return nodes_.get(n, parentOffset_, layout_.nodeBits);
+    }
+    Lm::Score backOffScore(NodeIndex n) const {
+        return backOffCodebooks_[depth(n) * codebookSize_ + nodes_.get(n, backOffOffset_, layout_.quantizationBits)];
+    }
+    NodeIndex childrenBegin(NodeIndex n) const {
+        return nodes_.get(n, firstChildOffset_, layout_.nodeBits);
+    }
+    NodeIndex childrenEnd(NodeIndex n) const {
+        return childrenBegin(n + 1);
+    }
+    WordScoreIndex scoresBegin(NodeIndex n) const {
+        return nodes_.get(n, firstWordScoreOffset_, layout_.wordScoreBits);
+    }
+    WordScoreIndex scoresEnd(NodeIndex n) const {
+        return scoresBegin(n + 1);
+    }
+    TokenIndex wordToken(WordScoreIndex i) const {
+        return wordScores_.get(i, 0, layout_.tokenBits);
+    }
+    /** Score of word score @c i attached to a node of depth @c d */
+    Lm::Score wordScore(WordScoreIndex i, Depth d) const {
+        return wordScoreCodebooks_[d * codebookSize_ + wordScores_.get(i, layout_.tokenBits, layout_.quantizationBits)];
+    }
+
+    NodeIndex      findChild(NodeIndex n, TokenIndex t) const;
+    WordScoreIndex findWordScore(NodeIndex n, TokenIndex t) const;
+
+private:
+    Layout           layout_;
+    NodeIndex        nNodes_;
+    WordScoreIndex   nWordScores_;
+    u32              codebookSize_;
+    const Lm::Score* backOffCodebooks_;
+    const Lm::Score* wordScoreCodebooks_;
+    PackedRecords    nodes_;
+    PackedRecords    wordScores_;
+
+    u32 tokenOffset_, depthOffset_, parentOffset_, firstChildOffset_, firstWordScoreOffset_, backOffOffset_;
+};
+
+}  // namespace BackingOffPrivate
+
+#endif  // _LM_COMPACT_BACKINGOFF_TRIE_HH
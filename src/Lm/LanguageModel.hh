@@ -590,6 +590,17 @@ public:
      */
     virtual void setSegment(Bliss::SpeechSegment const* s);
 
+    /**
+     * Whether the model can be used by several threads at the same time,
+     * i.e. histories can be created, copied and released and scores can be
+     * computed concurrently. The model data must not be modified after
+     * init() and all caches must be thread-local.
+     * Only such models are shared between decoders, see Module_::createLanguageModel().
+     */
+    virtual bool isThreadSafe() const {
+        return false;
+    }
+
 protected:
     // why is this even needed ?
     class NonCompiledBatchRequest : public CompiledBatchRequest {
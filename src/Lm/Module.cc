@@ -15,6 +15,7 @@
 #include "Module.hh"
 
 #include <Core/Application.hh>
+#include <Core/StringUtilities.hh>
 #include <Nn/DummyCompressedVectorFactory.hh>
 #include <Nn/FixedQuantizationCompressedVectorFactory.hh>
 #include <Nn/QuantizedCompressedVectorFactory.hh>
@@ -76,9 +77,84 @@ const Core::Choice Module_::lmTypeChoice(
 const Core::ParameterChoice Module_::lmTypeParam(
         "type", &Module_::lmTypeChoice, "type of language model", lmTypeZerogram);
 
+const Core::ParameterString Module_::paramSharedInstance(
+        "shared-instance",
+        "language models with the same (non-empty) name are loaded once and shared, e.g. between parallel decoders",
+        "");
+
+std::string Module_::describeConfiguration(const Core::Configuration& c) {
+    // parameters which select the loaded model, of all types which can be shared
+    static const char* const parameters[] = {
+            "type", "file", "encoding", "reverse-lm", "skip-inf-score",
+            "image", "image-format", "image-quantization-bits", "map-oov-to-unk",
+            "num-lms", "linear-combination", "lookahead-lm", "recombination-lm", "skip-threshold"};
+    static const char* const classParameters[] = {"file", "encoding", "scale"};
+
+    std::string result;
+    std::string value;
+    for (const char* parameter : parameters) {
+        if (c.get(parameter, value)) {
+            result += Core::form("%s%s=%s", result.empty() ? "" : " ", parameter, value.c_str());
+        }
+    }
+    Core::Configuration classConfig(c, "classes");
+    for (const char* parameter : classParameters) {
+        if (classConfig.get(parameter, value)) {
+            result += Core::form(" classes.%s=%s", parameter, value.c_str());
+        }
+    }
+    if (lmTypeParam(c) == lmTypeCombine) {
+        for (s32 i = 1; i <= CombineLanguageModel::paramNumLms(c); ++i) {
+            Core::Configuration subConfig(c, std::string("lm-") + std::to_string(i));
+            std::string         scale;
+            result += Core::form(" lm-%d{%s", i, describeConfiguration(subConfig).c_str());
+            if (subConfig.get("scale", scale)) {
+                result += " scale=" + scale;
+            }
+            result += "}";
+        }
+    }
+    return result;
+}
+
 Core::Ref<LanguageModel> Module_::createLanguageModel(
         const Core::Configuration& c,
         Bliss::LexiconRef          l) {
+    std::string sharedName = paramSharedInstance(c);
+    if (sharedName.empty()) {
+        return createNewLanguageModel(c, l);
+    }
+
+    std::string description = describeConfiguration(c);
+
+    std::lock_guard<std::recursive_mutex> lock(sharedInstancesMutex_);
+    auto                                  iter = sharedInstances_.find(sharedName);
+    if (iter != sharedInstances_.end()) {
+        if (iter->second.lexicon != l) {
+            Core::Application::us()->criticalError("shared language model instance \"%s\" requested with a different lexicon", sharedName.c_str());
+        }
+        if (iter->second.description != description) {
+            Core::Application::us()->criticalError("shared language model instance \"%s\" requested with a different configuration: \"%s\" (loaded: \"%s\")",
+                                                   sharedName.c_str(), description.c_str(), iter->second.description.c_str());
+        }
+        return iter->second.languageModel;
+    }
+
+    Core::Ref<LanguageModel> result = createNewLanguageModel(c, l);
+    if (!result) {
+        return result;
+    }
+    if (!result->isThreadSafe()) {
+        result->warning("not thread-safe, shared-instance \"%s\" is ignored", sharedName.c_str());
+        return result;
+    }
+    sharedInstances_[sharedName] = {result, l, description};
+    return result;
+}
+
+Core::Ref<LanguageModel> Module_::createNewLanguageModel(
+        const Core::Configuration& c,
+        Bliss::LexiconRef          l) {
     Core::Ref<LanguageModel> result;
 
     switch (lmTypeParam(c)) {
@@ -15,6 +15,9 @@
 #ifndef _LM_MODULE_HH
 #define _LM_MODULE_HH
 
+#include <mutex>
+#include <unordered_map>
+
 #include <Core/Singleton.hh>
 
 #include "LanguageModel.hh"
@@ -26,18 +29,45 @@ class Module_ {
 private:
     static const Core::Choice          lmTypeChoice;
     static const Core::ParameterChoice lmTypeParam;
+    static const Core::ParameterString paramSharedInstance;
+
+    struct SharedInstance {
+        Core::Ref<LanguageModel> languageModel;
+        Bliss::LexiconRef        lexicon;
+        std::string              description;
+    };
+
+    // recursive, since combined language models create their sub-models while the lock is held
+    std::recursive_mutex                            sharedInstancesMutex_;
+    std::unordered_map<std::string, SharedInstance> sharedInstances_;
+
+    Core::Ref<LanguageModel> createNewLanguageModel(const Core::Configuration&, Bliss::LexiconRef);
 
 public:
     Module_() {}
 
     /**
      * Creates and initializes a LanguageModel as configured.
-     * @return a newly created instance of LanguageModel or a void
+     * If "shared-instance" is set to a non-empty name, all language models
+     * configured with this name are one instance, which is loaded on first
+     * request and kept until the end of the process. Requesting it with a
+     * different lexicon or configuration (see describeConfiguration()) is a
+     * critical error.
+     * This is only supported for models which are thread-safe, see
+     * LanguageModel::isThreadSafe(), other models are created privately.
+     * @return a newly created or shared instance of LanguageModel or a void
      * reference if an error occured.
      */
     Core::Ref<LanguageModel> createLanguageModel(
             const Core::Configuration&, Bliss::LexiconRef);
 
+    /**
+     * Describes the parameters of @param c which select the loaded model,
+     * e.g. type and file, including the ones of combined sub-models.
+     * Shared instances are only handed out for equal descriptions.
+     */
+    static std::string describeConfiguration(const Core::Configuration& c);
+
     /**
      * Creates a scaled language model from @param languageModel.
      * @return a valid reference to the newly created instance of
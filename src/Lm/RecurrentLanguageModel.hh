@@ -6,6 +6,8 @@
 #include <thread>
 #include <vector>
 
+#include <Core/MemoryAccounting.hh>
+#include <Core/Tracing.hh>
 #include <Math/FastMatrix.hh>
 #include <Nn/AbstractStateManager.hh>
 #include <Nn/Module.hh>
@@ -170,6 +172,7 @@ private:
     mutable double                 total_expand_hist_time_;
     mutable detail::TimeStatistics fwd_statistics_;
     mutable size_t                 dump_inputs_counter_;
+    mutable Core::MemoryCharge     cache_memory_;  // nn-outputs and states of all histories, measured in startFrame
 
     std::unique_ptr<Nn::AbstractStateManager<value_t, state_variable_t>> state_manager_;
 
@@ -287,6 +290,7 @@ RecurrentLanguageModel<value_t, state_variable_t>::RecurrentLanguageModel(Core::
           total_expand_hist_time_(0.0),
           fwd_statistics_(),
           dump_inputs_counter_(0ul),
+          cache_memory_("lm-history-cache"),
           state_manager_(std::move(state_manager)),
           output_transform_function_(),
           state_comp_vec_factory_(Nn::Module::instance().createCompressedVectorFactory(select("state-compression"))),
@@ -438,6 +442,7 @@ Score RecurrentLanguageModel<value_t, state_variable_t>::score(History const& hi
     ScoresWithContext* sc = const_cast<ScoresWithContext*>(reinterpret_cast<ScoresWithContext const*>(hist.handle()));
 
     if (not sc->computed.load()) {
+        TRACE_SCOPE("lm", "request");
         auto start = std::chrono::steady_clock::now();
         if (async_) {
             // promise should only be used once
@@ -515,6 +520,7 @@ void RecurrentLanguageModel<value_t, state_variable_t>::startFrame(Search::Timef
             }
         }
     });
+    cache_memory_.set(nn_output_cache_size + state_cache_size);
 
     if (log_memory_ and statistics_.isOpen()) {
         statistics_ << Core::XmlOpen("memory-usage") + Core::XmlAttribute("time-frame", current_time_);
@@ -589,6 +595,7 @@ void RecurrentLanguageModel<value_t, state_variable_t>::forward(Lm::History cons
         to_fwd_finished_.set_value(hist);
         return;
     }
+    TRACE_SCOPE("lm", "forward");
     auto start = std::chrono::steady_clock::now();
 
     detail::RequestGraph request_graph;
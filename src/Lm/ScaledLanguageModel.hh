@@ -131,6 +131,9 @@ public:
     virtual void setSegment(Bliss::SpeechSegment const* s) {
         languageModel_->setSegment(s);
     }
+    virtual bool isThreadSafe() const {
+        return languageModel_->isThreadSafe();
+    }
     virtual Token sentenceBeginToken() const {
         return languageModel_->sentenceBeginToken();
     }
@@ -1,6 +1,8 @@
 #ifndef _LM_SIMPLE_HISTORY_LM_HH
 #define _LM_SIMPLE_HISTORY_LM_HH
 
+#include <atomic>
+
 #include "LanguageModel.hh"
 #include "NNHistoryManager.hh"
 
@@ -12,8 +14,8 @@ namespace Lm {
  */
 
 struct SimpleHistory {
-    TokenIdSequence tokIdSeq;
-    mutable u32     refCount;
+    TokenIdSequence          tokIdSeq;
+    mutable std::atomic<u32> refCount;
 
     SimpleHistory()
             : refCount(0) {}
@@ -38,8 +40,7 @@ public:
 
     virtual void release(HistoryHandle handle) {
         const SimpleHistory* sh = static_cast<const SimpleHistory*>(handle);
-        --(sh->refCount);
-        if (sh->refCount == 0)
+        if (--(sh->refCount) == 0)
             delete sh;
     }
 
@@ -97,6 +98,10 @@ public:
         return 0.0;
     }
 
+    bool isThreadSafe() const {
+        return true;
+    }
+
     std::string formatHistory(const History& h) const {
         const SimpleHistory* sh = static_cast<const SimpleHistory*>(h.handle());
         std::string          result;
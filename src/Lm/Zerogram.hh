@@ -44,6 +44,10 @@ public:
     virtual Score score(const History&, Token) const {
         return score_;
     }
+
+    virtual bool isThreadSafe() const {
+        return true;
+    }
 };
 
 }  // namespace Lm
@@ -18,6 +18,7 @@
 #include <Core/Application.hh>
 #include <Core/Assertions.hh>  // to use different require() functions
 #include <Core/OpenMPWrapper.hh>
+#include <Core/TaskScheduler.hh>
 
 #include <Math/Blas.hh>
 #include <Math/FastVector.hh>  // for matrix-vector operations (Blas 2)
@@ -510,8 +511,11 @@ s32 FastMatrix<T>::initialize() {
             value = 1;
         }
 
-        maxThreads = value;
-        Core::omp::set_num_threads(value);
+        maxThreads = Core::TaskScheduler::threadsWithinCoreBudget(std::max(value, 1));
+        if (maxThreads < value && Core::Application::us()) {
+            Core::Application::us()->warning("OMP_NUM_THREADS=%d exceeds the core budget of the process, using %d threads", value, maxThreads);
+        }
+        Core::omp::set_num_threads(maxThreads);
         if (Core::Application::us())
             Core::Application::us()->log("Maximum number of threads for CPU matrix operations: ") << maxThreads;
         else
@@ -14,6 +14,8 @@
  */
 #include "FixedQuantizationCompressedVectorFactory.hh"
 
+#include <cmath>
+
 #include <immintrin.h>
 
 namespace Nn {
@@ -196,14 +198,42 @@ const Core::ParameterFloat FixedQuantizationCompressedVectorFactory::paramEpsilo
                                                                                   "Distance between two quantized values.",
                                                                                   0.001, 0.0);
 
+const Core::ParameterBool FixedQuantizationCompressedVectorFactory::paramDynamicScale("dynamic-scale",
+                                                                                     "Choose the distance between two quantized values per vector such that its "
+                                                                                     "largest absolute value is representable. epsilon is the lower bound.",
+                                                                                     false);
+
+float FixedQuantizationCompressedVectorFactory::scale(float const* data, size_t size) const {
+    if (not dynamic_scale_) {
+        return epsilon_;
+    }
+    float max_abs = 0.0f;
+    for (size_t i = 0ul; i < size; i++) {
+        max_abs = std::max(max_abs, std::abs(data[i]));
+    }
+    float max_val = bits_per_val_ == 16 ? std::numeric_limits<s16>::max() : std::numeric_limits<s8>::max();
+    return std::max(epsilon_, max_abs / max_val);
+}
+
+float FixedQuantizationCompressedVectorFactory::scale(float const* data, ContiguousBlockInfo const& block_info) const {
+    if (not dynamic_scale_) {
+        return epsilon_;
+    }
+    float result = epsilon_;
+    for (size_t b = 0ul; b < block_info.numBlocks(); b++) {
+        result = std::max(result, scale(data + block_info.blockOffset(b), block_info.blockSize()));
+    }
+    return result;
+}
+
 CompressedVectorPtr<float> FixedQuantizationCompressedVectorFactory::compress(float const* data, size_t size, CompressionParameters const* params) const {
     if (bits_per_val_ == 16) {
-        QuantizedFloatVector16Bits* vec = new QuantizedFloatVector16Bits(epsilon_);
+        QuantizedFloatVector16Bits* vec = new QuantizedFloatVector16Bits(scale(data, size));
         vec->compress(data, size);
         return CompressedVectorPtr<float>(vec);
     }
     else if (bits_per_val_ == 8) {
-        QuantizedFloatVector8Bits* vec = new QuantizedFloatVector8Bits(epsilon_);
+        QuantizedFloatVector8Bits* vec = new QuantizedFloatVector8Bits(scale(data, size));
         vec->compress(data, size);
         return CompressedVectorPtr<float>(vec);
     }
@@ -212,12 +242,12 @@ CompressedVectorPtr<float> FixedQuantizationCompressedVectorFactory::compress(fl
 
 CompressedVectorPtr<float> FixedQuantizationCompressedVectorFactory::compress(float const* data, ContiguousBlockInfo const& block_info, CompressionParameters const* params) const {
     if (bits_per_val_ == 16) {
-        QuantizedFloatVector16Bits* vec = new QuantizedFloatVector16Bits(epsilon_);
+        QuantizedFloatVector16Bits* vec = new QuantizedFloatVector16Bits(scale(data, block_info));
         vec->compress(data, block_info);
         return CompressedVectorPtr<float>(vec);
     }
     else if (bits_per_val_ == 8) {
-        QuantizedFloatVector8Bits* vec = new QuantizedFloatVector8Bits(epsilon_);
+        QuantizedFloatVector8Bits* vec = new QuantizedFloatVector8Bits(scale(data, block_info));
         vec->compress(data, block_info);
         return CompressedVectorPtr<float>(vec);
     }
@@ -68,6 +68,7 @@ public:
 
     static const Core::ParameterInt   paramBitsPerVal;
     static const Core::ParameterFloat paramEpsilon;
+    static const Core::ParameterBool  paramDynamicScale;
 
     FixedQuantizationCompressedVectorFactory(Core::Configuration const& config);
     virtual ~FixedQuantizationCompressedVectorFactory() = default;
@@ -76,8 +77,12 @@ public:
     virtual CompressedVectorPtr<float> compress(float const* data, ContiguousBlockInfo const& block_info, CompressionParameters const* params) const;
 
 private:
+    float scale(float const* data, size_t size) const;
+    float scale(float const* data, ContiguousBlockInfo const& block_info) const;
+
     unsigned bits_per_val_;
     float    epsilon_;
+    bool     dynamic_scale_;
 };
 
 // inline implementations
@@ -179,7 +184,8 @@ std::vector<T> const& QuantizedFloatVectorFixedBits<T>::data() const {
 inline FixedQuantizationCompressedVectorFactory::FixedQuantizationCompressedVectorFactory(Core::Configuration const& config)
         : Precursor(config),
           bits_per_val_(paramBitsPerVal(config)),
-          epsilon_(paramEpsilon(config)) {
+          epsilon_(paramEpsilon(config)),
+          dynamic_scale_(paramDynamicScale(config)) {
     switch (bits_per_val_) {
         case 8:
         case 16:
@@ -0,0 +1,207 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "HalfPrecisionCompressedVectorFactory.hh"
+
+#include <cstring>
+
+#include <immintrin.h>
+
+namespace {
+
+inline u32 floatBits(float f) {
+    u32 x;
+    std::memcpy(&x, &f, sizeof(x));
+    return x;
+}
+
+inline float bitsFloat(u32 x) {
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+u16 floatToFp16(float f) {
+    u32 x    = floatBits(f);
+    u32 sign = (x >> 16) & 0x8000u;
+    x &= 0x7fffffffu;
+    if (x >= 0x7f800000u) {  // inf and nan, nans are quieted and keep the upper payload bits as with F16C
+        return sign | 0x7c00u | (x > 0x7f800000u ? 0x0200u | ((x >> 13) & 0x3ffu) : 0u);
+    }
+    if (x >= 0x47800000u) {  // too large, saturate to inf
+        return sign | 0x7c00u;
+    }
+    if (x < 0x38800000u) {  // subnormal in fp16
+        if (x < 0x33000000u) {
+            return sign;
+        }
+        u32 e     = x >> 23;
+        u32 m     = (x & 0x7fffffu) | 0x800000u;
+        u32 shift = 126u - e;
+        u32 h     = m >> shift;
+        u32 rem   = m & ((1u << shift) - 1u);
+        u32 half  = 1u << (shift - 1u);
+        if (rem > half or (rem == half and (h & 1u))) {
+            ++h;
+        }
+        return sign | h;
+    }
+    u32 h   = (x - 0x38000000u) >> 13;
+    u32 rem = x & 0x1fffu;
+    if (rem > 0x1000u or (rem == 0x1000u and (h & 1u))) {
+        ++h;  // may carry into the exponent, which is the correct rounding
+    }
+    return sign | h;
+}
+
+float fp16ToFloat(u16 h) {
+    u32 sign = static_cast<u32>(h & 0x8000u) << 16;
+    u32 e    = (h >> 10) & 0x1fu;
+    u32 m    = h & 0x3ffu;
+    if (e == 0u) {
+        float v = static_cast<float>(m) * (1.0f / 16777216.0f);
+        return sign ? -v : v;
+    }
+    if (e == 31u) {  // inf and nan, nans are quieted as with F16C
+        return bitsFloat(sign | 0x7f800000u | (m << 13) | (m != 0u ? 0x00400000u : 0u));
+    }
+    return bitsFloat(sign | ((e + 112u) << 23) | (m << 13));
+}
+
+inline u16 floatToBf16(float f) {
+    u32 x = floatBits(f);
+    if ((x & 0x7fffffffu) > 0x7f800000u) {
+        return static_cast<u16>((x >> 16) | 0x0040u);
+    }
+    x += 0x7fffu + ((x >> 16) & 1u);
+    return static_cast<u16>(x >> 16);
+}
+
+inline float bf16ToFloat(u16 h) {
+    return bitsFloat(static_cast<u32>(h) << 16);
+}
+
+}  // namespace
+
+namespace Nn {
+
+// --------------------------- HalfPrecisionFloatVector ---------------------------
+
+size_t HalfPrecisionFloatVector::size() const {
+    return data_.size();
+}
+
+float HalfPrecisionFloatVector::get(size_t pos) const {
+    return format_ == Fp16HalfPrecisionFormat ? fp16ToFloat(data_[pos]) : bf16ToFloat(data_[pos]);
+}
+
+void HalfPrecisionFloatVector::uncompress(float* data, size_t size) const {
+    require_ge(size, this->size());
+    uncompress_internal(data, this->size(), 0ul);
+}
+
+void HalfPrecisionFloatVector::uncompress(float* data, ContiguousBlockInfo const& block_info) const {
+    require_eq(block_info.totalSize(), this->size());
+    for (size_t b = 0ul; b < block_info.numBlocks(); b++) {
+        uncompress_internal(data + block_info.blockOffset(b), block_info.blockSize(), b * block_info.blockSize());
+    }
+}
+
+size_t HalfPrecisionFloatVector::usedMemory() const {
+    return data_.capacity() * sizeof(u16);
+}
+
+void HalfPrecisionFloatVector::store(float const* data, size_t size) {
+    data_.resize(size);
+    store_internal(data, size, 0ul);
+}
+
+void HalfPrecisionFloatVector::store(float const* data, ContiguousBlockInfo const& block_info) {
+    data_.resize(block_info.totalSize());
+    for (size_t b = 0ul; b < block_info.numBlocks(); b++) {
+        store_internal(data + block_info.blockOffset(b), block_info.blockSize(), b * block_info.blockSize());
+    }
+}
+
+void HalfPrecisionFloatVector::clear() {
+    data_.clear();
+}
+
+void HalfPrecisionFloatVector::uncompress_internal(float* data, size_t size, size_t pos) const {
+    u16 const* src = data_.data() + pos;
+    if (format_ == Fp16HalfPrecisionFormat) {
+        size_t i = 0ul;
+#ifdef __F16C__
+        for (; i + 8ul <= size; i += 8ul) {
+            __m128i h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+            _mm256_storeu_ps(data + i, _mm256_cvtph_ps(h));
+        }
+#endif
+        for (; i < size; i++) {
+            data[i] = fp16ToFloat(src[i]);
+        }
+    }
+    else {
+        for (size_t i = 0ul; i < size; i++) {
+            data[i] = bf16ToFloat(src[i]);
+        }
+    }
+}
+
+void HalfPrecisionFloatVector::store_internal(float const* data, size_t size, size_t pos) {
+    u16* dst = data_.data() + pos;
+    if (format_ == Fp16HalfPrecisionFormat) {
+        size_t i = 0ul;
+#ifdef __F16C__
+        for (; i + 8ul <= size; i += 8ul) {
+            __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(data + i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+        }
+#endif
+        for (; i < size; i++) {
+            dst[i] = floatToFp16(data[i]);
+        }
+    }
+    else {
+        for (size_t i = 0ul; i < size; i++) {
+            dst[i] = floatToBf16(data[i]);
+        }
+    }
+}
+
+// --------------------- HalfPrecisionCompressedVectorFactory ---------------------
+
+const Core::Choice HalfPrecisionCompressedVectorFactory::choiceFormat(
+        "fp16", Fp16HalfPrecisionFormat,
+        "bf16", Bf16HalfPrecisionFormat,
+        Core::Choice::endMark());
+
+const Core::ParameterChoice HalfPrecisionCompressedVectorFactory::paramFormat("format",
+                                                                               &choiceFormat,
+                                                                               "16 bit float format used for storage",
+                                                                               Fp16HalfPrecisionFormat);
+
+CompressedVectorPtr<float> HalfPrecisionCompressedVectorFactory::compress(float const* data, size_t size, CompressionParameters const* params) const {
+    HalfPrecisionFloatVector* vec = new HalfPrecisionFloatVector(format_);
+    vec->store(data, size);
+    return CompressedVectorPtr<float>(vec);
+}
+
+CompressedVectorPtr<float> HalfPrecisionCompressedVectorFactory::compress(float const* data, ContiguousBlockInfo const& block_info, CompressionParameters const* params) const {
+    HalfPrecisionFloatVector* vec = new HalfPrecisionFloatVector(format_);
+    vec->store(data, block_info);
+    return CompressedVectorPtr<float>(vec);
+}
+
+}  // namespace Nn
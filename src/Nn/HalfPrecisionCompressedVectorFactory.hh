@@ -0,0 +1,80 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef _NN_HALF_PRECISION_COMPRESSED_VECTOR_FACTORY_HH
+#define _NN_HALF_PRECISION_COMPRESSED_VECTOR_FACTORY_HH
+
+#include <vector>
+
+#include "CompressedVector.hh"
+
+/**
+ * Classes for vector compression by storing each value as a 16 bit float.
+ * Two formats are supported: IEEE half precision (fp16, 5 bit exponent, 10 bit mantissa)
+ * and bfloat16 (bf16, 8 bit exponent, 7 bit mantissa). Conversion uses round-to-nearest-even.
+ * fp16 is more precise but clips magnitudes above 65504, bf16 keeps the full float range.
+ */
+
+namespace Nn {
+
+enum HalfPrecisionFormat {
+    Fp16HalfPrecisionFormat,
+    Bf16HalfPrecisionFormat
+};
+
+class HalfPrecisionFloatVector : public CompressedVector<float> {
+public:
+    HalfPrecisionFloatVector(HalfPrecisionFormat format)
+            : format_(format) {
+    }
+
+    virtual size_t size() const;
+    virtual float  get(size_t pos) const;
+    virtual void   uncompress(float* data, size_t size) const;
+    virtual void   uncompress(float* data, ContiguousBlockInfo const& block_info) const;
+    virtual size_t usedMemory() const;
+    void           store(float const* data, size_t size);
+    void           store(float const* data, ContiguousBlockInfo const& block_info);
+    void           clear();
+
+private:
+    void uncompress_internal(float* data, size_t size, size_t pos) const;
+    void store_internal(float const* data, size_t size, size_t pos);
+
+    std::vector<u16>    data_;
+    HalfPrecisionFormat format_;
+};
+
+class HalfPrecisionCompressedVectorFactory : public CompressedVectorFactory<float> {
+public:
+    using Precursor = CompressedVectorFactory<float>;
+
+    static const Core::Choice          choiceFormat;
+    static const Core::ParameterChoice paramFormat;
+
+    HalfPrecisionCompressedVectorFactory(Core::Configuration const& config)
+            : Precursor(config),
+              format_(static_cast<HalfPrecisionFormat>(paramFormat(config))) {}
+    virtual ~HalfPrecisionCompressedVectorFactory() = default;
+
+    virtual CompressedVectorPtr<float> compress(float const* data, size_t size, CompressionParameters const* params) const;
+    virtual CompressedVectorPtr<float> compress(float const* data, ContiguousBlockInfo const& block_info, CompressionParameters const* params) const;
+
+private:
+    HalfPrecisionFormat format_;
+};
+
+}  // namespace Nn
+
+#endif  // _NN_HALF_PRECISION_COMPRESSED_VECTOR_FACTORY_HH
@@ -276,4 +276,32 @@ std::vector<std::optional<ScoreAccessorRef>> CombineLabelScorer::getScoreAccesso
     return combinedAccessors;
 }
 
+void CombineLabelScorer::precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) {
+    std::vector<CombineLabelScorer*> combineScorers;
+    combineScorers.reserve(labelScorers.size());
+    for (auto* labelScorer : labelScorers) {
+        auto* combineScorer = dynamic_cast<CombineLabelScorer*>(labelScorer);
+        verify(combineScorer != nullptr and combineScorer->scorers_.size() == scorers_.size());
+        combineScorers.push_back(combineScorer);
+    }
+
+    for (size_t scorerIdx = 0ul; scorerIdx < scorers_.size(); ++scorerIdx) {
+        // Extract sub-scorers and their contexts for every instance
+        std::vector<LabelScorer*>                   subScorers;
+        std::vector<std::vector<ScoringContextRef>> subScorerContexts;
+        subScorers.reserve(combineScorers.size());
+        subScorerContexts.reserve(combineScorers.size());
+        for (size_t instanceIdx = 0ul; instanceIdx < combineScorers.size(); ++instanceIdx) {
+            subScorers.push_back(combineScorers[instanceIdx]->scorers_[scorerIdx].get());
+            auto& contexts = subScorerContexts.emplace_back();
+            contexts.reserve(scoringContexts[instanceIdx].size());
+            for (auto const& scoringContext : scoringContexts[instanceIdx]) {
+                contexts.push_back(dynamic_cast<CombineScoringContext const*>(scoringContext.get())->scoringContexts[scorerIdx]);
+            }
+        }
+
+        scorers_[scorerIdx]->precomputeScores(subScorers, subScorerContexts);
+    }
+}
+
 }  // namespace Nn
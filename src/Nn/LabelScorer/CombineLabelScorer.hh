@@ -68,6 +68,9 @@ public:
     // Get accessors that return score-sums of all sub-scorers
     std::vector<std::optional<ScoreAccessorRef>> getScoreAccessors(std::vector<ScoringContextRef> const& scoringContexts) override;
 
+    // Precompute with the corresponding sub-scorers of all given instances
+    void precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) override;
+
 private:
     std::vector<Core::Ref<ScaledLabelScorer>> scorers_;
 };
@@ -15,27 +15,72 @@
 
 #include "Encoder.hh"
 
+#include <chrono>
+
+#include <Core/TaskScheduler.hh>
+#include <Core/Tracing.hh>
+
 namespace Nn {
 
+const Core::ParameterBool Encoder::paramAsync(
+        "async",
+        "Run the encoder forwarding as a task of the task scheduler while previously encoded outputs are consumed.",
+        false);
+
+const Core::ParameterInt Encoder::paramMaxQueuedOutputs(
+        "max-queued-outputs",
+        "In asynchronous mode, don't start encoding the next inputs while this many encoder outputs are waiting to be fetched.",
+        64,
+        1);
+
 Encoder::Encoder(Core::Configuration const& config)
         : Core::Component(config),
           inputBuffer_(),
           outputBuffer_(),
-          expectMoreFeatures_(true) {}
+          expectMoreFeatures_(true),
+          async_(paramAsync(config)),
+          maxQueuedOutputs_(paramMaxQueuedOutputs(config)),
+          encodingJob_(),
+          pendingInputs_(),
+          readyOutputs_() {
+    if (async_ and Core::TaskScheduler::global().nWorkers() == 0) {
+        warning("task scheduler has no workers (core budget of one), encoding synchronously");
+        async_ = false;
+    }
+    if (async_) {
+        log() << "Use asynchronous encoding with at most " << maxQueuedOutputs_ << " queued outputs";
+    }
+}
+
+Encoder::~Encoder() {
+    finishEncodingJob();
+}
 
 void Encoder::reset() {
+    finishEncodingJob();
+
     expectMoreFeatures_ = true;
     inputBuffer_.clear();
+    pendingInputs_.clear();
 
     outputBuffer_.clear();
+    readyOutputs_.clear();
 }
 
 void Encoder::signalNoMoreFeatures() {
+    // A running encoding job may still depend on the flag
+    finishEncodingJob();
     expectMoreFeatures_ = false;
 }
 
 void Encoder::addInput(DataView const& input) {
-    inputBuffer_.push_back(input);
+    if (encodingJob_.valid()) {
+        // The input buffer is owned by the running encoding job
+        pendingInputs_.push_back(input);
+    }
+    else {
+        inputBuffer_.push_back(input);
+    }
 }
 
 void Encoder::addInputs(DataView const& input, size_t nTimesteps) {
@@ -50,6 +95,10 @@ bool Encoder::canEncode() const {
 }
 
 std::optional<EncodedSpan> Encoder::getNextOutput() {
+    if (async_) {
+        return getNextOutputAsync();
+    }
+
     // Check if there are still outputs in the buffer to pass
     if (not outputBuffer_.empty()) {
         auto result = outputBuffer_.front();
@@ -63,7 +112,10 @@ std::optional<EncodedSpan> Encoder::getNextOutput() {
     }
 
     // Encoder is ready to run, so run it and try fetching an output again.
-    encode();
+    {
+        TRACE_SCOPE("nn", "encode");
+        encode();
+    }
     postEncodeCleanup();
 
     // If there are still no outputs after encoding, return None to avoid recursive call
@@ -79,4 +131,57 @@ void Encoder::postEncodeCleanup() {
     inputBuffer_.clear();
 }
 
+void Encoder::finishEncodingJob() {
+    if (not encodingJob_.valid()) {
+        return;
+    }
+    Core::TaskScheduler::global().get(encodingJob_);
+
+    readyOutputs_.insert(readyOutputs_.end(), outputBuffer_.begin(), outputBuffer_.end());
+    outputBuffer_.clear();
+
+    inputBuffer_.insert(inputBuffer_.end(), pendingInputs_.begin(), pendingInputs_.end());
+    pendingInputs_.clear();
+}
+
+void Encoder::startEncodingJob() {
+    verify(not encodingJob_.valid());
+    encodingJob_ = Core::TaskScheduler::global().submit([this]() {
+        TRACE_SCOPE("nn", "encode");
+        encode();
+        postEncodeCleanup();
+    });
+}
+
+std::optional<EncodedSpan> Encoder::getNextOutputAsync() {
+    // Take over the outputs of a finished encoding job
+    if (encodingJob_.valid() and encodingJob_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        finishEncodingJob();
+    }
+
+    // Encode the next inputs in the background while the ready outputs are consumed
+    if (not encodingJob_.valid() and readyOutputs_.size() < maxQueuedOutputs_ and canEncode()) {
+        startEncodingJob();
+    }
+
+    // After the segment end, all remaining outputs have to be delivered, so wait for the encoder
+    while (readyOutputs_.empty() and not expectMoreFeatures_ and encodingJob_.valid()) {
+        {
+            TRACE_SCOPE("nn", "encoder-wait");
+            finishEncodingJob();
+        }
+        if (canEncode()) {
+            startEncodingJob();
+        }
+    }
+
+    if (readyOutputs_.empty()) {
+        return {};
+    }
+
+    auto result = readyOutputs_.front();
+    readyOutputs_.pop_front();
+    return result;
+}
+
 }  // namespace Nn
@@ -17,9 +17,11 @@
 #define ENCODER_HH
 
 #include <deque>
+#include <future>
 #include <optional>
 
 #include <Core/Component.hh>
+#include <Core/Parameter.hh>
 
 #include "DataView.hh"
 
@@ -36,14 +38,25 @@ struct EncodedSpan {
 };
 
 /**
- * Encoder class can take features (e.g. from feature flow) and run them through an encoder model to get encoder states.
- * Works with input/output buffer logic, i.e. features get added to an input buffer and outputs are retreived from an output buffer.
+ * Base class for encoders which take features (e.g. from feature flow) and run them through an encoder model to get encoder states.
+ * Works with input/output buffer logic, i.e. features get added to an input buffer and outputs are retrieved from an output buffer.
+ *
+ * In asynchronous mode, `encode` and `postEncodeCleanup` run as a task of the global `Core::TaskScheduler` while the caller
+ * keeps consuming previously encoded outputs and adding new inputs. At most one job runs at a time and during that time the job
+ * owns `inputBuffer_`, `outputBuffer_` and the state of the derived class. New inputs are put aside and the outputs are
+ * only handed over once the job is finished. A new job is only started while fewer than `max-queued-outputs`
+ * outputs are waiting to be fetched. Without scheduler workers (a core budget of 1), the encoder runs synchronously.
+ * After the segment end has been signaled, `getNextOutput` waits for the encoder so that all remaining outputs are
+ * still delivered before returning None, just like in synchronous mode.
  */
 class Encoder : public virtual Core::Component,
                 public Core::ReferenceCounted {
 public:
+    static const Core::ParameterBool paramAsync;
+    static const Core::ParameterInt  paramMaxQueuedOutputs;
+
     Encoder(Core::Configuration const& config);
-    virtual ~Encoder() = default;
+    virtual ~Encoder();
 
     // Clear buffers and reset segment end flag.
     virtual void reset();
@@ -78,6 +91,21 @@ protected:
     // Check if encoder is ready to encode.
     // By default, allow encoding only after segment end has been signaled.
     virtual bool canEncode() const;
+
+    // Wait for a running asynchronous encoding job and take over its outputs.
+    // Since the job calls `encode` of the derived class, derived classes have to call this in their destructor.
+    void finishEncodingJob();
+
+private:
+    bool   async_;
+    size_t maxQueuedOutputs_;
+
+    std::future<void>       encodingJob_;
+    std::deque<DataView>    pendingInputs_;  // Inputs added while an encoding job is running
+    std::deque<EncodedSpan> readyOutputs_;   // Outputs of finished encoding jobs that have not been fetched yet
+
+    void                       startEncodingJob();
+    std::optional<EncodedSpan> getNextOutputAsync();
 };
 
 }  // namespace Nn
@@ -72,6 +72,17 @@ std::vector<std::optional<ScoreAccessorRef>> EncoderDecoderLabelScorer::getScore
     return decoder_->getScoreAccessors(scoringContexts);
 }
 
+void EncoderDecoderLabelScorer::precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) {
+    std::vector<LabelScorer*> decoders;
+    decoders.reserve(labelScorers.size());
+    for (auto* labelScorer : labelScorers) {
+        auto* encoderDecoderScorer = dynamic_cast<EncoderDecoderLabelScorer*>(labelScorer);
+        verify(encoderDecoderScorer != nullptr);
+        decoders.push_back(encoderDecoderScorer->decoder_.get());
+    }
+    decoder_->precomputeScores(decoders, scoringContexts);
+}
+
 void EncoderDecoderLabelScorer::passEncoderOutputsToDecoder() {
     std::optional<EncodedSpan> encoderOutput;
     while ((encoderOutput = encoder_->getNextOutput())) {
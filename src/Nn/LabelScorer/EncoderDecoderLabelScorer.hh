@@ -70,6 +70,9 @@ public:
     // Return accessors from decoder component
     std::vector<std::optional<ScoreAccessorRef>> getScoreAccessors(std::vector<ScoringContextRef> const& scoringContexts) override;
 
+    // Precompute with the decoder components of all given instances
+    void precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) override;
+
 private:
     Core::Ref<Encoder>           encoder_;
     Core::Ref<ScaledLabelScorer> decoder_;
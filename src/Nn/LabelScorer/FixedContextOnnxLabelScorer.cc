@@ -14,6 +14,11 @@
  */
 
 #include "FixedContextOnnxLabelScorer.hh"
+
+#include <algorithm>
+
+#include <Core/Tracing.hh>
+
 #include "ScoreAccessor.hh"
 
 namespace Nn {
@@ -114,6 +119,7 @@ FixedContextOnnxLabelScorer::FixedContextOnnxLabelScorer(Core::Configuration con
           loopUpdatesHistory_(paramLoopUpdatesHistory(config)),
           verticalLabelTransition_(paramVerticalLabelTransition(config)),
           maxBatchSize_(paramMaxBatchSize(config)),
+          batchedInputFeature_(false),
           scoreCache_() {
     Core::Configuration modelConfig(config, "onnx-model");
     auto                key = modelConfig.getSelection();
@@ -121,6 +127,9 @@ FixedContextOnnxLabelScorer::FixedContextOnnxLabelScorer(Core::Configuration con
     inputFeatureName_       = onnxModel_->mapping.getOnnxName("input-feature");
     historyName_            = onnxModel_->mapping.getOnnxName("history");
     scoresName_             = onnxModel_->mapping.getOnnxName("scores");
+
+    auto inputFeatureShape = onnxModel_->session.getInputShape(inputFeatureName_);
+    batchedInputFeature_   = not inputFeatureShape.empty() and inputFeatureShape.front() != 1;
 }
 
 void FixedContextOnnxLabelScorer::reset() {
@@ -271,10 +280,10 @@ std::vector<std::optional<ScoreAccessorRef>> FixedContextOnnxLabelScorer::getSco
             continue;
         }
 
-        std::vector<SeqStepScoringContextRef> contextBatch;
+        std::vector<InstanceContext> contextBatch;
         contextBatch.reserve(std::min(uniqueUncachedContexts.size(), maxBatchSize_));
         for (auto context : uniqueUncachedContexts) {
-            contextBatch.push_back(context);
+            contextBatch.emplace_back(this, context);
             if (contextBatch.size() == maxBatchSize_) {  // Batch is full -> forward now
                 forwardBatch(contextBatch);
                 contextBatch.clear();
@@ -297,44 +306,131 @@ std::optional<ScoreAccessorRef> FixedContextOnnxLabelScorer::getScoreAccessor(Sc
     return getScoreAccessors({scoringContext})[0];
 }
 
-void FixedContextOnnxLabelScorer::forwardBatch(std::vector<SeqStepScoringContextRef> const& scoringContextBatch) {
+void FixedContextOnnxLabelScorer::precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) {
+    verify(labelScorers.size() == scoringContexts.size());
+
+    /*
+     * Collect the unique uncached contexts of all instances and group them by instance and timestep
+     * since these share the same input feature
+     */
+    std::vector<std::vector<InstanceContext>> groups;
+    for (size_t instanceIdx = 0ul; instanceIdx < labelScorers.size(); ++instanceIdx) {
+        auto* scorer = dynamic_cast<FixedContextOnnxLabelScorer*>(labelScorers[instanceIdx]);
+        verify(scorer != nullptr);
+        if (scorer->onnxModel_ != onnxModel_) {
+            // Instances with a separately loaded model can't be merged; they compute their scores on demand
+            continue;
+        }
+
+        std::unordered_map<size_t, size_t>                                                 groupOfTimestep;
+        std::unordered_set<SeqStepScoringContextRef, ScoringContextHash, ScoringContextEq> uniqueUncachedContexts;
+        for (auto const& scoringContext : scoringContexts[instanceIdx]) {
+            SeqStepScoringContextRef seqStepScoringContext(dynamic_cast<SeqStepScoringContext const*>(scoringContext.get()));
+            if (not scorer->getInput(seqStepScoringContext->currentStep)) {
+                continue;
+            }
+            if (scorer->scoreCache_.find(seqStepScoringContext) != scorer->scoreCache_.end() or not uniqueUncachedContexts.insert(seqStepScoringContext).second) {
+                continue;
+            }
+
+            auto [it, inserted] = groupOfTimestep.emplace(seqStepScoringContext->currentStep, groups.size());
+            if (inserted) {
+                groups.emplace_back();
+            }
+            groups[it->second].emplace_back(scorer, seqStepScoringContext);
+        }
+    }
+
+    if (not batchedInputFeature_) {
+        // Each input feature needs its own session runs
+        for (auto const& group : groups) {
+            for (size_t batchStart = 0ul; batchStart < group.size(); batchStart += maxBatchSize_) {
+                auto batchBegin = group.begin() + batchStart;
+                auto batchEnd   = batchBegin + std::min(maxBatchSize_, group.size() - batchStart);
+                forwardBatch(std::vector<InstanceContext>(batchBegin, batchEnd));
+            }
+        }
+        return;
+    }
+
+    // Merge all groups into joint batches
+    std::vector<InstanceContext> contextBatch;
+    for (auto const& group : groups) {
+        for (auto const& request : group) {
+            contextBatch.push_back(request);
+            if (contextBatch.size() == maxBatchSize_) {
+                forwardBatch(contextBatch);
+                contextBatch.clear();
+            }
+        }
+    }
+    forwardBatch(contextBatch);
+}
+
+void FixedContextOnnxLabelScorer::forwardBatch(std::vector<InstanceContext> const& scoringContextBatch) {
     if (scoringContextBatch.empty()) {
         return;
     }
+    TRACE_SCOPE("nn", "label-scorer-batch");
+    TRACE_COUNTER("nn", "label-scorer-batch-size", scoringContextBatch.size());
 
     /*
      * Create session inputs
      */
-
-    // All requests in this iteration share the same input feature which is set up here
-    auto                 inputFeatureDataView = getInput(scoringContextBatch.front()->currentStep);
-    f32 const*           inputFeatureData     = inputFeatureDataView->data();
-    std::vector<int64_t> inputFeatureShape    = {1ul, static_cast<int64_t>(inputFeatureDataView->size())};
+    auto const& [firstScorer, firstContext] = scoringContextBatch.front();
+
+    bool sharedInput = std::all_of(
+            scoringContextBatch.begin(),
+            scoringContextBatch.end(),
+            [&](auto const& request) { return request.first == firstScorer and request.second->currentStep == firstContext->currentStep; });
+    verify(sharedInput or batchedInputFeature_);
+
+    Onnx::Value inputFeature;
+    auto        sharedInputDataView = firstScorer->getInput(firstContext->currentStep);
+    if (sharedInput) {
+        // All requests in this batch share the same input feature which is bound without copying
+        std::vector<int64_t> inputFeatureShape = {1ul, static_cast<int64_t>(sharedInputDataView->size())};
+        inputFeature                           = Onnx::Value::createView(sharedInputDataView->data(), inputFeatureShape);
+    }
+    else {
+        // Stack the input features of the individual requests
+        size_t featureDim = firstScorer->getInput(firstContext->currentStep)->size();
+        inputFeature      = Onnx::Value::createEmpty<f32>({static_cast<int64_t>(scoringContextBatch.size()), static_cast<int64_t>(featureDim)});
+        for (size_t b = 0ul; b < scoringContextBatch.size(); ++b) {
+            auto const& [scorer, context] = scoringContextBatch[b];
+
+            auto inputFeatureDataView = scorer->getInput(context->currentStep);
+            verify(inputFeatureDataView->size() == featureDim);
+            std::copy(inputFeatureDataView->data(), inputFeatureDataView->data() + featureDim, inputFeature.data<f32>(b));
+        }
+    }
 
     // Create batched context input
     Math::FastMatrix<s32> historyMat(historyLength_, scoringContextBatch.size());
     for (size_t b = 0ul; b < scoringContextBatch.size(); ++b) {
-        auto context = scoringContextBatch[b];
+        auto const& context = scoringContextBatch[b].second;
         std::copy(context->labelSeq.begin(), context->labelSeq.end(), &(historyMat.at(0, b)));  // Pointer to first element in column b
     }
 
     std::vector<std::pair<std::string, Onnx::Value>> sessionInputs;
-    sessionInputs.emplace_back(inputFeatureName_, Onnx::Value::create(inputFeatureData, inputFeatureShape));
+    sessionInputs.emplace_back(inputFeatureName_, std::move(inputFeature));
     sessionInputs.emplace_back(historyName_, Onnx::Value::create(historyMat, true));
 
     /*
      * Run session
      */
     std::vector<Onnx::Value> sessionOutputs;
-    onnxModel_->session.run(std::move(sessionInputs), {scoresName_}, sessionOutputs);
+    onnxModel_->session.runWithReusedOutputs(sessionInputs, {scoresName_}, sessionOutputs);
 
     /*
-     * Put resulting scores into cache map
+     * Put resulting scores into the cache maps of the owning instances
      */
     for (size_t b = 0ul; b < scoringContextBatch.size(); ++b) {
+        auto const& [scorer, context] = scoringContextBatch[b];
+
         auto scoreVec = std::make_shared<std::vector<Score>>();
         sessionOutputs.front().get(b, *scoreVec);
-        scoreCache_.emplace(scoringContextBatch[b], scoreVec);
+        scorer->scoreCache_.emplace(context, scoreVec);
     }
 }
 
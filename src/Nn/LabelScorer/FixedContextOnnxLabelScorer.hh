@@ -81,13 +81,20 @@ public:
     // Uses `getScoreAccessors` internally with some wrapping for vector packing/expansion
     std::optional<ScoreAccessorRef> getScoreAccessor(ScoringContextRef scoringContext) override;
 
+    // Forward the uncached contexts of all instances that share the ONNX model of this scorer. If the model accepts
+    // one input feature per batch entry, contexts of different instances and timesteps are merged into joint batches.
+    void precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) override;
+
 protected:
     size_t getMinActiveInputIndex(Core::CollapsedVector<ScoringContextRef> const& activeContexts) const override;
 
 private:
-    // Forward a batch of histories through the ONNX model and put the resulting scores into the score cache
-    // Assumes that all histories in the batch are based on the same timestep
-    void forwardBatch(std::vector<SeqStepScoringContextRef> const& scoringContextBatch);
+    // Pair of the scorer instance that owns the context (and thus the input buffer and score cache) and the context itself
+    typedef std::pair<FixedContextOnnxLabelScorer*, SeqStepScoringContextRef> InstanceContext;
+
+    // Forward a batch of histories through the ONNX model and put the resulting scores into the score caches of the owning instances.
+    // If all histories in the batch are based on the same input, it is passed only once; otherwise one input feature per history is passed.
+    void forwardBatch(std::vector<InstanceContext> const& scoringContextBatch);
 
     size_t startLabelIndex_;
     size_t historyLength_;
@@ -96,6 +103,7 @@ private:
     bool   loopUpdatesHistory_;
     bool   verticalLabelTransition_;
     size_t maxBatchSize_;
+    bool   batchedInputFeature_;  // Whether the model accepts one input feature per history instead of a single shared one
 
     std::shared_ptr<Onnx::Model> onnxModel_;
 
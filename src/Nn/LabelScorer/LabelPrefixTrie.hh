@@ -0,0 +1,152 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef LABEL_PREFIX_TRIE_HH
+#define LABEL_PREFIX_TRIE_HH
+
+#include <unordered_map>
+
+#include <Core/Assertions.hh>
+#include <Core/Hash.hh>
+#include <Core/MurmurHash.hh>
+#include <Core/ReferenceCounting.hh>
+
+#include "Types.hh"
+
+namespace Nn {
+
+/*
+ * Node of a trie over label sequences which is used as context store by label scorers with label-history dependent states.
+ * Every node represents the label sequence on the path from the root to it and owns a payload (e.g. hidden state and scores)
+ * that belongs to this label sequence.
+ *
+ * A node holds a strong reference to its parent and only weak references to its children. So a node is alive exactly as long
+ * as it is referenced from outside the trie or one of its descendants is. Since extending a node by a label returns the
+ * existing child while it is alive, two alive nodes represent the same label sequence if and only if they are identical.
+ * Extending, hashing and comparing label histories is therefore O(1) instead of linear in the sequence length.
+ *
+ * Ancestors are kept alive by their descendants, but their payload is usually not needed anymore. Therefore nodes additionally
+ * count their users (i.e. the scoring contexts referring to them, see `acquire` and `release`) and call `Payload::release`
+ * once the last user is gone. The payload decides what it gives up in that case; it is refilled by the label scorer if the node
+ * is used again later.
+ */
+template<typename Payload>
+class LabelPrefixNode : public Core::ReferenceCounted {
+public:
+    typedef Core::Ref<LabelPrefixNode> Ref;
+
+    Payload payload;
+
+    // Create a root node which represents the empty label sequence
+    LabelPrefixNode();
+    ~LabelPrefixNode();
+
+    // Return the node for this node's label sequence extended by `label`. It is created if there is no alive one yet.
+    Ref extended(LabelIndex label);
+
+    // Parent node; nullptr for the root
+    LabelPrefixNode* parent() const {
+        return parent_.get();
+    }
+
+    // Last label of the represented label sequence; invalid for the root
+    LabelIndex label() const {
+        return label_;
+    }
+
+    // Length of the represented label sequence
+    size_t length() const {
+        return length_;
+    }
+
+    // Hash of the represented label sequence. It doesn't depend on node addresses so that it is reproducible across runs.
+    size_t hash() const {
+        return hash_;
+    }
+
+    size_t numChildren() const {
+        return children_.size();
+    }
+
+    void acquire() {
+        ++numUsers_;
+    }
+
+    void release() {
+        verify(numUsers_ > 0u);
+        if (--numUsers_ == 0u) {
+            payload.release();
+        }
+    }
+
+    u32 numUsers() const {
+        return numUsers_;
+    }
+
+private:
+    LabelPrefixNode(Ref const& parent, LabelIndex label);
+
+    Ref                                              parent_;
+    LabelIndex                                       label_;
+    size_t                                           length_;
+    size_t                                           hash_;
+    u32                                              numUsers_;
+    std::unordered_map<LabelIndex, LabelPrefixNode*> children_;
+};
+
+template<typename Payload>
+LabelPrefixNode<Payload>::LabelPrefixNode()
+        : payload(),
+          parent_(),
+          label_(invalidLabelIndex),
+          length_(0ul),
+          hash_(0x78b174eb),
+          numUsers_(0u),
+          children_() {}
+
+template<typename Payload>
+LabelPrefixNode<Payload>::LabelPrefixNode(Ref const& parent, LabelIndex label)
+        : payload(),
+          parent_(parent),
+          label_(label),
+          length_(parent->length_ + 1ul),
+          hash_(Core::combineHashes(parent->hash_, Core::MurmurHash3_x64_64(&label, sizeof(LabelIndex), 0x78b174eb))),
+          numUsers_(0u),
+          children_() {}
+
+template<typename Payload>
+LabelPrefixNode<Payload>::~LabelPrefixNode() {
+    // Children hold a strong reference to this node, so they are all gone by now
+    verify(children_.empty());
+    if (parent_) {
+        parent_->children_.erase(label_);
+    }
+}
+
+template<typename Payload>
+typename LabelPrefixNode<Payload>::Ref LabelPrefixNode<Payload>::extended(LabelIndex label) {
+    auto it = children_.find(label);
+    if (it != children_.end()) {
+        return Ref(it->second);
+    }
+
+    Ref child(new LabelPrefixNode(Core::ref(this), label));
+    children_.emplace(label, child.get());
+    return child;
+}
+
+}  // namespace Nn
+
+#endif  // LABEL_PREFIX_TRIE_HH
@@ -117,6 +117,14 @@ public:
     // Returns std::nullopt for a context if the LabelScorer is not ready to score it yet
     virtual std::vector<std::optional<ScoreAccessorRef>> getScoreAccessors(std::vector<ScoringContextRef> const& scoringContexts);
 
+    // Compute the scores for contexts of several independent instances of this LabelScorer (e.g. one instance per stream
+    // of a multi-stream search) with merged model calls and cache them inside the respective instances, so that
+    // subsequent `getScoreAccessors` calls of each instance can be served without further computation.
+    // `labelScorers[i]` must be of the same type and configuration as this scorer and `scoringContexts[i]` must
+    // be contexts of `labelScorers[i]`. This scorer is expected to be contained in `labelScorers`.
+    // By default nothing is precomputed and each instance computes its scores on demand.
+    virtual void precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) {}
+
     // Check whether the given transition type can be scored by this LabelScorer
     inline bool scoresTransition(TransitionType transitionType) const {
         return enabledTransitions_.contains(transitionType);
@@ -16,6 +16,9 @@
 #include "NoContextOnnxLabelScorer.hh"
 
 #include <unordered_set>
+
+#include <Core/Tracing.hh>
+
 #include "ScoreAccessor.hh"
 
 namespace Nn {
@@ -39,12 +42,18 @@ static const std::vector<Onnx::IOSpecification> ioSpec = {
 NoContextOnnxLabelScorer::NoContextOnnxLabelScorer(Core::Configuration const& config, ModelCache& modelCache)
         : Core::Component(config),
           Precursor(config, TransitionPresetType::CTC),
+          maxBatchSize_(Core::Type<size_t>::max),
           scoreCache_() {
     Core::Configuration modelConfig(config, "onnx-model");
     auto                key = modelConfig.getSelection();
     onnxModel_              = modelCache.getOrCreate<Onnx::Model>(key, modelConfig, ioSpec);
     inputFeatureName_       = onnxModel_->mapping.getOnnxName("input-feature");
     scoresName_             = onnxModel_->mapping.getOnnxName("scores");
+
+    auto inputFeatureShape = onnxModel_->session.getInputShape(inputFeatureName_);
+    if (not inputFeatureShape.empty() and inputFeatureShape.front() == 1) {
+        maxBatchSize_ = 1ul;
+    }
 }
 
 void NoContextOnnxLabelScorer::reset() {
@@ -93,15 +102,34 @@ std::vector<std::optional<ScoreAccessorRef>> NoContextOnnxLabelScorer::getScoreA
 
     std::vector<std::optional<ScoreAccessorRef>> scoreAccessors(scoringContexts.size(), std::nullopt);
 
-    for (size_t contextIndex = 0ul; contextIndex < scoringContexts.size(); ++contextIndex) {
-        StepScoringContextRef stepScoringContext(dynamic_cast<StepScoringContext const*>(scoringContexts[contextIndex].get()));
+    std::vector<StepScoringContextRef> stepScoringContexts;
+    stepScoringContexts.reserve(scoringContexts.size());
+    for (auto const& scoringContext : scoringContexts) {
+        stepScoringContexts.push_back(Core::ref(dynamic_cast<StepScoringContext const*>(scoringContext.get())));
+    }
+
+    /*
+     * Collect all unique contexts that are not cached yet and forward them together
+     */
+    std::unordered_set<StepScoringContextRef, ScoringContextHash, ScoringContextEq> uniqueUncachedContexts;
+    std::vector<InstanceContext>                                                    requests;
+    for (auto const& stepScoringContext : stepScoringContexts) {
         if (not getInput(stepScoringContext->currentStep)) {
             // If input is not available, this context can't be forwarded
             continue;
         }
-        forwardContext(stepScoringContext);
+        if (scoreCache_.find(stepScoringContext) == scoreCache_.end() and uniqueUncachedContexts.insert(stepScoringContext).second) {
+            requests.emplace_back(this, stepScoringContext);
+        }
+    }
+    forwardBatch(requests);
 
-        scoreAccessors[contextIndex] = Core::ref(new VectorScoreAccessor(scoreCache_.at(stepScoringContext), stepScoringContext->currentStep));
+    for (size_t contextIndex = 0ul; contextIndex < stepScoringContexts.size(); ++contextIndex) {
+        auto const& stepScoringContext = stepScoringContexts[contextIndex];
+        auto        cacheIt            = scoreCache_.find(stepScoringContext);
+        if (cacheIt != scoreCache_.end()) {
+            scoreAccessors[contextIndex] = Core::ref(new VectorScoreAccessor(cacheIt->second, stepScoringContext->currentStep));
+        }
     }
 
     return scoreAccessors;
@@ -111,28 +139,79 @@ std::optional<ScoreAccessorRef> NoContextOnnxLabelScorer::getScoreAccessor(Scori
     return getScoreAccessors({scoringContext})[0];
 }
 
-void NoContextOnnxLabelScorer::forwardContext(StepScoringContextRef const& scoringContext) {
-    /*
-     * Create session inputs
-     */
-    auto                 inputDataView = getInput(scoringContext->currentStep);
-    f32 const*           inputData     = inputDataView->data();
-    std::vector<int64_t> inputShape    = {1ul, static_cast<int64_t>(inputDataView->size())};
+void NoContextOnnxLabelScorer::precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) {
+    verify(labelScorers.size() == scoringContexts.size());
 
-    std::vector<std::pair<std::string, Onnx::Value>> sessionInputs;
-    sessionInputs.emplace_back(inputFeatureName_, Onnx::Value::create(inputData, inputShape));
+    std::vector<InstanceContext> requests;
+    for (size_t instanceIdx = 0ul; instanceIdx < labelScorers.size(); ++instanceIdx) {
+        auto* scorer = dynamic_cast<NoContextOnnxLabelScorer*>(labelScorers[instanceIdx]);
+        verify(scorer != nullptr);
+        if (scorer->onnxModel_ != onnxModel_) {
+            // Instances with a separately loaded model can't be merged; they compute their scores on demand
+            continue;
+        }
 
-    /*
-     * Run session
-     */
-    std::vector<Onnx::Value> sessionOutputs;
-    onnxModel_->session.run(std::move(sessionInputs), {scoresName_}, sessionOutputs);
+        std::unordered_set<StepScoringContextRef, ScoringContextHash, ScoringContextEq> uniqueUncachedContexts;
+        for (auto const& scoringContext : scoringContexts[instanceIdx]) {
+            StepScoringContextRef stepScoringContext(dynamic_cast<StepScoringContext const*>(scoringContext.get()));
+            if (not scorer->getInput(stepScoringContext->currentStep)) {
+                continue;
+            }
+            if (scorer->scoreCache_.find(stepScoringContext) == scorer->scoreCache_.end() and uniqueUncachedContexts.insert(stepScoringContext).second) {
+                requests.emplace_back(scorer, stepScoringContext);
+            }
+        }
+    }
 
-    /*
-     * Put resulting scores into cache map
-     */
-    auto scoreVec = std::make_shared<std::vector<Score>>();
-    sessionOutputs.front().get(0, *scoreVec);
-    scoreCache_.emplace(scoringContext, scoreVec);
+    forwardBatch(requests);
+}
+
+void NoContextOnnxLabelScorer::forwardBatch(std::vector<InstanceContext> const& requests) {
+    for (size_t batchStart = 0ul; batchStart < requests.size(); batchStart += maxBatchSize_) {
+        size_t batchSize = std::min(maxBatchSize_, requests.size() - batchStart);
+        TRACE_SCOPE("nn", "label-scorer-batch");
+        TRACE_COUNTER("nn", "label-scorer-batch-size", batchSize);
+
+        /*
+         * Create session inputs by stacking the input features of all requests
+         */
+        auto        firstInputDataView = requests[batchStart].first->getInput(requests[batchStart].second->currentStep);
+        size_t      featureDim         = firstInputDataView->size();
+        Onnx::Value inputFeature;
+        if (batchSize == 1ul) {
+            // A single input feature can be bound without copying
+            inputFeature = Onnx::Value::createView(firstInputDataView->data(), {1l, static_cast<int64_t>(featureDim)});
+        }
+        else {
+            inputFeature = Onnx::Value::createEmpty<f32>({static_cast<int64_t>(batchSize), static_cast<int64_t>(featureDim)});
+            for (size_t b = 0ul; b < batchSize; ++b) {
+                auto const& [scorer, scoringContext] = requests[batchStart + b];
+
+                auto inputDataView = scorer->getInput(scoringContext->currentStep);
+                verify(inputDataView->size() == featureDim);
+                std::copy(inputDataView->data(), inputDataView->data() + featureDim, inputFeature.data<f32>(b));
+            }
+        }
+
+        std::vector<std::pair<std::string, Onnx::Value>> sessionInputs;
+        sessionInputs.emplace_back(inputFeatureName_, std::move(inputFeature));
+
+        /*
+         * Run session
+         */
+        std::vector<Onnx::Value> sessionOutputs;
+        onnxModel_->session.runWithReusedOutputs(sessionInputs, {scoresName_}, sessionOutputs);
+
+        /*
+         * Put resulting scores into the cache maps of the owning instances
+         */
+        for (size_t b = 0ul; b < batchSize; ++b) {
+            auto const& [scorer, scoringContext] = requests[batchStart + b];
+
+            auto scoreVec = std::make_shared<std::vector<Score>>();
+            sessionOutputs.front().get(b, *scoreVec);
+            scorer->scoreCache_.emplace(scoringContext, scoreVec);
+        }
+    }
 }
 }  // namespace Nn
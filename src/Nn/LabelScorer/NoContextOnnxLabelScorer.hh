@@ -58,6 +58,9 @@ public:
     // Uses `getScoreAccessors` internally with some wrapping for vector packing/expansion
     std::optional<ScoreAccessorRef> getScoreAccessor(ScoringContextRef scoringContext) override;
 
+    // Forward the uncached contexts of all instances that share the ONNX model of this scorer in joint batches
+    void precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) override;
+
 protected:
     size_t getMinActiveInputIndex(Core::CollapsedVector<ScoringContextRef> const& activeContexts) const override;
 
@@ -67,9 +70,16 @@ private:
     std::string inputFeatureName_;
     std::string scoresName_;
 
+    size_t maxBatchSize_;  // 1 if the model does not have a dynamic batch axis
+
     std::unordered_map<StepScoringContextRef, std::shared_ptr<std::vector<Score>>, ScoringContextHash, ScoringContextEq> scoreCache_;
 
-    void forwardContext(StepScoringContextRef const& scoringContext);
+    // Pair of the scorer instance that owns the context (and thus the input buffer and score cache) and the context itself
+    typedef std::pair<NoContextOnnxLabelScorer*, StepScoringContextRef> InstanceContext;
+
+    // Forward the input features of all requests through the ONNX model in batches of at most `maxBatchSize_`
+    // and put the resulting scores into the score caches of the owning instances
+    void forwardBatch(std::vector<InstanceContext> const& requests);
 };
 
 }  // namespace Nn
@@ -129,4 +129,15 @@ std::vector<std::optional<ScoreAccessorRef>> ScaledLabelScorer::getScoreAccessor
     return result;
 }
 
+void ScaledLabelScorer::precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) {
+    std::vector<LabelScorer*> subScorers;
+    subScorers.reserve(labelScorers.size());
+    for (auto* labelScorer : labelScorers) {
+        auto* scaledScorer = dynamic_cast<ScaledLabelScorer*>(labelScorer);
+        verify(scaledScorer != nullptr);
+        subScorers.push_back(scaledScorer->scorer_.get());
+    }
+    scorer_->precomputeScores(subScorers, scoringContexts);
+}
+
 }  // namespace Nn
@@ -68,6 +68,9 @@ public:
     // Score accessor wrapper that scales the scores
     std::vector<std::optional<ScoreAccessorRef>> getScoreAccessors(std::vector<ScoringContextRef> const& scoringContexts) override;
 
+    // Precompute with the sub-scorers of all given instances
+    void precomputeScores(std::vector<LabelScorer*> const& labelScorers, std::vector<std::vector<ScoringContextRef>> const& scoringContexts) override;
+
 private:
     Core::Ref<LabelScorer> scorer_;
     Score                  scale_;
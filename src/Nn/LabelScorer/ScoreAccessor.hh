@@ -16,6 +16,7 @@
 #ifndef SCORE_ACCESSOR_HH
 #define SCORE_ACCESSOR_HH
 
+#include <optional>
 #include <span>
 
 #include <Core/ReferenceCounting.hh>
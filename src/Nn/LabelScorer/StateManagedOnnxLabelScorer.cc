@@ -15,6 +15,7 @@
 
 #include "StateManagedOnnxLabelScorer.hh"
 
+#include <Core/Tracing.hh>
 #include <Nn/Module.hh>
 
 #include "ScoreAccessor.hh"
@@ -25,17 +26,21 @@
  */
 namespace Nn {
 
-StateManagedOnnxScoringContext::StateManagedOnnxScoringContext(HistoryState&& initialState)
-        : labelSeq(),
-          parent(),
-          state(std::make_shared<HistoryState>(std::move(initialState))) {
+void StateManagedOnnxPayload::release() {
+    scores.reset();
+    prefixState.reset();
+    if (not retainState) {
+        state.reset();
+    }
+}
+
+StateManagedOnnxScoringContext::StateManagedOnnxScoringContext(StateManagedOnnxNode::Ref const& node)
+        : node(node) {
+    node->acquire();
 }
 
-StateManagedOnnxScoringContext::StateManagedOnnxScoringContext(std::vector<LabelIndex>&&                       labelSeq,
-                                                               Core::Ref<StateManagedOnnxScoringContext const> parent)
-        : labelSeq(std::move(labelSeq)),
-          parent(parent),
-          state() {
+StateManagedOnnxScoringContext::~StateManagedOnnxScoringContext() {
+    node->release();
 }
 
 bool StateManagedOnnxScoringContext::isEqual(ScoringContextRef const& other) const {
@@ -45,11 +50,12 @@ bool StateManagedOnnxScoringContext::isEqual(ScoringContextRef const& other) con
         return false;
     }
 
-    return labelSeqEqual(labelSeq, otherPtr->labelSeq);
+    // Nodes of the label-prefix trie are unique per label history
+    return node == otherPtr->node;
 }
 
 size_t StateManagedOnnxScoringContext::hash() const {
-    return labelSeqHash(labelSeq);
+    return node->hash();
 }
 
 static const std::vector<Onnx::IOSpecification> ioSpec = {
@@ -130,11 +136,6 @@ const Core::ParameterInt StateManagedOnnxLabelScorer::paramMaxBatchSize(
         "Max number of scoring contexts that can be fed into the ONNX model at once.",
         Core::Type<int>::max);
 
-const Core::ParameterInt StateManagedOnnxLabelScorer::paramMaxCachedScores(
-        "max-cached-score-vectors",
-        "Maximum size of cache that maps scoring contexts to scores and state slices. This prevents memory overflow in case of very long audio segments.",
-        10000);
-
 StateManagedOnnxLabelScorer::StateManagedOnnxLabelScorer(Core::Configuration const& config, ModelCache& modelCache)
         : Core::Component(config),
           Precursor(config, TransitionPresetType::LM),
@@ -146,8 +147,7 @@ StateManagedOnnxLabelScorer::StateManagedOnnxLabelScorer(Core::Configuration con
           stateVectorFactory_(Module::instance().createCompressedVectorFactory(select("state-compression"))),
           encoderStatesValue_(),
           encoderStatesSizeValue_(),
-          scoreCache_(paramMaxCachedScores(config)),
-          stateCache_(scoreCache_.maxSize()) {
+          rootNode_() {
     Core::Configuration modelConfig(config, "onnx-model");
     auto                key = modelConfig.getSelection();
     onnxModel_              = modelCache.getOrCreate<Onnx::Model>(key, modelConfig, ioSpec);
@@ -168,8 +168,7 @@ void StateManagedOnnxLabelScorer::reset() {
     Precursor::reset();
     encoderStatesValue_     = Onnx::Value();
     encoderStatesSizeValue_ = Onnx::Value();
-    scoreCache_.clear();
-    stateCache_.clear();
+    rootNode_.reset();
 }
 
 void StateManagedOnnxLabelScorer::addInput(DataView const& input) {
@@ -179,18 +178,25 @@ void StateManagedOnnxLabelScorer::addInput(DataView const& input) {
 }
 
 ScoringContextRef StateManagedOnnxLabelScorer::getInitialScoringContext() {
-    auto rootState = stateManager_->initialState(stateVariables_, *stateVectorFactory_);
-    if (rootState.empty()) {
-        error("Initial recurrent state is empty.");
-    }
+    if (not rootNode_) {
+        auto rootState = stateManager_->initialState(stateVariables_, *stateVectorFactory_);
+        if (rootState.empty()) {
+            error("Initial recurrent state is empty.");
+        }
 
-    auto context = Core::ref(new StateManagedOnnxScoringContext(std::move(rootState)));
+        rootNode_                      = Core::ref(new StateManagedOnnxNode());
+        rootNode_->payload.state       = std::make_shared<HistoryState>(std::move(rootState));
+        rootNode_->payload.retainState = true;
+    }
 
+    ScoringContextRef context = Core::ref(new StateManagedOnnxScoringContext(rootNode_));
     for (auto const label : startLabels_) {
-        std::vector<LabelIndex> labelSeq(context->labelSeq);
-        labelSeq.push_back(label);
-        context = Core::ref(new StateManagedOnnxScoringContext(std::move(labelSeq), context));
-        cacheStatesAndScores({context});
+        context = extendedScoringContext(context, label, TransitionType::LABEL_TO_LABEL);
+
+        StateManagedOnnxScoringContextRef startContext(dynamic_cast<StateManagedOnnxScoringContext const*>(context.get()));
+        if (not startContext->node->payload.state) {
+            cacheStatesAndScores({startContext});
+        }
     }
     return context;
 }
@@ -232,9 +238,14 @@ ScoringContextRef StateManagedOnnxLabelScorer::extendedScoringContext(ScoringCon
     StateManagedOnnxScoringContextRef context(dynamic_cast<StateManagedOnnxScoringContext const*>(scoringContext.get()));
     verify(context);
 
-    std::vector<LabelIndex> labelSeq(context->labelSeq);
-    labelSeq.push_back(nextToken);
-    return Core::ref(new StateManagedOnnxScoringContext(std::move(labelSeq), context));
+    auto const& node    = context->node;
+    auto        newNode = node->extended(nextToken);
+    if (not newNode->payload.state) {
+        // Keep the parent state alive until the state of the new history is computed
+        newNode->payload.prefixState = node->payload.state;
+        newNode->payload.retainState = stateManager_->requiresAllParentStates();
+    }
+    return Core::ref(new StateManagedOnnxScoringContext(newNode));
 }
 
 std::vector<std::optional<ScoreAccessorRef>> StateManagedOnnxLabelScorer::getScoreAccessors(std::vector<ScoringContextRef> const& scoringContexts) {
@@ -254,16 +265,13 @@ std::vector<std::optional<ScoreAccessorRef>> StateManagedOnnxLabelScorer::getSco
     for (auto const& scoringContext : scoringContexts) {
         StateManagedOnnxScoringContextRef context(dynamic_cast<StateManagedOnnxScoringContext const*>(scoringContext.get()));
         verify(context);
-        if (not context->state and stateCache_.contains(context)) {
-            context->state = *stateCache_.get(context);
-        }
-        else {
+        if (not context->node->payload.scores) {
             uniqueUncachedScoringContexts.emplace(context);
         }
     }
 
     /*
-     * Fill state and score caches for all uncached scoring contexts
+     * Compute states and scores for all uncached scoring contexts
      */
     std::vector<StateManagedOnnxScoringContextRef> scoringContextBatch;
     scoringContextBatch.reserve(std::min(uniqueUncachedScoringContexts.size(), maxBatchSize_));
@@ -277,13 +285,13 @@ std::vector<std::optional<ScoreAccessorRef>> StateManagedOnnxLabelScorer::getSco
     cacheStatesAndScores(scoringContextBatch);
 
     /*
-     * Assign scores from cache to result vector
+     * Assign scores from the trie nodes to result vector
      */
     for (size_t i = 0ul; i < scoringContexts.size(); ++i) {
         StateManagedOnnxScoringContextRef context(dynamic_cast<StateManagedOnnxScoringContext const*>(scoringContexts[i].get()));
-        auto                              scores = scoreCache_.get(context);
-        verify(scores);
-        scoreAccessors[i] = Core::ref(new VectorScoreAccessor(scores->get(), context->labelSeq.empty() ? 0ul : context->labelSeq.size() - 1ul));
+        auto const&                       node = context->node;
+        verify(node->payload.scores);
+        scoreAccessors[i] = Core::ref(new VectorScoreAccessor(node->payload.scores, node->length() == 0ul ? 0ul : node->length() - 1ul));
     }
 
     return scoreAccessors;
@@ -325,6 +333,8 @@ void StateManagedOnnxLabelScorer::cacheStatesAndScores(std::vector<StateManagedO
     if (scoringContextBatch.empty()) {
         return;
     }
+    TRACE_SCOPE("nn", "label-scorer-batch");
+    TRACE_COUNTER("nn", "label-scorer-batch-size", scoringContextBatch.size());
 
     // Can't score before any encoder features are buffered; defer (mirrors the guard in getScoreAccessors()).
     if ((not encoderStatesName_.empty() or not encoderStatesSizeName_.empty()) and bufferSize() == 0ul) {
@@ -338,22 +348,27 @@ void StateManagedOnnxLabelScorer::cacheStatesAndScores(std::vector<StateManagedO
 
     // Fill in prefix states
     for (auto const& context : scoringContextBatch) {
-        auto parent = context->parent;
+        auto const& node   = context->node;
+        auto const* parent = node->parent();
+        verify(parent);
 
         if (stateManager_->requiresAllParentStates()) {
-            size_t prefixLength = parent->labelSeq.size();
+            // Ancestors retain their states as long as they have descendants
+            size_t prefixLength = parent->length();
             prefixLengths.push_back(prefixLength);
             prefixStates.resize(prefixStates.size() + prefixLength);
 
             size_t offset = prefixStates.size() - prefixLength;
             for (size_t i = 0ul; i < prefixLength; ++i) {
-                prefixStates[offset + prefixLength - i - 1] = parent->state.get();
-                parent                                      = parent->parent;
+                prefixStates[offset + prefixLength - i - 1] = parent->payload.state.get();
+                parent                                      = parent->parent();
             }
         }
         else {
-            prefixLengths.push_back(parent->labelSeq.size());
-            prefixStates.push_back(parent->state.get());
+            auto const& prefixState = node->payload.prefixState ? node->payload.prefixState : parent->payload.state;
+            verify(prefixState);
+            prefixLengths.push_back(parent->length());
+            prefixStates.push_back(prefixState.get());
         }
     }
 
@@ -363,7 +378,7 @@ void StateManagedOnnxLabelScorer::cacheStatesAndScores(std::vector<StateManagedO
 
     Math::FastMatrix<s32> tokens(scoringContextBatch.size(), 1);
     for (size_t i = 0ul; i < scoringContextBatch.size(); ++i) {
-        tokens.at(i, 0) = static_cast<s32>(scoringContextBatch[i]->labelSeq.back());
+        tokens.at(i, 0) = static_cast<s32>(scoringContextBatch[i]->node->label());
     }
     inputs.emplace_back(tokenName_, Onnx::Value::create(tokens));
     inputs.emplace_back(tokenLengthName_, Onnx::Value::create(std::vector<s32>(scoringContextBatch.size(), 1)));  // All suffix lengths are 1
@@ -389,7 +404,7 @@ void StateManagedOnnxLabelScorer::cacheStatesAndScores(std::vector<StateManagedO
     for (size_t b = 0ul; b < scoringContextBatch.size(); ++b) {
         auto scores = std::make_shared<std::vector<Score>>();
         outputs.front().get(b, 0, *scores);
-        scoreCache_.put(scoringContextBatch[b], scores);
+        scoringContextBatch[b]->node->payload.scores = scores;
     }
 
     std::vector<Onnx::Value> stateOutputs(std::make_move_iterator(outputs.begin() + 1), std::make_move_iterator(outputs.end()));
@@ -397,11 +412,9 @@ void StateManagedOnnxLabelScorer::cacheStatesAndScores(std::vector<StateManagedO
     auto                     splitStates = stateManager_->splitStates(stateVariables_, suffixLengths, stateOutputs, *stateVectorFactory_);
     verify_eq(splitStates.size(), scoringContextBatch.size());
     for (size_t i = 0ul; i < scoringContextBatch.size(); ++i) {
-        scoringContextBatch[i]->state = std::make_shared<HistoryState>(std::move(splitStates[i]));
-        stateCache_.put(scoringContextBatch[i], scoringContextBatch[i]->state);
-        if (not stateManager_->requiresAllParentStates()) {
-            scoringContextBatch[i]->parent.reset();
-        }
+        auto& payload = scoringContextBatch[i]->node->payload;
+        payload.state = std::make_shared<HistoryState>(std::move(splitStates[i]));
+        payload.prefixState.reset();
     }
 }
 
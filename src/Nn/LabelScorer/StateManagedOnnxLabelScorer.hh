@@ -16,31 +16,45 @@
 #ifndef STATE_MANAGED_ONNX_LABEL_SCORER_HH
 #define STATE_MANAGED_ONNX_LABEL_SCORER_HH
 
-#include <Core/FIFOCache.hh>
 #include <Onnx/Model.hh>
 
 #include "BufferedLabelScorer.hh"
+#include "LabelPrefixTrie.hh"
 #include "ModelCache.hh"
 #include "ScoringContext.hh"
 
 namespace Nn {
 
 /*
- * Scoring context for ONNX models with state managed by a StateManager.
+ * State slice and scores that belong to one label history.
  * The state stores only the slice produced for the most recent token.
  */
-struct StateManagedOnnxScoringContext : public ScoringContext {
+struct StateManagedOnnxPayload {
     using StateManager = AbstractStateManager<Onnx::Value, Onnx::OnnxStateVariable>;
     using HistoryState = StateManager::HistoryState;
 
-    std::vector<LabelIndex>                                 labelSeq;
-    mutable Core::Ref<StateManagedOnnxScoringContext const> parent;
+    std::shared_ptr<HistoryState>       state;
+    std::shared_ptr<HistoryState>       prefixState;  // State of the parent history, only kept until `state` is computed
+    std::shared_ptr<std::vector<Score>> scores;
+    bool                                retainState = false;  // Keep the state while descendants exist, e.g. if they need all parent states
+
+    // Drop scores (and the state unless it is retained) once no scoring context refers to the label history anymore
+    void release();
+};
+
+typedef LabelPrefixNode<StateManagedOnnxPayload> StateManagedOnnxNode;
 
-    mutable std::shared_ptr<HistoryState> state;
+/*
+ * Scoring context for ONNX models with state managed by a StateManager.
+ * It refers to a node in the label-prefix trie which stores the state slice.
+ */
+struct StateManagedOnnxScoringContext : public ScoringContext {
+    StateManagedOnnxNode::Ref node;
 
-    StateManagedOnnxScoringContext(HistoryState&& initialState);
-    StateManagedOnnxScoringContext(std::vector<LabelIndex>&&                       labelSeq,
-                                   Core::Ref<StateManagedOnnxScoringContext const> parent);
+    StateManagedOnnxScoringContext(StateManagedOnnxNode::Ref const& node);
+    StateManagedOnnxScoringContext(StateManagedOnnxScoringContext const&)            = delete;
+    StateManagedOnnxScoringContext& operator=(StateManagedOnnxScoringContext const&) = delete;
+    ~StateManagedOnnxScoringContext();
 
     bool   isEqual(ScoringContextRef const& other) const override;
     size_t hash() const override;
@@ -50,7 +64,7 @@ typedef Core::Ref<StateManagedOnnxScoringContext const> StateManagedOnnxScoringC
 
 /*
  * LabelScorer for ONNX models whose hidden-state management is done by a RASR StateManager.
- * Each scoring context stores only the state slice produced
+ * Each node of the label-prefix trie stores only the state slice produced
  * for its most recent token plus a parent pointer, which allows transformer KV caches to
  * be represented as a tree instead of duplicating the full prefix state per context.
  */
@@ -64,7 +78,6 @@ class StateManagedOnnxLabelScorer : public BufferedLabelScorer {
     static const Core::ParameterBool      paramSilenceUpdatesHistory;
     static const Core::ParameterBool      paramLoopUpdatesHistory;
     static const Core::ParameterInt       paramMaxBatchSize;
-    static const Core::ParameterInt       paramMaxCachedScores;
 
 public:
     StateManagedOnnxLabelScorer(Core::Configuration const& config, ModelCache& modelCache);
@@ -86,7 +99,7 @@ private:
     void setupEncoderStatesValue();
     void setupEncoderStatesSizeValue();
 
-    // Forward a batch of scoringContexts through the ONNX model and put the resulting states and scores into the caches
+    // Forward a batch of scoringContexts through the ONNX model and store the resulting states and scores in their trie nodes
     void cacheStatesAndScores(std::vector<StateManagedOnnxScoringContextRef> const& scoringContextBatch);
 
     std::vector<size_t> startLabels_;
@@ -111,8 +124,8 @@ private:
     Onnx::Value encoderStatesValue_;
     Onnx::Value encoderStatesSizeValue_;
 
-    Core::FIFOCache<StateManagedOnnxScoringContextRef, std::shared_ptr<std::vector<Score>>, ScoringContextHash, ScoringContextEq> scoreCache_;
-    Core::FIFOCache<StateManagedOnnxScoringContextRef, std::shared_ptr<HistoryState>, ScoringContextHash, ScoringContextEq>       stateCache_;
+    // Root of the label-prefix trie which stores states and scores of all label histories that are still in use
+    StateManagedOnnxNode::Ref rootNode_;
 };
 
 }  // namespace Nn
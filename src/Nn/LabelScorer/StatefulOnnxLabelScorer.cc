@@ -21,6 +21,7 @@
 
 #include <Core/Assertions.hh>
 #include <Core/ReferenceCounting.hh>
+#include <Core/Tracing.hh>
 #include <Flow/Timestamp.hh>
 #include <Math/FastMatrix.hh>
 #include <Mm/Module.hh>
@@ -34,21 +35,40 @@
 namespace Nn {
 
 OnnxHiddenState::OnnxHiddenState()
-        : stateValueMap() {}
+        : stateValueMap(),
+          memory("onnx-hidden-states") {}
 
-OnnxHiddenState::OnnxHiddenState(std::vector<std::string>&& names, std::vector<Onnx::Value>&& values) {
+OnnxHiddenState::OnnxHiddenState(std::vector<std::string>&& names, std::vector<Onnx::Value>&& values)
+        : stateValueMap(),
+          memory("onnx-hidden-states") {
     verify(names.size() == values.size());
     stateValueMap.reserve(names.size());
+    size_t bytes = 0ul;
     for (size_t i = 0ul; i < names.size(); ++i) {
+        bytes += values[i].byteSize();
         stateValueMap.emplace(std::move(names[i]), std::move(values[i]));
     }
+    memory.set(bytes);
 }
 
-OnnxHiddenStateScoringContext::OnnxHiddenStateScoringContext()
-        : labelSeq(), hiddenState(), requiresFinalize(false) {}
+void OnnxHiddenStatePayload::release() {
+    hiddenState.reset();
+    prefixHiddenState.reset();
+    scores.reset();
+}
+
+OnnxHiddenStateScoringContext::OnnxHiddenStateScoringContext(OnnxHiddenStateNode::Ref const& node)
+        : node(node) {
+    node->acquire();
+}
+
+OnnxHiddenStateScoringContext::~OnnxHiddenStateScoringContext() {
+    node->release();
+}
 
-OnnxHiddenStateScoringContext::OnnxHiddenStateScoringContext(std::vector<LabelIndex> const& labelSeq, OnnxHiddenStateRef state, bool requiresFinalize)
-        : labelSeq(labelSeq), hiddenState(state), requiresFinalize(requiresFinalize) {}
+bool OnnxHiddenStateScoringContext::requiresFinalize() const {
+    return node->length() > 0ul and not node->payload.hiddenState;
+}
 
 bool OnnxHiddenStateScoringContext::isEqual(ScoringContextRef const& other) const {
     auto* otherPtr = dynamic_cast<OnnxHiddenStateScoringContext const*>(other.get());
@@ -56,11 +76,12 @@ bool OnnxHiddenStateScoringContext::isEqual(ScoringContextRef const& other) cons
         return false;
     }
 
-    return labelSeqEqual(labelSeq, otherPtr->labelSeq);
+    // Nodes of the label-prefix trie are unique per label history
+    return node == otherPtr->node;
 }
 
 size_t OnnxHiddenStateScoringContext::hash() const {
-    return labelSeqHash(labelSeq);
+    return node->hash();
 }
 
 typedef Core::Ref<OnnxHiddenStateScoringContext const> OnnxHiddenStateScoringContextRef;
@@ -91,11 +112,6 @@ const Core::ParameterInt StatefulOnnxLabelScorer::paramMaxBatchSize(
         "Max number of hidden-states that can be fed into the scorer ONNX model at once.",
         Core::Type<int>::max);
 
-const Core::ParameterInt StatefulOnnxLabelScorer::paramMaxCachedScores(
-        "max-cached-score-vectors",
-        "Maximum size of cache that maps scoring contexts to scores. This prevents memory overflow in case of very long audio segments.",
-        1000);
-
 // Scorer only takes hidden states as input which are not part of the IO spec
 const std::vector<Onnx::IOSpecification> scorerModelIoSpec = {
         Onnx::IOSpecification{
@@ -159,8 +175,7 @@ StatefulOnnxLabelScorer::StatefulOnnxLabelScorer(Core::Configuration const& conf
           scorerInputToStateNameMap_(),
           encoderStatesValue_(),
           encoderStatesSizeValue_(),
-          scoreCache_(paramMaxCachedScores(config)),
-          stateCache_(scoreCache_.maxSize()) {
+          rootNode_() {
     Core::Configuration initializerModelConfig(config, "state-initializer-model");
     Core::Configuration updaterModelConfig(config, "state-updater-model");
     Core::Configuration scorerModelConfig(config, "scorer-model");
@@ -244,12 +259,15 @@ StatefulOnnxLabelScorer::StatefulOnnxLabelScorer(Core::Configuration const& conf
 
 void StatefulOnnxLabelScorer::reset() {
     Precursor::reset();
-    stateCache_.clear();
-    scoreCache_.clear();
+    rootNode_.reset();
 }
 
 ScoringContextRef StatefulOnnxLabelScorer::getInitialScoringContext() {
-    return Core::ref(new OnnxHiddenStateScoringContext());
+    if (not rootNode_) {
+        rootNode_ = Core::ref(new OnnxHiddenStateNode());
+    }
+    // The initial hidden state of the root is not stored but obtained via `computeInitialHiddenState` when needed
+    return Core::ref(new OnnxHiddenStateScoringContext(rootNode_));
 }
 
 void StatefulOnnxLabelScorer::addInput(DataView const& input) {
@@ -304,19 +322,16 @@ ScoringContextRef StatefulOnnxLabelScorer::extendedScoringContext(ScoringContext
     }
 
     OnnxHiddenStateScoringContextRef onnxHiddenStateScoringContext(dynamic_cast<OnnxHiddenStateScoringContext const*>(scoringContext.get()));
-    std::vector<LabelIndex>          newLabelSeq(onnxHiddenStateScoringContext->labelSeq);
-    newLabelSeq.push_back(nextToken);
+    auto const&                      node    = onnxHiddenStateScoringContext->node;
+    auto                             newNode = node->extended(nextToken);
 
-    // Re-use previous hidden-state but mark that finalization (i.e. hidden-state update) is required
-    auto newScoringContext = Core::ref(new OnnxHiddenStateScoringContext(std::move(newLabelSeq), onnxHiddenStateScoringContext->hiddenState, true));
-
-    auto hiddenState = stateCache_.get(newScoringContext);
-    if (hiddenState) {
-        newScoringContext->hiddenState      = *hiddenState;
-        newScoringContext->requiresFinalize = false;
+    // If the extended history has no hidden-state yet, remember the previous hidden-state as input for the
+    // update which is only done once the new scoring context is used for scoring
+    if (not newNode->payload.hiddenState) {
+        newNode->payload.prefixHiddenState = node->payload.hiddenState;
     }
 
-    return newScoringContext;
+    return Core::ref(new OnnxHiddenStateScoringContext(newNode));
 }
 
 std::vector<std::optional<ScoreAccessorRef>> StatefulOnnxLabelScorer::getScoreAccessors(std::vector<ScoringContextRef> const& scoringContexts) {
@@ -340,14 +355,14 @@ std::vector<std::optional<ScoreAccessorRef>> StatefulOnnxLabelScorer::getScoreAc
         // We need to finalize all scoring contexts before using them for scoring again.
 
         OnnxHiddenStateScoringContextRef onnxHiddenStateScoringContext(dynamic_cast<OnnxHiddenStateScoringContext const*>(scoringContext.get()));
-        if (not scoreCache_.contains(onnxHiddenStateScoringContext)) {
+        if (not onnxHiddenStateScoringContext->node->payload.scores) {
             // Group by unique scoring context
             uniqueUncachedScoringContexts.emplace(onnxHiddenStateScoringContext);
         }
     }
 
     /*
-     * Fill state and score caches for all uncached scoring contexts
+     * Compute states and scores for all uncached scoring contexts
      */
     std::vector<OnnxHiddenStateScoringContextRef> scoringContextBatch;
     scoringContextBatch.reserve(std::min(uniqueUncachedScoringContexts.size(), maxBatchSize_));
@@ -365,22 +380,15 @@ std::vector<std::optional<ScoreAccessorRef>> StatefulOnnxLabelScorer::getScoreAc
     cacheScores(scoringContextBatch);
 
     /*
-     * Assign states from cache to scoring contexts and scores from cache to result vector
+     * Assign scores from the trie nodes to result vector
      */
     for (size_t contextIndex = 0ul; contextIndex < scoringContexts.size(); ++contextIndex) {
         OnnxHiddenStateScoringContextRef onnxHiddenStateScoringContext(dynamic_cast<OnnxHiddenStateScoringContext const*>(scoringContexts[contextIndex].get()));
+        auto const&                      node = onnxHiddenStateScoringContext->node;
 
-        if (onnxHiddenStateScoringContext->requiresFinalize) {
-            auto hiddenState = stateCache_.get(onnxHiddenStateScoringContext);
-            verify(hiddenState);
-            onnxHiddenStateScoringContext->hiddenState      = *hiddenState;
-            onnxHiddenStateScoringContext->requiresFinalize = false;
-        }
-
-        verify(scoreCache_.contains(onnxHiddenStateScoringContext));
-        auto const& scoreVec         = scoreCache_.get(onnxHiddenStateScoringContext)->get();
-        auto const  timeframe        = onnxHiddenStateScoringContext->labelSeq.size();
-        scoreAccessors[contextIndex] = Core::ref(new VectorScoreAccessor(scoreVec, timeframe));
+        verify(not onnxHiddenStateScoringContext->requiresFinalize());
+        verify(node->payload.scores);
+        scoreAccessors[contextIndex] = Core::ref(new VectorScoreAccessor(node->payload.scores, node->length()));
     }
 
     return scoreAccessors;
@@ -427,11 +435,11 @@ OnnxHiddenStateRef StatefulOnnxLabelScorer::computeInitialHiddenState() {
 
         if (initializerEncoderStatesName_ != "") {
             setupEncoderStatesValue();
-            sessionInputs.emplace_back(initializerEncoderStatesName_, encoderStatesValue_);
+            sessionInputs.emplace_back(initializerEncoderStatesName_, encoderStatesValue_.view());
         }
         if (initializerEncoderStatesSizeName_ != "") {
             setupEncoderStatesSizeValue();
-            sessionInputs.emplace_back(initializerEncoderStatesSizeName_, encoderStatesSizeValue_);
+            sessionInputs.emplace_back(initializerEncoderStatesSizeName_, encoderStatesSizeValue_.view());
         }
 
         std::vector<std::string> sessionOutputNames;
@@ -457,18 +465,21 @@ OnnxHiddenStateRef StatefulOnnxLabelScorer::computeInitialHiddenState() {
 }
 
 std::vector<OnnxHiddenStateRef> StatefulOnnxLabelScorer::updatedHiddenStates(std::vector<OnnxHiddenStateRef> const& hiddenStatesBatch, std::vector<s32> nextTokensBatch) {
+    TRACE_SCOPE("nn", "label-scorer-state-batch");
+    TRACE_COUNTER("nn", "label-scorer-batch-size", hiddenStatesBatch.size());
     /*
      * Create session inputs
      */
     std::vector<std::pair<std::string, Onnx::Value>> sessionInputs;
 
+    // The encoder states stay the same during the whole segment, so they are only bound as views instead of being copied for each run
     if (updaterEncoderStatesName_ != "") {
         setupEncoderStatesValue();
-        sessionInputs.emplace_back(updaterEncoderStatesName_, encoderStatesValue_);
+        sessionInputs.emplace_back(updaterEncoderStatesName_, encoderStatesValue_.view());
     }
     if (updaterEncoderStatesSizeName_ != "") {
         setupEncoderStatesSizeValue();
-        sessionInputs.emplace_back(updaterEncoderStatesSizeName_, encoderStatesSizeValue_);
+        sessionInputs.emplace_back(updaterEncoderStatesSizeName_, encoderStatesSizeValue_.view());
     }
     if (updaterTokenName_ != "") {
         sessionInputs.emplace_back(updaterTokenName_, Onnx::Value::create(nextTokensBatch));
@@ -494,10 +505,10 @@ std::vector<OnnxHiddenStateRef> StatefulOnnxLabelScorer::updatedHiddenStates(std
     }
 
     std::vector<Onnx::Value> sessionOutputs;
-    stateUpdaterOnnxModel_->session.run(std::move(sessionInputs), sessionOutputNames, sessionOutputs);
+    stateUpdaterOnnxModel_->session.runWithReusedOutputs(sessionInputs, sessionOutputNames, sessionOutputs);
 
     /*
-     * Return resulting hidden states
+     * Return resulting hidden states. The session outputs are only valid until the next run, so the states are sliced (i.e. copied) out of them.
      */
     std::vector<OnnxHiddenStateRef> newHiddenStates;
     for (size_t b = 0ul; b < hiddenStatesBatch.size(); ++b) {
@@ -514,34 +525,80 @@ std::vector<OnnxHiddenStateRef> StatefulOnnxLabelScorer::updatedHiddenStates(std
 }
 
 void StatefulOnnxLabelScorer::cacheStates(std::vector<OnnxHiddenStateScoringContextRef> const& scoringContextBatch) {
-    std::vector<OnnxHiddenStateScoringContextRef> nonFinalizedContexts;
-    std::vector<OnnxHiddenStateRef>               hiddenStates;
-    std::vector<s32>                              nextTokens;
+    /*
+     * Collect the nodes whose hidden state has to be computed: the non-finalized nodes of the batch and, if a history was
+     * extended before its prefix was finalized and the prefix state has been released since, its ancestors without state.
+     * Each node gets the level at which it can be updated: 0 if its input state is available, otherwise the level of its
+     * parent plus one. Since a node has at most one ancestor per level, no level has more nodes than the batch.
+     */
+    std::unordered_map<OnnxHiddenStateNode*, size_t> levels;
+    std::vector<std::vector<OnnxHiddenStateNode*>>   nodesPerLevel;
     for (auto const& scoringContext : scoringContextBatch) {
-        if (not scoringContext->requiresFinalize) {
+        if (not scoringContext->requiresFinalize()) {
             continue;
         }
-        nonFinalizedContexts.push_back(scoringContext);
-        if (scoringContext->hiddenState) {
-            hiddenStates.push_back(scoringContext->hiddenState);
+        // Walk up until a node whose input state is available or which is collected already
+        std::vector<OnnxHiddenStateNode*> path;
+        size_t                            level = 0ul;
+        for (auto* node = scoringContext->node.get(); levels.find(node) == levels.end(); node = node->parent()) {
+            path.push_back(node);
+            auto* parent = node->parent();
+            if (node->payload.prefixHiddenState or parent->length() == 0ul or parent->payload.hiddenState) {
+                break;
+            }
+            auto it = levels.find(parent);
+            if (it != levels.end()) {
+                level = it->second + 1ul;
+            }
         }
-        else {
-            hiddenStates.push_back(computeInitialHiddenState());
+        for (auto it = path.rbegin(); it != path.rend(); ++it, ++level) {
+            levels.emplace(*it, level);
+            if (nodesPerLevel.size() <= level) {
+                nodesPerLevel.resize(level + 1ul);
+            }
+            nodesPerLevel[level].push_back(*it);
         }
-        verify(not scoringContext->labelSeq.empty());
-        nextTokens.push_back(scoringContext->labelSeq.back());
     }
 
-    // If no scoring contexts need finalization, nothing has to be done
-    if (nonFinalizedContexts.empty()) {
-        return;
-    }
+    /*
+     * Update the states level by level with one batched state-updater call each
+     */
+    std::unordered_map<OnnxHiddenStateNode*, OnnxHiddenStateRef> newHiddenStates;
+    for (auto const& nodes : nodesPerLevel) {
+        std::vector<OnnxHiddenStateRef> hiddenStates;
+        std::vector<s32>                nextTokens;
+        hiddenStates.reserve(nodes.size());
+        nextTokens.reserve(nodes.size());
+        for (auto* node : nodes) {
+            auto* parent = node->parent();
+            if (node->payload.prefixHiddenState) {
+                hiddenStates.push_back(node->payload.prefixHiddenState);
+            }
+            else if (parent->length() == 0ul) {
+                hiddenStates.push_back(computeInitialHiddenState());
+            }
+            else if (parent->payload.hiddenState) {
+                hiddenStates.push_back(parent->payload.hiddenState);
+            }
+            else {
+                // Ancestor recomputed at the previous level
+                hiddenStates.push_back(newHiddenStates.at(parent));
+            }
+            verify(hiddenStates.back());
+            nextTokens.push_back(node->label());
+        }
 
-    auto newHiddenStates = updatedHiddenStates(hiddenStates, nextTokens);
-    verify(newHiddenStates.size() == nonFinalizedContexts.size());
+        auto updatedStates = updatedHiddenStates(hiddenStates, nextTokens);
+        verify(updatedStates.size() == nodes.size());
 
-    for (size_t i = 0ul; i < nonFinalizedContexts.size(); ++i) {
-        stateCache_.put(nonFinalizedContexts[i], newHiddenStates[i]);
+        for (size_t i = 0ul; i < nodes.size(); ++i) {
+            newHiddenStates.emplace(nodes[i], updatedStates[i]);
+            // Ancestors without users would only keep the state until they are released again
+            if (nodes[i]->numUsers() > 0u) {
+                nodes[i]->payload.hiddenState = updatedStates[i];
+                nodes[i]->payload.prefixHiddenState.reset();
+            }
+        }
     }
 }
 
@@ -549,6 +606,8 @@ void StatefulOnnxLabelScorer::cacheScores(std::vector<OnnxHiddenStateScoringCont
     if (scoringContextBatch.empty()) {
         return;
     }
+    TRACE_SCOPE("nn", "label-scorer-batch");
+    TRACE_COUNTER("nn", "label-scorer-batch-size", scoringContextBatch.size());
 
     /*
      * Create session inputs
@@ -562,13 +621,13 @@ void StatefulOnnxLabelScorer::cacheScores(std::vector<OnnxHiddenStateScoringCont
         stateValues.reserve(scoringContextBatch.size());
 
         for (size_t b = 0ul; b < scoringContextBatch.size(); ++b) {
-            auto const&        scoringContext = scoringContextBatch[b];
+            auto const&        node = scoringContextBatch[b]->node;
             OnnxHiddenStateRef hiddenState;
-            if (scoringContext->labelSeq.empty()) {
+            if (node->length() == 0ul) {
                 hiddenState = computeInitialHiddenState();
             }
             else {
-                hiddenState = (*stateCache_.get(scoringContext)).get();
+                hiddenState = node->payload.hiddenState;
             }
             verify(hiddenState);
             stateValues.push_back(&hiddenState->stateValueMap.at(stateName));
@@ -580,15 +639,15 @@ void StatefulOnnxLabelScorer::cacheScores(std::vector<OnnxHiddenStateScoringCont
      * Run session
      */
     std::vector<Onnx::Value> sessionOutputs;
-    scorerOnnxModel_->session.run(std::move(sessionInputs), {scorerScoresName_}, sessionOutputs);
+    scorerOnnxModel_->session.runWithReusedOutputs(sessionInputs, {scorerScoresName_}, sessionOutputs);
 
     /*
-     * Put resulting scores into cache map
+     * Store resulting scores in the trie nodes
      */
     for (size_t b = 0ul; b < scoringContextBatch.size(); ++b) {
         auto scoreVec = std::make_shared<std::vector<Score>>();
         sessionOutputs.front().get(b, *scoreVec);
-        scoreCache_.put(scoringContextBatch[b], scoreVec);
+        scoringContextBatch[b]->node->payload.scores = scoreVec;
     }
 }
 
@@ -20,7 +20,7 @@
 
 #include <Core/Component.hh>
 #include <Core/Configuration.hh>
-#include <Core/FIFOCache.hh>
+#include <Core/MemoryAccounting.hh>
 #include <Core/ReferenceCounting.hh>
 #include <Mm/FeatureScorer.hh>
 #include <Onnx/IOSpecification.hh>
@@ -29,6 +29,7 @@
 #include <Speech/Feature.hh>
 
 #include "BufferedLabelScorer.hh"
+#include "LabelPrefixTrie.hh"
 #include "ModelCache.hh"
 #include "ScoringContext.hh"
 
@@ -39,6 +40,7 @@ namespace Nn {
  */
 struct OnnxHiddenState : public Core::ReferenceCounted {
     std::unordered_map<std::string, Onnx::Value> stateValueMap;
+    Core::MemoryCharge                           memory;  // tensor bytes, charged to "onnx-hidden-states"
 
     OnnxHiddenState();
     OnnxHiddenState(std::vector<std::string>&& names, std::vector<Onnx::Value>&& values);
@@ -47,17 +49,34 @@ struct OnnxHiddenState : public Core::ReferenceCounted {
 typedef Core::Ref<OnnxHiddenState const> OnnxHiddenStateRef;
 
 /*
- * Scoring context consisting of a hidden state.
+ * Hidden state and scores that belong to one label history
+ */
+struct OnnxHiddenStatePayload {
+    OnnxHiddenStateRef                  hiddenState;        // Empty as long as the state update for the last label is pending
+    OnnxHiddenStateRef                  prefixHiddenState;  // Hidden state of the history without its last label, input of the pending state update
+    std::shared_ptr<std::vector<Score>> scores;
+
+    // Drop hidden states and scores once no scoring context refers to the label history anymore
+    void release();
+};
+
+typedef LabelPrefixNode<OnnxHiddenStatePayload> OnnxHiddenStateNode;
+
+/*
+ * Scoring context consisting of a node in the label-prefix trie which stores the hidden state.
  * Assumes that two hidden states are equal if and only if they were created
  * from the same label history.
  */
 struct OnnxHiddenStateScoringContext : public ScoringContext {
-    std::vector<LabelIndex>    labelSeq;  // Used for hashing
-    mutable OnnxHiddenStateRef hiddenState;
-    mutable bool               requiresFinalize;
+    OnnxHiddenStateNode::Ref node;
+
+    OnnxHiddenStateScoringContext(OnnxHiddenStateNode::Ref const& node);
+    OnnxHiddenStateScoringContext(OnnxHiddenStateScoringContext const&)            = delete;
+    OnnxHiddenStateScoringContext& operator=(OnnxHiddenStateScoringContext const&) = delete;
+    ~OnnxHiddenStateScoringContext();
 
-    OnnxHiddenStateScoringContext();
-    OnnxHiddenStateScoringContext(std::vector<LabelIndex> const& labelSeq, OnnxHiddenStateRef state, bool requiresFinalize);
+    // Whether the hidden state still has to be updated with the last label of the history
+    bool requiresFinalize() const;
 
     bool   isEqual(ScoringContextRef const& other) const override;
     size_t hash() const override;
@@ -96,7 +115,6 @@ class StatefulOnnxLabelScorer : public BufferedLabelScorer {
     static const Core::ParameterBool paramSilenceUpdatesHistory;
     static const Core::ParameterBool paramLoopUpdatesHistory;
     static const Core::ParameterInt  paramMaxBatchSize;
-    static const Core::ParameterInt  paramMaxCachedScores;
 
 public:
     StatefulOnnxLabelScorer(Core::Configuration const& config, ModelCache& modelCache);
@@ -123,13 +141,15 @@ protected:
     size_t getMinActiveInputIndex(Core::CollapsedVector<ScoringContextRef> const& activeContexts) const override;
 
 private:
-    // Forward a batch of scoringContexts through the ONNX scorer model and put the resulting scores into the score cache
+    // Forward a batch of scoringContexts through the ONNX scorer model and store the resulting scores in their trie nodes
     void cacheScores(std::vector<OnnxHiddenStateScoringContextRef> const& scoringContextBatch);
 
     // Computes new hidden state based on previous hidden state and next token with batched state-updater call
     std::vector<OnnxHiddenStateRef> updatedHiddenStates(std::vector<OnnxHiddenStateRef> const& hiddenStatesBatch, std::vector<s32> nextTokensBatch);
 
-    // Compute updated states for all non-finalized scoring contexts and put them into the state cache
+    // Compute updated states for all non-finalized scoring contexts and store them in their trie nodes.
+    // Ancestor states that are not available anymore (released since) are recomputed as well, in one batched
+    // state-updater call per recomputation level, and stored in the nodes that are in use.
     void cacheStates(std::vector<OnnxHiddenStateScoringContextRef> const& scoringContextBatch);
 
     // Since the hidden-state matrix depends on the encoder time axis, we cannot create properly create hidden-states until all encoder states have been passed.
@@ -170,8 +190,8 @@ private:
     Onnx::Value encoderStatesValue_;
     Onnx::Value encoderStatesSizeValue_;
 
-    Core::FIFOCache<OnnxHiddenStateScoringContextRef, std::shared_ptr<std::vector<Score>>, ScoringContextHash, ScoringContextEq> scoreCache_;
-    Core::FIFOCache<OnnxHiddenStateScoringContextRef, OnnxHiddenStateRef, ScoringContextHash, ScoringContextEq>                  stateCache_;
+    // Root of the label-prefix trie which stores hidden states and scores of all label histories that are still in use
+    OnnxHiddenStateNode::Ref rootNode_;
 };
 
 }  // namespace Nn
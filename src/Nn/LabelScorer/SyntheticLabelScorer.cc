@@ -0,0 +1,162 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "SyntheticLabelScorer.hh"
+
+#include <cmath>
+#include <random>
+
+#include "ScoringContext.hh"
+
+namespace Nn {
+
+const Core::Choice SyntheticLabelScorer::choiceDistribution(
+        "random", randomDistribution,
+        "peaky", peakyDistribution,
+        Core::Choice::endMark());
+
+const Core::ParameterChoice SyntheticLabelScorer::paramDistribution(
+        "distribution", &choiceDistribution, "distribution of the synthetic label probabilities", peakyDistribution);
+
+const Core::ParameterInt SyntheticLabelScorer::paramNumClasses(
+        "num-classes", "number of labels the synthetic scores are generated for", 0, 0);
+
+const Core::ParameterInt SyntheticLabelScorer::paramSeed(
+        "seed", "seed of the random generator; scores of a step only depend on seed and step index", 0, 0);
+
+const Core::ParameterFloat SyntheticLabelScorer::paramLogitRange(
+        "logit-range", "logits of the random distribution are drawn uniformly from [0, logit-range)", 10.0, 0.0);
+
+const Core::ParameterFloat SyntheticLabelScorer::paramPeakProbability(
+        "peak-probability", "probability of the peak label of each step in the peaky distribution", 0.9, 0.0, 1.0);
+
+const Core::ParameterInt SyntheticLabelScorer::paramBlankIndex(
+        "blank-index", "label index of blank; negative if there is no blank", -1);
+
+const Core::ParameterFloat SyntheticLabelScorer::paramBlankPeakRatio(
+        "blank-peak-ratio", "fraction of steps whose peak is on blank in the peaky distribution", 0.7, 0.0, 1.0);
+
+SyntheticLabelScorer::SyntheticLabelScorer(Core::Configuration const& config)
+        : Core::Component(config),
+          Precursor(config),
+          distribution_(static_cast<Distribution>(paramDistribution(config))),
+          numClasses_(paramNumClasses(config)),
+          seed_(paramSeed(config)),
+          logitRange_(paramLogitRange(config)),
+          peakProbability_(paramPeakProbability(config)),
+          blankIndex_(paramBlankIndex(config) >= 0 ? static_cast<LabelIndex>(paramBlankIndex(config)) : invalidLabelIndex),
+          blankPeakRatio_(paramBlankPeakRatio(config)),
+          scoreCache_() {
+    if (numClasses_ == 0ul) {
+        error("Synthetic label scorer requires num-classes to be set");
+    }
+    if (blankIndex_ != invalidLabelIndex and blankIndex_ >= numClasses_) {
+        error() << "Blank index " << blankIndex_ << " exceeds number of classes " << numClasses_;
+    }
+}
+
+void SyntheticLabelScorer::reset() {
+    Precursor::reset();
+    scoreCache_.clear();
+}
+
+void SyntheticLabelScorer::cleanupCaches(Core::CollapsedVector<ScoringContextRef> const& activeContexts) {
+    Precursor::cleanupCaches(activeContexts);
+
+    auto minActiveStep = getMinActiveInputIndex(activeContexts);
+    for (auto it = scoreCache_.begin(); it != scoreCache_.end();) {
+        if (it->first < minActiveStep) {
+            it = scoreCache_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+std::optional<ScoreAccessorRef> SyntheticLabelScorer::getScoreAccessor(ScoringContextRef scoringContext) {
+    StepScoringContextRef stepScoringContext(dynamic_cast<StepScoringContext const*>(scoringContext.get()));
+    auto                  step = stepScoringContext->currentStep;
+
+    // Only the number of inputs matters: scores of a step become available once its input feature was added
+    if (not getInput(step)) {
+        return {};
+    }
+
+    auto it = scoreCache_.find(step);
+    if (it == scoreCache_.end()) {
+        it = scoreCache_.emplace(step, generateScores(step)).first;
+    }
+
+    return Core::ref(new VectorScoreAccessor(it->second, step));
+}
+
+std::shared_ptr<std::vector<Score>> SyntheticLabelScorer::generateScores(TimeframeIndex step) const {
+    std::seed_seq                         seedSequence{seed_, static_cast<u32>(step)};
+    std::mt19937                          generator(seedSequence);
+    std::uniform_real_distribution<Score> uniform(0.0, 1.0);
+
+    auto  scores = std::make_shared<std::vector<Score>>(numClasses_);
+    auto& result = *scores;
+
+    switch (distribution_) {
+        case randomDistribution: {
+            // Negative log-softmax over uniformly drawn logits
+            Score maxLogit = 0.0;
+            for (auto& score : result) {
+                score    = uniform(generator) * logitRange_;
+                maxLogit = std::max(maxLogit, score);
+            }
+            Score sum = 0.0;
+            for (auto score : result) {
+                sum += std::exp(score - maxLogit);
+            }
+            Score logNorm = maxLogit + std::log(sum);
+            for (auto& score : result) {
+                score = logNorm - score;
+            }
+        } break;
+        case peakyDistribution: {
+            LabelIndex peak;
+            if (blankIndex_ != invalidLabelIndex and uniform(generator) < blankPeakRatio_) {
+                peak = blankIndex_;
+            }
+            else {
+                peak = std::uniform_int_distribution<LabelIndex>(0u, numClasses_ - 1ul)(generator);
+            }
+
+            if (numClasses_ == 1ul) {
+                result[0] = 0.0;
+                break;
+            }
+
+            // Spread the remaining probability mass with random weights over the non-peak labels
+            Score sum = 0.0;
+            for (LabelIndex label = 0u; label < numClasses_; ++label) {
+                result[label] = label == peak ? 0.0 : uniform(generator) + 1e-3;
+                sum += result[label];
+            }
+            Score restMass = std::max<Score>(1.0 - peakProbability_, 1e-10);
+            for (LabelIndex label = 0u; label < numClasses_; ++label) {
+                result[label] = label == peak ? -std::log(std::max<Score>(peakProbability_, 1e-10)) : -std::log(restMass * result[label] / sum);
+            }
+        } break;
+        default: defect();
+    }
+
+    return scores;
+}
+
+}  // namespace Nn
@@ -0,0 +1,84 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SYNTHETIC_LABEL_SCORER_HH
+#define SYNTHETIC_LABEL_SCORER_HH
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "NoOpLabelScorer.hh"
+
+namespace Nn {
+
+/*
+ * Label scorer that ignores the content of its input features and produces synthetic scores instead.
+ * Every input feature corresponds to one step and the score vector of a step is drawn deterministically from
+ * the configured seed and the step index, so repeated runs (and different search algorithms) see identical scores.
+ *
+ * Two distributions are supported:
+ *  - "random": uniformly drawn logits in [0, logit-range), normalized to a log-softmax
+ *  - "peaky":  one randomly drawn label per step gets probability `peak-probability`, the rest of the probability
+ *              mass is spread randomly over the other labels. If `blank-index` is set, the peak is on blank with
+ *              probability `blank-peak-ratio`, mimicking the output of a CTC model.
+ *
+ * This allows to measure the performance of the search in isolation from any neural network.
+ */
+class SyntheticLabelScorer : public StepwiseNoOpLabelScorer {
+public:
+    using Precursor = StepwiseNoOpLabelScorer;
+
+    enum Distribution {
+        randomDistribution,
+        peakyDistribution,
+    };
+
+    static const Core::Choice          choiceDistribution;
+    static const Core::ParameterChoice paramDistribution;
+    static const Core::ParameterInt    paramNumClasses;
+    static const Core::ParameterInt    paramSeed;
+    static const Core::ParameterFloat  paramLogitRange;
+    static const Core::ParameterFloat  paramPeakProbability;
+    static const Core::ParameterInt    paramBlankIndex;
+    static const Core::ParameterFloat  paramBlankPeakRatio;
+
+    SyntheticLabelScorer(Core::Configuration const& config);
+
+    void reset() override;
+
+    void cleanupCaches(Core::CollapsedVector<ScoringContextRef> const& activeContexts) override;
+
+    // Gets an accessor for the synthetic scores of the requested step
+    std::optional<ScoreAccessorRef> getScoreAccessor(ScoringContextRef scoringContext) override;
+
+private:
+    Distribution distribution_;
+    size_t       numClasses_;
+    u32          seed_;
+    Score        logitRange_;
+    Score        peakProbability_;
+    LabelIndex   blankIndex_;
+    Score        blankPeakRatio_;
+
+    // Score vectors of the steps that are still referenced by active contexts
+    std::unordered_map<TimeframeIndex, std::shared_ptr<std::vector<Score>>> scoreCache_;
+
+    std::shared_ptr<std::vector<Score>> generateScores(TimeframeIndex step) const;
+};
+
+}  // namespace Nn
+
+#endif  // SYNTHETIC_LABEL_SCORER_HH
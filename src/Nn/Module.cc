@@ -18,6 +18,7 @@
 #include <Flow/Registry.hh>
 #include <Nn/DummyCompressedVectorFactory.hh>
 #include <Nn/FixedQuantizationCompressedVectorFactory.hh>
+#include <Nn/HalfPrecisionCompressedVectorFactory.hh>
 #include <Nn/QuantizedCompressedVectorFactory.hh>
 #include <Nn/ReducedPrecisionCompressedVectorFactory.hh>
 #include <Onnx/OnnxLstmStateManager.hh>
@@ -33,6 +34,7 @@
 #include "LabelScorer/PriorLabelScorer.hh"
 #include "LabelScorer/StateManagedOnnxLabelScorer.hh"
 #include "LabelScorer/StatefulOnnxLabelScorer.hh"
+#include "LabelScorer/SyntheticLabelScorer.hh"
 #include "LabelScorer/TransitionLabelScorer.hh"
 #include "Statistics.hh"
 
@@ -58,6 +60,7 @@ namespace {
 enum CompressedVectorFactoryType {
     DummyCompressedVectorFactoryType,
     FixedQuantizationCompressedVectorFactoryType,
+    HalfPrecisionCompressedVectorFactoryType,
     QuantizedCompressedVectorFactoryType,
     ReducedPrecisionCompressedVectorFactoryType
 };
@@ -74,6 +77,7 @@ enum StateManagerType {
 const Core::Choice Module_::compressedVectorFactoryTypeChoice(
         "dummy", DummyCompressedVectorFactoryType,
         "fixed-quantization", FixedQuantizationCompressedVectorFactoryType,
+        "half-precision", HalfPrecisionCompressedVectorFactoryType,
         "quantized", QuantizedCompressedVectorFactoryType,
         "reduced-precision", ReducedPrecisionCompressedVectorFactoryType,
         Core::Choice::endMark());
@@ -208,6 +212,13 @@ Module_::Module_()
                 return Core::ref(new StateManagedOnnxLabelScorer(config, modelCache));
             });
 
+    // Ignores the input features and produces seeded synthetic scores, e.g. for benchmarking the search
+    labelScorerFactory_.registerLabelScorer(
+            "synthetic",
+            [](Core::Configuration const& config, ModelCache&) {
+                return Core::ref(new SyntheticLabelScorer(config));
+            });
+
     // Returns predefined scores based on the transition type of each score request
     labelScorerFactory_.registerLabelScorer(
             "transition",
@@ -245,6 +256,8 @@ CompressedVectorFactoryPtr<float> Module_::createCompressedVectorFactory(Core::C
             return CompressedVectorFactoryPtr<float>(new DummyCompressedVectorFactory<float>(config));
         case FixedQuantizationCompressedVectorFactoryType:
             return CompressedVectorFactoryPtr<float>(new FixedQuantizationCompressedVectorFactory(config));
+        case HalfPrecisionCompressedVectorFactoryType:
+            return CompressedVectorFactoryPtr<float>(new HalfPrecisionCompressedVectorFactory(config));
         case QuantizedCompressedVectorFactoryType:
             return CompressedVectorFactoryPtr<float>(new QuantizedCompressedVectorFactory(config));
         case ReducedPrecisionCompressedVectorFactoryType:
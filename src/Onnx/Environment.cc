@@ -0,0 +1,80 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "Environment.hh"
+
+#include <Core/TaskScheduler.hh>
+
+namespace Onnx {
+
+const Core::ParameterBool Environment::paramGlobalThreadPool(
+        "global-thread-pool",
+        "Use one intra-op and one inter-op thread pool for all sessions in the process instead of per-session thread pools",
+        false);
+
+const Core::ParameterInt Environment::paramIntraOpNumThreads(
+        "intra-op-num-threads",
+        "number of threads of the global intra-op thread pool, i.e. the core budget of all sessions (0: core budget of the process)",
+        1,
+        0);
+
+const Core::ParameterInt Environment::paramInterOpNumThreads(
+        "inter-op-num-threads",
+        "number of threads of the global inter-op thread pool (0: core budget of the process)",
+        1,
+        0);
+
+const Core::ParameterBool Environment::paramAllowSpinning(
+        "allow-spinning",
+        "whether idle threads of the global thread pools spin-wait for new work instead of blocking",
+        true);
+
+const Core::ParameterString Environment::paramIntraOpThreadAffinity(
+        "intra-op-thread-affinity",
+        "pinning of the global intra-op threads in onnxruntime syntax, e.g. \"1;2;3\" or \"1-2;3-4\" for one entry (logical processors) per thread except for the calling thread",
+        "");
+
+namespace {
+
+Ort::Env createEnv(Core::Configuration const& config) {
+    if (not Environment::paramGlobalThreadPool(config)) {
+        return Ort::Env(ORT_LOGGING_LEVEL_WARNING, "rasr");
+    }
+
+    Ort::ThreadingOptions threadingOptions;
+    threadingOptions.SetGlobalIntraOpNumThreads(Core::TaskScheduler::threadsWithinCoreBudget(Environment::paramIntraOpNumThreads(config)));
+    threadingOptions.SetGlobalInterOpNumThreads(Core::TaskScheduler::threadsWithinCoreBudget(Environment::paramInterOpNumThreads(config)));
+    threadingOptions.SetGlobalSpinControl(Environment::paramAllowSpinning(config));
+    std::string affinity = Environment::paramIntraOpThreadAffinity(config);
+    if (not affinity.empty()) {
+        threadingOptions.SetGlobalIntraOpThreadAffinity(affinity.c_str());
+    }
+    return Ort::Env(threadingOptions, ORT_LOGGING_LEVEL_WARNING, "rasr");
+}
+
+}  // namespace
+
+Environment::Environment(Core::Configuration const& config)
+        : Precursor(config),
+          useGlobalThreadPool_(paramGlobalThreadPool(config)),
+          env_(createEnv(config)) {
+    if (useGlobalThreadPool_) {
+        log() << "Created ONNX environment with global thread pools of "
+              << Core::TaskScheduler::threadsWithinCoreBudget(paramIntraOpNumThreads(config)) << " intra-op and "
+              << Core::TaskScheduler::threadsWithinCoreBudget(paramInterOpNumThreads(config)) << " inter-op threads";
+    }
+}
+
+}  // namespace Onnx
@@ -0,0 +1,64 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef ONNX_ENVIRONMENT_HH
+#define ONNX_ENVIRONMENT_HH
+
+#include <onnxruntime_cxx_api.h>
+
+#include <Core/Component.hh>
+#include <Core/Parameter.hh>
+
+namespace Onnx {
+
+/*
+ * Process-wide ONNX runtime environment which is shared by all sessions (see `Module_::environment`).
+ *
+ * By default every session creates its own intra-op and inter-op thread pools. With `global-thread-pool` enabled the
+ * environment instead owns a single pair of thread pools with the configured core budget that is used by all sessions,
+ * so that several models (e.g. encoder, scorer and state updater) and several recognizers in one process don't
+ * oversubscribe the cores. Spin-waiting and pinning of the global intra-op threads are configurable as well.
+ */
+class Environment : public Core::Component {
+public:
+    using Precursor = Core::Component;
+
+    static const Core::ParameterBool   paramGlobalThreadPool;
+    static const Core::ParameterInt    paramIntraOpNumThreads;
+    static const Core::ParameterInt    paramInterOpNumThreads;
+    static const Core::ParameterBool   paramAllowSpinning;
+    static const Core::ParameterString paramIntraOpThreadAffinity;
+
+    Environment(Core::Configuration const& config);
+    virtual ~Environment() = default;
+
+    Ort::Env& env() {
+        return env_;
+    }
+
+    // Whether sessions have to use the global thread pools instead of their own ones
+    bool useGlobalThreadPool() const {
+        return useGlobalThreadPool_;
+    }
+
+private:
+    const bool useGlobalThreadPool_;
+
+    Ort::Env env_;
+};
+
+}  // namespace Onnx
+
+#endif  // ONNX_ENVIRONMENT_HH
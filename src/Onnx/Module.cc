@@ -3,10 +3,12 @@
  */
 #include "Module.hh"
 
+#include <Core/Application.hh>
 #include <Flow/Registry.hh>
 #include <Mm/FeatureScorerFactory.hh>
 #include <Nn/Module.hh>
 
+#include "Environment.hh"
 #include "OnnxEncoder.hh"
 #include "OnnxFeatureScorer.hh"
 #include "OnnxForwardNode.hh"
@@ -36,4 +38,13 @@ Module_::Module_() {
             });
 }
 
+Module_::~Module_() = default;
+
+Environment& Module_::environment() {
+    std::call_once(environmentFlag_, [this]() {
+        environment_ = std::make_unique<Environment>(Core::Configuration(Core::Application::us()->getConfiguration(), "onnx-environment"));
+    });
+    return *environment_;
+}
+
 }  // namespace Onnx
@@ -4,14 +4,29 @@
 #ifndef _ONNX_MODULE_HH
 #define _ONNX_MODULE_HH
 
+#include <memory>
+#include <mutex>
+
 #include <Core/Singleton.hh>
 
 namespace Onnx {
 
+class Environment;
+
 class Module_ {
 public:
     Module_();
-    ~Module_() = default;
+    ~Module_();
+
+    /*
+     * Process-wide ONNX runtime environment which is shared by all sessions.
+     * Created on first use from the "onnx-environment" configuration of the application.
+     */
+    Environment& environment();
+
+private:
+    std::once_flag               environmentFlag_;
+    std::unique_ptr<Environment> environment_;
 };
 
 typedef Core::SingletonHolder<Module_> Module;
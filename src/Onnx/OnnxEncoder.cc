@@ -64,6 +64,10 @@ OnnxEncoder::OnnxEncoder(Core::Configuration const& config, Nn::ModelCache& mode
     stateManager_->setInitialStates(stateVariables_);
 }
 
+OnnxEncoder::~OnnxEncoder() {
+    finishEncodingJob();
+}
+
 void OnnxEncoder::reset() {
     Encoder::reset();
     stateManager_->setInitialStates(stateVariables_);
@@ -221,6 +225,11 @@ ChunkedOnnxEncoder::ChunkedOnnxEncoder(Core::Configuration const& config, Nn::Mo
     initWindow(static_cast<WindowType>(paramWindowType(config)));
 }
 
+ChunkedOnnxEncoder::~ChunkedOnnxEncoder() {
+    // A running encoding job may still access the chunking state
+    finishEncodingJob();
+}
+
 void ChunkedOnnxEncoder::reset() {
     Precursor::reset();
     chunkCenterStart_     = 0ul;
@@ -35,7 +35,7 @@ public:
     static const Core::ParameterInt paramInputStepSize;
 
     OnnxEncoder(Core::Configuration const& config, Nn::ModelCache& modelCache);
-    virtual ~OnnxEncoder() = default;
+    virtual ~OnnxEncoder();
 
     // Clear buffers and reset segment end flag.
     virtual void reset() override;
@@ -92,6 +92,7 @@ public:
     static const Core::ParameterChoice paramInterpolationMode;
 
     ChunkedOnnxEncoder(Core::Configuration const& config, Nn::ModelCache& modelCache);
+    virtual ~ChunkedOnnxEncoder();
 
     virtual void reset() override;
 
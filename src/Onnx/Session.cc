@@ -9,6 +9,11 @@
 #include <cuda_runtime.h>
 #endif
 
+#include <Core/TaskScheduler.hh>
+#include <Core/Tracing.hh>
+
+#include "Environment.hh"
+#include "Module.hh"
 #include "Util.hh"
 
 namespace Onnx {
@@ -18,13 +23,22 @@ const Core::ParameterString Session::paramFile("file",
                                                "");
 
 const Core::ParameterInt Session::paramIntraOpNumThreads("intra-op-num-threads",
-                                                         "number of threads to use within one op",
+                                                         "number of threads to use within one op (limited to the core budget of the process, 0: core budget)",
                                                          1);
 
 const Core::ParameterInt Session::paramInterOpNumThreads("inter-op-num-threads",
-                                                         "number of threads to use between ops",
+                                                         "number of threads to use between ops (limited to the core budget of the process, 0: core budget)",
                                                          1);
 
+const Core::ParameterBool Session::paramAllowSpinning("allow-spinning",
+                                                      "whether idle threads of the per-session thread pools spin-wait for new work instead of blocking",
+                                                      true);
+
+const Core::ParameterInt Session::paramMaxOutputBufferSets("max-output-buffer-sets",
+                                                           "maximum number of different input shapes for which output buffers are kept when running with reused outputs",
+                                                           64,
+                                                           1);
+
 const Core::Choice Session::executionProviderChoice(
         "cpu", ExecutionProviderType::cpu,
         "cuda", ExecutionProviderType::cuda,
@@ -44,18 +58,32 @@ const Core::ParameterBool Session::paramRemovePrefixFromKey("remove-prefix-from-
 Session::Session(Core::Configuration const& config)
         : Precursor(config),
           file_(paramFile(config)),
-          intraOpNumThreads_(paramIntraOpNumThreads(config)),
-          interOpNumThreads_(paramInterOpNumThreads(config)),
+          intraOpNumThreads_(Core::TaskScheduler::threadsWithinCoreBudget(paramIntraOpNumThreads(config))),
+          interOpNumThreads_(Core::TaskScheduler::threadsWithinCoreBudget(paramInterOpNumThreads(config))),
+          allowSpinning_(paramAllowSpinning(config)),
+          maxOutputBufferSets_(paramMaxOutputBufferSets(config)),
           statePrefix_(paramStatePrefix(config)),
           removePrefixFromKey_(paramRemovePrefixFromKey(config)),
+          traceName_(Core::Tracer::intern(file_)),
           allocator_(),
-          env_(ORT_LOGGING_LEVEL_WARNING),
           session_(nullptr),
+          memoryInfo_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
+          outputBuffers_(),
           inputNameMap_(),
           outputNameMap_() {
+    Environment& environment = Module::instance().environment();
+
     Ort::SessionOptions session_opts;
-    session_opts.SetIntraOpNumThreads(intraOpNumThreads_);
-    session_opts.SetInterOpNumThreads(interOpNumThreads_);
+    if (environment.useGlobalThreadPool()) {
+        // Thread counts and spinning are configured for the global thread pools in the environment
+        session_opts.DisablePerSessionThreads();
+    }
+    else {
+        session_opts.SetIntraOpNumThreads(intraOpNumThreads_);
+        session_opts.SetInterOpNumThreads(interOpNumThreads_);
+        session_opts.AddConfigEntry("session.intra_op.allow_spinning", allowSpinning_ ? "1" : "0");
+        session_opts.AddConfigEntry("session.inter_op.allow_spinning", allowSpinning_ ? "1" : "0");
+    }
 
     auto providers = Ort::GetAvailableProviders();
     switch (paramExecutionProviderType(config)) {
@@ -87,7 +115,7 @@ Session::Session(Core::Configuration const& config)
             error() << "Execution provider for ONNX session not known.";
     }
 
-    session_ = Ort::Session(env_, file_.c_str(), session_opts);
+    session_ = Ort::Session(environment.env(), file_.c_str(), session_opts);
 
     size_t num_inputs  = session_.GetInputCount();
     size_t num_outputs = session_.GetOutputCount();
@@ -211,6 +239,7 @@ std::vector<int64_t> Session::getOutputShape(std::string const& name) const {
 bool Session::run(std::vector<std::pair<std::string, Value>>&& inputs,
                   std::vector<std::string> const&              output_names,
                   std::vector<Value>&                          outputs) {
+    TRACE_SCOPE("onnx", traceName_);
     Ort::RunOptions run_options;
 
     std::vector<char const*> input_names;
@@ -242,6 +271,72 @@ bool Session::run(std::vector<std::pair<std::string, Value>>&& inputs,
     return true;
 }
 
+bool Session::runWithReusedOutputs(std::vector<std::pair<std::string, Value>> const& inputs,
+                                   std::vector<std::string> const&                   output_names,
+                                   std::vector<Value>&                               outputs) {
+    TRACE_SCOPE("onnx", traceName_);
+    std::string key;
+    for (auto const& input : inputs) {
+        key += input.first;
+        for (int d = 0; d < input.second.numDims(); ++d) {
+            key += ':' + std::to_string(input.second.dimSize(d));
+        }
+        key += ';';
+    }
+    for (auto const& n : output_names) {
+        key += n + ';';
+    }
+
+    Ort::IoBinding binding(session_);
+    for (auto const& input : inputs) {
+        binding.BindInput(input.first.c_str(), input.second.value_);
+    }
+
+    auto bufferIt = outputBuffers_.find(key);
+    try {
+        if (bufferIt != outputBuffers_.end()) {
+            try {
+                for (size_t i = 0ul; i < output_names.size(); i++) {
+                    binding.BindOutput(output_names[i].c_str(), bufferIt->second[i].value_);
+                }
+                session_.Run(Ort::RunOptions(), binding);
+            }
+            catch (Ort::Exception const&) {
+                // Output shapes don't only depend on the input shapes, so let the session allocate them again
+                outputBuffers_.erase(bufferIt);
+                bufferIt = outputBuffers_.end();
+                binding.ClearBoundOutputs();
+            }
+        }
+        if (bufferIt == outputBuffers_.end()) {
+            for (auto const& n : output_names) {
+                binding.BindOutput(n.c_str(), memoryInfo_);
+            }
+            session_.Run(Ort::RunOptions(), binding);
+
+            if (outputBuffers_.size() >= maxOutputBufferSets_) {
+                outputBuffers_.clear();
+            }
+            std::vector<Value> buffers;
+            for (auto&& v : binding.GetOutputValues()) {
+                buffers.emplace_back(Value(std::move(v)));
+            }
+            bufferIt = outputBuffers_.emplace(key, std::move(buffers)).first;
+        }
+    }
+    catch (Ort::Exception& e) {
+        warning() << "Exception during ONNX session run: " << e.what();
+        return false;
+    }
+
+    outputs.resize(bufferIt->second.size());
+    for (size_t i = 0ul; i < outputs.size(); i++) {
+        outputs[i] = bufferIt->second[i].view();
+    }
+
+    return true;
+}
+
 std::string Session::getCustomMetadata(std::string const& key) const {
     std::string result = "";
 
@@ -27,6 +27,8 @@ public:
     static const Core::ParameterString paramFile;
     static const Core::ParameterInt    paramIntraOpNumThreads;
     static const Core::ParameterInt    paramInterOpNumThreads;
+    static const Core::ParameterBool   paramAllowSpinning;
+    static const Core::ParameterInt    paramMaxOutputBufferSets;
     static const Core::ParameterString paramStatePrefix;
     static const Core::ParameterBool   paramRemovePrefixFromKey;
 
@@ -49,6 +51,18 @@ public:
              std::vector<std::string> const&              output_names,
              std::vector<Value>&                          outputs);
 
+    /*
+     * Like `run`, but the outputs are written into preallocated buffers owned by the session via IO binding.
+     * The buffers are kept per combination of input shapes and output names and reused by later runs with the same
+     * input shapes, so that steady-state runs don't allocate. The inputs are bound without copying them.
+     * The returned outputs refer to the session's buffers and are only valid until the next call to this function,
+     * so they have to be copied if they are needed for longer. Therefore this function must not be called concurrently:
+     * a session that is shared between threads has to use `run`.
+     */
+    bool runWithReusedOutputs(std::vector<std::pair<std::string, Value>> const& inputs,
+                              std::vector<std::string> const&                   output_names,
+                              std::vector<Value>&                               outputs);
+
     std::string                     getCustomMetadata(std::string const& key) const;
     std::vector<std::string> const& getCustomMetadataKeys() const;
 
@@ -58,12 +72,18 @@ private:
     const std::string file_;
     const size_t      intraOpNumThreads_;
     const size_t      interOpNumThreads_;
+    const bool        allowSpinning_;
+    const size_t      maxOutputBufferSets_;
     const std::string statePrefix_;
     const bool        removePrefixFromKey_;
+    const char* const traceName_;  // span name of the runs in the trace
 
     Ort::AllocatorWithDefaultOptions allocator_;
-    Ort::Env                         env_;
     Ort::Session                     session_;
+    Ort::MemoryInfo                  memoryInfo_;
+
+    // Output buffers for `runWithReusedOutputs` keyed by input shapes and output names
+    std::unordered_map<std::string, std::vector<Value>> outputBuffers_;
 
     std::unordered_map<std::string, size_t> inputNameMap_;
     std::unordered_map<std::string, size_t> outputNameMap_;
@@ -146,6 +146,29 @@ template Value Value::createEmpty<u16>(std::vector<int64_t> const& dim);
 template Value Value::createEmpty<s8>(std::vector<int64_t> const& dim);
 template Value Value::createEmpty<u8>(std::vector<int64_t> const& dim);
 
+template<typename T>
+Value Value::createView(T const* data, std::vector<int64_t> const& dim) {
+    static Ort::MemoryInfo const memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+    size_t numElements = std::accumulate(dim.begin(), dim.end(), 1l, [](int64_t a, int64_t b) { return a * b; });
+
+    Value res;
+    res.value_ = Ort::Value::CreateTensor<T>(memoryInfo, const_cast<T*>(data), numElements, dim.data(), dim.size());
+
+    return res;
+}
+
+template Value Value::createView<f32>(f32 const* data, std::vector<int64_t> const& dim);
+template Value Value::createView<f64>(f64 const* data, std::vector<int64_t> const& dim);
+template Value Value::createView<s64>(s64 const* data, std::vector<int64_t> const& dim);
+template Value Value::createView<u64>(u64 const* data, std::vector<int64_t> const& dim);
+template Value Value::createView<s32>(s32 const* data, std::vector<int64_t> const& dim);
+template Value Value::createView<u32>(u32 const* data, std::vector<int64_t> const& dim);
+template Value Value::createView<s16>(s16 const* data, std::vector<int64_t> const& dim);
+template Value Value::createView<u16>(u16 const* data, std::vector<int64_t> const& dim);
+template Value Value::createView<s8>(s8 const* data, std::vector<int64_t> const& dim);
+template Value Value::createView<u8>(u8 const* data, std::vector<int64_t> const& dim);
+
 template<typename T>
 Value Value::zeros(std::initializer_list<int64_t> dim) {
     Value res = createEmpty<T>(dim);
@@ -477,6 +500,33 @@ std::string Value::dataTypeName() const {
     return "empty";
 }
 
+size_t Value::byteSize() const {
+    if (empty() or not value_.IsTensor()) {
+        return 0ul;
+    }
+    Ort::TensorTypeAndShapeInfo info = value_.GetTensorTypeAndShapeInfo();
+    size_t                      elementSize;
+    switch (info.GetElementType()) {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL: elementSize = 1ul; break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_BFLOAT16: elementSize = 2ul; break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32: elementSize = 4ul; break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT64:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_COMPLEX64: elementSize = 8ul; break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_COMPLEX128: elementSize = 16ul; break;
+        default: elementSize = 0ul;
+    }
+    return info.GetElementCount() * elementSize;
+}
+
 template<typename T>
 void Value::get(Math::FastMatrix<T>& mat, bool transpose) const {
     ONNXTensorElementDataType expected_dtype = ToDataType<T>::onnx_tensor_element_type;
@@ -1048,6 +1098,40 @@ template u16 const* Value::data<u16>(size_t, size_t, size_t) const;
 template s8 const*  Value::data<s8>(size_t, size_t, size_t) const;
 template u8 const*  Value::data<u8>(size_t, size_t, size_t) const;
 
+Value Value::view() const {
+    std::vector<int64_t> shape = value_.GetTensorTypeAndShapeInfo().GetShape();
+    switch (dataType()) {
+        case ValueDataType::FLOAT: {
+            return createView(value_.GetTensorData<float>(), shape);
+        }
+        case ValueDataType::DOUBLE: {
+            return createView(value_.GetTensorData<double>(), shape);
+        }
+        case ValueDataType::INT64: {
+            return createView(value_.GetTensorData<int64_t>(), shape);
+        }
+        case ValueDataType::UINT64: {
+            return createView(value_.GetTensorData<uint64_t>(), shape);
+        }
+        case ValueDataType::INT32: {
+            return createView(value_.GetTensorData<int32_t>(), shape);
+        }
+        case ValueDataType::UINT32: {
+            return createView(value_.GetTensorData<uint32_t>(), shape);
+        }
+        case ValueDataType::INT16: {
+            return createView(value_.GetTensorData<int16_t>(), shape);
+        }
+        case ValueDataType::UINT16: {
+            return createView(value_.GetTensorData<uint16_t>(), shape);
+        }
+        case ValueDataType::INT8: {
+            return createView(value_.GetTensorData<int8_t>(), shape);
+        }
+        default: defect();
+    }
+}
+
 Value Value::slice(int64_t start, int64_t end, int axis) {
     start = start >= 0 ? start : dimSize(axis) + start;
     end   = end >= 0 ? end : dimSize(axis) + 1 + end;
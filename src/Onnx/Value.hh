@@ -64,6 +64,13 @@ public:
     template<typename T>
     static Value zeros(std::vector<int64_t> const& dim);
 
+    /*
+     * Create a tensor that refers to external memory instead of owning a copy of it. The memory has to stay valid
+     * and unchanged as long as the returned value (or a session binding of it) is in use.
+     */
+    template<typename T>
+    static Value createView(T const* data, std::vector<int64_t> const& dim);
+
     static Value concat(Value const& a, Value const& b, int axis);
     static Value concat(std::vector<Value const*> const& values, int axis);
 
@@ -85,6 +92,7 @@ public:
     std::string   typeName() const;
     ValueDataType dataType() const;
     std::string   dataTypeName() const;
+    size_t        byteSize() const;  // memory of the tensor elements, 0 for string and non-tensor values
 
     template<typename T>
     void get(Math::FastMatrix<T>& mat, bool transpose = false) const;
@@ -152,6 +160,9 @@ public:
     template<typename T>
     T const* data(size_t dim0_idx, size_t dim1_idx, size_t dim2_idx) const;
 
+    // Tensor that refers to the data of this value without copying it (see `createView`)
+    Value view() const;
+
     Value slice(int64_t start, int64_t end, int axis);
 
     Value slice(std::vector<int64_t> const& start, std::vector<int64_t> const& end);
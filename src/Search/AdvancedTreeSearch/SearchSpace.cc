@@ -3877,6 +3877,9 @@ void SearchSpace::startNewTrees() {
         allEnteredTrees.insert(instance);
         if (lmLookahead_) {
             instance->lookaheadHistory = lmLookahead_->getReducedHistory(weh->lookaheadHistory);
+            if (lmLookahead_->prefetchEnabled() and not instance->lookahead and instance->lookaheadHistory != unigramHistory_) {
+                lmLookahead_->prefetch(instance->lookaheadHistory, sparseLookahead_);
+            }
         }
     }
 
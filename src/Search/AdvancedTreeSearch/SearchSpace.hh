@@ -31,7 +31,6 @@
 #include "Helpers.hh"
 #include "ScoreDependentStatistics.hh"
 #include "SearchSpaceHelpers.hh"
-#include "SimpleThreadPool.hh"
 #include "Trace.hh"
 
 struct EmissionSetCounter;
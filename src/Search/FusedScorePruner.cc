@@ -0,0 +1,126 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "FusedScorePruner.hh"
+
+#include <Core/Assertions.hh>
+#include <Core/Types.hh>
+
+namespace Search {
+
+FusedScorePruner::FusedScorePruner()
+        : numLabels_(0ul),
+          excludedLabels_(),
+          relativeThreshold_(Core::Type<Score>::max),
+          maxSurvivors_(Core::Type<size_t>::max),
+          bestScore_(Core::Type<Score>::max),
+          scoreBuffer_(),
+          survivorLabels_(),
+          survivorScores_() {}
+
+void FusedScorePruner::setNumLabels(size_t numLabels) {
+    numLabels_ = numLabels;
+    excludedLabels_.clear();
+    scoreBuffer_.resize(numLabels_);
+    survivorLabels_.reserve(numLabels_);
+    survivorScores_.reserve(numLabels_);
+}
+
+void FusedScorePruner::exclude(Nn::LabelIndex label) {
+    if (label < numLabels_) {
+        excludedLabels_.push_back(label);
+    }
+}
+
+void FusedScorePruner::startStep(Score relativeThreshold, size_t maxSurvivors) {
+    require(maxSurvivors > 0ul);
+    relativeThreshold_ = relativeThreshold;
+    maxSurvivors_      = maxSurvivors;
+    bestScore_         = Core::Type<Score>::max;
+}
+
+void FusedScorePruner::process(Score baseScore, Nn::DenseScoreSpan const& scores, Nn::LabelIndex extraExcludedLabel) {
+    require(scores.size() >= numLabels_);
+    size_t const numLabels = numLabels_;
+    Score*       buffer    = scoreBuffer_.data();
+
+    // Accumulate in the same order as `DenseScoreSpan::operator[]` so that the scores are identical to the unfused path
+    if (scores.terms.size() == 1ul) {
+        Score const* termScores = scores.terms.front().scores.data();
+        Score const  scale      = scores.terms.front().scale;
+        for (size_t label = 0ul; label < numLabels; ++label) {
+            buffer[label] = baseScore + termScores[label] * scale;
+        }
+    }
+    else {
+        std::fill(buffer, buffer + numLabels, Score(0.0));
+        for (auto const& term : scores.terms) {
+            Score const* termScores = term.scores.data();
+            Score const  scale      = term.scale;
+            for (size_t label = 0ul; label < numLabels; ++label) {
+                buffer[label] += termScores[label] * scale;
+            }
+        }
+        for (size_t label = 0ul; label < numLabels; ++label) {
+            buffer[label] = baseScore + buffer[label];
+        }
+    }
+
+    for (auto label : excludedLabels_) {
+        buffer[label] = Core::Type<Score>::max;
+    }
+    if (extraExcludedLabel < numLabels) {
+        buffer[extraExcludedLabel] = Core::Type<Score>::max;
+    }
+
+    Score hypBestScore = Core::Type<Score>::max;
+    for (size_t label = 0ul; label < numLabels; ++label) {
+        hypBestScore = std::min(hypBestScore, buffer[label]);
+    }
+    bestScore_ = std::min(bestScore_, hypBestScore);
+
+    Score threshold = Core::Type<Score>::max;
+    if (relativeThreshold_ != Core::Type<Score>::max) {
+        threshold = bestScore_ + relativeThreshold_;
+    }
+
+    // Branch-free compaction of the labels within the threshold
+    survivorLabels_.resize(numLabels);
+    Nn::LabelIndex* survivors    = survivorLabels_.data();
+    size_t          numSurvivors = 0ul;
+    for (size_t label = 0ul; label < numLabels; ++label) {
+        survivors[numSurvivors] = label;
+        numSurvivors += (buffer[label] <= threshold) & (buffer[label] < Core::Type<Score>::max);
+    }
+    survivorLabels_.resize(numSurvivors);
+
+    // Partial top-k selection, afterwards restore label order
+    if (numSurvivors > maxSurvivors_) {
+        std::nth_element(
+                survivorLabels_.begin(),
+                survivorLabels_.begin() + maxSurvivors_,
+                survivorLabels_.end(),
+                [buffer](Nn::LabelIndex a, Nn::LabelIndex b) { return buffer[a] < buffer[b]; });
+        survivorLabels_.resize(maxSurvivors_);
+        std::sort(survivorLabels_.begin(), survivorLabels_.end());
+    }
+
+    survivorScores_.resize(survivorLabels_.size());
+    for (size_t i = 0ul; i < survivorLabels_.size(); ++i) {
+        survivorScores_[i] = buffer[survivorLabels_[i]];
+    }
+}
+
+}  // namespace Search
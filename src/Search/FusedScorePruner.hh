@@ -0,0 +1,98 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SEARCH_FUSED_SCORE_PRUNER_HH
+#define SEARCH_FUSED_SCORE_PRUNER_HH
+
+#include <algorithm>
+#include <vector>
+
+#include <Nn/LabelScorer/ScoreAccessor.hh>
+#include <Nn/Types.hh>
+
+#include "Types.hh"
+
+namespace Search {
+
+/*
+ * Scores and prunes the extensions of a hypothesis by all labels of a dense score vector in one pass,
+ * without creating an extension candidate for every label.
+ *
+ * For each hypothesis the base score is added to the dense label scores in a contiguous buffer, the running
+ * best score over all hypotheses of the current step is updated and only the labels within the relative
+ * score threshold of it survive. If more than `maxSurvivors` labels survive, only the best ones are kept
+ * (partial selection). This is exact w.r.t. beam pruning as long as sibling extensions of a hypothesis are never
+ * recombined with each other, since a label with `maxSurvivors` better siblings can't survive beam pruning anyway.
+ *
+ * The inner loops are plain loops over contiguous float arrays so that the compiler can vectorize them.
+ * Labels that need special treatment by the search (e.g. blank or sentence-end) can be excluded; they never survive.
+ */
+class FusedScorePruner {
+public:
+    FusedScorePruner();
+
+    // Set number of labels and clear the set of excluded labels
+    void setNumLabels(size_t numLabels);
+
+    size_t numLabels() const {
+        return numLabels_;
+    }
+
+    // Exclude `label` from the survivors of all subsequent calls to `process`
+    void exclude(Nn::LabelIndex label);
+
+    // Start a new search step: resets the running best score
+    void startStep(Score relativeThreshold, size_t maxSurvivors);
+
+    // Update the running best score with the score of an extension that was computed outside of `process`
+    void updateBestScore(Score score) {
+        bestScore_ = std::min(bestScore_, score);
+    }
+
+    Score bestScore() const {
+        return bestScore_;
+    }
+
+    /*
+     * Compute `baseScore + scores[label]` for all labels, update the running best score and collect the survivors.
+     * `extraExcludedLabel` is excluded for this call only (e.g. the current label of the hypothesis).
+     * Survivors are ordered by label index.
+     */
+    void process(Score baseScore, Nn::DenseScoreSpan const& scores, Nn::LabelIndex extraExcludedLabel = Nn::invalidLabelIndex);
+
+    std::vector<Nn::LabelIndex> const& survivorLabels() const {
+        return survivorLabels_;
+    }
+
+    std::vector<Score> const& survivorScores() const {
+        return survivorScores_;
+    }
+
+private:
+    size_t                      numLabels_;
+    std::vector<Nn::LabelIndex> excludedLabels_;
+    Score                       relativeThreshold_;
+    size_t                      maxSurvivors_;
+    Score                       bestScore_;
+
+    // Pre-allocated intermediate vectors
+    std::vector<Score>          scoreBuffer_;
+    std::vector<Nn::LabelIndex> survivorLabels_;
+    std::vector<Score>          survivorScores_;
+};
+
+}  // namespace Search
+
+#endif  // SEARCH_FUSED_SCORE_PRUNER_HH
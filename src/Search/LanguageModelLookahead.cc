@@ -19,6 +19,7 @@
 #include <Core/Debug.hh>
 #include <Core/MappedArchive.hh>
 #include <Core/Statistics.hh>
+#include <Core/Tracing.hh>
 #include <Core/Utility.hh>
 #include <Lm/BackingOff.hh>
 #include <Lm/FsaLm.hh>
@@ -133,6 +134,19 @@ static struct EvaluateSparseStats {
  * there may be less tables, if the search never requires that many
  * different contexts.)
  *
+ * Prefetching: With prefetch-threads > 0 the search can announce
+ * histories whose tables it will probably need soon (e.g. the
+ * histories of newly started trees).  The tables are acquired on the
+ * search thread like any other table and computed by tasks on the
+ * global Core::TaskScheduler, so that fill() usually finds them ready.
+ * The cache bookkeeping (map, active and free lists) is only ever
+ * touched by the search thread: the prefetch tasks only write the scores of
+ * tables which are kept active by a reference held in
+ * prefetchedTables_ until the pool is done with them.  Tables are
+ * only prefetched while there are fewer than cache-size-high active
+ * tables, and only dense tables are prefetched, because the sparse
+ * computation shares scratch buffers between tables.
+ *
  * Tree cutoff: In the full look-ahead structure non-branching state
  * sequences are represented by a single node.  The MINIMUM depth of
  * these states is used as pruning criterion: If it is larger than
@@ -202,12 +216,20 @@ struct LanguageModelLookahead::CacheStatistics {
         freeCacheHit,
         cacheMiss
     };
+    enum PrefetchEvent {
+        prefetchSubmitted,
+        prefetchWait,
+        prefetchComputedBySearch
+    };
     static const Core::Choice cacheEventChoice;
+    static const Core::Choice prefetchEventChoice;
     Core::ChoiceStatistics    cacheEvents;
+    Core::ChoiceStatistics    prefetchEvents;
     Core::Statistics<u32>     nTables, nActiveTables;
+    bool                      prefetching;
     void                      clear();
     void                      write(Core::XmlWriter&) const;
-    CacheStatistics();
+    CacheStatistics(bool prefetching);
 
     SparseStatistics sparseStats;
 };
@@ -284,6 +306,28 @@ const Core::ParameterString LanguageModelLookahead::paramCacheArchive(
         "cache archive in which the look-ahead should be cached",
         "global-cache");
 
+const Core::ParameterInt LanguageModelLookahead::paramPrefetchThreads(
+        "prefetch-threads",
+        "number of look-ahead tables of prefetched histories computed in parallel on the task scheduler (0 disables prefetching, requires a thread-safe language model)",
+        0, 0);
+
+class LanguageModelLookahead::PrefetchMapper {
+public:
+    PrefetchMapper(LanguageModelLookahead const* la = nullptr)
+            : la_(la) {}
+
+    PrefetchMapper* clone() const {
+        return new PrefetchMapper(la_);
+    }
+    void map(ContextLookahead* const& lookahead) {
+        la_->computePrefetchedTable(*lookahead);
+    }
+    void reset() {}
+
+private:
+    LanguageModelLookahead const* la_;
+};
+
 static const int predictionArraySize = 100;
 
 LanguageModelLookahead::LanguageModelLookahead(
@@ -304,6 +348,8 @@ LanguageModelLookahead::LanguageModelLookahead(
           batchRequest_(0),
           nTables_(0),
           nFreeTables_(0),
+          tableMemory_("lm-lookahead-tables"),
+          prefetchPool_(nullptr),
           statisticsChannel_(config, "statistics") {
     acousticModel_ = acousticModel;
 
@@ -348,7 +394,17 @@ LanguageModelLookahead::LanguageModelLookahead(
         considerPronunciationScore_ = false;
     }
 
-    cacheStatistics_ = new CacheStatistics;
+    u32 prefetchThreads = paramPrefetchThreads(config);
+    if (prefetchThreads > 0 and not lm_->unscaled()->isThreadSafe()) {
+        warning("language model is not thread-safe, look-ahead prefetching is disabled");
+        prefetchThreads = 0;
+    }
+    if (prefetchThreads > 0 and Core::TaskScheduler::global().nWorkers() == 0) {
+        warning("task scheduler has no workers (core budget of one), look-ahead prefetching is disabled");
+        prefetchThreads = 0;
+    }
+
+    cacheStatistics_ = new CacheStatistics(prefetchThreads > 0);
 
     if (historyLimit_ == -1) {
         log("using unlimited look-ahead history");
@@ -358,9 +414,17 @@ LanguageModelLookahead::LanguageModelLookahead(
             historyLimit_, historyLimit_ + 1);
     }
     buildLookaheadStructure(tree, rootNode, exits);
+
+    if (prefetchThreads > 0) {
+        log("computing up to %d prefetched look-ahead tables in parallel", prefetchThreads);
+        prefetchPool_ = new PrefetchPool();
+        prefetchPool_->init(prefetchThreads, PrefetchMapper(this));
+    }
 }
 
 LanguageModelLookahead::~LanguageModelLookahead() {
+    delete prefetchPool_;  // waits for all queued tables
+    prefetchedTables_.clear();
     delete cacheStatistics_;
     for (List::iterator t = tables_.begin(); t != tables_.end(); ++t) {
         delete *t;
@@ -651,6 +715,9 @@ void LanguageModelLookahead::ConstructionTree::build(HMMStateNetwork const&
 
             for (HMMStateNetwork::SuccessorIterator target = tree_.successors(node); target; ++target) {
                 if (not target.isLabel()) {
+                    if (*target == node) {
+                        continue;  // Self-loops (e.g. label-loops in CTC trees) don't change the reachable word ends
+                    }
                     build(*target, depth + 1);
                     successors.push_back(*target);
                 }
@@ -745,7 +812,7 @@ void LanguageModelLookahead::ConstructionTree::build(HMMStateNetwork const&
             collected[node] = -2;
 
             for (HMMStateNetwork::SuccessorIterator edges = tree_.successors(node); edges; ++edges) {
-                if (not edges.isLabel()) {
+                if (not edges.isLabel() and *edges != node) {
                     int depth2 = collectTopologicalStates(*edges, depth + 1, topologicalStates, collected);
                     if (depth2 - 1 < depth) {
                         depth = depth2 - 1;
@@ -1655,8 +1722,7 @@ void LanguageModelLookahead::buildLookaheadStructure(HMMStateNetwork const& tree
     verify(maxDepth_ != 0);
     waitingLookaheadNodesByDepth_.resize(maxDepth_ + 1);
 
-    log("table size (%d entries): %zd bytes", nEntries_,
-        sizeof(ContextLookahead) + nEntries_ * sizeof(Score));
+    log("table size (%d entries): %zd bytes", nEntries_, tableSize());
 
     Core::Channel dc(config, "dot");
     if (dc.isOpen()) {
@@ -1693,6 +1759,7 @@ void LanguageModelLookahead::draw(std::ostream& os) const {
 // dynamic data and caching
 
 void LanguageModelLookahead::computeScores(Lm::History const& history, std::vector<Score>& scores) const {
+    TRACE_SCOPE("lm", "lookahead");
     if (scores.size() == nEntries_) {
         std::fill(scores.begin(), scores.end(), Core::Type<Score>::max);
     }
@@ -1905,7 +1972,8 @@ LanguageModelLookahead::ContextLookahead::ContextLookahead(
         : la_(la),
           history_(_history),
           freePos_(la->freeTables_.end()),
-          isFilled_(false),
+          fillState_(NotFilled),
+          prefetchPending_(false),
           sparseScores_(Core::Type<Score>::max),
           approxSparseScores_(),
           backOffScore_(Core::Type<Score>::max) {
@@ -1919,6 +1987,7 @@ LanguageModelLookahead::ContextLookahead* LanguageModelLookahead::acquireTable(L
         tables_.push_front(t);
         t->pos_ = tables_.begin();
         ++nTables_;
+        tableMemory_.set(nTables_ * tableSize());
     }
     else {
         t = freeTables_.back();
@@ -1946,6 +2015,7 @@ void LanguageModelLookahead::releaseTable(ContextLookahead const* ct) const {
         verify(*t->pos_ == t);
         tables_.erase(t->pos_);
         --nTables_;
+        tableMemory_.set(nTables_ * tableSize());
         map_.erase(t->history_);
         delete t;
     }
@@ -1995,8 +2065,8 @@ LanguageModelLookahead::ContextLookaheadReference
         cacheStatistics_->cacheEvents += CacheStatistics::cacheMiss;
         map_[h] = t = acquireTable(h);
 
-        t->isFilled_ = false;
-        t->history_  = h;
+        t->fillState_ = ContextLookahead::NotFilled;
+        t->history_   = h;
     }
 
     ensure(t->history_ == h);
@@ -2006,12 +2076,27 @@ LanguageModelLookahead::ContextLookaheadReference
 }
 
 void LanguageModelLookahead::fill(ContextLookaheadReference lookahead, bool sparse, bool approx) {
-    if (lookahead->isFilled_) {
-        return;  ///@todo If another thread is filling this table, wait
-    }
-
     ContextLookahead* t = const_cast<ContextLookahead*>(lookahead.get());
 
+    ContextLookahead::FillState state = t->fillState_.load();
+    if (state == ContextLookahead::Filled) {
+        return;
+    }
+    if (state == ContextLookahead::Queued) {
+        // take the table back from the prefetch queue instead of waiting for a thread to pick it up
+        if (t->fillState_.compare_exchange_strong(state, ContextLookahead::NotFilled)) {
+            cacheStatistics_->prefetchEvents += CacheStatistics::prefetchComputedBySearch;
+        }
+    }
+    if (state == ContextLookahead::Computing) {
+        cacheStatistics_->prefetchEvents += CacheStatistics::prefetchWait;
+        waitForPrefetchedTable(*t);
+        return;
+    }
+    if (state == ContextLookahead::Filled) {
+        return;
+    }
+
     if (sparse) {
         // sparseLM may still be not sparse for some special history
         // e.g. empty history for backing-off LM (including subLM of combinedLM)
@@ -2034,7 +2119,7 @@ void LanguageModelLookahead::fill(ContextLookaheadReference lookahead, bool spar
         computeScores(t->history_, t->scores_);
     }
 
-    t->isFilled_ = true;
+    t->fillState_ = ContextLookahead::Filled;
 }
 
 void LanguageModelLookahead::fillZero(ContextLookaheadReference lookahead) {
@@ -2044,7 +2129,7 @@ void LanguageModelLookahead::fillZero(ContextLookaheadReference lookahead) {
     t->approxSparseScores_.clear();
     t->scores_.assign(nEntries_, 0);
 
-    t->isFilled_ = true;
+    t->fillState_ = ContextLookahead::Filled;
 }
 
 LanguageModelLookahead::ContextLookaheadReference
@@ -2056,7 +2141,7 @@ LanguageModelLookahead::ContextLookaheadReference
     ensure(!t || t->history_ == h);
     ensure(!t || t->isActive());
 
-    if (t && t->isFilled_) {
+    if (t && t->fillState_.load() == ContextLookahead::Filled) {
         return ContextLookaheadReference(t);
     }
     else {
@@ -2064,12 +2149,75 @@ LanguageModelLookahead::ContextLookaheadReference
     }
 }
 
+void LanguageModelLookahead::prefetch(Lm::History const& fh, bool sparse) const {
+    if (not prefetchPool_) {
+        return;
+    }
+    releaseFinishedPrefetches();
+
+    Lm::History h(getReducedHistory(fh));
+    if (map_.find(h) != map_.end() or nActiveTables() >= cacheSizeHighMark_) {
+        return;
+    }
+    if (sparse and lm_->isSparse(h)) {
+        return;
+    }
+
+    ContextLookahead* t = acquireTable(h);
+    map_[h]             = t;
+    t->history_         = h;
+    t->fillState_       = ContextLookahead::Queued;
+    t->prefetchPending_ = true;
+    prefetchedTables_.push_back(ContextLookaheadReference(t));
+    cacheStatistics_->prefetchEvents += CacheStatistics::prefetchSubmitted;
+    prefetchPool_->submit(t);
+}
+
+void LanguageModelLookahead::computePrefetchedTable(ContextLookahead& lookahead) const {
+    ContextLookahead::FillState state = ContextLookahead::Queued;
+    if (lookahead.fillState_.compare_exchange_strong(state, ContextLookahead::Computing)) {
+        lookahead.sparseScores_.clear();
+        lookahead.approxSparseScores_.clear();
+        computeScores(lookahead.history_, lookahead.scores_);
+        {
+            std::lock_guard<std::mutex> lock(prefetchMutex_);
+            lookahead.fillState_ = ContextLookahead::Filled;
+        }
+        prefetchFinished_.notify_all();
+    }
+    // otherwise the search thread took the table back and filled it itself
+    lookahead.prefetchPending_ = false;
+}
+
+void LanguageModelLookahead::waitForPrefetchedTable(ContextLookahead const& lookahead) const {
+    std::unique_lock<std::mutex> lock(prefetchMutex_);
+    prefetchFinished_.wait(lock, [&lookahead]() { return lookahead.fillState_.load() == ContextLookahead::Filled; });
+}
+
+void LanguageModelLookahead::releaseFinishedPrefetches() const {
+    // a table must stay active until the pool is done with it, otherwise it could be re-used or deleted
+    for (auto t = prefetchedTables_.begin(); t != prefetchedTables_.end();) {
+        if ((*t)->prefetchPending_.load()) {
+            ++t;
+        }
+        else {
+            t = prefetchedTables_.erase(t);
+        }
+    }
+}
+
 const Core::Choice LanguageModelLookahead::CacheStatistics::cacheEventChoice(
         "cache hits on active tables  ", shareInCacheHit,
         "cache hits on inactive tables", freeCacheHit,
         "number of table calculations ", cacheMiss,
         Core::Choice::endMark());
 
+const Core::Choice LanguageModelLookahead::CacheStatistics::prefetchEventChoice(
+        "prefetched tables                   ", prefetchSubmitted,
+        "waits for prefetch threads          ", prefetchWait,
+        "prefetched tables computed by search", prefetchComputedBySearch,
+        Core::Choice::endMark());
+
 void SparseStatistics::write(Core::XmlWriter& w) const {
     if (sparseTables) {
         w << Core::XmlOpen("language-model-lookahead-sparse-statistics");
@@ -2104,6 +2252,7 @@ void SparseStatistics::clear() {
 }
 void LanguageModelLookahead::CacheStatistics::clear() {
     cacheEvents.clear();
+    prefetchEvents.clear();
     nTables.clear();
     nActiveTables.clear();
     sparseStats.clear();
@@ -2113,15 +2262,20 @@ void LanguageModelLookahead::CacheStatistics::write(Core::XmlWriter& os) const {
     os << Core::XmlOpen("language-model-lookahead-cache-statistics")
        << cacheEvents
        << nActiveTables
-       << nTables
-       << Core::XmlClose("language-model-lookahead-cache-statistics");
+       << nTables;
+    if (prefetching) {
+        os << prefetchEvents;
+    }
+    os << Core::XmlClose("language-model-lookahead-cache-statistics");
     sparseStats.write(os);
 }
 
-LanguageModelLookahead::CacheStatistics::CacheStatistics()
+LanguageModelLookahead::CacheStatistics::CacheStatistics(bool prefetching)
         : cacheEvents("look-ahead requests", cacheEventChoice),
+          prefetchEvents("look-ahead prefetches", prefetchEventChoice),
           nTables("number of tables in memory"),
-          nActiveTables("number of active tables") {
+          nActiveTables("number of active tables"),
+          prefetching(prefetching) {
     clear();
 }
 
@@ -15,13 +15,18 @@
 #ifndef SEARCH_LANGUAGEMODELLOOKAHEAD_HH
 #define SEARCH_LANGUAGEMODELLOOKAHEAD_HH
 
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
 #include <list>
+#include <mutex>
 
 #include <Core/Component.hh>
 #include <Core/Hash.hh>
+#include <Core/MemoryAccounting.hh>
 #include <Core/Parameter.hh>
 #include <Core/ReferenceCounting.hh>
+#include <Core/ThreadPool.hh>
 #include <Core/ThreadSafeReference.hh>
 #include <Lm/ScaledLanguageModel.hh>
 
@@ -128,6 +133,8 @@ private:
     mutable u32  nTables_, nFreeTables_;
     mutable Map  map_;
 
+    mutable Core::MemoryCharge tableMemory_;  // dense size of all tables, an upper bound for sparse tables
+
     // Returns whether the sparse scores were successfully computed
     template<bool approx>
     bool computeScoresSparse(ContextLookahead& lookahead) const;
@@ -136,6 +143,19 @@ private:
     ContextLookahead* getCachedTable(Lm::History const&) const;
     void              releaseTable(ContextLookahead const*) const;
 
+    // Background computation of prefetched tables
+    class PrefetchMapper;
+    typedef Core::ThreadPool<ContextLookahead*, PrefetchMapper> PrefetchPool;
+
+    PrefetchPool*                                          prefetchPool_;
+    mutable std::list<Core::TsRef<const ContextLookahead>> prefetchedTables_;  // keeps queued tables alive, only touched by the search thread
+    mutable std::mutex                                     prefetchMutex_;
+    mutable std::condition_variable                        prefetchFinished_;
+
+    void computePrefetchedTable(ContextLookahead& lookahead) const;
+    void waitForPrefetchedTable(ContextLookahead const& lookahead) const;
+    void releaseFinishedPrefetches() const;
+
     struct CacheStatistics;
     CacheStatistics*                   cacheStatistics_;
     mutable Core::XmlChannel           statisticsChannel_;
@@ -164,6 +184,7 @@ public:
     static const Core::ParameterInt    paramCollisionHashSize;
     static const Core::ParameterFloat  paramMaxCollisionDeviation;
     static const Core::ParameterString paramCacheArchive;
+    static const Core::ParameterInt    paramPrefetchThreads;
 
     LanguageModelLookahead(Core::Configuration const&,
                            Lm::Score wpScale,
@@ -194,7 +215,15 @@ public:
         Lm::History                   history_;
         List::iterator                pos_, freePos_;
         std::vector<Score>            scores_;  // If this is empty, the look-ahead is sparse
-        bool                          isFilled_;
+
+        enum FillState {
+            NotFilled,
+            Queued,     // submitted to the prefetch pool
+            Computing,  // a prefetch thread or the search thread computes the scores
+            Filled
+        };
+        std::atomic<FillState> fillState_;
+        std::atomic<bool>      prefetchPending_;  // the table is in the queue of the prefetch pool
 
         Search::LinearMiniHash<LookaheadId, (LanguageModelLookahead::LookaheadId)-1, Score>                             sparseScores_;
         typedef Search::ApproxLinearMiniHash<LookaheadId, (LanguageModelLookahead::LookaheadId)-1, Score, false, false> ApproxHash;
@@ -314,6 +343,10 @@ private:
         verify_(nTables_ == tables_.size());
         return nTables_;
     }
+    /** Bytes of a table with dense scores. */
+    size_t tableSize() const {
+        return sizeof(ContextLookahead) + nEntries_ * sizeof(Score);
+    }
     u32 nActiveTables() const {
         verify_(nTables_ == tables_.size());
         verify_(nFreeTables_ == freeTables_.size());
@@ -357,6 +390,18 @@ public:
      * */
     void fillZero(ContextLookaheadReference lah);
 
+    /**
+     * Schedules the computation of the LM look-ahead table for the given history on the prefetch threads,
+     * so that a later fill(..) finds it ready. Must be called from the search thread.
+     * Does nothing if prefetching is disabled, the table is already known, the table would be sparse,
+     * or the number of active tables has reached cache-size-high.
+     * */
+    void prefetch(const Lm::History&, bool sparse = false) const;
+
+    bool prefetchEnabled() const {
+        return prefetchPool_ != nullptr;
+    }
+
     LookaheadId lastNodeOnDepth(int depth) const;
 
     u32 numNodes() const {
@@ -20,6 +20,7 @@
 #include <strings.h>
 
 #include <Core/CollapsedVector.hh>
+#include <Core/Tracing.hh>
 #include <Core/XmlStream.hh>
 #include <Math/Utilities.hh>
 #include <Nn/LabelScorer/LabelScorer.hh>
@@ -165,6 +166,11 @@ const Core::ParameterBool LexiconfreeLabelsyncBeamSearch::paramLogStepwiseStatis
         "Log statistics about the beam at every search step.",
         false);
 
+const Core::ParameterBool LexiconfreeLabelsyncBeamSearch::paramFusedScorePruning(
+        "fused-score-pruning",
+        "Score and pre-prune the extensions by the first label scorer in one pass over its dense scores and only create the surviving extensions.",
+        true);
+
 const Core::ParameterInt LexiconfreeLabelsyncBeamSearch::paramCacheCleanupInterval(
         "cache-cleanup-interval",
         "Interval of search steps after which buffered inputs that are not needed anymore get cleaned up.",
@@ -181,6 +187,8 @@ LexiconfreeLabelsyncBeamSearch::LexiconfreeLabelsyncBeamSearch(Core::Configurati
           recombinationEnabled_(paramRecombinationMode(config) == RecombinationModeOn),
           logStepwiseStatistics_(paramLogStepwiseStatistics(config)),
           cacheCleanupInterval_(paramCacheCleanupInterval(config)),
+          useFusedScorePruning_(paramFusedScorePruning(config)),
+          fusedScorePruner_(),
           debugChannel_(config, "debug"),
           labelScorers_(),
           beam_(),
@@ -254,6 +262,10 @@ bool LexiconfreeLabelsyncBeamSearch::setModelCombination(Speech::ModelCombinatio
         }
     }
 
+    // Sentence-end has its own transition type and is handled separately by the search
+    fusedScorePruner_.setNumLabels(lexicon_->nLemmas());
+    fusedScorePruner_.exclude(sentenceEndLabelIndex_);
+
     return true;
 }
 
@@ -359,7 +371,28 @@ Core::Ref<const LatticeTrace> LexiconfreeLabelsyncBeamSearch::getCommonPrefix()
     return Core::Ref<const LatticeTrace>(searcher.rootTrace());
 }
 
+size_t LexiconfreeLabelsyncBeamSearch::numHypotheses() const {
+    return beam_.size();
+}
+
+std::vector<Nn::ScoringContextRef> LexiconfreeLabelsyncBeamSearch::nextScoringContexts() const {
+    std::vector<Nn::ScoringContextRef> result;
+    if (finishedSegment_ or labelScorers_.empty()) {
+        return result;
+    }
+
+    // Only the scoring contexts of active hypotheses get forwarded
+    result.reserve(beam_.size());
+    for (auto const& hyp : beam_) {
+        if (hyp.isActive) {
+            result.push_back(hyp.scoringContexts.front());
+        }
+    }
+    return result;
+}
+
 bool LexiconfreeLabelsyncBeamSearch::decodeStep() {
+    TRACE_SCOPE("search", "decode-step");
     if (finishedSegment_) {
         return false;
     }
@@ -411,8 +444,12 @@ bool LexiconfreeLabelsyncBeamSearch::decodeStep() {
         /*
          * Perform scoring of all the scoring contexts with the label scorer.
          */
+        std::vector<std::optional<Nn::ScoreAccessorRef>> scoreAccessors;
         scoringTime_.start();
-        auto scoreAccessors = labelScorer->getScoreAccessors(scoringContexts_);
+        {
+            TRACE_SCOPE("search", "label-scoring");
+            scoreAccessors = labelScorer->getScoreAccessors(scoringContexts_);
+        }
         scoringTime_.stop();
         std::vector<std::optional<Nn::DenseScoreSpan>> denseScoreSpans(scoreAccessors.size(), std::nullopt);
         std::vector<Nn::TimeframeIndex>                scoreTimes(scoreAccessors.size(), 0);
@@ -425,7 +462,7 @@ bool LexiconfreeLabelsyncBeamSearch::decodeStep() {
 
         if (scorerIdx == 0ul) {
             // In the first iteration, create extensions while pre-pruning
-            Score currentBestScore = Core::Type<Score>::max;
+            fusedScorePruner_.startStep(scoreThresholds_.front(), maxBeamSizes_.front());
 
             for (size_t hypIndex = 0ul; hypIndex < beam_.size(); ++hypIndex) {
                 auto const& hyp = beam_[hypIndex];
@@ -443,9 +480,7 @@ bool LexiconfreeLabelsyncBeamSearch::decodeStep() {
                     continue;
                 }
 
-                // Iterate over possible successors (all lemmas)
-                for (auto lemmaIt = lemmas.first; lemmaIt != lemmas.second; ++lemmaIt) {
-                    auto const*    lemma(*lemmaIt);
+                auto extend = [&](Bliss::Lemma const* lemma) {
                     Nn::LabelIndex tokenIdx = lemma->id();
 
                     auto transitionType = Nn::TransitionType::LABEL_TO_LABEL;
@@ -465,10 +500,10 @@ bool LexiconfreeLabelsyncBeamSearch::decodeStep() {
                     }
 
                     // Pre-prune based on score before creating extension instance and appending to list
-                    if (useScorePruning_.front() and extScore > currentBestScore + scoreThresholds_.front()) {
-                        continue;
+                    if (useScorePruning_.front() and extScore > fusedScorePruner_.bestScore() + scoreThresholds_.front()) {
+                        return;
                     }
-                    currentBestScore = std::min(currentBestScore, extScore);
+                    fusedScorePruner_.updateBestScore(extScore);
 
                     extensions_.push_back(
                             {.nextToken      = tokenIdx,
@@ -477,6 +512,19 @@ bool LexiconfreeLabelsyncBeamSearch::decodeStep() {
                              .timeframe      = extTime,
                              .transitionType = transitionType,
                              .baseHypIndex   = hypIndex});
+                };
+
+                if (fusedExtension(hypIndex, denseScores, scoreTime)) {
+                    // Only sentence-end remains
+                    if (sentenceEndLabelIndex_ < fusedScorePruner_.numLabels()) {
+                        extend(lemmas.first[sentenceEndLabelIndex_]);
+                    }
+                }
+                else {
+                    // Iterate over possible successors (all lemmas)
+                    for (auto lemmaIt = lemmas.first; lemmaIt != lemmas.second; ++lemmaIt) {
+                        extend(*lemmaIt);
+                    }
                 }
             }
         }
@@ -762,6 +810,40 @@ void LexiconfreeLabelsyncBeamSearch::logStatistics() const {
     numActiveHypsAfterBeamPruning_.write(clog());
 }
 
+bool LexiconfreeLabelsyncBeamSearch::fusedExtension(size_t hypIndex, std::optional<Nn::DenseScoreSpan> const& denseScores, Nn::TimeframeIndex scoreTime) {
+    if (not useFusedScorePruning_ or not denseScores or denseScores->size() < fusedScorePruner_.numLabels()) {
+        return false;
+    }
+
+    auto const& hyp = beam_[hypIndex];
+
+    auto transitionType = Nn::TransitionType::LABEL_TO_LABEL;
+    if (hyp.currentToken == Nn::invalidLabelIndex) {
+        transitionType = Nn::TransitionType::INITIAL_LABEL;
+    }
+    if (not labelScorers_.front()->scoresTransition(transitionType)) {
+        return false;
+    }
+
+    fusedScorePruner_.process(hyp.score, *denseScores);
+
+    auto        lemmas    = lexicon_->lemmas();
+    auto        extTime   = std::max(hyp.trace->time, scoreTime);
+    auto const& labels    = fusedScorePruner_.survivorLabels();
+    auto const& extScores = fusedScorePruner_.survivorScores();
+    for (size_t i = 0ul; i < labels.size(); ++i) {
+        extensions_.push_back(
+                {.nextToken      = labels[i],
+                 .pron           = lemmas.first[labels[i]]->pronunciations().first,
+                 .score          = extScores[i],
+                 .timeframe      = extTime,
+                 .transitionType = transitionType,
+                 .baseHypIndex   = hypIndex});
+    }
+
+    return true;
+}
+
 template<typename Element>
 void LexiconfreeLabelsyncBeamSearch::scorePruning(std::vector<Element>& hypotheses, Score relativeThreshold, size_t maxBeamSize) {
     // Find ranges for score histogram and setting absolute threshold
@@ -23,6 +23,7 @@
 #include <Nn/LabelScorer/DataView.hh>
 #include <Nn/LabelScorer/LabelScorer.hh>
 #include <Nn/LabelScorer/ScoringContext.hh>
+#include <Search/FusedScorePruner.hh>
 #include <Search/Histogram.hh>
 #include <Search/SearchV2.hh>
 #include <Search/Traceback.hh>
@@ -52,6 +53,7 @@ public:
     static const Core::Choice               choiceRecombinationMode;
     static const Core::ParameterChoice      paramRecombinationMode;
     static const Core::ParameterBool        paramLogStepwiseStatistics;
+    static const Core::ParameterBool        paramFusedScorePruning;
 
     LexiconfreeLabelsyncBeamSearch(Core::Configuration const&);
 
@@ -67,8 +69,11 @@ public:
     Core::Ref<const LatticeAdaptor> getCurrentBestWordLattice() const override;
     Core::Ref<const LatticeTrace>   getCurrentBestLatticeTrace() const override;
     Core::Ref<const LatticeTrace>   getCommonPrefix() const override;
+    size_t                          numHypotheses() const override;
     bool                            decodeStep() override;
 
+    std::vector<Nn::ScoringContextRef> nextScoringContexts() const override;
+
 protected:
     /*
      * Possible extension for some label hypothesis in the beam
@@ -140,6 +145,8 @@ private:
     bool                recombinationEnabled_;
     bool                logStepwiseStatistics_;
     size_t              cacheCleanupInterval_;
+    bool                useFusedScorePruning_;
+    FusedScorePruner    fusedScorePruner_;
 
     Core::Channel debugChannel_;
 
@@ -195,6 +202,13 @@ private:
      * Count hyps with `isActive` flag in `newBeam_`
      */
     size_t numActiveHyps() const;
+
+    /*
+     * Score `hyp` with the dense scores of the first label scorer and append the extensions that survive the
+     * fused pruning to `extensions_`. Returns false if the fused path is not applicable to this hypothesis.
+     * The sentence-end label is left out and needs to be extended separately.
+     */
+    bool fusedExtension(size_t hypIndex, std::optional<Nn::DenseScoreSpan> const& denseScores, Nn::TimeframeIndex scoreTime);
 };
 
 }  // namespace Search
@@ -19,6 +19,7 @@
 #include <strings.h>
 
 #include <Core/CollapsedVector.hh>
+#include <Core/Tracing.hh>
 #include <Core/XmlStream.hh>
 #include <Lattice/LatticeAdaptor.hh>
 #include <Math/Utilities.hh>
@@ -146,6 +147,11 @@ const Core::ParameterBool LexiconfreeTimesyncBeamSearch::paramLogStepwiseStatist
         "Log statistics about the beam at every search step.",
         false);
 
+const Core::ParameterBool LexiconfreeTimesyncBeamSearch::paramFusedScorePruning(
+        "fused-score-pruning",
+        "Score and pre-prune the extensions by the first label scorer in one pass over its dense scores and only create the surviving extensions.",
+        true);
+
 const Core::ParameterInt LexiconfreeTimesyncBeamSearch::paramCacheCleanupInterval(
         "cache-cleanup-interval",
         "Interval of search steps after which buffered inputs that are not needed anymore get cleaned up.",
@@ -190,6 +196,8 @@ LexiconfreeTimesyncBeamSearch::LexiconfreeTimesyncBeamSearch(Core::Configuration
           maximumStableDelayPruningInterval_(paramMaximumStableDelayPruningInterval(config)),
           recombinationEnabled_(paramRecombinationMode(config) == RecombinationModeOn),
           logStepwiseStatistics_(paramLogStepwiseStatistics(config)),
+          useFusedScorePruning_(paramFusedScorePruning(config)),
+          fusedScorePruner_(),
           debugChannel_(config, "debug"),
           labelScorers_(),
           beam_(),
@@ -305,6 +313,18 @@ bool LexiconfreeTimesyncBeamSearch::setModelCombination(Speech::ModelCombination
         }
     }
 
+    // Blank, silence and sentence-end are handled separately by the search
+    fusedScorePruner_.setNumLabels(lexicon_->nLemmas());
+    if (useBlank_) {
+        fusedScorePruner_.exclude(blankLabelIndex_);
+    }
+    if (useSilence_) {
+        fusedScorePruner_.exclude(silenceLabelIndex_);
+    }
+    if (useSentenceEnd_) {
+        fusedScorePruner_.exclude(sentenceEndLabelIndex_);
+    }
+
     return true;
 }
 
@@ -405,7 +425,25 @@ Core::Ref<const LatticeTrace> LexiconfreeTimesyncBeamSearch::getCommonPrefix() c
     return Core::Ref<const LatticeTrace>(searcher.rootTrace());
 }
 
+size_t LexiconfreeTimesyncBeamSearch::numHypotheses() const {
+    return beam_.size();
+}
+
+std::vector<Nn::ScoringContextRef> LexiconfreeTimesyncBeamSearch::nextScoringContexts() const {
+    std::vector<Nn::ScoringContextRef> result;
+    if (finishedSegment_ or labelScorers_.empty()) {
+        return result;
+    }
+
+    result.reserve(beam_.size());
+    for (auto const& hyp : beam_) {
+        result.push_back(hyp.scoringContexts.front());
+    }
+    return result;
+}
+
 bool LexiconfreeTimesyncBeamSearch::decodeStep() {
+    TRACE_SCOPE("search", "decode-step");
     if (finishedSegment_) {
         return false;
     }
@@ -437,8 +475,12 @@ bool LexiconfreeTimesyncBeamSearch::decodeStep() {
 
     for (size_t scorerIdx = 0ul; scorerIdx < labelScorers_.size(); ++scorerIdx) {
         auto const& labelScorer = labelScorers_[scorerIdx];
+        std::vector<std::optional<Nn::ScoreAccessorRef>> scoreAccessors;
         scoringTime_.start();
-        auto scoreAccessors = labelScorer->getScoreAccessors(scoringContexts_);
+        {
+            TRACE_SCOPE("search", "label-scoring");
+            scoreAccessors = labelScorer->getScoreAccessors(scoringContexts_);
+        }
         scoringTime_.stop();
         std::vector<std::optional<Nn::DenseScoreSpan>> denseScoreSpans(scoreAccessors.size(), std::nullopt);
         std::vector<Nn::TimeframeIndex>                scoreTimes(scoreAccessors.size(), 0);
@@ -451,7 +493,7 @@ bool LexiconfreeTimesyncBeamSearch::decodeStep() {
 
         if (scorerIdx == 0ul) {
             // In the first iteration, create extensions while pre-pruning
-            Score currentBestScore = Core::Type<Score>::max;
+            fusedScorePruner_.startStep(scoreThresholds_.front(), maxBeamSizes_.front());
 
             for (size_t hypIndex = 0ul; hypIndex < beam_.size(); ++hypIndex) {
                 auto const& hyp = beam_[hypIndex];
@@ -464,13 +506,11 @@ bool LexiconfreeTimesyncBeamSearch::decodeStep() {
                 auto const& denseScores = denseScoreSpans[hypIndexToContextIndexMap_[hypIndex]];
                 auto        scoreTime   = scoreTimes[hypIndexToContextIndexMap_[hypIndex]];
 
-                // Iterate over possible successors (all lemmas)
-                for (auto lemmaIt = lemmas.first; lemmaIt != lemmas.second; ++lemmaIt) {
-                    Bliss::Lemma const* lemma(*lemmaIt);
-                    Nn::LabelIndex      tokenIdx = lemma->id();
+                auto extend = [&](Bliss::Lemma const* lemma) {
+                    Nn::LabelIndex tokenIdx = lemma->id();
                     // Don't score the sentence-end token
                     if (tokenIdx == sentenceEndLabelIndex_) {
-                        continue;
+                        return;
                     }
                     auto transitionType = inferTransitionType(hyp.currentToken, tokenIdx);
                     auto extScore       = hyp.score;
@@ -483,10 +523,10 @@ bool LexiconfreeTimesyncBeamSearch::decodeStep() {
                     }
 
                     // Pre-prune based on score before creating extension instance and appending to list
-                    if (useScorePruning_.front() and extScore > currentBestScore + scoreThresholds_.front()) {
-                        continue;
+                    if (useScorePruning_.front() and extScore > fusedScorePruner_.bestScore() + scoreThresholds_.front()) {
+                        return;
                     }
-                    currentBestScore = std::min(currentBestScore, extScore);
+                    fusedScorePruner_.updateBestScore(extScore);
 
                     extensions_.push_back(
                             {.nextToken      = tokenIdx,
@@ -495,6 +535,27 @@ bool LexiconfreeTimesyncBeamSearch::decodeStep() {
                              .timeframe      = extTime,
                              .transitionType = transitionType,
                              .baseHypIndex   = hypIndex});
+                };
+
+                if (fusedExtension(hypIndex, denseScores, scoreTime)) {
+                    // Only the labels left out by the fused pruning remain
+                    Nn::LabelIndex remainingLabels[] = {
+                            useBlank_ ? blankLabelIndex_ : Nn::invalidLabelIndex,
+                            useSilence_ ? silenceLabelIndex_ : Nn::invalidLabelIndex,
+                            collapseRepeatedLabels_ ? hyp.currentToken : Nn::invalidLabelIndex};
+                    for (size_t i = 0ul; i < 3ul; ++i) {
+                        auto label = remainingLabels[i];
+                        if (label >= fusedScorePruner_.numLabels() or std::find(remainingLabels, remainingLabels + i, label) != remainingLabels + i) {
+                            continue;
+                        }
+                        extend(lemmas.first[label]);
+                    }
+                }
+                else {
+                    // Iterate over possible successors (all lemmas)
+                    for (auto lemmaIt = lemmas.first; lemmaIt != lemmas.second; ++lemmaIt) {
+                        extend(*lemmaIt);
+                    }
                 }
             }
         }
@@ -598,6 +659,7 @@ bool LexiconfreeTimesyncBeamSearch::decodeStep() {
     }
 
     numActiveHyps_ += newBeam_.size();
+    TRACE_COUNTER("search", "active-hyps", newBeam_.size());
 
     beam_.swap(newBeam_);
 
@@ -725,6 +787,38 @@ Nn::TransitionType LexiconfreeTimesyncBeamSearch::inferTransitionType(Nn::LabelI
     }
 }
 
+bool LexiconfreeTimesyncBeamSearch::fusedExtension(size_t hypIndex, std::optional<Nn::DenseScoreSpan> const& denseScores, Nn::TimeframeIndex scoreTime) {
+    if (not useFusedScorePruning_ or not denseScores or denseScores->size() < fusedScorePruner_.numLabels()) {
+        return false;
+    }
+
+    auto const& hyp = beam_[hypIndex];
+
+    // All labels except for blank, silence and a repeated label share the transition type of an arbitrary new label
+    auto transitionType = inferTransitionType(hyp.currentToken, Nn::invalidLabelIndex);
+    if (not labelScorers_.front()->scoresTransition(transitionType)) {
+        return false;
+    }
+
+    fusedScorePruner_.process(hyp.score, *denseScores, collapseRepeatedLabels_ ? hyp.currentToken : Nn::invalidLabelIndex);
+
+    auto        lemmas    = lexicon_->lemmas();
+    auto        extTime   = std::max(hyp.trace->time, scoreTime);
+    auto const& labels    = fusedScorePruner_.survivorLabels();
+    auto const& extScores = fusedScorePruner_.survivorScores();
+    for (size_t i = 0ul; i < labels.size(); ++i) {
+        extensions_.push_back(
+                {.nextToken      = labels[i],
+                 .pron           = lemmas.first[labels[i]]->pronunciations().first,
+                 .score          = extScores[i],
+                 .timeframe      = extTime,
+                 .transitionType = transitionType,
+                 .baseHypIndex   = hypIndex});
+    }
+
+    return true;
+}
+
 template<typename Element>
 void LexiconfreeTimesyncBeamSearch::scorePruning(std::vector<Element>& hypotheses, Score relativeThreshold, size_t maxBeamSize) {
     hypotheses.erase(
@@ -899,8 +993,12 @@ void LexiconfreeTimesyncBeamSearch::finalizeHypotheses() {
             scoringContexts_.push_back(hyp.scoringContexts[scorerIdx]);
         }
 
+        std::vector<std::optional<Nn::ScoreAccessorRef>> scoreAccessors;
         scoringTime_.start();
-        auto scoreAccessors = labelScorers_[scorerIdx]->getScoreAccessors(scoringContexts_);
+        {
+            TRACE_SCOPE("search", "label-scoring");
+            scoreAccessors = labelScorers_[scorerIdx]->getScoreAccessors(scoringContexts_);
+        }
         scoringTime_.stop();
 
         for (size_t extensionIdx = 0ul; extensionIdx < extensions_.size(); ++extensionIdx) {
@@ -23,6 +23,7 @@
 #include <Nn/LabelScorer/DataView.hh>
 #include <Nn/LabelScorer/LabelScorer.hh>
 #include <Nn/LabelScorer/ScoringContext.hh>
+#include <Search/FusedScorePruner.hh>
 #include <Search/Histogram.hh>
 #include <Search/SearchV2.hh>
 #include <Search/Traceback.hh>
@@ -55,6 +56,7 @@ public:
     static const Core::Choice               choiceRecombinationMode;
     static const Core::ParameterChoice      paramRecombinationMode;
     static const Core::ParameterBool        paramLogStepwiseStatistics;
+    static const Core::ParameterBool        paramFusedScorePruning;
 
     LexiconfreeTimesyncBeamSearch(Core::Configuration const&);
 
@@ -71,6 +73,9 @@ public:
     Core::Ref<const LatticeAdaptor> getCurrentBestWordLattice() const override;
     Core::Ref<const LatticeTrace>   getCurrentBestLatticeTrace() const override;
     Core::Ref<const LatticeTrace>   getCommonPrefix() const override;
+    size_t                          numHypotheses() const override;
+
+    std::vector<Nn::ScoringContextRef> nextScoringContexts() const override;
 
     bool decodeStep() override;
 
@@ -131,6 +136,8 @@ private:
     size_t              maximumStableDelayPruningInterval_;
     bool                recombinationEnabled_;
     bool                logStepwiseStatistics_;
+    bool                useFusedScorePruning_;
+    FusedScorePruner    fusedScorePruner_;
 
     Core::Channel debugChannel_;
 
@@ -168,6 +175,13 @@ private:
      */
     Nn::TransitionType inferTransitionType(Nn::LabelIndex prevLabel, Nn::LabelIndex nextLabel) const;
 
+    /*
+     * Score `hyp` with the dense scores of the first label scorer and append the extensions that survive the
+     * fused pruning to `extensions_`. Returns false if the fused path is not applicable to this hypothesis.
+     * Blank, silence and (when collapsing) the repeated label are left out and need to be extended separately.
+     */
+    bool fusedExtension(size_t hypIndex, std::optional<Nn::DenseScoreSpan> const& denseScores, Nn::TimeframeIndex scoreTime);
+
     /*
      * Helper function for acoustic pruning. Calculates an absolute threshold based on best score + relative threshold and
      * score histogram. Removes all hypotheses with a score > absolute threshold.
@@ -0,0 +1,215 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "MultiStreamSearch.hh"
+
+#include <algorithm>
+
+#include <Core/XmlStream.hh>
+
+#include "Module.hh"
+
+namespace Search {
+
+const Core::ParameterInt MultiStreamSearch::paramNumStreams(
+        "num-streams",
+        "Number of independent streams that are decoded in lockstep.",
+        1,
+        1);
+
+MultiStreamSearch::MultiStreamSearch(Core::Configuration const& config)
+        : Core::Component(config),
+          searches_(),
+          modelCombinations_(),
+          streamStates_(),
+          modelCache_(),
+          precomputationTime_(),
+          numStreamsPerStep_("num-streams-per-step"),
+          numContextsPerStep_("num-precomputed-contexts-per-step") {
+    size_t numStreams = paramNumStreams(config);
+    for (size_t streamIdx = 0ul; streamIdx < numStreams; ++streamIdx) {
+        auto& search = searches_.emplace_back(Module::instance().createSearchAlgorithmV2(select("search-algorithm")));
+        auto  mode   = search->requiredModelCombination();
+
+        Speech::ModelCombinationRef modelCombination;
+        if (modelCombinations_.empty()) {
+            // Lexicon, acoustic model and language model are loaded once and shared by all streams
+            modelCombination = Core::ref(new Speech::ModelCombination(select("model-combination"), mode & ~Speech::ModelCombination::useLabelScorer, search->requiredAcousticModel()));
+        }
+        else {
+            auto const& first = modelCombinations_.front();
+            modelCombination  = Core::ref(new Speech::ModelCombination(select("model-combination"), first->lexicon(), first->acousticModel(), first->languageModel()));
+        }
+
+        // Each stream needs its own label scorers since they buffer the stream's inputs, but the models are shared
+        if (mode & Speech::ModelCombination::useLabelScorer) {
+            modelCombination->createLabelScorers(modelCache_);
+        }
+
+        search->setModelCombination(*modelCombination);
+        modelCombinations_.push_back(modelCombination);
+        streamStates_.push_back(StreamState::Idle);
+    }
+    log() << "Created " << numStreams << " search streams";
+}
+
+size_t MultiStreamSearch::numStreams() const {
+    return searches_.size();
+}
+
+SearchAlgorithmV2& MultiStreamSearch::stream(size_t streamIdx) {
+    require(streamIdx < searches_.size());
+    return *searches_[streamIdx];
+}
+
+SearchAlgorithmV2 const& MultiStreamSearch::stream(size_t streamIdx) const {
+    require(streamIdx < searches_.size());
+    return *searches_[streamIdx];
+}
+
+Speech::ModelCombination& MultiStreamSearch::modelCombination(size_t streamIdx) {
+    require(streamIdx < modelCombinations_.size());
+    return *modelCombinations_[streamIdx];
+}
+
+void MultiStreamSearch::enterSegment(size_t streamIdx, Bliss::SpeechSegment const* segment) {
+    require(streamIdx < searches_.size());
+    searches_[streamIdx]->enterSegment(segment);
+    streamStates_[streamIdx] = StreamState::Decoding;
+}
+
+void MultiStreamSearch::putFeature(size_t streamIdx, Nn::DataView const& feature) {
+    require(streamIdx < searches_.size());
+    searches_[streamIdx]->putFeature(feature);
+}
+
+void MultiStreamSearch::putFeatures(size_t streamIdx, Nn::DataView const& features, size_t nTimesteps) {
+    require(streamIdx < searches_.size());
+    searches_[streamIdx]->putFeatures(features, nTimesteps);
+}
+
+void MultiStreamSearch::finishSegment(size_t streamIdx) {
+    require(streamIdx < searches_.size());
+    if (streamStates_[streamIdx] != StreamState::Decoding) {
+        warning() << "Stream " << streamIdx << " can't finish a segment that was not entered";
+        return;
+    }
+
+    // Signal the segment end to the label scorers directly so that the remaining steps can still be decoded in lockstep.
+    // The search's own `finishSegment` signals again later, which is a no-op then.
+    for (auto const& labelScorer : modelCombinations_[streamIdx]->labelScorers()) {
+        if (labelScorer) {
+            labelScorer->signalNoMoreFeatures();
+        }
+    }
+    streamStates_[streamIdx] = StreamState::Finishing;
+}
+
+bool MultiStreamSearch::isFinished(size_t streamIdx) const {
+    require(streamIdx < searches_.size());
+    return streamStates_[streamIdx] == StreamState::Idle;
+}
+
+size_t MultiStreamSearch::decodeStep() {
+    precomputeScores();
+
+    size_t numSteps = 0ul;
+    for (size_t streamIdx = 0ul; streamIdx < searches_.size(); ++streamIdx) {
+        if (streamStates_[streamIdx] == StreamState::Idle) {
+            continue;
+        }
+
+        if (searches_[streamIdx]->decodeStep()) {
+            ++numSteps;
+        }
+        else if (streamStates_[streamIdx] == StreamState::Finishing) {
+            // No more progress is possible in a finishing stream
+            finalizeStream(streamIdx);
+        }
+    }
+
+    if (numSteps > 0ul) {
+        numStreamsPerStep_ += numSteps;
+    }
+
+    return numSteps;
+}
+
+unsigned MultiStreamSearch::decodeManySteps() {
+    unsigned count = 0u;
+    while (decodeStep() > 0ul) {
+        ++count;
+    }
+
+    return count;
+}
+
+void MultiStreamSearch::precomputeScores() {
+    std::vector<Nn::LabelScorer*>                   labelScorers;
+    std::vector<std::vector<Nn::ScoringContextRef>> scoringContexts;
+    size_t                                          numContexts = 0ul;
+
+    for (size_t streamIdx = 0ul; streamIdx < searches_.size(); ++streamIdx) {
+        if (streamStates_[streamIdx] == StreamState::Idle) {
+            continue;
+        }
+        auto labelScorer = modelCombinations_[streamIdx]->labelScorer(0ul);
+        if (not labelScorer) {
+            continue;
+        }
+        auto contexts = searches_[streamIdx]->nextScoringContexts();
+        if (contexts.empty()) {
+            continue;
+        }
+
+        numContexts += contexts.size();
+        labelScorers.push_back(labelScorer.get());
+        scoringContexts.push_back(std::move(contexts));
+    }
+
+    if (labelScorers.size() < 2ul) {
+        // Nothing to merge; a single stream computes its scores on demand as usual
+        return;
+    }
+
+    precomputationTime_.start();
+    labelScorers.front()->precomputeScores(labelScorers, scoringContexts);
+    precomputationTime_.stop();
+
+    numContextsPerStep_ += numContexts;
+}
+
+void MultiStreamSearch::finalizeStream(size_t streamIdx) {
+    searches_[streamIdx]->finishSegment();
+    streamStates_[streamIdx] = StreamState::Idle;
+
+    if (std::all_of(streamStates_.begin(), streamStates_.end(), [](StreamState state) { return state == StreamState::Idle; })) {
+        logStatistics();
+    }
+}
+
+void MultiStreamSearch::logStatistics() {
+    clog() << Core::XmlOpen("multi-stream-statistics");
+    clog() << Core::XmlOpen("precomputation-time") + Core::XmlAttribute("unit", "milliseconds") << precomputationTime_.elapsedMilliseconds() << Core::XmlClose("precomputation-time");
+    numStreamsPerStep_.write(clog());
+    numContextsPerStep_.write(clog());
+    clog() << Core::XmlClose("multi-stream-statistics");
+
+    precomputationTime_.reset();
+    numStreamsPerStep_.clear();
+    numContextsPerStep_.clear();
+}
+
+}  // namespace Search
@@ -0,0 +1,115 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef MULTI_STREAM_SEARCH_HH
+#define MULTI_STREAM_SEARCH_HH
+
+#include <memory>
+
+#include <Core/Component.hh>
+#include <Core/Parameter.hh>
+#include <Core/Statistics.hh>
+#include <Core/StopWatch.hh>
+#include <Nn/LabelScorer/ModelCache.hh>
+#include <Speech/ModelCombination.hh>
+
+#include "SearchV2.hh"
+
+namespace Search {
+
+/*
+ * Driver that decodes several independent segments ("streams") in lockstep, each with its own `SearchAlgorithmV2` instance.
+ *
+ * All streams are created from the same configuration. They share the lexicon, acoustic model and language model, and their
+ * label scorers share the underlying models through a common `Nn::ModelCache`.
+ * Before each lockstep step, the scoring contexts that every stream is about to score with its first label scorer are collected
+ * via `SearchAlgorithmV2::nextScoringContexts` and precomputed in merged model calls via `Nn::LabelScorer::precomputeScores`.
+ * The following `decodeStep` of each stream is then served from its label scorer's cache. Since every stream is still decoded
+ * by its own search instance on the same scores, the per-stream results are the same as when decoding the streams separately.
+ *
+ * Usage:
+ *  1. Call `enterSegment` for every stream that should start a new segment.
+ *  2. Pass features to the streams via `putFeature` or `putFeatures`.
+ *  3. Call `decodeStep` or `decodeManySteps` to advance all streams as far as their features allow.
+ *  4. Call `finishSegment` for a stream after all of its features have been passed. The stream is finalized
+ *     by the next `decodeStep` that can't advance it any further, after which `isFinished` returns true.
+ *  5. Retrieve results from the individual searches via `stream`.
+ */
+class MultiStreamSearch : public Core::Component {
+public:
+    static const Core::ParameterInt paramNumStreams;
+
+    MultiStreamSearch(Core::Configuration const& config);
+
+    size_t numStreams() const;
+
+    // Access the search algorithm of a single stream, e.g. to retrieve tracebacks
+    SearchAlgorithmV2&       stream(size_t streamIdx);
+    SearchAlgorithmV2 const& stream(size_t streamIdx) const;
+
+    // Return the model combination used by a single stream
+    Speech::ModelCombination& modelCombination(size_t streamIdx);
+
+    // Start a new segment in the given stream
+    void enterSegment(size_t streamIdx, Bliss::SpeechSegment const* segment = nullptr);
+
+    // Pass a single feature vector to the given stream
+    void putFeature(size_t streamIdx, Nn::DataView const& feature);
+
+    // Pass feature vectors for multiple time steps to the given stream
+    void putFeatures(size_t streamIdx, Nn::DataView const& features, size_t nTimesteps);
+
+    // Signal that all features of the current segment of the given stream have been passed.
+    // Remaining steps of the stream are decoded in lockstep with the other streams.
+    void finishSegment(size_t streamIdx);
+
+    // Whether the current segment of the given stream has been finalized
+    bool isFinished(size_t streamIdx) const;
+
+    // Decode one step in every stream that is able to make one. Returns the number of streams that made a step.
+    size_t decodeStep();
+
+    // Decode as much as possible in all streams given the currently available features. Returns the number of lockstep steps.
+    unsigned decodeManySteps();
+
+private:
+    enum class StreamState {
+        Idle,       // No segment entered or segment already finalized
+        Decoding,   // Segment entered, more features may follow
+        Finishing,  // All features passed, remaining steps are decoded
+    };
+
+    std::vector<std::unique_ptr<SearchAlgorithmV2>> searches_;
+    std::vector<Speech::ModelCombinationRef>        modelCombinations_;
+    std::vector<StreamState>                        streamStates_;
+
+    Nn::ModelCache modelCache_;
+
+    Core::StopWatch       precomputationTime_;
+    Core::Statistics<u32> numStreamsPerStep_;
+    Core::Statistics<u32> numContextsPerStep_;
+
+    // Precompute the scores of the first label scorer for all streams that are in one of the decoding states
+    void precomputeScores();
+
+    // Finalize the segment of the given stream and log the driver statistics
+    void finalizeStream(size_t streamIdx);
+
+    void logStatistics();
+};
+
+}  // namespace Search
+
+#endif  // MULTI_STREAM_SEARCH_HH
@@ -178,7 +178,8 @@ PersistentStateTree::PersistentStateTree(Core::Configuration config, Core::Ref<c
           acousticModel_(acousticModel),
           lexicon_(lexicon),
           config_(config),
-          treeBuilderFactory_(treeBuilderFactory) {
+          treeBuilderFactory_(treeBuilderFactory),
+          memory_("search-network") {
     if (acousticModel_.get() && lexicon_.get()) {
         const Am::ClassicAcousticModel* am = required_cast(const Am::ClassicAcousticModel*, acousticModel.get());
         Core::DependencySet             d;
@@ -241,6 +242,7 @@ void PersistentStateTree::build() {
     rootTransitDescriptions = convert.rootTransitDescriptions;
 
     delete tree;
+    updateMemoryCharge();
 
     Core::Application::us()->log() << "network conversion ready";
 }
@@ -311,6 +313,7 @@ bool PersistentStateTree::read(Core::MappedArchiveReader in) {
     if (v >= 14) {
         in >> finalStates;
     }
+    updateMemoryCharge();
 
     return in.good();
 }
@@ -357,6 +360,7 @@ void PersistentStateTree::removeOutputs() {
             Core::Application::us()->log() << "mapped " << it->first << " to " << it->second;
         verify(it->first == it->second);
     }
+    updateMemoryCharge();
 }
 
 HMMStateNetwork::CleanupResult PersistentStateTree::cleanup(bool cleanupExits) {
@@ -467,6 +471,7 @@ HMMStateNetwork::CleanupResult PersistentStateTree::cleanup(bool cleanupExits) {
     uncoarticulatedWordEndStates = cleanupResult.mapNodes(uncoarticulatedWordEndStates);
     //   uncoarticulatedPushedWordEndNodes = cleanupResult.mapNodes( uncoarticulatedPushedWordEndNodes );
     unpushedCoarticulatedRootStates = cleanupResult.mapNodes(unpushedCoarticulatedRootStates);
+    updateMemoryCharge();
 
     return cleanupResult;
 }
@@ -516,6 +521,14 @@ void PersistentStateTree::dumpDotGraph(std::string file, const std::vector<int>&
     os << "}" << std::endl;
 }
 
+size_t PersistentStateTree::memoryUsage() const {
+    return structure.memoryUsage() + exits.capacity() * sizeof(Exit);
+}
+
+void PersistentStateTree::updateMemoryCharge() {
+    memory_.set(memoryUsage());
+}
+
 Core::DependencySet PersistentStateTree::getDependencies() {
     return dependencies_;
 }
@@ -16,6 +16,7 @@
 #define PERSISTENT_STATE_TREE_H
 
 #include <Core/MappedArchive.hh>
+#include <Core/MemoryAccounting.hh>
 #include "TreeStructure.hh"
 
 template<class Key>
@@ -76,6 +77,9 @@ public:
 
     Core::DependencySet getDependencies();
 
+    /// Bytes allocated for the network structure and the exits
+    size_t memoryUsage() const;
+
     /**  ----- types: ------  */
 
     struct Exit {
@@ -145,6 +149,10 @@ private:
     Bliss::LexiconRef                  lexicon_;
     Core::Configuration                config_;
     TreeBuilderFactory                 treeBuilderFactory_;
+    Core::MemoryCharge                 memory_;
+
+    // Charges the current memoryUsage() to the "search-network" account
+    void updateMemoryCharge();
 
     // Writes the whole state network into the given stream
     void write(Core::MappedArchiveWriter writer);
@@ -89,6 +89,16 @@ public:
     // Return common prefix of all active traces.
     virtual Core::Ref<const LatticeTrace> getCommonPrefix() const = 0;
 
+    // Return the number of hypotheses that are currently in the beam.
+    virtual size_t numHypotheses() const = 0;
+
+    // Return the scoring contexts that the first label scorer will be asked to score in the next `decodeStep`.
+    // This allows a driver such as `MultiStreamSearch` to precompute these scores for several search instances at once.
+    // Search algorithms that can't determine the contexts in advance return an empty vector.
+    virtual std::vector<Nn::ScoringContextRef> nextScoringContexts() const {
+        return {};
+    }
+
     // Try to decode one more step. Return bool indicates whether a step could be made.
     virtual bool decodeStep() = 0;
 
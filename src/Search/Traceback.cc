@@ -15,10 +15,188 @@
 
 #include "Traceback.hh"
 
+#include <mutex>
 #include <stack>
 
 namespace Search {
 
+namespace {
+
+/*
+ * Pool of fixed-size memory blocks which are carved out of large slabs. Each thread allocates from and frees
+ * to its own free list; blocks are exchanged with a shared free list in batches. Traces may still be referenced
+ * until the very end of the program, so the slabs are only returned to the system at exit if all blocks are free.
+ */
+template<size_t blockSize>
+class FixedSizeBlockPool {
+public:
+    static void* allocate() {
+        ThreadCache* cache = threadCache();
+        if (not cache) {
+            return allocateShared();
+        }
+        if (not cache->head) {
+            refill(*cache);
+        }
+        FreeBlock* block = cache->head;
+        cache->head      = block->next;
+        --cache->size;
+        return block;
+    }
+
+    static void deallocate(void* p) {
+        FreeBlock*   block = static_cast<FreeBlock*>(p);
+        ThreadCache* cache = threadCache();
+        if (not cache) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            block->next = sharedHead_;
+            sharedHead_ = block;
+            ++sharedSize_;
+            return;
+        }
+        block->next = cache->head;
+        cache->head = block;
+        if (++cache->size > 2ul * batchSize) {
+            giveBack(*cache, batchSize);
+        }
+    }
+
+    static size_t numAllocatedBlocks() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return numAllocatedBlocks_;
+    }
+
+private:
+    static constexpr size_t batchSize  = 4096ul;
+    static constexpr size_t slabSize   = 16ul * batchSize;
+    static constexpr size_t paddedSize = (blockSize + alignof(std::max_align_t) - 1ul) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // Header of a slab, followed by slabSize blocks
+    struct alignas(std::max_align_t) Slab {
+        Slab* next;
+    };
+
+    struct ThreadCache {
+        FreeBlock* head = nullptr;
+        size_t     size = 0ul;
+
+        ~ThreadCache() {
+            giveBack(*this, size);
+            threadCacheDestroyed_ = true;
+        }
+    };
+
+    // Releases the slabs at exit
+    struct SlabRelease {
+        ~SlabRelease() {
+            releaseSlabs();
+        }
+    };
+
+    static inline std::mutex        mutex_;
+    static inline FreeBlock*        sharedHead_           = nullptr;
+    static inline size_t            sharedSize_           = 0ul;
+    static inline Slab*             slabs_                = nullptr;
+    static inline size_t            numAllocatedBlocks_   = 0ul;
+    static inline thread_local bool threadCacheDestroyed_ = false;
+
+    // The cache of the calling thread, nullptr once it is destroyed at thread exit
+    static ThreadCache* threadCache() {
+        if (threadCacheDestroyed_) {
+            return nullptr;
+        }
+        static thread_local ThreadCache cache;
+        return &cache;
+    }
+
+    // Must be called with the mutex held
+    static void newSlab() {
+        // Static objects created before the first slab are destroyed after it, so releaseSlabs() has to check
+        // whether they still hold traces
+        static SlabRelease release;
+        Slab* slab  = static_cast<Slab*>(::operator new(sizeof(Slab) + slabSize * paddedSize));
+        slab->next  = slabs_;
+        slabs_      = slab;
+        char* first = reinterpret_cast<char*>(slab + 1);
+        for (size_t i = slabSize; i > 0ul; --i) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(first + (i - 1ul) * paddedSize);
+            block->next      = sharedHead_;
+            sharedHead_      = block;
+        }
+        sharedSize_ += slabSize;
+        numAllocatedBlocks_ += slabSize;
+    }
+
+    static void* allocateShared() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (not sharedHead_) {
+            newSlab();
+        }
+        FreeBlock* block = sharedHead_;
+        sharedHead_      = block->next;
+        --sharedSize_;
+        return block;
+    }
+
+    static void refill(ThreadCache& cache) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (not sharedHead_) {
+            newSlab();
+        }
+        for (size_t i = 0ul; i < batchSize and sharedHead_; ++i) {
+            FreeBlock* block = sharedHead_;
+            sharedHead_      = block->next;
+            --sharedSize_;
+            block->next = cache.head;
+            cache.head  = block;
+            ++cache.size;
+        }
+    }
+
+    static void giveBack(ThreadCache& cache, size_t count) {
+        if (count == 0ul) {
+            return;
+        }
+        FreeBlock* first = cache.head;
+        FreeBlock* last  = first;
+        for (size_t i = 1ul; i < count; ++i) {
+            last = last->next;
+        }
+        cache.head = last->next;
+        cache.size -= count;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        last->next  = sharedHead_;
+        sharedHead_ = first;
+        sharedSize_ += count;
+    }
+
+    // Frees all slabs if all their blocks are in the shared free list, i.e. no trace is alive
+    // and no other thread holds cached blocks anymore
+    static void releaseSlabs() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (sharedSize_ != numAllocatedBlocks_) {
+            return;
+        }
+        while (slabs_) {
+            Slab* next = slabs_->next;
+            ::operator delete(slabs_);
+            slabs_ = next;
+        }
+        sharedHead_         = nullptr;
+        sharedSize_         = 0ul;
+        numAllocatedBlocks_ = 0ul;
+    }
+};
+
+typedef FixedSizeBlockPool<sizeof(LatticeTrace)> LatticeTracePool;
+
+}  // namespace
+
 void Traceback::write(std::ostream& os, Core::Ref<const Bliss::PhonemeInventory> phi) const {
     for (const_iterator tbi = begin(); tbi != end(); ++tbi) {
         os << "t=" << std::setw(5) << tbi->time << "    s=" << std::setw(8) << tbi->score;
@@ -88,6 +266,26 @@ LatticeTrace::LatticeTrace(
 LatticeTrace::LatticeTrace(Speech::TimeframeIndex timeframe, ScoreVector scores, const Transit& transit)
         : TracebackItem(0, timeframe, scores, transit), predecessor(), sibling() {}
 
+void* LatticeTrace::operator new(size_t size) {
+    if (size != sizeof(LatticeTrace)) {
+        // Derived classes don't fit into the blocks
+        return ::operator new(size);
+    }
+    return LatticeTracePool::allocate();
+}
+
+void LatticeTrace::operator delete(void* p, size_t size) {
+    if (size != sizeof(LatticeTrace)) {
+        ::operator delete(p);
+        return;
+    }
+    LatticeTracePool::deallocate(p);
+}
+
+size_t LatticeTrace::numAllocatedBlocks() {
+    return LatticeTracePool::numAllocatedBlocks();
+}
+
 void LatticeTrace::appendSiblingToChain(Core::Ref<LatticeTrace> newSibling) {
     if (sibling) {
         sibling->appendSiblingToChain(newSibling);
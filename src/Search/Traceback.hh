@@ -98,8 +98,15 @@ public:
  *
  * Note: Don't connect traces as siblings or predecessor of each other in a circular way as this may result
  * in infinite loops during traversal.
+ *
+ * Since every hypothesis extension creates a trace, traces are allocated from slabs of fixed-size blocks instead of
+ * the general heap. Freed blocks are kept in a thread-local free list (and handed over to a shared one if it grows too
+ * large or the thread exits), so creating and releasing traces neither calls malloc nor contends between threads.
+ * For the same reason the reference counts of traces are not atomic: traces must not be shared across threads.
+ * All references to a trace and its predecessors and siblings have to be held by one thread at a time; they may only
+ * be handed over to another thread with synchronization in between, e.g. by joining the thread which created them.
  */
-class LatticeTrace : public Core::ReferenceCounted,
+class LatticeTrace : public Core::UnsynchronizedReferenceCounted,
                      public TracebackItem {
 public:
     Core::Ref<LatticeTrace> predecessor;
@@ -115,6 +122,16 @@ public:
 
     LatticeTrace(LatticeTrace const& other) = delete;
 
+    static void* operator new(size_t size);
+    static void  operator delete(void* p, size_t size);
+
+    /*
+     * Number of trace blocks allocated from the system so far. This is an upper bound of the peak number of
+     * simultaneously alive traces: blocks are allocated in whole slabs and the free blocks kept in the per-thread
+     * caches are counted as well.
+     */
+    static size_t numAllocatedBlocks();
+
     /*
      * Append sibling chain to the end of the own sibling chain
      * Example: If we have sibling chains
@@ -21,6 +21,7 @@
 
 #include <Am/ClassicStateModel.hh>
 #include <Core/CollapsedVector.hh>
+#include <Core/Tracing.hh>
 #include <Core/XmlStream.hh>
 #include <Lattice/LatticeAdaptor.hh>
 #include <Math/Utilities.hh>
@@ -52,10 +53,12 @@ TreeLabelsyncBeamSearch::LabelHypothesis::LabelHypothesis()
           currentToken(Nn::invalidLabelIndex),
           currentState(invalidTreeNodeIndex),
           lmHistory(),
+          lmLookahead(),
           timeframe(0),
           length(0),
           score(0.0),
           scaledScore(0.0),
+          lmLookaheadScore(0.0),
           trace(Core::ref(new LatticeTrace(0, {0, 0}, {}))),
           isActive(true)
 #ifdef SEARCHV2_DEBUG
@@ -76,10 +79,12 @@ TreeLabelsyncBeamSearch::LabelHypothesis::LabelHypothesis(
           currentToken(extension.nextToken),
           currentState(extension.nextState),
           lmHistory(base.lmHistory),
+          lmLookahead(base.lmLookahead),
           timeframe(extension.timeframe),
           length(base.length + 1),
           score(extension.score),
           scaledScore(score / std::pow(length, lengthNormScale)),
+          lmLookaheadScore(extension.lmLookaheadScore),
           trace(base.trace),
           isActive(extension.transitionType != Nn::TransitionType::SENTENCE_END)
 #ifdef SEARCHV2_DEBUG
@@ -105,10 +110,12 @@ TreeLabelsyncBeamSearch::LabelHypothesis::LabelHypothesis(
           currentToken(base.currentToken),
           currentState(extension.rootState),
           lmHistory(newLmHistory),
+          lmLookahead(),
           timeframe(extension.timeframe),
           length(base.length),
           score(extension.score),
           scaledScore(score / std::pow(length, lengthNormScale)),
+          lmLookaheadScore(0.0),
           trace(),
           isActive(base.isActive)
 #ifdef SEARCHV2_DEBUG
@@ -118,7 +125,8 @@ TreeLabelsyncBeamSearch::LabelHypothesis::LabelHypothesis(
           tokenTimeframes(base.tokenTimeframes)
 #endif
 {
-    auto newLmScore   = score - base.score;
+    // The LM look-ahead score of the base hypothesis is replaced by the actual LM score
+    auto newLmScore   = score - (base.score - base.lmLookaheadScore);
     auto totalLmScore = base.trace->score.lm + newLmScore;
     auto totalAmScore = score - totalLmScore;
 
@@ -237,6 +245,16 @@ const Core::ParameterInt TreeLabelsyncBeamSearch::paramCacheCleanupInterval(
         10,
         1);
 
+const Core::ParameterBool TreeLabelsyncBeamSearch::paramLmLookahead(
+        "lm-lookahead",
+        "Anticipate the LM scores of the words reachable from each state in the search tree for pruning. Configured via the \"lm-lookahead\" sub-component.",
+        false);
+
+const Core::ParameterBool TreeLabelsyncBeamSearch::paramSparseLmLookahead(
+        "sparse-lm-lookahead",
+        "Use sparse LM look-ahead tables for histories with few explicitly scored successors (requires a sparse LM such as a backing-off LM).",
+        true);
+
 TreeLabelsyncBeamSearch::TreeLabelsyncBeamSearch(Core::Configuration const& config)
         : Core::Component(config),
           SearchAlgorithmV2(config),
@@ -251,9 +269,13 @@ TreeLabelsyncBeamSearch::TreeLabelsyncBeamSearch(Core::Configuration const& conf
           sentenceEndFallback_(paramSentenceEndFallBack(config)),
           recombinationEnabled_(paramRecombinationMode(config) == RecombinationModeOn),
           logStepwiseStatistics_(paramLogStepwiseStatistics(config)),
+          useLmLookahead_(paramLmLookahead(config)),
+          sparseLmLookahead_(paramSparseLmLookahead(config)),
           labelScorers_(),
           nonWordLemmas_(),
           debugChannel_(config, "debug"),
+          lmLookahead_(),
+          unigramLmLookahead_(),
           hypIndexToContextIndexMap_(),
           withinWordExtensions_(),
           wordEndExtensions_(),
@@ -268,6 +290,7 @@ TreeLabelsyncBeamSearch::TreeLabelsyncBeamSearch(Core::Configuration const& conf
           initializationTime_(),
           featureProcessingTime_(),
           scoringTime_(),
+          lmLookaheadTime_(),
           numHypsAfterIntermediatePruning_(),
           numTerminatedHypsAfterScorePruning_("num-terminated-hyps-after-score-pruning"),
           numTerminatedHypsAfterRecombination_("num-terminated-hyps-after-recombination"),
@@ -380,6 +403,10 @@ bool TreeLabelsyncBeamSearch::setModelCombination(Speech::ModelCombination const
     // Create look-ups for state successors and exits of each state
     createSuccessorLookups();
 
+    if (useLmLookahead_) {
+        initializeLmLookahead();
+    }
+
     return true;
 }
 
@@ -387,6 +414,7 @@ void TreeLabelsyncBeamSearch::enterSegment(Bliss::SpeechSegment const* segment)
     initializationTime_.reset();
     featureProcessingTime_.reset();
     scoringTime_.reset();
+    lmLookaheadTime_.reset();
     for (auto& stat : numHypsAfterIntermediatePruning_) {
         stat.clear();
     }
@@ -425,6 +453,10 @@ void TreeLabelsyncBeamSearch::enterSegment(Bliss::SpeechSegment const* segment)
         }
     }
 
+    if (lmLookahead_) {
+        activateLmLookahead(beam_.front());
+    }
+
     finishedSegment_   = false;
     totalTimesteps_    = 0ul;
     currentSearchStep_ = 0ul;
@@ -500,7 +532,28 @@ Core::Ref<const LatticeTrace> TreeLabelsyncBeamSearch::getCommonPrefix() const {
     return Core::Ref<const LatticeTrace>(searcher.rootTrace());
 }
 
+size_t TreeLabelsyncBeamSearch::numHypotheses() const {
+    return beam_.size();
+}
+
+std::vector<Nn::ScoringContextRef> TreeLabelsyncBeamSearch::nextScoringContexts() const {
+    std::vector<Nn::ScoringContextRef> result;
+    if (finishedSegment_ or labelScorers_.empty()) {
+        return result;
+    }
+
+    // Only the scoring contexts of active hypotheses get forwarded
+    result.reserve(beam_.size());
+    for (auto const& hyp : beam_) {
+        if (hyp.isActive) {
+            result.push_back(hyp.scoringContexts.front());
+        }
+    }
+    return result;
+}
+
 bool TreeLabelsyncBeamSearch::decodeStep() {
+    TRACE_SCOPE("search", "decode-step");
     if (finishedSegment_) {
         return false;
     }
@@ -549,8 +602,12 @@ bool TreeLabelsyncBeamSearch::decodeStep() {
         /*
          * Perform scoring of all the scoring contexts with the label scorer.
          */
+        std::vector<std::optional<Nn::ScoreAccessorRef>> scoreAccessors;
         scoringTime_.start();
-        auto scoreAccessors = labelScorer->getScoreAccessors(scoringContexts_);
+        {
+            TRACE_SCOPE("search", "label-scoring");
+            scoreAccessors = labelScorer->getScoreAccessors(scoringContexts_);
+        }
         scoringTime_.stop();
         std::vector<std::optional<Nn::DenseScoreSpan>> denseScoreSpans(scoreAccessors.size(), std::nullopt);
         std::vector<Nn::TimeframeIndex>                scoreTimes(scoreAccessors.size(), 0);
@@ -594,8 +651,14 @@ bool TreeLabelsyncBeamSearch::decodeStep() {
                         transitionType = Nn::TransitionType::SENTENCE_END;
                     }
 
-                    auto extScore = hyp.score;
-                    auto extTime  = hyp.trace->time;
+                    auto extScore       = hyp.score;
+                    auto extTime        = hyp.trace->time;
+                    auto extLmLookahead = hyp.lmLookaheadScore;
+                    if (lmLookahead_ and successorState != hyp.currentState) {
+                        // Replace the look-ahead score of the current state by the one of the successor state
+                        extLmLookahead = lmLookaheadScore(*hyp.lmLookahead, successorState);
+                        extScore += extLmLookahead - hyp.lmLookaheadScore;
+                    }
                     if (labelScorer->scoresTransition(transitionType)) {
                         extScore += (denseScores and tokenIdx < denseScores->size())
                                             ? (*denseScores)[tokenIdx]
@@ -610,12 +673,13 @@ bool TreeLabelsyncBeamSearch::decodeStep() {
                     currentBestScore = std::min(currentBestScore, extScore);
 
                     withinWordExtensions_.push_back(
-                            {.nextToken      = tokenIdx,
-                             .nextState      = successorState,
-                             .timeframe      = extTime,
-                             .score          = extScore,
-                             .transitionType = transitionType,
-                             .baseHypIndex   = hypIndex});
+                            {.nextToken        = tokenIdx,
+                             .nextState        = successorState,
+                             .timeframe        = extTime,
+                             .score            = extScore,
+                             .lmLookaheadScore = extLmLookahead,
+                             .transitionType   = transitionType,
+                             .baseHypIndex     = hypIndex});
                 }
             }
         }
@@ -732,7 +796,7 @@ bool TreeLabelsyncBeamSearch::decodeStep() {
                 wordEndExtensions_.push_back({
                         .pron           = lemmaPron,
                         .rootState      = exit.transitState,
-                        .score          = hyp.score + languageModel_->sentenceEndScore(hyp.lmHistory),
+                        .score          = hyp.score - hyp.lmLookaheadScore + languageModel_->sentenceEndScore(hyp.lmHistory),
                         .timeframe      = hyp.timeframe,
                         .transitionType = Nn::TransitionType::SENTENCE_END,
                         .baseHypIndex   = hypIndex,
@@ -770,7 +834,7 @@ bool TreeLabelsyncBeamSearch::decodeStep() {
             wordEndExtensions_.push_back({
                     .pron           = lemmaPron,
                     .rootState      = exit.transitState,
-                    .score          = hyp.score + lmScore + penalty,
+                    .score          = hyp.score - hyp.lmLookaheadScore + lmScore + penalty,
                     .timeframe      = hyp.timeframe,
                     .transitionType = wordEndtransitionType,
                     .baseHypIndex   = hypIndex,
@@ -803,6 +867,9 @@ bool TreeLabelsyncBeamSearch::decodeStep() {
         }
 
         wordEndHypotheses_.push_back({baseHyp, extension, newLmHistory, lengthNormScale_});
+        if (lmLookahead_ and baseHyp.isActive) {
+            activateLmLookahead(wordEndHypotheses_.back());
+        }
     }
 
     // Freshly terminated hypotheses have been expanded to word-end hypotheses, so the base hypotheses are removed
@@ -897,6 +964,9 @@ bool TreeLabelsyncBeamSearch::decodeStep() {
     if (logStepwiseStatistics_) {
         clog() << Core::XmlFull("num-active-trees", seenHistories.size());
     }
+    if (lmLookahead_) {
+        lmLookahead_->collectStatistics();
+    }
 
     /*
      * Log statistics about the new beam after this step.
@@ -1011,6 +1081,9 @@ void TreeLabelsyncBeamSearch::logStatistics() const {
     clog() << Core::XmlOpen("initialization-time") << initializationTime_.elapsedMilliseconds() << Core::XmlClose("initialization-time");
     clog() << Core::XmlOpen("feature-processing-time") << featureProcessingTime_.elapsedMilliseconds() << Core::XmlClose("feature-processing-time");
     clog() << Core::XmlOpen("scoring-time") << scoringTime_.elapsedMilliseconds() << Core::XmlClose("scoring-time");
+    if (lmLookahead_) {
+        clog() << Core::XmlOpen("lm-lookahead-time") << lmLookaheadTime_.elapsedMilliseconds() << Core::XmlClose("lm-lookahead-time");
+    }
     clog() << Core::XmlClose("timing-statistics");
     for (auto const& stat : numHypsAfterIntermediatePruning_) {
         stat.write(clog());
@@ -1026,6 +1099,9 @@ void TreeLabelsyncBeamSearch::logStatistics() const {
     numActiveWordEndHypsAfterRecombination_.write(clog());
     numActiveWordEndHypsAfterBeamPruning_.write(clog());
     numActiveTrees_.write(clog());
+    if (lmLookahead_) {
+        lmLookahead_->logStatistics();
+    }
 }
 
 template<typename Element>
@@ -1227,6 +1303,69 @@ void TreeLabelsyncBeamSearch::createSuccessorLookups() {
     stateExitsOffset_[numStates]      = stateExits_.size();
 }
 
+void TreeLabelsyncBeamSearch::initializeLmLookahead() {
+    // Release all tables of a previous look-ahead instance before replacing it
+    beam_.clear();
+    newBeam_.clear();
+    wordEndHypotheses_.clear();
+    tempHypotheses_.clear();
+    unigramLmLookahead_.reset();
+
+    if (sparseLmLookahead_ and not languageModel_->isSparse(Lm::History())) {
+        warning() << "Not using sparse LM look-ahead because the LM can not be sparse";
+        sparseLmLookahead_ = false;
+    }
+    if (sparseLmLookahead_) {
+        log() << "Use sparse LM look-ahead";
+    }
+
+    // Pronunciation scores are not part of the search, so they are not considered in the look-ahead either
+    lmLookahead_ = std::make_unique<LanguageModelLookahead>(
+            select("lm-lookahead"),
+            0.0,
+            languageModel_,
+            network_->structure,
+            network_->rootState,
+            network_->exits,
+            acousticModel_,
+            sparseLmLookahead_);
+
+    Lm::History unigramHistory = languageModel_->reducedHistory(languageModel_->startHistory(), 0);
+    if (lmLookahead_->historyLimit() == 0 and not languageModel_->unscaled()->fixedHistory(0) and sparseLmLookahead_ and not languageModel_->isSparse(unigramHistory)) {
+        log() << "LM look-ahead history with limit 0 is not fixed, apply caching for partial sparse unigram look-ahead";
+        lmLookahead_->cacheBatch(unigramHistory);
+    }
+    unigramLmLookahead_ = lmLookahead_->getLookahead(unigramHistory);
+    lmLookahead_->fill(unigramLmLookahead_);
+}
+
+Score TreeLabelsyncBeamSearch::lmLookaheadScore(LanguageModelLookahead::ContextLookahead const& lookahead, StateId state) const {
+    if (not lookahead.isSparse()) {
+        return lookahead.scoreForLookAheadIdNormal(lmLookahead_->lookaheadId(state));
+    }
+
+    // Words that are not explicitly scored in the sparse table are reached via the back-off
+    Score score = lookahead.backOffScore() + unigramLmLookahead_->scoreForLookAheadIdNormal(lmLookahead_->lookaheadId(state));
+    Score sparseScore;
+    if (lookahead.getScoreForLookAheadHashSparse(lmLookahead_->lookaheadHash(state), sparseScore)) {
+        score = std::min(score, sparseScore);
+    }
+    return score;
+}
+
+void TreeLabelsyncBeamSearch::activateLmLookahead(LabelHypothesis& hyp) {
+    lmLookaheadTime_.start();
+    // Tables are cached inside the look-ahead, so this only computes scores for histories without an active table
+    hyp.lmLookahead = lmLookahead_->getLookahead(hyp.lmHistory);
+    lmLookahead_->fill(hyp.lmLookahead, sparseLmLookahead_);
+    hyp.lmLookaheadScore = lmLookaheadScore(*hyp.lmLookahead, hyp.currentState);
+    hyp.score += hyp.lmLookaheadScore;
+    if (hyp.length > 0ul) {
+        hyp.scaledScore = hyp.score / std::pow(hyp.length, lengthNormScale_);
+    }
+    lmLookaheadTime_.stop();
+}
+
 void TreeLabelsyncBeamSearch::finalizeHypotheses() {
     // Only keep terminated hypotheses (they already contain the sentence-end AM and LM score)
     newBeam_.clear();
@@ -1274,12 +1413,13 @@ void TreeLabelsyncBeamSearch::finalizeHypotheses() {
     for (size_t hypIndex = 0ul; hypIndex < tempHypotheses_.size(); ++hypIndex) {
         auto const& hyp = tempHypotheses_[hypIndex];
         withinWordExtensions_.push_back(
-                {.nextToken      = sentenceEndLabelIndex_,
-                 .nextState      = hyp.currentState,
-                 .timeframe      = hyp.trace->time,
-                 .score          = hyp.score,
-                 .transitionType = Nn::TransitionType::SENTENCE_END,
-                 .baseHypIndex   = hypIndex});
+                {.nextToken        = sentenceEndLabelIndex_,
+                 .nextState        = hyp.currentState,
+                 .timeframe        = hyp.trace->time,
+                 .score            = hyp.score,
+                 .lmLookaheadScore = hyp.lmLookaheadScore,
+                 .transitionType   = Nn::TransitionType::SENTENCE_END,
+                 .baseHypIndex     = hypIndex});
     }
 
     // Score sentence-end with all label scorers
@@ -1293,8 +1433,12 @@ void TreeLabelsyncBeamSearch::finalizeHypotheses() {
             scoringContexts_.push_back(hyp.scoringContexts[scorerIdx]);
         }
 
+        std::vector<std::optional<Nn::ScoreAccessorRef>> scoreAccessors;
         scoringTime_.start();
-        auto scoreAccessors = labelScorers_[scorerIdx]->getScoreAccessors(scoringContexts_);
+        {
+            TRACE_SCOPE("search", "label-scoring");
+            scoreAccessors = labelScorers_[scorerIdx]->getScoreAccessors(scoringContexts_);
+        }
         scoringTime_.stop();
         std::vector<std::optional<Nn::DenseScoreSpan>> denseScoreSpans(scoreAccessors.size(), std::nullopt);
         std::vector<Nn::TimeframeIndex>                scoreTimes(scoreAccessors.size(), 0);
@@ -1337,7 +1481,7 @@ void TreeLabelsyncBeamSearch::finalizeHypotheses() {
         wordEndExtensions_.push_back({
                 .pron           = sentenceEndLemma_->pronunciations().first,
                 .rootState      = hyp.currentState,
-                .score          = hyp.score + sentenceEndScore,
+                .score          = hyp.score - hyp.lmLookaheadScore + sentenceEndScore,
                 .timeframe      = hyp.timeframe,
                 .transitionType = Nn::TransitionType::SENTENCE_END,
                 .baseHypIndex   = hypIndex,
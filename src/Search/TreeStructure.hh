@@ -427,6 +427,12 @@ public:
         return edgeTargetBatches_;
     }
 
+    /// Bytes allocated for the states and edges
+    size_t memoryUsage() const {
+        return (subTreeListBatches_.capacity() + edgeTargetBatches_.capacity()) * sizeof(StateId) +
+               states_.capacity() * sizeof(HMMState) + edgeTargetLists_.capacity() * sizeof(SuccessorBatchId);
+    }
+
 private:
     void addTargetToEdge(SuccessorBatchId& batch, u32 target);
     u32  countReachableEnds(std::vector<u32>& counts, StateId node) const;
@@ -20,6 +20,7 @@
 
 #include <Am/ClassicStateModel.hh>
 #include <Core/CollapsedVector.hh>
+#include <Core/Tracing.hh>
 #include <Core/XmlStream.hh>
 #include <Lattice/LatticeAdaptor.hh>
 #include <Math/Utilities.hh>
@@ -51,8 +52,10 @@ TreeTimesyncBeamSearch::LabelHypothesis::LabelHypothesis()
           currentToken(Nn::invalidLabelIndex),
           currentState(invalidTreeNodeIndex),
           lmHistory(),
+          lmLookahead(),
           timeframe(0),
           score(0.0),
+          lmLookaheadScore(0.0),
           trace(Core::ref(new LatticeTrace(0, {0, 0}, {})))
 #ifdef SEARCHV2_DEBUG
           ,
@@ -71,8 +74,10 @@ TreeTimesyncBeamSearch::LabelHypothesis::LabelHypothesis(
           currentToken(extension.nextToken),
           currentState(extension.nextState),
           lmHistory(base.lmHistory),
+          lmLookahead(base.lmLookahead),
           timeframe(extension.timeframe),
           score(extension.score),
+          lmLookaheadScore(extension.lmLookaheadScore),
           trace(base.trace)
 #ifdef SEARCHV2_DEBUG
           ,
@@ -96,8 +101,10 @@ TreeTimesyncBeamSearch::LabelHypothesis::LabelHypothesis(
           currentToken(base.currentToken),
           currentState(extension.rootState),
           lmHistory(newLmHistory),
+          lmLookahead(),
           timeframe(base.timeframe),
-          score(extension.score)
+          score(extension.score),
+          lmLookaheadScore(0.0)
 #ifdef SEARCHV2_DEBUG
           ,
           tokenSequence(base.tokenSequence),
@@ -105,7 +112,8 @@ TreeTimesyncBeamSearch::LabelHypothesis::LabelHypothesis(
           tokenTimeframes(base.tokenTimeframes)
 #endif
 {
-    auto newLmScore   = score - base.score;
+    // The LM look-ahead score of the base hypothesis is replaced by the actual LM score
+    auto newLmScore   = score - (base.score - base.lmLookaheadScore);
     auto totalLmScore = base.trace->score.lm + newLmScore;
     auto totalAmScore = score - totalLmScore;
 
@@ -232,6 +240,16 @@ const Core::ParameterChoice TreeTimesyncBeamSearch::paramRecombinationMode(
         "Whether hypotheses with identical recombination state should be recombined.",
         RecombinationModeOn);
 
+const Core::ParameterBool TreeTimesyncBeamSearch::paramLmLookahead(
+        "lm-lookahead",
+        "Anticipate the LM scores of the words reachable from each state in the search tree for pruning. Configured via the \"lm-lookahead\" sub-component.",
+        false);
+
+const Core::ParameterBool TreeTimesyncBeamSearch::paramSparseLmLookahead(
+        "sparse-lm-lookahead",
+        "Use sparse LM look-ahead tables for histories with few explicitly scored successors (requires a sparse LM such as a backing-off LM).",
+        true);
+
 TreeTimesyncBeamSearch::TreeTimesyncBeamSearch(Core::Configuration const& config)
         : Core::Component(config),
           SearchAlgorithmV2(config),
@@ -251,9 +269,13 @@ TreeTimesyncBeamSearch::TreeTimesyncBeamSearch(Core::Configuration const& config
           sentenceEndFallback_(paramSentenceEndFallBack(config)),
           recombinationEnabled_(paramRecombinationMode(config) == RecombinationModeOn),
           logStepwiseStatistics_(paramLogStepwiseStatistics(config)),
+          useLmLookahead_(paramLmLookahead(config)),
+          sparseLmLookahead_(paramSparseLmLookahead(config)),
           labelScorers_(),
           nonWordLemmas_(),
           debugChannel_(config, "debug"),
+          lmLookahead_(),
+          unigramLmLookahead_(),
           hypIndexToContextIndexMap_(),
           withinWordExtensions_(),
           wordEndExtensions_(),
@@ -267,6 +289,7 @@ TreeTimesyncBeamSearch::TreeTimesyncBeamSearch(Core::Configuration const& config
           initializationTime_(),
           featureProcessingTime_(),
           scoringTime_(),
+          lmLookaheadTime_(),
           numHypsAfterRecombination_("num-hyps-after-recombination"),
           numHypsAfterPruning_("num-hyps-after-pruning"),
           numWordEndHypsAfterScorePruning_("num-word-end-hyps-after-score-pruning"),
@@ -394,6 +417,10 @@ bool TreeTimesyncBeamSearch::setModelCombination(Speech::ModelCombination const&
     // Create look-ups for state successors and exits of each state
     createSuccessorLookups();
 
+    if (useLmLookahead_) {
+        initializeLmLookahead();
+    }
+
     return true;
 }
 
@@ -401,6 +428,7 @@ void TreeTimesyncBeamSearch::enterSegment(Bliss::SpeechSegment const* segment) {
     initializationTime_.reset();
     featureProcessingTime_.reset();
     scoringTime_.reset();
+    lmLookaheadTime_.reset();
     for (auto& stat : numHypsAfterIntermediatePruning_) {
         stat.clear();
     }
@@ -438,6 +466,10 @@ void TreeTimesyncBeamSearch::enterSegment(Bliss::SpeechSegment const* segment) {
             hyp.lmHistory = languageModel_->startHistory();
         }
     }
+
+    if (lmLookahead_) {
+        activateLmLookahead(beam_.front());
+    }
 }
 
 void TreeTimesyncBeamSearch::finishSegment() {
@@ -506,7 +538,25 @@ Core::Ref<const LatticeTrace> TreeTimesyncBeamSearch::getCommonPrefix() const {
     return Core::Ref<const LatticeTrace>(searcher.rootTrace());
 }
 
+size_t TreeTimesyncBeamSearch::numHypotheses() const {
+    return beam_.size();
+}
+
+std::vector<Nn::ScoringContextRef> TreeTimesyncBeamSearch::nextScoringContexts() const {
+    std::vector<Nn::ScoringContextRef> result;
+    if (finishedSegment_ or labelScorers_.empty()) {
+        return result;
+    }
+
+    result.reserve(beam_.size());
+    for (auto const& hyp : beam_) {
+        result.push_back(hyp.scoringContexts.front());
+    }
+    return result;
+}
+
 bool TreeTimesyncBeamSearch::decodeStep() {
+    TRACE_SCOPE("search", "decode-step");
     if (finishedSegment_) {
         return false;
     }
@@ -538,8 +588,12 @@ bool TreeTimesyncBeamSearch::decodeStep() {
         /*
          * Perform scoring of all the scoring contexts with the label scorer.
          */
+        std::vector<std::optional<Nn::ScoreAccessorRef>> scoreAccessors;
         scoringTime_.start();
-        auto scoreAccessors = labelScorer->getScoreAccessors(scoringContexts_);
+        {
+            TRACE_SCOPE("search", "label-scoring");
+            scoreAccessors = labelScorer->getScoreAccessors(scoringContexts_);
+        }
         scoringTime_.stop();
         std::vector<std::optional<Nn::DenseScoreSpan>> denseScoreSpans(scoreAccessors.size(), std::nullopt);
         std::vector<Nn::TimeframeIndex>                scoreTimes(scoreAccessors.size(), 0);
@@ -580,6 +634,12 @@ bool TreeTimesyncBeamSearch::decodeStep() {
                     auto transitionType = inferTransitionType(hyp.currentToken, tokenIdx, hyp.currentState == successorState);
                     auto extScore       = hyp.score;
                     auto extTime        = hyp.timeframe;
+                    auto extLmLookahead = hyp.lmLookaheadScore;
+                    if (lmLookahead_ and successorState != hyp.currentState) {
+                        // Replace the look-ahead score of the current state by the one of the successor state
+                        extLmLookahead = lmLookaheadScore(*hyp.lmLookahead, successorState);
+                        extScore += extLmLookahead - hyp.lmLookaheadScore;
+                    }
                     if (labelScorers_[scorerIdx]->scoresTransition(transitionType)) {
                         if (denseScores and tokenIdx < denseScores->size()) {
                             extScore += (*denseScores)[tokenIdx];
@@ -597,12 +657,13 @@ bool TreeTimesyncBeamSearch::decodeStep() {
                     currentBestScore = std::min(currentBestScore, extScore);
 
                     withinWordExtensions_.push_back(
-                            {.nextToken      = tokenIdx,
-                             .nextState      = successorState,
-                             .timeframe      = extTime,
-                             .score          = extScore,
-                             .transitionType = transitionType,
-                             .baseHypIndex   = hypIndex});
+                            {.nextToken        = tokenIdx,
+                             .nextState        = successorState,
+                             .timeframe        = extTime,
+                             .score            = extScore,
+                             .lmLookaheadScore = extLmLookahead,
+                             .transitionType   = transitionType,
+                             .baseHypIndex     = hypIndex});
                 }
             }
         }
@@ -743,7 +804,7 @@ bool TreeTimesyncBeamSearch::decodeStep() {
             wordEndExtensions_.push_back({
                     .pron           = lemmaPron,
                     .rootState      = exit.transitState,
-                    .score          = hyp.score + lmScore + penalty,
+                    .score          = hyp.score - hyp.lmLookaheadScore + lmScore + penalty,
                     .transitionType = wordEndtransitionType,
                     .baseHypIndex   = hypIndex,
             });
@@ -774,6 +835,9 @@ bool TreeTimesyncBeamSearch::decodeStep() {
         }
 
         wordEndHypotheses_.push_back({baseHyp, extension, newLmHistory});
+        if (lmLookahead_) {
+            activateLmLookahead(wordEndHypotheses_.back());
+        }
     }
 
     recombination(wordEndHypotheses_, true);
@@ -793,6 +857,7 @@ bool TreeTimesyncBeamSearch::decodeStep() {
     beam_.insert(beam_.end(), wordEndHypotheses_.begin(), wordEndHypotheses_.end());
 
     numActiveHyps_ += beam_.size();
+    TRACE_COUNTER("search", "active-hyps", beam_.size());
 
     ++currentSearchStep_;
 
@@ -818,6 +883,9 @@ bool TreeTimesyncBeamSearch::decodeStep() {
     if (logStepwiseStatistics_) {
         clog() << Core::XmlFull("num-active-trees", seenHistories.size());
     }
+    if (lmLookahead_) {
+        lmLookahead_->collectStatistics();
+    }
 
     /*
      * Apply maximum-stable-delay-pruning.
@@ -869,6 +937,9 @@ void TreeTimesyncBeamSearch::logStatistics() const {
     clog() << Core::XmlOpen("initialization-time") << initializationTime_.elapsedMilliseconds() << Core::XmlClose("initialization-time");
     clog() << Core::XmlOpen("feature-processing-time") << featureProcessingTime_.elapsedMilliseconds() << Core::XmlClose("feature-processing-time");
     clog() << Core::XmlOpen("scoring-time") << scoringTime_.elapsedMilliseconds() << Core::XmlClose("scoring-time");
+    if (lmLookahead_) {
+        clog() << Core::XmlOpen("lm-lookahead-time") << lmLookaheadTime_.elapsedMilliseconds() << Core::XmlClose("lm-lookahead-time");
+    }
     clog() << Core::XmlClose("timing-statistics");
     for (auto const& stat : numHypsAfterIntermediatePruning_) {
         stat.write(clog());
@@ -880,6 +951,9 @@ void TreeTimesyncBeamSearch::logStatistics() const {
     numWordEndHypsAfterBeamPruning_.write(clog());
     numActiveHyps_.write(clog());
     numActiveTrees_.write(clog());
+    if (lmLookahead_) {
+        lmLookahead_->logStatistics();
+    }
 }
 
 Nn::TransitionType TreeTimesyncBeamSearch::inferTransitionType(Nn::LabelIndex prevLabel, Nn::LabelIndex nextLabel, bool isSameState) const {
@@ -1122,6 +1196,66 @@ void TreeTimesyncBeamSearch::createSuccessorLookups() {
     stateExitsOffset_[numStates]      = stateExits_.size();
 }
 
+void TreeTimesyncBeamSearch::initializeLmLookahead() {
+    // Release all tables of a previous look-ahead instance before replacing it
+    beam_.clear();
+    newBeam_.clear();
+    wordEndHypotheses_.clear();
+    tempHypotheses_.clear();
+    unigramLmLookahead_.reset();
+
+    if (sparseLmLookahead_ and not languageModel_->isSparse(Lm::History())) {
+        warning() << "Not using sparse LM look-ahead because the LM can not be sparse";
+        sparseLmLookahead_ = false;
+    }
+    if (sparseLmLookahead_) {
+        log() << "Use sparse LM look-ahead";
+    }
+
+    // Pronunciation scores are not part of the search, so they are not considered in the look-ahead either
+    lmLookahead_ = std::make_unique<LanguageModelLookahead>(
+            select("lm-lookahead"),
+            0.0,
+            languageModel_,
+            network_->structure,
+            network_->rootState,
+            network_->exits,
+            acousticModel_,
+            sparseLmLookahead_);
+
+    Lm::History unigramHistory = languageModel_->reducedHistory(languageModel_->startHistory(), 0);
+    if (lmLookahead_->historyLimit() == 0 and not languageModel_->unscaled()->fixedHistory(0) and sparseLmLookahead_ and not languageModel_->isSparse(unigramHistory)) {
+        log() << "LM look-ahead history with limit 0 is not fixed, apply caching for partial sparse unigram look-ahead";
+        lmLookahead_->cacheBatch(unigramHistory);
+    }
+    unigramLmLookahead_ = lmLookahead_->getLookahead(unigramHistory);
+    lmLookahead_->fill(unigramLmLookahead_);
+}
+
+Score TreeTimesyncBeamSearch::lmLookaheadScore(LanguageModelLookahead::ContextLookahead const& lookahead, StateId state) const {
+    if (not lookahead.isSparse()) {
+        return lookahead.scoreForLookAheadIdNormal(lmLookahead_->lookaheadId(state));
+    }
+
+    // Words that are not explicitly scored in the sparse table are reached via the back-off
+    Score score = lookahead.backOffScore() + unigramLmLookahead_->scoreForLookAheadIdNormal(lmLookahead_->lookaheadId(state));
+    Score sparseScore;
+    if (lookahead.getScoreForLookAheadHashSparse(lmLookahead_->lookaheadHash(state), sparseScore)) {
+        score = std::min(score, sparseScore);
+    }
+    return score;
+}
+
+void TreeTimesyncBeamSearch::activateLmLookahead(LabelHypothesis& hyp) {
+    lmLookaheadTime_.start();
+    // Tables are cached inside the look-ahead, so this only computes scores for histories without an active table
+    hyp.lmLookahead = lmLookahead_->getLookahead(hyp.lmHistory);
+    lmLookahead_->fill(hyp.lmLookahead, sparseLmLookahead_);
+    hyp.lmLookaheadScore = lmLookaheadScore(*hyp.lmLookahead, hyp.currentState);
+    hyp.score += hyp.lmLookaheadScore;
+    lmLookaheadTime_.stop();
+}
+
 void TreeTimesyncBeamSearch::finalizeHypotheses() {
     tempHypotheses_.clear();
     for (auto const& hyp : beam_) {
@@ -1146,6 +1280,7 @@ void TreeTimesyncBeamSearch::finalizeHypotheses() {
                      hyp.currentState,
                      hyp.trace->time,
                      hyp.score,
+                     hyp.lmLookaheadScore,
                      Nn::TransitionType::SENTENCE_END,
                      hypIndex});
         }
@@ -1161,8 +1296,12 @@ void TreeTimesyncBeamSearch::finalizeHypotheses() {
                 scoringContexts_.push_back(hyp.scoringContexts[scorerIdx]);
             }
 
+            std::vector<std::optional<Nn::ScoreAccessorRef>> scoreAccessors;
             scoringTime_.start();
-            auto scoreAccessors = labelScorers_[scorerIdx]->getScoreAccessors(scoringContexts_);
+            {
+                TRACE_SCOPE("search", "label-scoring");
+                scoreAccessors = labelScorers_[scorerIdx]->getScoreAccessors(scoringContexts_);
+            }
             scoringTime_.stop();
             std::vector<std::optional<Nn::DenseScoreSpan>> denseScoreSpans(scoreAccessors.size(), std::nullopt);
             std::vector<Nn::TimeframeIndex>                scoreTimes(scoreAccessors.size(), 0);
@@ -1205,7 +1344,7 @@ void TreeTimesyncBeamSearch::finalizeHypotheses() {
             wordEndExtensions_.push_back({
                     .pron           = sentenceEndLemma_->pronunciations().first,
                     .rootState      = hyp.currentState,
-                    .score          = hyp.score + sentenceEndScore,
+                    .score          = hyp.score - hyp.lmLookaheadScore + sentenceEndScore,
                     .transitionType = Nn::TransitionType::SENTENCE_END,
                     .baseHypIndex   = hypIndex,
             });
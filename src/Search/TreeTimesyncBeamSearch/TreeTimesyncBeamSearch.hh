@@ -24,6 +24,7 @@
 #include <Nn/LabelScorer/LabelScorer.hh>
 #include <Nn/LabelScorer/ScoringContext.hh>
 #include <Search/Histogram.hh>
+#include <Search/LanguageModelLookahead.hh>
 #include <Search/PersistentStateTree.hh>
 #include <Search/SearchV2.hh>
 #include <Search/Traceback.hh>
@@ -34,6 +35,9 @@ namespace Search {
  * Simple time synchronous beam search algorithm on a search tree built by a TreeBuilder.
  * At a word end, a language model score is added to the hypothesis score,
  * if no language model should be used, the LM-scale has to be set to 0.0.
+ * Optionally, the LM scores are anticipated inside the tree via LM look-ahead: the score of each hypothesis then also
+ * contains the best LM score of all words that are still reachable from its current state, which is replaced by the
+ * actual LM score at the word end.
  * Performs separate pruning of within-word and word-end hypotheses
  * by max beam-size and by score difference to the best hypothesis.
  * Uses one or more LabelScorers for context initialization/extension and scoring.
@@ -58,6 +62,8 @@ public:
     static const Core::ParameterInt         paramMaximumStableDelayPruningInterval;
     static const Core::Choice               choiceRecombinationMode;
     static const Core::ParameterChoice      paramRecombinationMode;
+    static const Core::ParameterBool        paramLmLookahead;
+    static const Core::ParameterBool        paramSparseLmLookahead;
 
     TreeTimesyncBeamSearch(Core::Configuration const&);
 
@@ -75,6 +81,9 @@ public:
     Core::Ref<const LatticeAdaptor> getCurrentBestWordLattice() const override;
     Core::Ref<const LatticeTrace>   getCurrentBestLatticeTrace() const override;
     Core::Ref<const LatticeTrace>   getCommonPrefix() const override;
+    size_t                          numHypotheses() const override;
+
+    std::vector<Nn::ScoringContextRef> nextScoringContexts() const override;
 
     bool decodeStep() override;
 
@@ -83,12 +92,13 @@ protected:
      * Possible extension for some label hypothesis in the beam
      */
     struct WithinWordExtensionCandidate {
-        Nn::LabelIndex         nextToken;       // Proposed token to extend the hypothesis with
-        StateId                nextState;       // State in the search tree of this extension
-        Search::TimeframeIndex timeframe;       // Timestamp of `nextToken` for traceback
-        Score                  score;           // Would-be total score of the full hypothesis after extension
-        Nn::TransitionType     transitionType;  // Type of transition toward `nextToken`
-        size_t                 baseHypIndex;    // Index of base hypothesis in beam
+        Nn::LabelIndex         nextToken;         // Proposed token to extend the hypothesis with
+        StateId                nextState;         // State in the search tree of this extension
+        Search::TimeframeIndex timeframe;         // Timestamp of `nextToken` for traceback
+        Score                  score;             // Would-be total score of the full hypothesis after extension
+        Score                  lmLookaheadScore;  // LM look-ahead score of `nextState` which is contained in `score`
+        Nn::TransitionType     transitionType;    // Type of transition toward `nextToken`
+        size_t                 baseHypIndex;      // Index of base hypothesis in beam
 
         bool operator<(WithinWordExtensionCandidate const& other) {
             return score < other.score;
@@ -98,7 +108,7 @@ protected:
     struct WordEndExtensionCandidate {
         Bliss::LemmaPronunciation const* pron;            // Proposed lemma pronunciation
         StateId                          rootState;       // Proposed root-state to transition to
-        Score                            score;           // Would-be total score of the full hypothesis after LM score contribution
+        Score                            score;           // Would-be total score of the full hypothesis after LM score contribution (without LM look-ahead)
         Nn::TransitionType               transitionType;  // Type of transition towward `rootState`
         size_t                           baseHypIndex;    // Index of base hypothesis in beam
 
@@ -111,13 +121,15 @@ protected:
      * Struct containing all information about a single hypothesis in the beam
      */
     struct LabelHypothesis {
-        std::vector<Nn::ScoringContextRef> scoringContexts;  // Context to compute scores based on this hypothesis
-        Nn::LabelIndex                     currentToken;     // Most recent token in associated label sequence (useful to infer transition type)
-        StateId                            currentState;     // Current state in the search tree
-        Lm::History                        lmHistory;        // Language model history
-        Speech::TimeframeIndex             timeframe;        // Timeframe of current token
-        Score                              score;            // Full score of the hypothesis
-        Core::Ref<LatticeTrace>            trace;            // Associated trace for traceback or lattice building of hypothesis
+        std::vector<Nn::ScoringContextRef>                scoringContexts;   // Context to compute scores based on this hypothesis
+        Nn::LabelIndex                                    currentToken;      // Most recent token in associated label sequence (useful to infer transition type)
+        StateId                                           currentState;      // Current state in the search tree
+        Lm::History                                       lmHistory;         // Language model history
+        LanguageModelLookahead::ContextLookaheadReference lmLookahead;       // LM look-ahead table for `lmHistory` (empty if LM look-ahead is disabled)
+        Speech::TimeframeIndex                            timeframe;         // Timeframe of current token
+        Score                                             score;             // Full score of the hypothesis including `lmLookaheadScore`
+        Score                                             lmLookaheadScore;  // LM look-ahead score of `currentState`
+        Core::Ref<LatticeTrace>                           trace;             // Associated trace for traceback or lattice building of hypothesis
 
 #ifdef SEARCHV2_DEBUG
         std::vector<Nn::LabelIndex>         tokenSequence;     // Full sequence of predicted tokens for debugging purposes
@@ -130,7 +142,7 @@ protected:
         // Within-word constructor from base and within-word extension
         LabelHypothesis(LabelHypothesis const& base, WithinWordExtensionCandidate const& extension, std::vector<Nn::ScoringContextRef> const& newScoringContexts);
 
-        // Word-end constructor from base and word-end extension
+        // Word-end constructor from base and word-end extension. The LM look-ahead for the new history is not applied yet.
         LabelHypothesis(LabelHypothesis const& base, WordEndExtensionCandidate const& extension, Lm::History const& newLmHistory);
 
         bool operator<(LabelHypothesis const& other) const {
@@ -163,6 +175,8 @@ private:
     bool sentenceEndFallback_;
     bool recombinationEnabled_;
     bool logStepwiseStatistics_;
+    bool useLmLookahead_;
+    bool sparseLmLookahead_;
 
     std::vector<Core::Ref<Nn::LabelScorer>>        labelScorers_;
     Bliss::LexiconRef                              lexicon_;
@@ -172,6 +186,10 @@ private:
     Core::Ref<Lm::ScaledLanguageModel>             languageModel_;
     Core::Channel                                  debugChannel_;
 
+    // Declared before the hypothesis containers since the hypotheses hold references to its tables
+    std::unique_ptr<LanguageModelLookahead>           lmLookahead_;
+    LanguageModelLookahead::ContextLookaheadReference unigramLmLookahead_;
+
     // Pre-allocated intermediate vectors
     std::vector<int>                          hypIndexToContextIndexMap_;
     std::vector<WithinWordExtensionCandidate> withinWordExtensions_;
@@ -194,6 +212,7 @@ private:
     Core::StopWatch initializationTime_;
     Core::StopWatch featureProcessingTime_;
     Core::StopWatch scoringTime_;
+    Core::StopWatch lmLookaheadTime_;
 
     std::vector<Core::Statistics<u32>> numHypsAfterIntermediatePruning_;
     Core::Statistics<u32>              numHypsAfterRecombination_;
@@ -236,6 +255,24 @@ private:
      */
     void createSuccessorLookups();
 
+    /*
+     * Build the LM look-ahead structure on the search tree and fill the unigram table which is used as
+     * back-off for sparse look-ahead tables.
+     */
+    void initializeLmLookahead();
+
+    /*
+     * LM look-ahead score of `state` in the given look-ahead table. For sparse tables, nodes without an explicit score
+     * fall back to the back-off score of the table plus the unigram look-ahead score.
+     */
+    Score lmLookaheadScore(LanguageModelLookahead::ContextLookahead const& lookahead, StateId state) const;
+
+    /*
+     * Retrieve the LM look-ahead table for the LM history of `hyp` and add the look-ahead score of its current state to its score.
+     * Expects that no look-ahead score is contained in the hypothesis score yet.
+     */
+    void activateLmLookahead(LabelHypothesis& hyp);
+
     /*
      * After reaching the segment end, go through the active hypotheses, only keep those
      * which are final states of the search tree.
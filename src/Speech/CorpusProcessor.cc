@@ -13,13 +13,15 @@
  *  limitations under the License.
  */
 #include "CorpusProcessor.hh"
+#include <Core/MemoryAccounting.hh>
 #include <Flow/Types.hh>
 
 using namespace Speech;
 
 CorpusProcessor::CorpusProcessor(const Core::Configuration& c)
         : Component(c),
-          channelTimer_(c, "real-time-factor") {}
+          channelTimer_(c, "real-time-factor"),
+          channelMemory_(c, "memory-usage") {}
 
 CorpusProcessor::~CorpusProcessor() {}
 
@@ -33,6 +35,9 @@ void CorpusProcessor::enterRecording(Bliss::Recording*) {}
 void CorpusProcessor::leaveRecording(Bliss::Recording*) {}
 
 void CorpusProcessor::enterSegment(Bliss::Segment*) {
+    if (channelMemory_.isOpen()) {
+        Core::MemoryAccounting::resetPeaks();
+    }
     timer_.start();
 }
 
@@ -62,6 +67,9 @@ void CorpusProcessor::leaveSegment(Bliss::Segment* s) {
         timer_.stop();
         timer_.write(channelTimer_);
     }
+    if (channelMemory_.isOpen()) {
+        Core::MemoryAccounting::write(channelMemory_);
+    }
 }
 
 void CorpusProcessor::leaveSpeechSegment(Bliss::SpeechSegment* speechSegment) {
@@ -28,10 +28,12 @@ class CorpusVisitor;
  *
  * Output (XML format):
  * - CPU time and real time factor (channel: real-time-factor)
+ * - current and peak memory of the accounted subsystems (channel: memory-usage)
  */
 class CorpusProcessor : public virtual Core::Component {
 protected:
     Core::XmlChannel channelTimer_;
+    Core::XmlChannel channelMemory_;
     Core::Timer      timer_;
     void             reportRealTime(Flow::Time);
 
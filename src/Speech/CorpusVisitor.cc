@@ -208,6 +208,13 @@ void CorpusVisitor::visitSpeechSegment(Bliss::SpeechSegment* speechSegment) {
     ++segmentIndex_;
 }
 
+void CorpusVisitor::announceSegments(const std::vector<Bliss::Segment*>& segments) {
+    // Only the segment id is announced, since it identifies the cache entries of a segment.
+    for (size_t i = 0; i < dataSources_.size(); ++i)
+        for (size_t j = 0; j < segments.size(); ++j)
+            dataSources_[i]->announceParameter("id", segments[j]->fullName());
+}
+
 void CorpusVisitor::clearRegistrations() {
     corpusKeys_.clear();
     dataSources_.clear();
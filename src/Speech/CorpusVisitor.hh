@@ -62,6 +62,7 @@ protected:
     virtual void leaveRecording(Bliss::Recording*);
     virtual void visitSegment(Bliss::Segment*);
     virtual void visitSpeechSegment(Bliss::SpeechSegment*);
+    virtual void announceSegments(const std::vector<Bliss::Segment*>&);
 
 public:
     CorpusVisitor(const Core::Configuration& c);
@@ -73,19 +73,7 @@ ModelCombination::ModelCombination(const Core::Configuration& c,
     }
     if (mode & useLabelScorer) {
         Nn::ModelCache modelCache;
-        for (size_t i = 0; i < labelScorers_.size(); ++i) {
-            std::string subConfigName;
-            if (labelScorers_.size() == 1) {
-                subConfigName = "label-scorer";
-            }
-            else {
-                subConfigName = std::string("label-scorer-") + std::to_string(i + 1);
-            }
-            setLabelScorer(Nn::Module::instance().labelScorerFactory().createLabelScorer(select(subConfigName), modelCache), i);
-            if (!labelScorers_[i]) {
-                criticalError("Failed to initialize label scorer %zu", i + 1);
-            }
-        }
+        createLabelScorers(modelCache);
     }
 }
 
@@ -126,6 +114,22 @@ void ModelCombination::setLabelScorer(Core::Ref<Nn::LabelScorer> ls, size_t inde
     labelScorers_[index] = ls;
 }
 
+void ModelCombination::createLabelScorers(Nn::ModelCache& modelCache) {
+    for (size_t i = 0; i < labelScorers_.size(); ++i) {
+        std::string subConfigName;
+        if (labelScorers_.size() == 1) {
+            subConfigName = "label-scorer";
+        }
+        else {
+            subConfigName = std::string("label-scorer-") + std::to_string(i + 1);
+        }
+        setLabelScorer(Nn::Module::instance().labelScorerFactory().createLabelScorer(select(subConfigName), modelCache), i);
+        if (!labelScorers_[i]) {
+            criticalError("Failed to initialize label scorer %zu", i + 1);
+        }
+    }
+}
+
 void ModelCombination::distributeScaleUpdate(const Mc::ScaleUpdate& scaleUpdate) {
     if (lexicon_) {
         Mm::Score scale;
@@ -22,6 +22,7 @@
 #include <Lm/ScaledLanguageModel.hh>
 #include <Mc/Component.hh>
 #include <Nn/LabelScorer/LabelScorer.hh>
+#include <Nn/LabelScorer/ModelCache.hh>
 
 namespace Speech {
 
@@ -104,6 +105,10 @@ public:
 
     void setLabelScorer(Core::Ref<Nn::LabelScorer> ls, size_t index = 0ul);
 
+    // Create all label scorers from the config. Models are taken from or put into the given cache,
+    // so that several model combinations can share them.
+    void createLabelScorers(Nn::ModelCache& modelCache);
+
     Core::Ref<Nn::LabelScorer> labelScorer(size_t index = 0ul) const {
         verify(index < labelScorers_.size());
         return labelScorers_[index];
@@ -0,0 +1,228 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <Bliss/CorpusDescription.hh>
+#include <Bliss/CorpusImage.hh>
+#include <Bliss/CorpusParser.hh>
+#include <Core/TextStream.hh>
+#include <Test/File.hh>
+#include <Test/UnitTest.hh>
+
+namespace {
+
+/** Records the traversal as one line per event. */
+class TraceVisitor : public Bliss::CorpusVisitor {
+public:
+    void enterCorpus(Bliss::Corpus* corpus) {
+        trace_.push_back("enter " + corpus->fullName());
+    }
+    void leaveCorpus(Bliss::Corpus* corpus) {
+        trace_.push_back("leave " + corpus->fullName());
+    }
+    void enterRecording(Bliss::Recording* recording) {
+        trace_.push_back("enter " + recording->fullName() + " " + recording->audio());
+    }
+    void leaveRecording(Bliss::Recording* recording) {
+        trace_.push_back("leave " + recording->fullName());
+    }
+    void visitSpeechSegment(Bliss::SpeechSegment* segment) {
+        std::string s = segment->fullName() + Core::form(" %.2f %.2f %d", segment->start(), segment->end(), segment->track());
+        if (segment->speaker())
+            s += Core::form(" %s:%d", segment->speaker()->fullName().c_str(), segment->speaker()->gender());
+        if (segment->condition())
+            s += " " + segment->condition()->fullName();
+        s += " " + describe(segment->orthography()) + " [" + segment->leftContextOrth() + "|" + segment->rightContextOrth() + "]";
+        segments_.push_back(segment->fullName());
+        trace_.push_back(s);
+    }
+
+    const std::vector<std::string>& trace() const {
+        return trace_;
+    }
+    const std::vector<std::string>& segments() const {
+        return segments_;
+    }
+
+private:
+    static std::string describe(const Bliss::Orthography& orth) {
+        std::string result;
+        for (const Bliss::Orthography::Span& span : orth.spans()) {
+            if (span.type() == Bliss::Orthography::Span::Type::text) {
+                result += "(" + span.text() + ")";
+            }
+            else {
+                result += "{";
+                for (const Bliss::Orthography& alternative : span.alternatives())
+                    result += describe(alternative) + ";";
+                result += "}";
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::string> trace_, segments_;
+};
+
+}  // namespace
+
+class CorpusImageTest : public Test::ConfigurableFixture {
+public:
+    void setUp();
+    void tearDown();
+
+protected:
+    void                     createCorpus();
+    std::vector<std::string> traverse(bool useImage, std::vector<std::string>* segments = 0);
+    ::Test::Directory*       tmpDir_;
+    std::string              corpusFile_, imageFile_, orderFile_;
+};
+
+void CorpusImageTest::setUp() {
+    tmpDir_     = new ::Test::Directory;
+    corpusFile_ = ::Test::File(*tmpDir_, "test.corpus").path();
+    imageFile_  = ::Test::File(*tmpDir_, "test.corpus.image").path();
+    orderFile_  = ::Test::File(*tmpDir_, "segments").path();
+    createCorpus();
+    setParameter("*.channel", "nil");
+    setParameter("*.error.channel", "stderr");
+    setParameter("*.corpus.file", corpusFile_);
+}
+
+void CorpusImageTest::tearDown() {
+    delete tmpDir_;
+}
+
+void CorpusImageTest::createCorpus() {
+    Core::TextOutputStream os(corpusFile_);
+    os << "<?xml version=\"1.0\" encoding=\"utf8\"?>\n"
+       << "<corpus name=\"test\">\n"
+       << "  <speaker-description name=\"a\"><gender>female</gender></speaker-description>\n"
+       << "  <speaker-description><gender>male</gender></speaker-description>\n"
+       << "  <condition-description name=\"clean\"/>\n"
+       << "  <recording name=\"r1\" audio=\"r1.wav\">\n"
+       << "    <segment name=\"s1\" start=\"0.0\" end=\"1.5\" track=\"1\"><speaker name=\"a\"/>\n"
+       << "      <orth>one <alternatives><orth>two</orth><orth>too <optional>much</optional></orth></alternatives> three</orth>\n"
+       << "      <left-context-orth>zero</left-context-orth></segment>\n"
+       << "    <segment start=\"1.5\" end=\"2.0\"><orth>default speaker</orth></segment>\n"
+       << "    <segment name=\"s3\" start=\"2.0\" end=\"4.0\">\n"
+       << "      <condition-description/><speaker-description><gender>female</gender></speaker-description>\n"
+       << "      <right-context-orth>four</right-context-orth></segment>\n"
+       << "  </recording>\n"
+       << "  <subcorpus name=\"sub\">\n"
+       << "    <speaker-description name=\"b\"/>\n"
+       << "    <condition-description name=\"noisy\"/><condition name=\"noisy\"/>\n"
+       << "    <subcorpus name=\"inner\">\n"
+       << "      <recording name=\"r2\" audio=\"r2.wav\">\n"
+       << "        <speaker-description name=\"c\"/><speaker name=\"c\"/>\n"
+       << "        <segment name=\"x\" start=\"0\" end=\"3\"><orth>x</orth></segment>\n"
+       << "        <segment name=\"y\" start=\"3\" end=\"3.5\"><speaker name=\"b\"/><condition name=\"clean\"/><orth>y</orth></segment>\n"
+       << "      </recording>\n"
+       << "    </subcorpus>\n"
+       << "    <recording name=\"r3\" audio=\"r3.wav\">\n"
+       << "      <segment name=\"z\" start=\"0\" end=\"0.5\"><speaker name=\"a\"/><orth>z</orth></segment>\n"
+       << "    </recording>\n"
+       << "  </subcorpus>\n"
+       << "</corpus>\n";
+}
+
+std::vector<std::string> CorpusImageTest::traverse(bool useImage, std::vector<std::string>* segments) {
+    setParameter("*.corpus.image", useImage ? imageFile_ : "");
+    Bliss::CorpusDescription description(select("corpus"));
+    TraceVisitor             visitor;
+    description.accept(&visitor);
+    if (segments)
+        *segments = visitor.segments();
+    return visitor.trace();
+}
+
+TEST_F(Bliss, CorpusImageTest, DocumentOrder) {
+    std::vector<std::string> parsed = traverse(false);
+    EXPECT_FALSE(Core::isRegularFile(imageFile_));
+    std::vector<std::string> compiled = traverse(true);
+    EXPECT_TRUE(Core::isRegularFile(imageFile_));
+    std::vector<std::string> mounted = traverse(true);
+    EXPECT_EQ(parsed.size(), compiled.size());
+    EXPECT_EQ(parsed.size(), mounted.size());
+    for (u32 i = 0; i < parsed.size() && i < compiled.size() && i < mounted.size(); ++i) {
+        EXPECT_EQ(parsed[i], compiled[i]);
+        EXPECT_EQ(parsed[i], mounted[i]);
+    }
+}
+
+TEST_F(Bliss, CorpusImageTest, SegmentOrder) {
+    std::vector<std::string> segments;
+    traverse(false, &segments);
+    {
+        Core::TextOutputStream os(orderFile_);
+        for (std::vector<std::string>::const_reverse_iterator s = segments.rbegin(); s != segments.rend(); ++s)
+            os << *s << std::endl;
+    }
+    setParameter("*.corpus.segment-order", orderFile_);
+    std::vector<std::string> visited;
+    traverse(true, &visited);
+    EXPECT_EQ(segments.size(), visited.size());
+    std::vector<std::string>::const_iterator v = visited.begin();
+    for (std::vector<std::string>::const_reverse_iterator s = segments.rbegin(); s != segments.rend() && v != visited.end(); ++s, ++v)
+        EXPECT_EQ(*s, *v);
+}
+
+TEST_F(Bliss, CorpusImageTest, Shuffle) {
+    setParameter("*.corpus.segment-order-shuffle", "true");
+    setParameter("*.corpus.segment-order-shuffle-seed", "3");
+    std::vector<std::string> parsed, mounted;
+    traverse(false, &parsed);
+    traverse(true, &mounted);
+    EXPECT_EQ(parsed.size(), mounted.size());
+    for (u32 i = 0; i < parsed.size() && i < mounted.size(); ++i)
+        EXPECT_EQ(parsed[i], mounted[i]);
+}
+
+TEST_F(Bliss, CorpusImageTest, FindSegment) {
+    Bliss::CorpusImage::Builder    builder("");
+    Bliss::CorpusDescriptionParser parser(select("corpus"));
+    parser.accept(corpusFile_, &builder);
+    std::string message;
+    EXPECT_TRUE(builder.write(imageFile_, "info", message));
+
+    Bliss::CorpusImage image;
+    std::string        info;
+    EXPECT_TRUE(image.mount(imageFile_, info));
+    EXPECT_EQ(std::string("info"), info);
+    EXPECT_EQ(6u, image.nSegments());
+    for (u32 s = 0; s < image.nSegments(); ++s)
+        EXPECT_EQ(s, image.findSegment(image.segmentFullName(s)));
+    EXPECT_EQ(std::string("test/sub/inner/r2/y"), image.segmentFullName(4));
+    EXPECT_EQ(std::string("2"), image.segmentName(1));
+    EXPECT_EQ(Bliss::CorpusImage::invalidIndex, image.findSegment("test/r1/s4"));
+}
+
+TEST_F(Bliss, CorpusImageTest, ChangedCorpus) {
+    std::string settings = Bliss::CorpusImage::settings(select("corpus"), corpusFile_);
+    traverse(true);
+    {
+        Core::TextOutputStream os(corpusFile_);
+        os << "<?xml version=\"1.0\" encoding=\"utf8\"?>\n"
+           << "<corpus name=\"test\">\n"
+           << "  <recording name=\"r4\" audio=\"r4.wav\">\n"
+           << "    <segment name=\"new\" start=\"0\" end=\"1\"><orth>new</orth></segment>\n"
+           << "  </recording>\n"
+           << "</corpus>\n";
+    }
+    EXPECT_TRUE(settings != Bliss::CorpusImage::settings(select("corpus"), corpusFile_));
+    // the outdated image is ignored
+    std::vector<std::string> segments;
+    traverse(true, &segments);
+    EXPECT_EQ(size_t(1), segments.size());
+    EXPECT_EQ(std::string("test/r4/new"), segments.front());
+}
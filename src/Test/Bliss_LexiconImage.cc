@@ -0,0 +1,142 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <Bliss/Lexicon.hh>
+#include <Core/Directory.hh>
+#include <Core/TextStream.hh>
+#include <Test/File.hh>
+#include <Test/UnitTest.hh>
+
+class LexiconImageTest : public Test::ConfigurableFixture {
+public:
+    void setUp();
+    void tearDown();
+
+protected:
+    void                     createLexicon(const std::string& extraLemma = "");
+    std::vector<std::string> load(bool useImage);
+    ::Test::Directory*       tmpDir_;
+    std::string              lexiconFile_, imageFile_;
+};
+
+void LexiconImageTest::setUp() {
+    tmpDir_      = new ::Test::Directory;
+    lexiconFile_ = ::Test::File(*tmpDir_, "test.lexicon").path();
+    imageFile_   = ::Test::File(*tmpDir_, "test.lexicon.image").path();
+    createLexicon();
+    setParameter("*.channel", "nil");
+    setParameter("*.error.channel", "stderr");
+    setParameter("*.lexicon.file", lexiconFile_);
+}
+
+void LexiconImageTest::tearDown() {
+    delete tmpDir_;
+}
+
+void LexiconImageTest::createLexicon(const std::string& extraLemma) {
+    Core::TextOutputStream os(lexiconFile_);
+    os << "<?xml version=\"1.0\" encoding=\"utf8\"?>\n"
+       << "<lexicon>\n"
+       << "  <phoneme-inventory>\n"
+       << "    <phoneme><symbol>si</symbol><variation>none</variation></phoneme>\n"
+       << "    <phoneme><symbol>a</symbol><symbol>A</symbol></phoneme>\n"
+       << "    <phoneme><symbol>b</symbol></phoneme>\n"
+       << "  </phoneme-inventory>\n"
+       << "  <lemma special=\"silence\"><orth>[SILENCE]</orth><phon>si</phon><synt/><eval/></lemma>\n"
+       << "  <lemma special=\"sentence-end\"><orth>[SENTENCE-END]</orth><synt><tok>&lt;/s&gt;</tok></synt><eval/></lemma>\n"
+       << "  <lemma><orth>ab</orth><orth>aB</orth><phon weight=\"3\">a b</phon><phon>A b b</phon></lemma>\n"
+       << "  <lemma><orth>ab</orth><phon>b a</phon><synt><tok>x</tok><tok>ab</tok></synt>\n"
+       << "    <eval><tok>x</tok></eval><eval><tok>y</tok><tok>z</tok></eval></lemma>\n"
+       << "  <lemma name=\"named\"><orth>ba</orth><phon>a b</phon></lemma>\n"
+       << extraLemma
+       << "</lexicon>\n";
+}
+
+/** Describes the lexicon with all ids, one line per item. */
+std::vector<std::string> LexiconImageTest::load(bool useImage) {
+    setParameter("*.lexicon.image", useImage ? imageFile_ : "");
+    Bliss::LexiconRef        lexicon = Bliss::Lexicon::create(select("lexicon"));
+    std::vector<std::string> result;
+    if (!lexicon) {
+        return result;
+    }
+    Core::Ref<const Bliss::PhonemeInventory> pi = lexicon->phonemeInventory();
+    Bliss::PhonemeInventory::PhonemeIterator p, p_end;
+    for (Core::tie(p, p_end) = pi->phonemes(); p != p_end; ++p) {
+        result.push_back(Core::form("phoneme %d %s %d", (*p)->id(), (*p)->symbol().str(), int((*p)->isContextDependent())));
+    }
+    result.push_back(Core::form("alias %d", pi->phoneme("A")->id()));
+    Bliss::Lexicon::LemmaIterator l, l_end;
+    for (Core::tie(l, l_end) = lexicon->lemmas(); l != l_end; ++l) {
+        const Bliss::Lemma* lemma = *l;
+        std::string         s     = Core::form("lemma %d %s special=%s", lemma->id(), lemma->name().str(), lexicon->getSpecialLemmaName(lemma).c_str());
+        for (Bliss::OrthographicFormList::Iterator o = lemma->orthographicForms().begin(); o != lemma->orthographicForms().end(); ++o) {
+            s += Core::form(" orth=%s", o->str());
+        }
+        Bliss::Lemma::PronunciationIterator lp, lp_end;
+        for (Core::tie(lp, lp_end) = lemma->pronunciations(); lp != lp_end; ++lp) {
+            s += Core::form(" phon%d=%s:%.9g", lp->id(), lp->pronunciation()->format(pi).c_str(), lp->pronunciationScore());
+        }
+        for (Bliss::SyntacticTokenSequence::Iterator t = lemma->syntacticTokenSequence().begin(); t != lemma->syntacticTokenSequence().end(); ++t) {
+            s += Core::form(" synt%d=%s", (*t)->id(), (*t)->symbol().str());
+        }
+        Bliss::Lemma::EvaluationTokenSequenceIterator e, e_end;
+        for (Core::tie(e, e_end) = lemma->evaluationTokenSequences(); e != e_end; ++e) {
+            s += " eval";
+            for (Bliss::EvaluationTokenSequence::Iterator t = e->begin(); t != e->end(); ++t) {
+                s += Core::form(" %d=%s", (*t)->id(), (*t)->symbol().str());
+            }
+        }
+        result.push_back(s);
+    }
+    for (u32 i = 0; i < lexicon->letterInventory().size(); ++i) {
+        result.push_back(Core::form("letter %s", lexicon->letterInventory()[i]->symbol().str()));
+    }
+    result.push_back(Core::form("lemma %s", lexicon->lemma("ab [1]") ? "ab [1]" : "missing"));
+    result.push_back(Core::form("pronunciations %d", lexicon->nPronunciations()));
+    return result;
+}
+
+TEST_F(Bliss, LexiconImageTest, Restore) {
+    std::vector<std::string> parsed = load(false);
+    EXPECT_FALSE(Core::isRegularFile(imageFile_));
+    std::vector<std::string> compiled = load(true);
+    EXPECT_TRUE(Core::isRegularFile(imageFile_));
+    std::vector<std::string> mounted = load(true);
+    EXPECT_TRUE(parsed.size() > 10u);
+    EXPECT_EQ(parsed.size(), compiled.size());
+    EXPECT_EQ(parsed.size(), mounted.size());
+    for (u32 i = 0; i < parsed.size() && i < compiled.size() && i < mounted.size(); ++i) {
+        EXPECT_EQ(parsed[i], compiled[i]);
+        EXPECT_EQ(parsed[i], mounted[i]);
+    }
+}
+
+TEST_F(Bliss, LexiconImageTest, Outdated) {
+    load(true);
+    createLexicon("  <lemma><orth>c</orth><phon>b</phon></lemma>\n");
+    std::vector<std::string> parsed  = load(false);
+    std::vector<std::string> mounted = load(true);
+    EXPECT_EQ(parsed.size(), mounted.size());
+    for (u32 i = 0; i < parsed.size() && i < mounted.size(); ++i) {
+        EXPECT_EQ(parsed[i], mounted[i]);
+    }
+    setParameter("*.lexicon.normalize-pronunciation", "false");
+    std::vector<std::string> unnormalized = load(false);
+    mounted                               = load(true);
+    EXPECT_EQ(unnormalized.size(), mounted.size());
+    for (u32 i = 0; i < unnormalized.size() && i < mounted.size(); ++i) {
+        EXPECT_EQ(unnormalized[i], mounted[i]);
+    }
+}
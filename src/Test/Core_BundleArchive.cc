@@ -0,0 +1,68 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <fstream>
+
+#include <Core/Archive.hh>
+#include <Test/File.hh>
+#include <Test/UnitTest.hh>
+
+class BundleArchiveTest : public Test::ConfigurableFixture {
+public:
+    void setUp();
+
+protected:
+    Test::Directory dir_;
+
+    /** Creates the archive @param name holding the file @param file, uncompressed. */
+    std::string writeArchive(const std::string& name, const std::string& file, const std::string& content);
+};
+
+void BundleArchiveTest::setUp() {
+    setParameter("*.channel", "nil");
+    setParameter("*.memory-map", "true");
+    setParameter("*.max-open-files", "1");
+}
+
+std::string BundleArchiveTest::writeArchive(const std::string& name, const std::string& file, const std::string& content) {
+    Test::File     path(dir_, name);
+    Core::Archive* archive = Core::Archive::create(select("archive"), path.path(), Core::Archive::AccessModeWrite);
+    EXPECT_TRUE(archive);
+    EXPECT_TRUE(archive->writeFile(file, content, false));
+    delete archive;
+    return path.path();
+}
+
+TEST_F(Core, BundleArchiveTest, ViewOutlivesClosedMember) {
+    std::string   a = writeArchive("a.cache", "a", "content of a");
+    std::string   b = writeArchive("b.cache", "b", "content of b");
+    Test::File    bundle(dir_, "all.bundle");
+    std::ofstream(bundle.path().c_str()) << a << "\n"
+                                         << b << "\n";
+
+    Core::Archive* archive = Core::Archive::create(select("archive"), bundle.path(), Core::Archive::AccessModeRead);
+    EXPECT_TRUE(archive);
+    Core::ArchiveReader readerA(*archive, "a");
+    EXPECT_TRUE(readerA.isOpen());
+    // opening the second member closes the first one of the bundle
+    Core::ArchiveReader readerB(*archive, "b");
+    EXPECT_TRUE(readerB.isOpen());
+    delete archive;
+
+    std::string line;
+    std::getline(readerA, line);
+    EXPECT_EQ(line, std::string("content of a"));
+    std::getline(readerB, line);
+    EXPECT_EQ(line, std::string("content of b"));
+}
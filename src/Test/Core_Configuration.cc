@@ -0,0 +1,118 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <Core/Configuration.hh>
+#include <Test/UnitTest.hh>
+#include <random>
+#include <sstream>
+
+namespace {
+
+/** Value of parameter @c name in the dot-separated @c selection, "-" if it is not configured. */
+std::string lookup(const Core::Configuration& config, const std::string& selection, const std::string& name) {
+    Core::Configuration c(config);
+    c.setSelection(selection);
+    std::string value;
+    return c.get(name, value) ? value : std::string("-");
+}
+
+/** Resource selection by trying all resources, like Configuration did originally. */
+std::string linearLookup(const std::vector<std::string>& resources, const std::string& parameter) {
+    std::vector<std::string> components;
+    std::istringstream       is(parameter);
+    for (std::string c; std::getline(is, c, '.');) {
+        components.push_back(c);
+    }
+    std::string result = "-";
+    s32         best   = 0;
+    for (const std::string& name : resources) {
+        s32 m = Core::Configuration::Resource(name, name, 0).match(components);
+        if (m > best || (m == best && m > 0 && name < result)) {
+            best   = m;
+            result = name;
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(Core, Configuration, MostSpecificResource) {
+    Core::Configuration config;
+    config.set("*.file", "any");
+    config.set("*.lexicon.file", "lexicon");
+    config.set("a.*.lexicon.file", "a-lexicon");
+    config.set("*.b.*.file", "b");
+    EXPECT_EQ(lookup(config, "x.lexicon", "file"), std::string("lexicon"));
+    EXPECT_EQ(lookup(config, "a.lexicon", "file"), std::string("a-lexicon"));
+    EXPECT_EQ(lookup(config, "a.c.d.lexicon", "file"), std::string("a-lexicon"));
+    EXPECT_EQ(lookup(config, "x.y", "file"), std::string("any"));
+    EXPECT_EQ(lookup(config, "x.b.y", "file"), std::string("b"));
+    EXPECT_EQ(lookup(config, "x.y", "encoding"), std::string("-"));
+
+    // changes invalidate memorized lookups
+    config.set("*.lexicon.file", "changed");
+    EXPECT_EQ(lookup(config, "x.lexicon", "file"), std::string("changed"));
+    config.set("x.lexicon.file", "x");
+    EXPECT_EQ(lookup(config, "x.lexicon", "file"), std::string("x"));
+}
+
+TEST(Core, Configuration, EquallySpecificResources) {
+    std::streambuf*    cerr = std::cerr.rdbuf();
+    std::ostringstream warnings;
+    std::cerr.rdbuf(warnings.rdbuf());
+
+    Core::Configuration config;
+    config.set("*.b.c", "x");
+    config.set("a.*.c", "y");
+    EXPECT_EQ(lookup(config, "a.b", "c"), std::string("x"));
+    EXPECT_EQ(lookup(config, "a.b", "c"), std::string("x"));
+
+    std::cerr.rdbuf(cerr);
+    std::string w = warnings.str();
+    EXPECT_NE(w.find("is matched by 2 equally specific resources"), std::string::npos);
+    EXPECT_NE(w.find("is matched by 2", w.find("using")), std::string::npos);
+}
+
+TEST(Core, Configuration, MatchesLinearSearch) {
+    std::streambuf*    cerr = std::cerr.rdbuf();
+    std::ostringstream warnings;
+    std::cerr.rdbuf(warnings.rdbuf());
+
+    const char* components[] = {"*", "*", "a", "b", "c", "d"};
+    std::mt19937                         random(42);
+    std::uniform_int_distribution<u32>   length(1, 5), component(0, 5);
+    Core::Configuration                  config;
+    std::vector<std::string>             resources;
+    for (u32 r = 0; r < 300; ++r) {
+        std::string name;
+        for (u32 n = length(random); n > 0; --n) {
+            name += std::string(name.empty() ? "" : ".") + components[component(random)];
+        }
+        config.set(name, name);
+        if (std::find(resources.begin(), resources.end(), name) == resources.end()) {
+            resources.push_back(name);
+        }
+        for (u32 q = 0; q < 10; ++q) {
+            std::string selection = "a";
+            for (u32 n = length(random); n > 0; --n) {
+                selection += std::string(".") + components[2 + component(random) % 4];
+            }
+            std::string name = components[2 + component(random) % 4];
+            EXPECT_EQ(lookup(config, selection, name), linearLookup(resources, selection + "." + name));
+        }
+    }
+
+    std::cerr.rdbuf(cerr);
+}
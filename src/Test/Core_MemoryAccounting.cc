@@ -0,0 +1,84 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <sstream>
+
+#include <Core/MemoryAccounting.hh>
+#include <Test/UnitTest.hh>
+
+using Core::MemoryAccount;
+using Core::MemoryAccounting;
+using Core::MemoryCharge;
+
+TEST(Core, MemoryAccounting, AllocateRelease) {
+    MemoryAccount& a = MemoryAccounting::account("test-allocate-release");
+    EXPECT_TRUE(&a == &MemoryAccounting::account("test-allocate-release"));
+    EXPECT_EQ(a.name(), std::string("test-allocate-release"));
+    a.allocate(100);
+    a.allocate(50);
+    a.release(120);
+    EXPECT_EQ(a.current(), s64(30));
+    EXPECT_EQ(a.peak(), s64(150));
+    a.resetPeak();
+    EXPECT_EQ(a.peak(), s64(30));
+    a.allocate(10);
+    EXPECT_EQ(a.peak(), s64(40));
+    a.release(40);
+}
+
+TEST(Core, MemoryAccounting, Charge) {
+    MemoryAccount& a = MemoryAccounting::account("test-charge");
+    {
+        MemoryCharge c("test-charge");
+        c.set(1000);
+        c.set(400);
+        EXPECT_EQ(a.current(), s64(400));
+        EXPECT_EQ(a.peak(), s64(1000));
+        {
+            MemoryCharge copy(c);
+            EXPECT_EQ(copy.bytes(), size_t(400));
+            EXPECT_EQ(a.current(), s64(800));
+        }
+        EXPECT_EQ(a.current(), s64(400));
+        MemoryCharge other("test-charge-other");
+        other.set(7);
+        other = c;
+        EXPECT_EQ(MemoryAccounting::account("test-charge-other").current(), s64(0));
+        EXPECT_EQ(a.current(), s64(800));
+    }
+    EXPECT_EQ(a.current(), s64(0));
+}
+
+TEST(Core, MemoryAccounting, ResetPeaks) {
+    MemoryAccount& a = MemoryAccounting::account("test-reset-peaks");
+    MemoryCharge   c("test-reset-peaks");
+    c.set(64);
+    c.set(16);
+    MemoryAccounting::resetPeaks();
+    EXPECT_EQ(a.peak(), s64(16));
+}
+
+TEST(Core, MemoryAccounting, Write) {
+    MemoryCharge c("test-write");
+    c.set(123);
+    std::ostringstream ss;
+    {
+        Core::XmlWriter os(ss);
+        MemoryAccounting::write(os);
+    }
+    std::string report = ss.str();
+    EXPECT_TRUE(report.find("<memory-accounting unit=\"bytes\">") != std::string::npos);
+    EXPECT_TRUE(report.find("name=\"test-write\" current=\"123\" peak=\"123\"") != std::string::npos);
+    EXPECT_TRUE(report.find("<rss ") != std::string::npos);
+}
@@ -107,4 +107,12 @@ TEST(Core, StringUtilities, ReplaceAll) {
     replaceAll(haystack, "aa", "bbb");
     EXPECT_EQ(haystack, string("bbb"));
 }
+
+TEST(Core, StringUtilities, JsonString) {
+    EXPECT_EQ(jsonString(""), string("\"\""));
+    EXPECT_EQ(jsonString("tree-timesync"), string("\"tree-timesync\""));
+    EXPECT_EQ(jsonString("a\"b\\c"), string("\"a\\\"b\\\\c\""));
+    EXPECT_EQ(jsonString("a\nb\tc"), string("\"a\\u000ab\\u0009c\""));
+    EXPECT_EQ(jsonString("\xc3\xa4"), string("\"\xc3\xa4\""));
+}
 }  // namespace Core
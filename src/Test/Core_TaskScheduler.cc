@@ -0,0 +1,143 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <thread>
+
+#include <Core/TaskScheduler.hh>
+#include <Test/UnitTest.hh>
+
+class TaskSchedulerTest : public Test::ConfigurableFixture {
+public:
+    void setUp();
+
+protected:
+    /** fib(n), each call forks a task */
+    static u32 fib(Core::TaskScheduler& scheduler, u32 n);
+};
+
+void TaskSchedulerTest::setUp() {
+    setParameter("*.channel", "nil");
+    setParameter("*.task-scheduler.core-budget", "4");
+}
+
+u32 TaskSchedulerTest::fib(Core::TaskScheduler& scheduler, u32 n) {
+    if (n < 2) {
+        return n;
+    }
+    std::future<u32> a = scheduler.submit([&scheduler, n]() { return fib(scheduler, n - 1); });
+    u32              b = fib(scheduler, n - 2);
+    return scheduler.get(a) + b;
+}
+
+TEST_F(Core, TaskSchedulerTest, Submit) {
+    Core::TaskScheduler scheduler(select("task-scheduler"));
+    EXPECT_EQ(scheduler.nWorkers(), 3u);
+    std::future<int> f = scheduler.submit([]() { return 42; });
+    EXPECT_EQ(scheduler.get(f), 42);
+    EXPECT_EQ(fib(scheduler, 18), 2584u);
+}
+
+TEST_F(Core, TaskSchedulerTest, ParallelFor) {
+    Core::TaskScheduler           scheduler(select("task-scheduler"));
+    std::vector<std::atomic<u32>> visits(10007);
+    scheduler.parallelFor(3, visits.size(), 100, [&visits](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            ++visits[i];
+        }
+    });
+    u32 wrong = 0;
+    for (size_t i = 0; i < visits.size(); ++i) {
+        wrong += (visits[i] != (i < 3 ? 0u : 1u));
+    }
+    EXPECT_EQ(wrong, 0u);
+}
+
+TEST_F(Core, TaskSchedulerTest, ParallelReduce) {
+    Core::TaskScheduler scheduler(select("task-scheduler"));
+    auto                sum = [](size_t b, size_t e) {
+        u64 s = 0;
+        for (size_t i = b; i < e; ++i) {
+            s += i;
+        }
+        return s;
+    };
+    EXPECT_EQ(scheduler.parallelReduce(0, 100000, 7, u64(0), sum, std::plus<u64>()), u64(100000) * 99999 / 2);
+    EXPECT_EQ(scheduler.parallelReduce(5, 5, 7, u64(1), sum, std::plus<u64>()), u64(1));
+
+    // ranges are combined in order
+    std::string s = scheduler.parallelReduce(
+            0, 26, 3, std::string(),
+            [](size_t b, size_t e) {
+                std::string r;
+                for (size_t i = b; i < e; ++i) {
+                    r += char('a' + i);
+                }
+                return r;
+            },
+            std::plus<std::string>());
+    EXPECT_EQ(s, std::string("abcdefghijklmnopqrstuvwxyz"));
+}
+
+TEST_F(Core, TaskSchedulerTest, Nested) {
+    Core::TaskScheduler scheduler(select("task-scheduler"));
+    std::atomic<u32>    count(0);
+    scheduler.parallelFor(0, 16, 1, [&](size_t, size_t) {
+        scheduler.parallelFor(0, 100, 10, [&](size_t b, size_t e) { count += e - b; });
+    });
+    EXPECT_EQ(count.load(), 1600u);
+}
+
+TEST_F(Core, TaskSchedulerTest, SingleCore) {
+    setParameter("*.task-scheduler.core-budget", "1");
+    setParameter("*.task-scheduler.affinity", "compact");
+    Core::TaskScheduler scheduler(select("task-scheduler"));
+    EXPECT_EQ(scheduler.nWorkers(), 0u);
+    std::atomic<u32> count(0);
+    for (u32 i = 0; i < 10; ++i) {
+        scheduler.spawn([&count]() { ++count; });
+    }
+    std::future<u32> f = scheduler.submit([&count]() { return count.load(); });
+    EXPECT_EQ(scheduler.get(f), 10u);
+    EXPECT_EQ(fib(scheduler, 10), 55u);
+}
+
+TEST_F(Core, TaskSchedulerTest, ParallelReduceBool) {
+    // the results of neighbouring ranges are written concurrently
+    Core::TaskScheduler scheduler(select("task-scheduler"));
+    for (u32 i = 0; i < 100; ++i) {
+        bool all = scheduler.parallelReduce(0, 64, 1, true, [](size_t b, size_t) { return b != 63; }, std::logical_and<bool>());
+        EXPECT_FALSE(all);
+        bool any = scheduler.parallelReduce(0, 64, 1, false, [](size_t b, size_t) { return b == 63; }, std::logical_or<bool>());
+        EXPECT_TRUE(any);
+    }
+}
+
+TEST_F(Core, TaskSchedulerTest, WaitingBlocks) {
+    // a thread waiting for a running task sleeps instead of polling
+    Core::TaskScheduler scheduler(select("task-scheduler"));
+    std::future<int>    f = scheduler.submit([]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return 1;
+    });
+
+    timespec start, stop;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    EXPECT_EQ(scheduler.get(f), 1);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &stop);
+    double cpuSeconds = (stop.tv_sec - start.tv_sec) + 1e-9 * (stop.tv_nsec - start.tv_nsec);
+    EXPECT_LT(cpuSeconds, 0.05);
+}
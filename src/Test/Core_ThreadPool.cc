@@ -151,3 +151,24 @@ TEST(Core, ThreadPool, Reset) {
     pool.combine(&reducer);
     EXPECT_EQ(reducer.sum, num_task * (num_task - 1) / 2);
 }
+
+TEST(Core, ThreadPool, WithoutWorkers) {
+    // a single core: the scheduler has no workers, only waiting threads run tasks
+    Core::Configuration config;
+    config.set("*.channel", "nil");
+    config.set("*.core-budget", "1");
+    TaskScheduler scheduler(config);
+    EXPECT_EQ(scheduler.nWorkers(), 0u);
+    ThreadPool<TestTask, TestMapper, TestReducer> pool(scheduler);
+    TestMapper                                    mapper;
+    pool.init(4, mapper);
+    const int num_task = 100;
+    for (int t = 0; t < num_task; ++t) {
+        pool.waitForWaitingTasks(8);
+        pool.submit(TestTask(t));
+        EXPECT_TRUE(pool.numWaitingTasks() <= 9u);
+    }
+    TestReducer reducer;
+    pool.combine(&reducer);
+    EXPECT_EQ(reducer.sum, num_task * (num_task - 1) / 2);
+}
@@ -0,0 +1,111 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <Core/Tracing.hh>
+#include <Test/File.hh>
+#include <Test/UnitTest.hh>
+
+class TracingTest : public Test::ConfigurableFixture {
+public:
+    void setUp();
+    void tearDown();
+
+protected:
+    Test::Directory dir_;
+
+    /** Writes the trace and returns its contents. */
+    std::string write(s64& nEvents);
+
+    static u32 count(const std::string& s, const std::string& pattern);
+};
+
+void TracingTest::setUp() {
+    setParameter("*.channel", "nil");
+    setParameter("*.tracing.file", Test::File(dir_, "unused.json").path());
+}
+
+void TracingTest::tearDown() {
+    Core::Tracer::configure(select("no-tracing"));
+}
+
+std::string TracingTest::write(s64& nEvents) {
+    Test::File file(dir_, "trace.json");
+    nEvents = Core::Tracer::write(file.path());
+    std::ifstream      is(file.path());
+    std::ostringstream ss;
+    ss << is.rdbuf();
+    return ss.str();
+}
+
+u32 TracingTest::count(const std::string& s, const std::string& pattern) {
+    u32 n = 0;
+    for (size_t pos = s.find(pattern); pos != std::string::npos; pos = s.find(pattern, pos + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+TEST_F(Core, TracingTest, Disabled) {
+    Core::Tracer::configure(select("no-tracing"));
+    EXPECT_FALSE(Core::Tracer::isEnabled());
+    u32 nEvaluated = 0;
+    {
+        TRACE_SCOPE("test", (++nEvaluated, "span"));
+        TRACE_COUNTER("test", "counter", ++nEvaluated);
+    }
+    EXPECT_EQ(nEvaluated, 0u);
+}
+
+TEST_F(Core, TracingTest, ChromeTrace) {
+    Core::Tracer::configure(select("tracing"));
+    EXPECT_TRUE(Core::Tracer::isEnabled());
+    std::thread thread([]() {
+        Core::Tracer::setThreadName("test \"thread\"");
+        {
+            TRACE_SCOPE("test", Core::Tracer::intern(std::string("dynamic-") + "span"));
+            TRACE_COUNTER("test", "hyps", 42);
+        }
+    });
+    thread.join();
+    EXPECT_TRUE(Core::Tracer::intern("dynamic-span") == Core::Tracer::intern(std::string("dynamic-span")));
+
+    s64         nEvents;
+    std::string trace = write(nEvents);
+    EXPECT_GE(nEvents, 2);
+    EXPECT_EQ(trace.rfind("{\"displayTimeUnit\"", 0), size_t(0));
+    EXPECT_EQ(count(trace, "{\"name\":\"dynamic-span\",\"cat\":\"test\",\"ph\":\"X\""), 1u);
+    EXPECT_EQ(count(trace, "{\"name\":\"hyps\",\"cat\":\"test\",\"ph\":\"C\""), 1u);
+    EXPECT_EQ(count(trace, "\"args\":{\"value\":42}"), 1u);
+    EXPECT_EQ(count(trace, "\"args\":{\"name\":\"test \\\"thread\\\"\"}"), 1u);
+    EXPECT_EQ(trace.compare(trace.size() - 4, 4, "\n]}\n"), 0);
+}
+
+TEST_F(Core, TracingTest, RingBuffer) {
+    setParameter("*.tracing.buffer-size", "8");
+    Core::Tracer::configure(select("tracing"));
+    std::thread thread([]() {
+        for (u32 i = 0; i < 100; ++i) {
+            TRACE_SCOPE("test", "ring");
+        }
+    });
+    thread.join();
+
+    s64         nEvents;
+    std::string trace = write(nEvents);
+    EXPECT_EQ(count(trace, "\"name\":\"ring\""), 8u);
+}
@@ -0,0 +1,199 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <Flow/DataAdaptor.hh>
+#include <Flow/Network.hh>
+#include <Flow/Node.hh>
+#include <Test/UnitTest.hh>
+
+namespace {
+
+/** Streams of 0, 1, ..., length - 1 with timestamps, each ended by EOS. */
+class CountingSource : public Flow::SourceNode {
+public:
+    u32 length;
+    u32 nWork;  // calls of work()
+    u32 next;
+
+    CountingSource(const Core::Configuration& c)
+            : Core::Component(c),
+              Flow::SourceNode(c),
+              length(0),
+              nWork(0),
+              next(0) {}
+
+    virtual bool configure() {
+        auto a = std::make_shared<Flow::Attributes>();
+        a->set("sample-rate", "100");
+        a->set("frame-shift", "10");
+        return putOutputAttributes(0, a);
+    }
+    virtual bool work(Flow::PortId out) {
+        ++nWork;
+        if (next == length) {
+            next = 0;
+            return putEos(out);
+        }
+        Flow::Float32* d = new Flow::Float32(next);
+        d->setStartTime(0.01 * next);
+        d->setEndTime(0.01 * (next + 1));
+        ++next;
+        return putData(out, d);
+    }
+};
+
+class AddOne : public Flow::SleeveNode {
+public:
+    AddOne(const Core::Configuration& c)
+            : Core::Component(c),
+              Flow::SleeveNode(c) {}
+
+    virtual bool configure() {
+        return putOutputAttributes(0, getInputAttributes(0));
+    }
+    virtual bool work(Flow::PortId out) {
+        Flow::DataPtr<Flow::Float32> in;
+        if (!getData(0, in)) {
+            return putData(out, in.get());
+        }
+        Flow::Float32* d = new Flow::Float32((*in)() + 1);
+        d->setTimestamp(*in);
+        return putData(out, d);
+    }
+};
+
+}  // namespace
+
+class PipelineTest : public Test::ConfigurableFixture {
+public:
+    void setUp();
+    void tearDown();
+
+protected:
+    Flow::Network*  network_;
+    CountingSource* source_;
+    Flow::PortId    out_;
+
+    /** source -> add-one -> add-one-again -> output "out" */
+    void build(u32 buffer);
+    /** source -> add-one -> output "out", source -> add-one-again -> output "other" */
+    void buildFanOut();
+    /** Pulls one stream, checks values and timestamps and @return its length. */
+    u32 pullStream();
+};
+
+void PipelineTest::setUp() {
+    setParameter("*.channel", "nil");
+    network_ = 0;
+}
+
+void PipelineTest::tearDown() {
+    delete network_;
+}
+
+void PipelineTest::build(u32 buffer) {
+    network_ = new Flow::Network(select("network"), false);
+    source_  = new CountingSource(select("source"));
+    network_->addNode(source_);
+    network_->addNode(new AddOne(select("add-one")));
+    network_->addNode(new AddOne(select("add-one-again")));
+    network_->addOutput("out");
+    network_->addLink("source", "", "add-one", "", buffer);
+    network_->addLink("add-one", "", "add-one-again", "", buffer);
+    network_->addLink("add-one-again", "", "network", "out", buffer);
+    out_ = network_->getOutput("out");
+}
+
+void PipelineTest::buildFanOut() {
+    network_ = new Flow::Network(select("network"), false);
+    source_  = new CountingSource(select("source"));
+    network_->addNode(source_);
+    network_->addNode(new AddOne(select("add-one")));
+    network_->addNode(new AddOne(select("add-one-again")));
+    network_->addOutput("out");
+    network_->addOutput("other");
+    network_->addLink("source", "", "add-one", "", 4);
+    network_->addLink("source", "", "add-one-again", "", 4);
+    network_->addLink("add-one", "", "network", "out", 4);
+    network_->addLink("add-one-again", "", "network", "other", 4);
+    out_ = network_->getOutput("out");
+}
+
+u32 PipelineTest::pullStream() {
+    Flow::DataPtr<Flow::Float32> d;
+    u32                          n = 0;
+    while (network_->getData(out_, d)) {
+        EXPECT_EQ((*d)(), f32(n + 2));
+        EXPECT_TRUE(d->startTime() == 0.01 * n);
+        ++n;
+    }
+    EXPECT_TRUE(d == Flow::Data::eos());
+    return n;
+}
+
+TEST_F(Flow, PipelineTest, Sequential) {
+    build(0);
+    source_->length = 100;
+    EXPECT_EQ(pullStream(), 100u);
+    EXPECT_EQ(source_->nWork, 101u);
+}
+
+TEST_F(Flow, PipelineTest, Threaded) {
+    setParameter("*.source.threaded", "true");
+    setParameter("*.add-one-again.threaded", "true");
+    build(4);
+    source_->length = 1000;
+    EXPECT_EQ(pullStream(), 1000u);
+    // the stages pause at the end of the stream
+    network_->stopThreads();
+    EXPECT_EQ(source_->nWork, 1001u);
+    EXPECT_EQ(pullStream(), 1000u);
+    EXPECT_EQ(pullStream(), 1000u);
+}
+
+TEST_F(Flow, PipelineTest, StopWithinStream) {
+    setParameter("*.source.threaded", "true");
+    setParameter("*.add-one.threaded", "true");
+    build(2);
+    source_->length = 100;
+    Flow::DataPtr<Flow::Float32> d;
+    EXPECT_TRUE(network_->getData(out_, d));
+    EXPECT_TRUE(network_->getData(out_, d));
+    // the threads may wait for full queues
+    network_->stopThreads();
+    source_->next = 0;
+    network_->reset();
+    EXPECT_EQ(pullStream(), 100u);
+}
+
+TEST_F(Flow, PipelineTest, Attributes) {
+    setParameter("*.source.threaded", "true");
+    setParameter("*.add-one-again.threaded", "true");
+    build(4);
+    source_->length = 10;
+    EXPECT_EQ(network_->getAttribute(out_, "sample-rate"), std::string("100"));
+    EXPECT_EQ(pullStream(), 10u);
+    EXPECT_EQ(network_->getAttribute(out_, "frame-shift"), std::string("10"));
+}
+
+TEST_F(Flow, PipelineTest, FanOutRejected) {
+    // the consumers of several queues could block each other
+    setParameter("*.on-error", "ignore");
+    setParameter("*.source.threaded", "true");
+    buildFanOut();
+    source_->length = 10;
+    Flow::DataPtr<Flow::Float32> d;
+    EXPECT_FALSE(network_->getData(out_, d));
+    EXPECT_EQ(source_->nWork, 0u);
+}
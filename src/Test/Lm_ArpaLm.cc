@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
 #include <Bliss/Lexicon.hh>
+#include <Core/Application.hh>
 #include <Lm/Module.hh>
 #include <Test/File.hh>
 #include <Test/UnitTest.hh>
@@ -13,6 +18,17 @@ protected:
     Core::Configuration lm_config_;
     Bliss::LexiconRef   base_lex_;
     Bliss::LexiconRef   shuffle_lex_;
+
+    /**
+     * Writes a bigram LM over the words of the base lexicon to @param path,
+     * padded with @param nUnknown unigrams of an unknown word, so that
+     * it is read in many chunks.
+     */
+    void writeBigramLm(const std::string& path, u32 nUnknown) const;
+    /** Scores of all bigrams of the base lexicon */
+    std::vector<Lm::Score> bigramScores(const Lm::LanguageModel& lm) const;
+    /** Expects the same scores, back-off scores and successors of all histories up to bigrams, up to @param tolerance */
+    void compareLms(const Lm::LanguageModel& lm, const Lm::LanguageModel& other, Lm::Score tolerance) const;
 };
 
 void TestArpaLm::setUp() {
@@ -27,8 +43,69 @@ void TestArpaLm::setUp() {
     lm_config_.set("*.lm.image", "");
 }
 
+void TestArpaLm::writeBigramLm(const std::string& path, u32 nUnknown) const {
+    std::vector<std::string> words;
+    for (const Bliss::Token* t : base_lex_->syntacticTokenInventory()) {
+        words.push_back(t->symbol().str());
+    }
+    std::ofstream os(path.c_str());
+    os << "\\data\\\n"
+       << "ngram 1=" << words.size() + nUnknown << "\n"
+       << "ngram 2=" << words.size() * words.size() << "\n\n"
+       << "\\1-grams:\n";
+    for (u32 i = 0; i < words.size(); ++i) {
+        os << -0.1 * (i + 1) << "\t" << words[i] << "\t" << -0.01 * i << "\n";
+    }
+    for (u32 i = 0; i < nUnknown; ++i) {
+        os << "-2\tUNKNOWN\n";
+    }
+    os << "\n\\2-grams:\n";
+    for (u32 i = 0; i < words.size(); ++i) {
+        for (u32 j = 0; j < words.size(); ++j) {
+            os << -0.001 * (i * words.size() + j + 1) << "\t" << words[i] << " " << words[j] << "\n";
+        }
+    }
+    os << "\n\\end\\\n";
+}
+
+std::vector<Lm::Score> TestArpaLm::bigramScores(const Lm::LanguageModel& lm) const {
+    std::vector<Lm::Score> scores;
+    for (const Bliss::Token* v : lm.tokenInventory()) {
+        Lm::History h = lm.extendedHistory(lm.startHistory(), v);
+        for (const Bliss::Token* w : lm.tokenInventory()) {
+            scores.push_back(lm.score(h, w));
+        }
+    }
+    return scores;
+}
+
+void TestArpaLm::compareLms(const Lm::LanguageModel& lm, const Lm::LanguageModel& other, Lm::Score tolerance) const {
+    std::vector<Lm::History> histories(1, lm.startHistory()), otherHistories(1, other.startHistory());
+    for (const Bliss::Token* v : lm.tokenInventory()) {
+        histories.push_back(lm.extendedHistory(lm.startHistory(), v));
+        otherHistories.push_back(other.extendedHistory(other.startHistory(), v));
+    }
+    for (u32 i = 0; i < histories.size(); ++i) {
+        for (const Bliss::Token* w : lm.tokenInventory()) {
+            EXPECT_DOUBLE_EQ(lm.score(histories[i], w), other.score(otherHistories[i], w), tolerance);
+        }
+        EXPECT_DOUBLE_EQ(lm.getBackOffScore(histories[i]), other.getBackOffScore(otherHistories[i]), tolerance);
+
+        Lm::HistorySuccessors successors      = lm.getHistorySuccessors(histories[i]);
+        Lm::HistorySuccessors otherSuccessors = other.getHistorySuccessors(otherHistories[i]);
+        std::sort(successors.begin(), successors.end(), Lm::WordScore::Ordering());
+        std::sort(otherSuccessors.begin(), otherSuccessors.end(), Lm::WordScore::Ordering());
+        EXPECT_EQ(successors.size(), otherSuccessors.size());
+        for (u32 s = 0; s < successors.size() && s < otherSuccessors.size(); ++s) {
+            EXPECT_EQ(successors[s].token(), otherSuccessors[s].token());
+            EXPECT_DOUBLE_EQ(successors[s].score(), otherSuccessors[s].score(), tolerance);
+        }
+        EXPECT_DOUBLE_EQ(successors.backOffScore, otherSuccessors.backOffScore, tolerance);
+    }
+}
+
 TEST_F(Test, TestArpaLm, TestShuffle) {
-    auto m = Lm::Module::instance();
+    auto& m = Lm::Module::instance();
     lm_config_.set("*.lm.image", Test::dataFile("arpa_lm/unigram.image"));
     Core::Ref<Lm::LanguageModel> base_lm    = m.createLanguageModel(Core::Configuration(lm_config_, "lm"), base_lex_);
     Core::Ref<Lm::LanguageModel> shuffle_lm = m.createLanguageModel(Core::Configuration(lm_config_, "lm"), shuffle_lex_);
@@ -36,3 +113,67 @@ TEST_F(Test, TestArpaLm, TestShuffle) {
     Lm::History base_h    = base_lm->startHistory();
     Lm::History shuffle_h = shuffle_lm->startHistory();
 }
+
+TEST_F(Test, TestArpaLm, ParallelReadWithoutWorkers) {
+    // the parser tasks run on the waiting thread only, if the global
+    // scheduler is created with this configuration
+    Core::Configuration(Core::Application::us()->getConfiguration()).set("*.task-scheduler.core-budget", "1");
+    Test::Directory dir;
+    Test::File      file(dir, "chunks.arpa");
+    // more chunks than the parser pool queues at a time
+    writeBigramLm(file.path(), 20 * (1 << 16));
+    lm_config_.set("*.lm.file", file.path());
+    lm_config_.set("*.lm.num-threads", "4");
+    Core::Ref<Lm::LanguageModel> lm = Lm::Module::instance().createLanguageModel(Core::Configuration(lm_config_, "lm"), base_lex_);
+    EXPECT_TRUE(lm);
+    EXPECT_EQ(bigramScores(*lm).size(), size_t(lm->tokenInventory().size() * lm->tokenInventory().size()));
+}
+
+TEST_F(Test, TestArpaLm, ParallelReadMatchesSequential) {
+    Test::Directory dir;
+    Test::File      file(dir, "chunks.arpa");
+    writeBigramLm(file.path(), 4 * (1 << 16));
+    lm_config_.set("*.lm.file", file.path());
+    lm_config_.set("*.lm.num-threads", "1");
+    Core::Ref<Lm::LanguageModel> sequential = Lm::Module::instance().createLanguageModel(Core::Configuration(lm_config_, "lm"), base_lex_);
+    lm_config_.set("*.lm.num-threads", "4");
+    Core::Ref<Lm::LanguageModel> parallel = Lm::Module::instance().createLanguageModel(Core::Configuration(lm_config_, "lm"), base_lex_);
+    EXPECT_TRUE(sequential);
+    EXPECT_TRUE(parallel);
+
+    std::vector<Lm::Score> sequentialScores = bigramScores(*sequential);
+    EXPECT_EQ(sequentialScores.size(), size_t(sequential->tokenInventory().size() * sequential->tokenInventory().size()));
+    EXPECT_TRUE(sequentialScores == bigramScores(*parallel));
+
+    // the md5 sum of the file is the dependency value, e.g. of images
+    Core::DependencySet sequentialDependencies, parallelDependencies;
+    sequential->getDependencies(sequentialDependencies);
+    parallel->getDependencies(parallelDependencies);
+    EXPECT_TRUE(sequentialDependencies == parallelDependencies);
+    std::ostringstream ss;
+    ss << parallelDependencies;
+    EXPECT_TRUE(ss.str().find("value ''") == std::string::npos);
+}
+
+TEST_F(Test, TestArpaLm, CompactImage) {
+    Test::Directory dir;
+    Test::File      file(dir, "bigram.arpa");
+    writeBigramLm(file.path(), 0);
+    lm_config_.set("*.lm.file", file.path());
+    auto& m = Lm::Module::instance();
+
+    lm_config_.set("*.lm.image", Test::File(dir, "full.image").path());
+    Core::Ref<Lm::LanguageModel> full = m.createLanguageModel(Core::Configuration(lm_config_, "lm"), base_lex_);
+    lm_config_.set("*.lm.image-format", "compact");
+    lm_config_.set("*.lm.image", Test::File(dir, "compact.image").path());
+    Core::Ref<Lm::LanguageModel> compact = m.createLanguageModel(Core::Configuration(lm_config_, "lm"), base_lex_);
+    EXPECT_TRUE(full);
+    EXPECT_TRUE(compact);
+    // the images are written and then mounted, mounting them again must give the same model
+    Core::Ref<Lm::LanguageModel> mounted = m.createLanguageModel(Core::Configuration(lm_config_, "lm"), base_lex_);
+
+    // the bigram scores span at most 0.001 * |V|^2 * ln(10), the default 8 bit codebooks split this range into 256 steps
+    Lm::Score tolerance = 0.001 * base_lex_->syntacticTokenInventory().size() * base_lex_->syntacticTokenInventory().size() * 2.31 / 256;
+    compareLms(*full, *compact, tolerance);
+    compareLms(*compact, *mounted, 0.0);
+}
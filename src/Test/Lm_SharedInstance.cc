@@ -0,0 +1,167 @@
+#include <fstream>
+#include <thread>
+
+#include <Bliss/Lexicon.hh>
+#include <Lm/Module.hh>
+#include <Test/File.hh>
+#include <Test/UnitTest.hh>
+
+class TestSharedInstance : public Test::Fixture {
+public:
+    void setUp();
+
+protected:
+    Core::Configuration lex_config_;
+    Core::Configuration lm_config_;
+    Bliss::LexiconRef   lex_;
+    Test::Directory     dir_;
+    std::string         arpaFile_;
+
+    Core::Ref<Lm::LanguageModel> create(const std::string& type);
+    /** Batch request of all words, to the targets in @param reversed order or not */
+    Lm::BatchRequest batchRequest(bool reversed) const;
+    /** Lookahead scores after each word, caching the scores of the (sparse) history after the first word if @param cache */
+    std::vector<f32> lookaheadScores(const Lm::LanguageModel& lm, const Lm::BatchRequest& request, bool cache) const;
+};
+
+void TestSharedInstance::setUp() {
+    lex_config_.set("*.lexicon.file", Test::dataFile("arpa_lm/base.xml.gz"));
+    lex_ = Bliss::Lexicon::create(Core::Configuration(lex_config_, "lexicon"));
+
+    // bigrams only after the first word, so that bigram histories are sparse
+    std::vector<std::string> words;
+    for (const Bliss::Token* t : lex_->syntacticTokenInventory()) {
+        words.push_back(t->symbol().str());
+    }
+    arpaFile_ = Test::File(dir_, "sparse.arpa").path();
+    std::ofstream os(arpaFile_.c_str());
+    os << "\\data\\\n"
+       << "ngram 1=" << words.size() << "\n"
+       << "ngram 2=" << words.size() << "\n\n"
+       << "\\1-grams:\n";
+    for (u32 i = 0; i < words.size(); ++i) {
+        os << -0.1 * (i + 1) << "\t" << words[i] << "\t" << -0.01 * i << "\n";
+    }
+    os << "\n\\2-grams:\n";
+    for (u32 i = 0; i < words.size(); ++i) {
+        os << -0.001 * (i + 1) << "\t" << words[0] << " " << words[i] << "\n";
+    }
+    os << "\n\\end\\\n";
+    os.close();
+
+    lm_config_.set("*.lm.file", arpaFile_);
+    lm_config_.set("*.lm.image", "");
+    lm_config_.set("*.lm.num-lms", "2");
+    lm_config_.set("*.lm.lm-1.type", "ARPA");
+    lm_config_.set("*.lm.lm-1.file", arpaFile_);
+    lm_config_.set("*.lm.lm-1.image", "");
+    lm_config_.set("*.lm.lm-2.type", "zerogram");
+    lm_config_.set("*.lm.lm-2.scale", "0.5");
+}
+
+Core::Ref<Lm::LanguageModel> TestSharedInstance::create(const std::string& type) {
+    lm_config_.set("*.lm.type", type);
+    return Lm::Module::instance().createLanguageModel(Core::Configuration(lm_config_, "lm"), lex_);
+}
+
+Lm::BatchRequest TestSharedInstance::batchRequest(bool reversed) const {
+    Lm::BatchRequest                      request;
+    Bliss::Lexicon::SyntacticTokenIterator begin, end;
+    std::tie(begin, end) = lex_->syntacticTokens();
+    u32 size             = end - begin;
+    for (u32 i = 0; i < size; ++i) {
+        request.push_back(Lm::Request(Bliss::SyntacticTokenSequence(begin + i, begin + i + 1), reversed ? size - 1 - i : i));
+    }
+    return request;
+}
+
+std::vector<f32> TestSharedInstance::lookaheadScores(const Lm::LanguageModel& lm, const Lm::BatchRequest& request, bool cache) const {
+    const Lm::TokenInventory& tokens = lm.tokenInventory();
+    Lm::CompiledBatchRequest* cbr    = lm.compileBatchRequest(request);
+    Lm::History               h      = lm.startHistory();
+    if (cache) {
+        lm.cacheBatch(lm.extendedHistory(h, tokens[0]), cbr, request.size());
+    }
+
+    std::vector<f32> scores;
+    for (const Bliss::Token* w : tokens) {
+        std::vector<f32> result(request.size(), Core::Type<f32>::max);
+        lm.getBatch(lm.extendedHistory(h, w), cbr, result);
+        scores.insert(scores.end(), result.begin(), result.end());
+    }
+    delete cbr;
+    return scores;
+}
+
+TEST_F(Lm, TestSharedInstance, ThreadSafe) {
+    EXPECT_TRUE(create("zerogram")->isThreadSafe());
+    EXPECT_TRUE(create("ARPA")->isThreadSafe());
+    EXPECT_TRUE(create("simple-history")->isThreadSafe());
+    EXPECT_TRUE(create("combine")->isThreadSafe());
+    EXPECT_TRUE(Lm::Module::instance().createScaledLanguageModel(Core::Configuration(lm_config_, "lm"), create("ARPA"))->isThreadSafe());
+    EXPECT_FALSE(create("cheating-segment")->isThreadSafe());
+
+    // a combination is only thread-safe if all of its models are
+    lm_config_.set("*.lm.lm-2.type", "cheating-segment");
+    EXPECT_FALSE(create("combine")->isThreadSafe());
+}
+
+TEST_F(Lm, TestSharedInstance, SameInstance) {
+    lm_config_.set("*.lm.shared-instance", "test-same-instance");
+    Core::Ref<Lm::LanguageModel> lm = create("ARPA");
+    EXPECT_TRUE(lm);
+    EXPECT_TRUE(lm == create("ARPA"));
+    lm_config_.set("*.lm.shared-instance", "test-other-instance");
+    EXPECT_FALSE(lm == create("ARPA"));
+
+    // models which are not thread-safe are not shared
+    lm_config_.set("*.lm.shared-instance", "test-not-thread-safe");
+    EXPECT_FALSE(create("cheating-segment") == create("cheating-segment"));
+}
+
+TEST_F(Lm, TestSharedInstance, DescribeConfiguration) {
+    lm_config_.set("*.lm.type", "combine");
+    Core::Configuration c(lm_config_, "lm");
+    std::string         description = Lm::Module_::describeConfiguration(c);
+    EXPECT_TRUE(description.find("file=" + arpaFile_) != std::string::npos);
+    EXPECT_TRUE(description.find("lm-2{type=zerogram scale=0.5}") != std::string::npos);
+    EXPECT_EQ(description, Lm::Module_::describeConfiguration(Core::Configuration(lm_config_, "lm")));
+
+    // parameters of other components do not matter
+    lm_config_.set("*.lm.scale", "3");
+    lm_config_.set("*.lexicon.file", "other.xml");
+    EXPECT_EQ(description, Lm::Module_::describeConfiguration(Core::Configuration(lm_config_, "lm")));
+
+    lm_config_.set("*.lm.lm-1.file", Test::File(dir_, "other.arpa").path());
+    EXPECT_NE(description, Lm::Module_::describeConfiguration(Core::Configuration(lm_config_, "lm")));
+    lm_config_.set("*.lm.lm-1.file", arpaFile_);
+    lm_config_.set("*.lm.lm-2.scale", "0.7");
+    EXPECT_NE(description, Lm::Module_::describeConfiguration(Core::Configuration(lm_config_, "lm")));
+}
+
+TEST_F(Lm, TestSharedInstance, CombineBatchCachePerThread) {
+    // the lookahead of the combination caches the scores of the zerogram
+    lm_config_.set("*.lm.shared-instance", "test-combine-batch-cache");
+    Core::Ref<Lm::LanguageModel> lm = create("combine");
+    EXPECT_TRUE(lm);
+    Lm::BatchRequest request = batchRequest(false), reversedRequest = batchRequest(true);
+
+    // each thread starts with an empty cache
+    std::vector<f32> expected, expectedReversed, uncached;
+    std::thread([&]() { expected = lookaheadScores(*lm, request, true); }).join();
+    std::thread([&]() { expectedReversed = lookaheadScores(*lm, reversedRequest, true); }).join();
+    std::thread([&]() { uncached = lookaheadScores(*lm, request, false); }).join();
+    // the cached scores lack the unigram scores of the sparse bigram history
+    EXPECT_EQ(expected.size(), uncached.size());
+    EXPECT_FALSE(expected == uncached);
+
+    for (u32 round = 0; round < 20; ++round) {
+        std::vector<f32> scores, reversedScores;
+        std::thread      first([&]() { scores = lookaheadScores(*lm, request, true); });
+        std::thread      second([&]() { reversedScores = lookaheadScores(*lm, reversedRequest, true); });
+        first.join();
+        second.join();
+        EXPECT_TRUE(scores == expected);
+        EXPECT_TRUE(reversedScores == expectedReversed);
+    }
+}
@@ -0,0 +1,166 @@
+/** Copyright 2020 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <Nn/FixedQuantizationCompressedVectorFactory.hh>
+#include <Nn/HalfPrecisionCompressedVectorFactory.hh>
+#include <Test/UnitTest.hh>
+
+class TestCompressedVector : public Test::ConfigurableFixture {
+public:
+    void setUp();
+
+protected:
+    static u32 bits(float f);
+
+    /**
+     * Bits of @param value after compression to @param format and back.
+     * The value is stored at the start and at the end of a vector of 9 values, so that both
+     * the vectorized and the scalar conversion are used; the result is only returned if all agree.
+     */
+    u32 roundTrip(Nn::HalfPrecisionFormat format, float value);
+};
+
+void TestCompressedVector::setUp() {
+    setParameter("*.channel", "nil");
+}
+
+u32 TestCompressedVector::bits(float f) {
+    u32 x;
+    std::memcpy(&x, &f, sizeof(x));
+    return x;
+}
+
+u32 TestCompressedVector::roundTrip(Nn::HalfPrecisionFormat format, float value) {
+    std::vector<float>           data(9, value);
+    Nn::HalfPrecisionFloatVector vec(format);
+    vec.store(data.data(), data.size());
+    std::vector<float> result(data.size());
+    vec.uncompress(result.data(), result.size());
+    EXPECT_EQ(bits(result[0]), bits(result[8]));
+    EXPECT_EQ(bits(result[0]), bits(vec.get(0)));
+    EXPECT_EQ(bits(result[0]), bits(vec.get(8)));
+    return bits(result[0]);
+}
+
+TEST_F(Nn, TestCompressedVector, Fp16Rounding) {
+    Nn::HalfPrecisionFormat fp16 = Nn::Fp16HalfPrecisionFormat;
+    EXPECT_EQ(roundTrip(fp16, 1.0f), bits(1.0f));
+    EXPECT_EQ(roundTrip(fp16, -0.0f), bits(-0.0f));
+    // ties round to even
+    EXPECT_EQ(roundTrip(fp16, 1.0f + std::ldexp(1.0f, -11)), bits(1.0f));
+    EXPECT_EQ(roundTrip(fp16, 1.0f + 3.0f * std::ldexp(1.0f, -11)), bits(1.0f + std::ldexp(1.0f, -9)));
+    EXPECT_EQ(roundTrip(fp16, -1.0f - 3.0f * std::ldexp(1.0f, -11)), bits(-1.0f - std::ldexp(1.0f, -9)));
+    EXPECT_EQ(roundTrip(fp16, 1.0f + 1.5f * std::ldexp(1.0f, -11)), bits(1.0f + std::ldexp(1.0f, -10)));
+    // rounding carries into the exponent
+    EXPECT_EQ(roundTrip(fp16, 2.0f - std::ldexp(1.0f, -12)), bits(2.0f));
+}
+
+TEST_F(Nn, TestCompressedVector, Fp16Subnormals) {
+    Nn::HalfPrecisionFormat fp16 = Nn::Fp16HalfPrecisionFormat;
+    float                   min  = std::ldexp(1.0f, -24);  // smallest subnormal
+    EXPECT_EQ(roundTrip(fp16, min), bits(min));
+    EXPECT_EQ(roundTrip(fp16, 1023.0f * min), bits(1023.0f * min));
+    EXPECT_EQ(roundTrip(fp16, 0.5f * min), bits(0.0f));
+    EXPECT_EQ(roundTrip(fp16, -0.5f * min), bits(-0.0f));
+    EXPECT_EQ(roundTrip(fp16, 0.75f * min), bits(min));
+    EXPECT_EQ(roundTrip(fp16, 1.5f * min), bits(2.0f * min));
+    EXPECT_EQ(roundTrip(fp16, 2.5f * min), bits(2.0f * min));
+    EXPECT_EQ(roundTrip(fp16, std::ldexp(1.0f, -30)), bits(0.0f));
+    // largest subnormal rounds up to the smallest normal
+    EXPECT_EQ(roundTrip(fp16, 1023.5f * min), bits(std::ldexp(1.0f, -14)));
+}
+
+TEST_F(Nn, TestCompressedVector, Fp16Overflow) {
+    Nn::HalfPrecisionFormat fp16 = Nn::Fp16HalfPrecisionFormat;
+    float                   inf  = std::numeric_limits<float>::infinity();
+    EXPECT_EQ(roundTrip(fp16, 65504.0f), bits(65504.0f));
+    EXPECT_EQ(roundTrip(fp16, 65519.0f), bits(65504.0f));
+    EXPECT_EQ(roundTrip(fp16, 65520.0f), bits(inf));
+    EXPECT_EQ(roundTrip(fp16, -1e10f), bits(-inf));
+    EXPECT_EQ(roundTrip(fp16, std::numeric_limits<float>::max()), bits(inf));
+    EXPECT_EQ(roundTrip(fp16, inf), bits(inf));
+    EXPECT_EQ(roundTrip(fp16, -inf), bits(-inf));
+}
+
+TEST_F(Nn, TestCompressedVector, Fp16NaN) {
+    // quiet and signaling nans with payloads: vectorized and scalar conversion have to agree bit by bit
+    for (u32 x : {0x7fc00000u, 0xffc00001u, 0x7f802000u, 0x7fa5a000u, 0xff800001u}) {
+        float nan;
+        std::memcpy(&nan, &x, sizeof(nan));
+        u32 result = roundTrip(Nn::Fp16HalfPrecisionFormat, nan);
+        EXPECT_GT(result & 0x7fffffffu, 0x7f800000u);
+        EXPECT_TRUE(result & 0x00400000u);  // quiet
+        EXPECT_EQ(result & 0x80000000u, x & 0x80000000u);
+    }
+}
+
+TEST_F(Nn, TestCompressedVector, Bf16Rounding) {
+    Nn::HalfPrecisionFormat bf16 = Nn::Bf16HalfPrecisionFormat;
+    float                   inf  = std::numeric_limits<float>::infinity();
+    EXPECT_EQ(roundTrip(bf16, 1.0f), bits(1.0f));
+    // ties round to even
+    EXPECT_EQ(roundTrip(bf16, 1.0f + std::ldexp(1.0f, -8)), bits(1.0f));
+    EXPECT_EQ(roundTrip(bf16, 1.0f + 3.0f * std::ldexp(1.0f, -8)), bits(1.0f + std::ldexp(1.0f, -6)));
+    EXPECT_EQ(roundTrip(bf16, 1.0f + 1.5f * std::ldexp(1.0f, -8)), bits(1.0f + std::ldexp(1.0f, -7)));
+    // bf16 keeps the float range, subnormals included
+    EXPECT_EQ(roundTrip(bf16, std::ldexp(1.5f, 100)), bits(std::ldexp(1.5f, 100)));
+    EXPECT_EQ(roundTrip(bf16, std::ldexp(1.0f, -130)), bits(std::ldexp(1.0f, -130)));
+    EXPECT_EQ(roundTrip(bf16, std::numeric_limits<float>::max()), bits(inf));
+    EXPECT_EQ(roundTrip(bf16, -inf), bits(-inf));
+    // signaling nans stay nans
+    u32 result = roundTrip(bf16, std::numeric_limits<float>::signaling_NaN());
+    EXPECT_GT(result & 0x7fffffffu, 0x7f800000u);
+}
+
+TEST_F(Nn, TestCompressedVector, FixedQuantizationDynamicScale) {
+    std::vector<float> data(37);
+    for (size_t i = 0ul; i < data.size(); i++) {
+        data[i] = std::sin(0.5f * i) * 3.0f;
+    }
+    data[5] = -7.0f;
+
+    setParameter("*.epsilon", "0.00001");
+    for (std::string bitsPerVal : {"8", "16"}) {
+        setParameter("*.bits-per-val", bitsPerVal);
+        setParameter("*.dynamic-scale", "true");
+        Nn::FixedQuantizationCompressedVectorFactory factory(select("compression"));
+        float                                        maxVal = bitsPerVal == "8" ? 127.0f : 32767.0f;
+
+        Nn::CompressedVectorPtr<float> vec = factory.compress(data.data(), data.size(), nullptr);
+        std::vector<float>             result(data.size());
+        vec->uncompress(result.data(), result.size());
+        // the largest absolute value is representable, all values are within one quantization step
+        float step = 7.0f / maxVal;
+        EXPECT_DOUBLE_EQ(result[5], -7.0f, 1.0001 * step);
+        for (size_t i = 0ul; i < data.size(); i++) {
+            EXPECT_DOUBLE_EQ(result[i], data[i], 1.0001 * step);
+            EXPECT_DOUBLE_EQ(vec->get(i), result[i], 0.0);
+        }
+
+        // epsilon is the lower bound of the scale
+        std::vector<float>             small(data.size(), 1e-6f);
+        Nn::CompressedVectorPtr<float> smallVec = factory.compress(small.data(), small.size(), nullptr);
+        EXPECT_DOUBLE_EQ(smallVec->get(0), 0.0, 1e-12);
+
+        // without dynamic scale the step is epsilon and large values are clipped
+        setParameter("*.dynamic-scale", "false");
+        Nn::FixedQuantizationCompressedVectorFactory fixedFactory(select("compression"));
+        Nn::CompressedVectorPtr<float>               fixedVec = fixedFactory.compress(data.data(), data.size(), nullptr);
+        EXPECT_DOUBLE_EQ(fixedVec->get(5), -0.00001 * (maxVal + 1.0f), 1e-7);
+    }
+}
@@ -0,0 +1,185 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <Core/Types.hh>
+#include <Search/FusedScorePruner.hh>
+#include <Test/UnitTest.hh>
+
+namespace {
+
+struct Extension {
+    size_t         hyp;
+    Nn::LabelIndex label;
+    Search::Score  score;
+
+    bool operator==(Extension const& other) const {
+        return hyp == other.hyp and label == other.label and score == other.score;
+    }
+};
+
+/**
+ * Pruning of all extensions of a search step as done by the search after the scoring: keeps the extensions
+ * within @param threshold of the best one and of those the @param maxSize best. Sorted by hypothesis and label.
+ */
+std::vector<Extension> prune(std::vector<Extension> extensions, Search::Score threshold, size_t maxSize) {
+    Search::Score best = Core::Type<Search::Score>::max;
+    for (auto const& ext : extensions) {
+        best = std::min(best, ext.score);
+    }
+    Search::Score limit = threshold == Core::Type<Search::Score>::max ? Core::Type<Search::Score>::max : best + threshold;
+    extensions.erase(std::remove_if(extensions.begin(), extensions.end(), [limit](auto const& ext) {
+                         return ext.score > limit or ext.score >= Core::Type<Search::Score>::max;
+                     }),
+                     extensions.end());
+    std::sort(extensions.begin(), extensions.end(), [](auto const& a, auto const& b) { return a.score < b.score; });
+    if (extensions.size() > maxSize) {
+        extensions.resize(maxSize);
+    }
+    std::sort(extensions.begin(), extensions.end(), [](auto const& a, auto const& b) {
+        return std::tie(a.hyp, a.label) < std::tie(b.hyp, b.label);
+    });
+    return extensions;
+}
+
+}  // namespace
+
+class TestFusedScorePruner : public Test::Fixture {
+public:
+    void setUp();
+
+protected:
+    static const size_t numHyps   = 6;
+    static const size_t numLabels = 50;
+
+    std::mt19937 rng_;
+
+    /**
+     * Scores one search step with random scores of dense spans with one term per entry of @param scales, with the
+     * fused pruner and label by label, and compares the extensions which survive the pruning of the search.
+     * The current label of each hypothesis is excluded as well if @param excludeCurrentLabel.
+     */
+    void compare(std::vector<Search::Score> const& scales, Search::Score threshold, size_t maxSurvivors,
+                 std::vector<Nn::LabelIndex> const& excluded, bool excludeCurrentLabel);
+};
+
+void TestFusedScorePruner::setUp() {
+    rng_.seed(42);
+}
+
+void TestFusedScorePruner::compare(std::vector<Search::Score> const& scales, Search::Score threshold, size_t maxSurvivors,
+                                   std::vector<Nn::LabelIndex> const& excluded, bool excludeCurrentLabel) {
+    std::uniform_real_distribution<Search::Score> baseDistribution(0.0, 5.0), labelDistribution(0.0, 10.0);
+
+    Search::FusedScorePruner pruner;
+    pruner.setNumLabels(numLabels);
+    for (auto label : excluded) {
+        pruner.exclude(label);
+    }
+
+    for (u32 step = 0; step < 20; ++step) {
+        pruner.startStep(threshold, maxSurvivors);
+        std::vector<Extension> unfused, fused;
+        Search::Score          best = Core::Type<Search::Score>::max;
+        for (size_t hyp = 0ul; hyp < numHyps; ++hyp) {
+            std::vector<std::vector<Search::Score>> termScores(scales.size(), std::vector<Search::Score>(numLabels));
+            std::vector<Nn::DenseScoreTerm>         terms;
+            for (size_t t = 0ul; t < scales.size(); ++t) {
+                for (auto& score : termScores[t]) {
+                    score = labelDistribution(rng_);
+                }
+                terms.push_back({termScores[t], scales[t]});
+            }
+            Nn::DenseScoreSpan span(std::move(terms));
+            Search::Score      baseScore    = baseDistribution(rng_);
+            Nn::LabelIndex     currentLabel = (7 * hyp + step) % numLabels;
+
+            // unfused: one extension per label, scored like the search does without fused pruning
+            for (Nn::LabelIndex label = 0; label < numLabels; ++label) {
+                if (std::find(excluded.begin(), excluded.end(), label) != excluded.end() or (excludeCurrentLabel and label == currentLabel)) {
+                    continue;
+                }
+                unfused.push_back({hyp, label, baseScore + span[label]});
+                best = std::min(best, unfused.back().score);
+            }
+
+            pruner.process(baseScore, span, excludeCurrentLabel ? currentLabel : Nn::invalidLabelIndex);
+            auto const& labels = pruner.survivorLabels();
+            auto const& scores = pruner.survivorScores();
+            EXPECT_EQ(labels.size(), scores.size());
+            EXPECT_LE(labels.size(), maxSurvivors);
+            EXPECT_TRUE(std::is_sorted(labels.begin(), labels.end()));
+            for (size_t i = 0ul; i < labels.size(); ++i) {
+                EXPECT_TRUE(std::find(excluded.begin(), excluded.end(), labels[i]) == excluded.end());
+                EXPECT_FALSE(excludeCurrentLabel and labels[i] == currentLabel);
+                // the scores are identical to the unfused ones, not only close
+                EXPECT_TRUE(scores[i] == baseScore + span[labels[i]]);
+                fused.push_back({hyp, labels[i], scores[i]});
+            }
+            EXPECT_TRUE(pruner.bestScore() == best);
+        }
+
+        size_t                 maxSize        = std::min(maxSurvivors, unfused.size());
+        std::vector<Extension> expected       = prune(unfused, threshold, maxSize);
+        std::vector<Extension> fusedAndPruned = prune(fused, threshold, maxSize);
+        EXPECT_FALSE(expected.empty());
+        EXPECT_EQ(fusedAndPruned.size(), expected.size());
+        EXPECT_TRUE(fusedAndPruned == expected);
+    }
+}
+
+TEST_F(Search, TestFusedScorePruner, NoPruning) {
+    Search::FusedScorePruner pruner;
+    pruner.setNumLabels(4);
+    pruner.exclude(2);
+    pruner.exclude(7);  // out of range, ignored
+    pruner.startStep(Core::Type<Search::Score>::max, Core::Type<size_t>::max);
+    std::vector<Search::Score> scores = {3.0, 1.0, 2.0, 4.0, 0.5};
+    pruner.process(1.0, Nn::DenseScoreSpan({scores, 2.0}), 3);
+    EXPECT_TRUE(pruner.survivorLabels() == std::vector<Nn::LabelIndex>({0, 1}));
+    EXPECT_TRUE(pruner.survivorScores() == std::vector<Search::Score>({7.0, 3.0}));
+    EXPECT_EQ(pruner.bestScore(), 3.0f);
+    pruner.updateBestScore(2.5);
+    EXPECT_EQ(pruner.bestScore(), 2.5f);
+}
+
+TEST_F(Search, TestFusedScorePruner, Threshold) {
+    compare({1.0}, 3.0, Core::Type<size_t>::max, {}, false);
+    compare({0.7}, 0.5, Core::Type<size_t>::max, {}, true);
+}
+
+TEST_F(Search, TestFusedScorePruner, TopK) {
+    compare({1.0}, Core::Type<Search::Score>::max, 5, {}, false);
+    compare({1.0}, Core::Type<Search::Score>::max, 1, {}, true);
+}
+
+TEST_F(Search, TestFusedScorePruner, ThresholdAndTopK) {
+    compare({1.0}, 6.0, 4, {}, false);
+    compare({1.0}, 1.0, 20, {}, false);
+}
+
+TEST_F(Search, TestFusedScorePruner, ExcludedLabels) {
+    compare({1.0}, Core::Type<Search::Score>::max, Core::Type<size_t>::max, {0, 49}, true);
+    compare({1.0}, 6.0, 4, {0, 17, 49}, true);
+}
+
+TEST_F(Search, TestFusedScorePruner, MultiTermSpans) {
+    compare({1.0, 0.5}, 5.0, 6, {}, false);
+    compare({1.0, 0.5, -0.3}, 4.0, 3, {3}, true);
+    compare({0.3, 0.3, 0.3, 0.3}, Core::Type<Search::Score>::max, Core::Type<size_t>::max, {3}, true);
+}
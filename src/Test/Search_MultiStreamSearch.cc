@@ -0,0 +1,290 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <Nn/LabelScorer/NoOpLabelScorer.hh>
+#include <Nn/Module.hh>
+#include <Search/Module.hh>
+#include <Search/MultiStreamSearch.hh>
+#include <Search/SearchV2.hh>
+#include <Search/Traceback.hh>
+#include <Test/File.hh>
+#include <Test/UnitTest.hh>
+
+namespace {
+
+/*
+ * Label scorer that takes its input features as scores like the no-op label scorer, but simulates a model which has
+ * to be run to compute them: the uncached steps of one `getScoreAccessors` call are computed by one run, and so are
+ * the uncached steps of all instances passed to one `precomputeScores` call.
+ */
+class CountingLabelScorer : public Nn::StepwiseNoOpLabelScorer {
+public:
+    using Precursor = Nn::StepwiseNoOpLabelScorer;
+
+    static size_t numRuns;
+
+    CountingLabelScorer(Core::Configuration const& config)
+            : Core::Component(config),
+              Precursor(config) {}
+
+    void reset() override {
+        Precursor::reset();
+        computedSteps_.clear();
+    }
+
+    std::optional<Nn::ScoreAccessorRef> getScoreAccessor(Nn::ScoringContextRef scoringContext) override {
+        return getScoreAccessors({scoringContext}).front();
+    }
+
+    std::vector<std::optional<Nn::ScoreAccessorRef>> getScoreAccessors(std::vector<Nn::ScoringContextRef> const& scoringContexts) override {
+        run({this}, {scoringContexts});
+
+        std::vector<std::optional<Nn::ScoreAccessorRef>> result;
+        for (auto const& scoringContext : scoringContexts) {
+            if (computedSteps_.count(step(scoringContext))) {
+                result.push_back(Precursor::getScoreAccessor(scoringContext));
+            }
+            else {
+                result.push_back({});
+            }
+        }
+        return result;
+    }
+
+    void precomputeScores(std::vector<Nn::LabelScorer*> const& labelScorers, std::vector<std::vector<Nn::ScoringContextRef>> const& scoringContexts) override {
+        std::vector<CountingLabelScorer*> instances;
+        for (auto* labelScorer : labelScorers) {
+            instances.push_back(dynamic_cast<CountingLabelScorer*>(labelScorer));
+            verify(instances.back() != nullptr);
+        }
+        run(instances, scoringContexts);
+    }
+
+private:
+    std::unordered_set<Speech::TimeframeIndex> computedSteps_;
+
+    static Speech::TimeframeIndex step(Nn::ScoringContextRef const& scoringContext) {
+        return dynamic_cast<Nn::StepScoringContext const*>(scoringContext.get())->currentStep;
+    }
+
+    // Counts one run if any of the instances has an uncached step with available input
+    static void run(std::vector<CountingLabelScorer*> const& instances, std::vector<std::vector<Nn::ScoringContextRef>> const& scoringContexts) {
+        bool computed = false;
+        for (size_t instanceIdx = 0ul; instanceIdx < instances.size(); ++instanceIdx) {
+            auto* instance = instances[instanceIdx];
+            for (auto const& scoringContext : scoringContexts[instanceIdx]) {
+                auto currentStep = step(scoringContext);
+                if (instance->getInput(currentStep) and instance->computedSteps_.insert(currentStep).second) {
+                    computed = true;
+                }
+            }
+        }
+        if (computed) {
+            ++numRuns;
+        }
+    }
+};
+
+size_t CountingLabelScorer::numRuns = 0ul;
+
+/*
+ * Traceback item that doesn't refer to the lexicon, which is owned by the model combination of the search
+ */
+struct ResultItem {
+    Bliss::Lemma::Id       lemma;
+    Speech::TimeframeIndex time;
+    Search::Score          acoustic;
+    Search::Score          lm;
+
+    bool operator==(ResultItem const& other) const {
+        // the scores are identical, not only close
+        return lemma == other.lemma and time == other.time and acoustic == other.acoustic and lm == other.lm;
+    }
+};
+
+typedef std::vector<ResultItem> Result;
+
+Result result(Search::Traceback const& traceback) {
+    Result result;
+    for (auto const& item : traceback) {
+        Bliss::Lemma::Id lemma = item.pronunciation ? item.pronunciation->lemma()->id() : Core::Type<Bliss::Lemma::Id>::max;
+        result.push_back({lemma, item.time, item.score.acoustic, item.score.lm});
+    }
+    return result;
+}
+
+}  // namespace
+
+class TestMultiStreamSearch : public Test::ConfigurableFixture {
+public:
+    void setUp();
+
+protected:
+    static const size_t numLabels = 5;
+
+    Test::Directory                         dir_;
+    std::vector<std::vector<Search::Score>> features_;  // Per segment, numLabels scores per frame
+
+    /** Result of the segment @param segmentIdx decoded by a search of its own */
+    Result decodeAlone(size_t segmentIdx);
+
+    /** Results of the segments @param segments decoded in lockstep, one stream per segment */
+    std::vector<Result> decodeInLockstep(Search::MultiStreamSearch& multiStreamSearch, std::vector<size_t> const& segments);
+
+    Nn::DataView feature(size_t segmentIdx, size_t t) const;
+};
+
+void TestMultiStreamSearch::setUp() {
+    static bool registered = false;
+    if (not registered) {
+        Nn::Module::instance().labelScorerFactory().registerLabelScorer(
+                "test-counting",
+                [](Core::Configuration const& config, Nn::ModelCache&) {
+                    return Core::ref(new CountingLabelScorer(config));
+                });
+        registered = true;
+    }
+
+    std::string   lexiconFile = Test::File(dir_, "lexicon.xml").path();
+    std::ofstream os(lexiconFile.c_str());
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+       << "<lexicon>\n"
+       << "  <phoneme-inventory><phoneme><symbol>x</symbol></phoneme></phoneme-inventory>\n"
+       << "  <lemma special=\"blank\"><orth>[blank]</orth><phon>x</phon><synt/><eval/></lemma>\n";
+    for (char c : std::string("abcd")) {
+        os << "  <lemma><orth>" << c << "</orth><phon>x</phon></lemma>\n";
+    }
+    os << "</lexicon>\n";
+    os.close();
+
+    setParameter("*.channel", "nil");
+    setParameter("*.lexicon.file", lexiconFile);
+    setParameter("*.label-scorer.type", "test-counting");
+    setParameter("*.search-algorithm.type", "lexiconfree-timesync-beam-search");
+    setParameter("*.search-algorithm.max-beam-size", "4");
+    setParameter("*.search-algorithm.score-threshold", "6.0");
+    setParameter("*.num-streams", "3");
+
+    // Segments of different lengths, so that streams finish at different steps
+    std::mt19937                                  rng(23);
+    std::uniform_real_distribution<Search::Score> distribution(0.0, 5.0);
+    for (size_t numFrames : {12ul, 20ul, 7ul, 15ul}) {
+        auto& scores = features_.emplace_back(numFrames * numLabels);
+        for (auto& score : scores) {
+            score = distribution(rng);
+        }
+    }
+}
+
+Nn::DataView TestMultiStreamSearch::feature(size_t segmentIdx, size_t t) const {
+    std::shared_ptr<f32[]> data(new f32[numLabels]);
+    std::copy(features_[segmentIdx].begin() + t * numLabels, features_[segmentIdx].begin() + (t + 1) * numLabels, data.get());
+    return Nn::DataView(std::shared_ptr<f32 const[]>(data), numLabels);
+}
+
+Result TestMultiStreamSearch::decodeAlone(size_t segmentIdx) {
+    std::unique_ptr<Search::SearchAlgorithmV2> search(Search::Module::instance().createSearchAlgorithmV2(select("search-algorithm")));
+
+    auto modelCombination = Core::ref(new Speech::ModelCombination(select("model-combination"), search->requiredModelCombination(), search->requiredAcousticModel()));
+    EXPECT_TRUE(search->setModelCombination(*modelCombination));
+
+    search->enterSegment();
+    for (size_t t = 0ul; t < features_[segmentIdx].size() / numLabels; ++t) {
+        search->putFeature(feature(segmentIdx, t));
+        search->decodeManySteps();
+    }
+    search->finishSegment();
+    return result(*search->getCurrentBestTraceback());
+}
+
+std::vector<Result> TestMultiStreamSearch::decodeInLockstep(Search::MultiStreamSearch& multiStreamSearch, std::vector<size_t> const& segments) {
+    for (size_t streamIdx = 0ul; streamIdx < segments.size(); ++streamIdx) {
+        multiStreamSearch.enterSegment(streamIdx);
+    }
+
+    // Features arrive frame by frame in all streams, like in online recognition
+    for (size_t t = 0ul; not std::all_of(segments.begin(), segments.end(), [&](size_t s) { return t > features_[s].size() / numLabels; }); ++t) {
+        for (size_t streamIdx = 0ul; streamIdx < segments.size(); ++streamIdx) {
+            size_t numFrames = features_[segments[streamIdx]].size() / numLabels;
+            if (t < numFrames) {
+                multiStreamSearch.putFeature(streamIdx, feature(segments[streamIdx], t));
+            }
+            else if (t == numFrames) {
+                multiStreamSearch.finishSegment(streamIdx);
+            }
+        }
+        multiStreamSearch.decodeManySteps();
+    }
+    multiStreamSearch.decodeManySteps();
+
+    std::vector<Result> results;
+    for (size_t streamIdx = 0ul; streamIdx < segments.size(); ++streamIdx) {
+        EXPECT_TRUE(multiStreamSearch.isFinished(streamIdx));
+        results.push_back(result(*multiStreamSearch.stream(streamIdx).getCurrentBestTraceback()));
+    }
+    return results;
+}
+
+TEST_F(Search, TestMultiStreamSearch, SameResultsAsSingleStreams) {
+    std::vector<Result> expected;
+    CountingLabelScorer::numRuns = 0ul;
+    for (size_t segmentIdx = 0ul; segmentIdx < features_.size(); ++segmentIdx) {
+        expected.push_back(decodeAlone(segmentIdx));
+        EXPECT_FALSE(expected.back().empty());
+    }
+    // one run per frame
+    EXPECT_EQ(CountingLabelScorer::numRuns, 54ul);
+
+    Search::MultiStreamSearch multiStreamSearch(config);
+    EXPECT_EQ(multiStreamSearch.numStreams(), 3ul);
+
+    // the streams are reused for further segments
+    for (std::vector<size_t> segments : {std::vector<size_t>({0ul, 1ul, 2ul}), std::vector<size_t>({3ul, 2ul, 0ul})}) {
+        auto results = decodeInLockstep(multiStreamSearch, segments);
+        for (size_t streamIdx = 0ul; streamIdx < segments.size(); ++streamIdx) {
+            EXPECT_EQ(results[streamIdx].size(), expected[segments[streamIdx]].size());
+            EXPECT_TRUE(results[streamIdx] == expected[segments[streamIdx]]);
+        }
+    }
+}
+
+TEST_F(Search, TestMultiStreamSearch, OneRunPerStep) {
+    Search::MultiStreamSearch multiStreamSearch(config);
+
+    // the frames of all streams are scored together, so the longest segment determines the number of runs
+    CountingLabelScorer::numRuns = 0ul;
+    decodeInLockstep(multiStreamSearch, {0ul, 1ul, 2ul});
+    EXPECT_EQ(CountingLabelScorer::numRuns, 20ul);
+
+    CountingLabelScorer::numRuns = 0ul;
+    decodeInLockstep(multiStreamSearch, {2ul, 2ul, 3ul});
+    EXPECT_EQ(CountingLabelScorer::numRuns, 15ul);
+}
+
+TEST_F(Search, TestMultiStreamSearch, SingleStream) {
+    setParameter("*.num-streams", "1");
+    Search::MultiStreamSearch multiStreamSearch(config);
+    Result                    expected = decodeAlone(1ul);
+
+    CountingLabelScorer::numRuns = 0ul;
+    EXPECT_TRUE(decodeInLockstep(multiStreamSearch, {1ul}).front() == expected);
+    EXPECT_EQ(CountingLabelScorer::numRuns, 20ul);
+}
@@ -0,0 +1,63 @@
+/** Copyright 2025 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <thread>
+#include <vector>
+
+#include <Search/Traceback.hh>
+#include <Test/UnitTest.hh>
+
+namespace {
+
+/** Chain of @param length traces, the newest one is returned. */
+Core::Ref<Search::LatticeTrace> traceChain(u32 length) {
+    Core::Ref<Search::LatticeTrace> trace;
+    for (u32 t = 0; t < length; ++t) {
+        trace = Core::ref(new Search::LatticeTrace(trace, nullptr, t, Search::ScoreVector(t, 0), Search::LatticeTrace::Transit()));
+    }
+    return trace;
+}
+
+}  // namespace
+
+TEST(Search, LatticeTrace, ReferenceCount) {
+    Core::Ref<Search::LatticeTrace> trace = traceChain(3);
+    EXPECT_EQ(trace->refCount(), 1u);
+    Core::Ref<Search::LatticeTrace> copy = trace;
+    EXPECT_EQ(trace->refCount(), 2u);
+    copy.reset();
+    EXPECT_EQ(trace->refCount(), 1u);
+    EXPECT_EQ(trace->predecessor->refCount(), 1u);
+    EXPECT_EQ(trace->predecessor->time, 1u);
+    EXPECT_FALSE(trace->predecessor->predecessor->predecessor);
+}
+
+TEST(Search, LatticeTrace, AllocateAcrossThreads) {
+    // traces are allocated by short-lived threads and freed by this one
+    const u32                       nTraces = 100000;
+    Core::Ref<Search::LatticeTrace> trace;
+    size_t                          nAllocated = 0;
+    for (u32 round = 0; round < 8; ++round) {
+        std::thread producer([&trace, nTraces]() { trace = traceChain(nTraces); });
+        producer.join();
+        EXPECT_EQ(trace->time, nTraces - 1);
+        trace.reset();
+        if (round == 0) {
+            nAllocated = Search::LatticeTrace::numAllocatedBlocks();
+            EXPECT_GE(nAllocated, size_t(nTraces));
+        }
+    }
+    // the blocks freed here and cached by the exited threads are reused, no new slabs are needed
+    EXPECT_EQ(Search::LatticeTrace::numAllocatedBlocks(), nAllocated);
+}
@@ -0,0 +1,423 @@
+/** Copyright 2026 RWTH Aachen University. All rights reserved.
+ *
+ *  Licensed under the RWTH ASR License (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.hltpr.rwth-aachen.de/rwth-asr/rwth-asr-license.html
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+#include <Am/Module.hh>
+#include <Audio/Module.hh>
+#include <Core/Application.hh>
+#include <Core/ResourceUsageInfo.hh>
+#include <Core/StringUtilities.hh>
+#include <Flow/Module.hh>
+#include <Lm/Module.hh>
+#include <Math/Module.hh>
+#include <Mm/Module.hh>
+#include <Nn/Module.hh>
+#include <Search/Module.hh>
+#include <Search/MultiStreamSearch.hh>
+#include <Search/SearchV2.hh>
+#include <Search/Traceback.hh>
+#include <Signal/Module.hh>
+#include <Speech/ModelCombination.hh>
+#include <Speech/Module.hh>
+#ifdef MODULE_ONNX
+#include <Onnx/Module.hh>
+#endif
+
+/*
+ * Count all heap allocations of the process so that the benchmark can report
+ * how many allocations the search performs per step.
+ */
+namespace {
+
+std::atomic<u64> numAllocations(0ul);
+std::atomic<u64> numAllocatedBytes(0ul);
+
+void* countedAllocation(size_t size) {
+    numAllocations.fetch_add(1ul, std::memory_order_relaxed);
+    numAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0ul) {
+        size = 1ul;
+    }
+    void* ptr = std::malloc(size);
+    if (not ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return countedAllocation(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAllocation(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+/*
+ * Benchmark for search algorithms of the `SearchAlgorithmV2` interface.
+ *
+ * The search is run on synthetic segments of dummy features; the actual scores are expected to come from
+ * a label scorer that doesn't depend on the feature content, usually the "synthetic" label scorer.
+ * Lexicon and language model are set up as usual via the model combination. This allows to measure
+ * the performance of the search in isolation from any neural network.
+ *
+ * Features are passed one by one and after each feature all possible search steps are performed, i.e. the
+ * search runs in the same way as in online recognition. The results are written as JSON.
+ *
+ * With `num-streams` > 1, that many segments are decoded in lockstep by a `Search::MultiStreamSearch`,
+ * which merges the scorer calls of all streams per step. Latencies are then measured per lockstep step and
+ * `num-segments` counts rounds of `num-streams` segments each.
+ */
+class SearchBenchmark : public Core::Application {
+public:
+    static const Core::ParameterInt    paramNumSegments;
+    static const Core::ParameterInt    paramNumWarmupSegments;
+    static const Core::ParameterInt    paramNumFrames;
+    static const Core::ParameterInt    paramFeatureDimension;
+    static const Core::ParameterFloat  paramFrameShift;
+    static const Core::ParameterString paramOutputFile;
+
+    virtual std::string getUsage() const {
+        return "benchmark of search algorithms on synthetic inputs";
+    }
+
+    SearchBenchmark() {
+        INIT_MODULE(Flow);
+        INIT_MODULE(Am);
+        INIT_MODULE(Audio);
+        INIT_MODULE(Lm);
+        INIT_MODULE(Math);
+        INIT_MODULE(Mm);
+        INIT_MODULE(Nn);
+        INIT_MODULE(Search);
+        INIT_MODULE(Signal);
+        INIT_MODULE(Speech);
+#ifdef MODULE_ONNX
+        INIT_MODULE(Onnx);
+#endif
+
+        setTitle("search-benchmark");
+    }
+
+    int main(const std::vector<std::string>& arguments);
+
+private:
+    struct Statistics {
+        size_t           numSegments      = 0ul;
+        size_t           numFrames        = 0ul;
+        double           decodeTime       = 0.0;  // in seconds
+        u64              numAllocations   = 0ul;
+        u64              allocatedBytes   = 0ul;
+        std::vector<f64> stepLatencies;    // in microseconds
+        std::vector<f64> finishLatencies;  // in microseconds
+        std::vector<f64> numHypotheses;
+    };
+
+    void runSegment(Search::SearchAlgorithmV2& search, Statistics& statistics);
+    void runLockstepSegments(Search::MultiStreamSearch& multiStreamSearch, Statistics& statistics);
+    void writeJson(std::ostream& os, Statistics const& statistics, std::string const& searchType, size_t numStreams) const;
+};
+
+APPLICATION(SearchBenchmark)
+
+const Core::ParameterInt SearchBenchmark::paramNumSegments(
+        "num-segments", "number of measured segments", 10, 1);
+
+const Core::ParameterInt SearchBenchmark::paramNumWarmupSegments(
+        "num-warmup-segments", "number of segments that are decoded before the measurement starts", 1, 0);
+
+const Core::ParameterInt SearchBenchmark::paramNumFrames(
+        "num-frames", "number of feature frames per segment", 500, 1);
+
+const Core::ParameterInt SearchBenchmark::paramFeatureDimension(
+        "feature-dimension", "dimension of the dummy features passed to the search", 1, 1);
+
+const Core::ParameterFloat SearchBenchmark::paramFrameShift(
+        "frame-shift", "audio duration of a single feature frame in seconds; used to compute the real time factor", 0.04, 0.0);
+
+const Core::ParameterString SearchBenchmark::paramOutputFile(
+        "output-file", "file to write the JSON results to; written to stdout if empty", "");
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+f64 microseconds(Clock::duration duration) {
+    return std::chrono::duration<f64, std::micro>(duration).count();
+}
+
+// Nearest-rank percentile of sorted values
+f64 percentile(std::vector<f64> const& sortedValues, f64 p) {
+    if (sortedValues.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sortedValues.size()));
+    return sortedValues[std::clamp<size_t>(rank, 1ul, sortedValues.size()) - 1ul];
+}
+
+void writeDistribution(std::ostream& os, std::vector<f64> values) {
+    std::sort(values.begin(), values.end());
+    f64 mean = values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    os << "{\"mean\": " << mean
+       << ", \"p50\": " << percentile(values, 50.0)
+       << ", \"p90\": " << percentile(values, 90.0)
+       << ", \"p99\": " << percentile(values, 99.0)
+       << ", \"max\": " << (values.empty() ? 0.0 : values.back()) << "}";
+}
+
+}  // namespace
+
+void SearchBenchmark::runSegment(Search::SearchAlgorithmV2& search, Statistics& statistics) {
+    size_t numFrames        = paramNumFrames(config);
+    size_t featureDimension = paramFeatureDimension(config);
+
+    std::shared_ptr<f32[]> featureData(new f32[featureDimension]);
+    std::fill(featureData.get(), featureData.get() + featureDimension, 0.0f);
+    Nn::DataView feature(std::shared_ptr<f32 const[]>(featureData), featureDimension);
+
+    u64             allocationsBefore   = numAllocations.load(std::memory_order_relaxed);
+    u64             bytesBefore         = numAllocatedBytes.load(std::memory_order_relaxed);
+    u64             excludedAllocations = 0ul;
+    u64             excludedBytes       = 0ul;
+    Clock::duration decodeTime          = Clock::duration::zero();
+
+    auto start = Clock::now();
+    search.enterSegment();
+    for (size_t t = 0ul; t < numFrames; ++t) {
+        search.putFeature(feature);
+        while (true) {
+            auto stepStart = Clock::now();
+            bool stepped   = search.decodeStep();
+            auto stepEnd   = Clock::now();
+            decodeTime += stepEnd - start;
+            if (not stepped) {
+                start = stepEnd;
+                break;
+            }
+
+            // Exclude the bookkeeping of the benchmark from the measured time and allocations
+            u64 allocations = numAllocations.load(std::memory_order_relaxed);
+            u64 bytes       = numAllocatedBytes.load(std::memory_order_relaxed);
+            statistics.stepLatencies.push_back(microseconds(stepEnd - stepStart));
+            statistics.numHypotheses.push_back(search.numHypotheses());
+            excludedAllocations += numAllocations.load(std::memory_order_relaxed) - allocations;
+            excludedBytes += numAllocatedBytes.load(std::memory_order_relaxed) - bytes;
+            start = Clock::now();
+        }
+    }
+    auto finishStart = Clock::now();
+    search.finishSegment();
+    auto traceback = search.getCurrentBestTraceback();
+    auto finishEnd = Clock::now();
+    decodeTime += finishEnd - start;
+
+    statistics.finishLatencies.push_back(microseconds(finishEnd - finishStart));
+    statistics.decodeTime += std::chrono::duration<f64>(decodeTime).count();
+    statistics.numAllocations += numAllocations.load(std::memory_order_relaxed) - allocationsBefore - excludedAllocations;
+    statistics.allocatedBytes += numAllocatedBytes.load(std::memory_order_relaxed) - bytesBefore - excludedBytes;
+    statistics.numFrames += numFrames;
+    statistics.numSegments += 1ul;
+
+    log() << "decoded segment with " << numFrames << " frames and " << traceback->size() << " traceback items";
+}
+
+void SearchBenchmark::runLockstepSegments(Search::MultiStreamSearch& multiStreamSearch, Statistics& statistics) {
+    size_t numFrames        = paramNumFrames(config);
+    size_t featureDimension = paramFeatureDimension(config);
+    size_t numStreams       = multiStreamSearch.numStreams();
+
+    std::shared_ptr<f32[]> featureData(new f32[featureDimension]);
+    std::fill(featureData.get(), featureData.get() + featureDimension, 0.0f);
+    Nn::DataView feature(std::shared_ptr<f32 const[]>(featureData), featureDimension);
+
+    u64             allocationsBefore   = numAllocations.load(std::memory_order_relaxed);
+    u64             bytesBefore         = numAllocatedBytes.load(std::memory_order_relaxed);
+    u64             excludedAllocations = 0ul;
+    u64             excludedBytes       = 0ul;
+    Clock::duration decodeTime          = Clock::duration::zero();
+
+    auto start = Clock::now();
+    for (size_t streamIdx = 0ul; streamIdx < numStreams; ++streamIdx) {
+        multiStreamSearch.enterSegment(streamIdx);
+    }
+    for (size_t t = 0ul; t < numFrames; ++t) {
+        for (size_t streamIdx = 0ul; streamIdx < numStreams; ++streamIdx) {
+            multiStreamSearch.putFeature(streamIdx, feature);
+        }
+        while (true) {
+            auto   stepStart = Clock::now();
+            size_t numSteps  = multiStreamSearch.decodeStep();
+            auto   stepEnd   = Clock::now();
+            decodeTime += stepEnd - start;
+            if (numSteps == 0ul) {
+                start = stepEnd;
+                break;
+            }
+
+            // Exclude the bookkeeping of the benchmark from the measured time and allocations
+            u64    allocations   = numAllocations.load(std::memory_order_relaxed);
+            u64    bytes         = numAllocatedBytes.load(std::memory_order_relaxed);
+            size_t numHypotheses = 0ul;
+            for (size_t streamIdx = 0ul; streamIdx < numStreams; ++streamIdx) {
+                numHypotheses += multiStreamSearch.stream(streamIdx).numHypotheses();
+            }
+            statistics.stepLatencies.push_back(microseconds(stepEnd - stepStart));
+            statistics.numHypotheses.push_back(numHypotheses);
+            excludedAllocations += numAllocations.load(std::memory_order_relaxed) - allocations;
+            excludedBytes += numAllocatedBytes.load(std::memory_order_relaxed) - bytes;
+            start = Clock::now();
+        }
+    }
+    auto finishStart = Clock::now();
+    for (size_t streamIdx = 0ul; streamIdx < numStreams; ++streamIdx) {
+        multiStreamSearch.finishSegment(streamIdx);
+    }
+    multiStreamSearch.decodeManySteps();
+    size_t numTracebackItems = 0ul;
+    for (size_t streamIdx = 0ul; streamIdx < numStreams; ++streamIdx) {
+        verify(multiStreamSearch.isFinished(streamIdx));
+        numTracebackItems += multiStreamSearch.stream(streamIdx).getCurrentBestTraceback()->size();
+    }
+    auto finishEnd = Clock::now();
+    decodeTime += finishEnd - start;
+
+    statistics.finishLatencies.push_back(microseconds(finishEnd - finishStart));
+    statistics.decodeTime += std::chrono::duration<f64>(decodeTime).count();
+    statistics.numAllocations += numAllocations.load(std::memory_order_relaxed) - allocationsBefore - excludedAllocations;
+    statistics.allocatedBytes += numAllocatedBytes.load(std::memory_order_relaxed) - bytesBefore - excludedBytes;
+    statistics.numFrames += numStreams * numFrames;
+    statistics.numSegments += numStreams;
+
+    log() << "decoded " << numStreams << " segments in lockstep with " << numFrames << " frames each and " << numTracebackItems << " traceback items in total";
+}
+
+void SearchBenchmark::writeJson(std::ostream& os, Statistics const& statistics, std::string const& searchType, size_t numStreams) const {
+    Core::ResourceUsageInfo resourceUsage;
+    resourceUsage.update();
+
+    f64 audioDuration = statistics.numFrames * paramFrameShift(config);
+    f64 numSteps      = statistics.stepLatencies.size();
+
+    os << std::setprecision(6);
+    os << "{\n";
+    os << "  \"search-algorithm\": " << Core::jsonString(searchType) << ",\n";
+    os << "  \"streams\": " << numStreams << ",\n";
+    os << "  \"segments\": " << statistics.numSegments << ",\n";
+    os << "  \"frames\": " << statistics.numFrames << ",\n";
+    os << "  \"steps\": " << statistics.stepLatencies.size() << ",\n";
+    os << "  \"audio-duration-s\": " << audioDuration << ",\n";
+    os << "  \"decode-time-s\": " << statistics.decodeTime << ",\n";
+    os << "  \"rtf\": " << (audioDuration > 0.0 ? statistics.decodeTime / audioDuration : 0.0) << ",\n";
+    os << "  \"step-latency-us\": ";
+    writeDistribution(os, statistics.stepLatencies);
+    os << ",\n";
+    os << "  \"finish-segment-latency-us\": ";
+    writeDistribution(os, statistics.finishLatencies);
+    os << ",\n";
+    os << "  \"hypotheses-per-step\": ";
+    writeDistribution(os, statistics.numHypotheses);
+    os << ",\n";
+    os << "  \"allocations\": {\"count\": " << statistics.numAllocations
+       << ", \"bytes\": " << statistics.allocatedBytes
+       << ", \"per-step\": " << (numSteps > 0.0 ? statistics.numAllocations / numSteps : 0.0)
+       << ", \"lattice-trace-blocks\": " << Search::LatticeTrace::numAllocatedBlocks() << "},\n";
+    os << "  \"peak-rss-kb\": " << resourceUsage.maxResidentSetSize() << "\n";
+    os << "}\n";
+}
+
+int SearchBenchmark::main(const std::vector<std::string>& arguments) {
+    Core::Configuration searchConfig = select("search-algorithm");
+    std::string         searchType;
+    if (not searchConfig.get("type", searchType)) {
+        searchType = "default";
+    }
+
+    size_t     numStreams = Search::MultiStreamSearch::paramNumStreams(config);
+    Statistics warmupStatistics;
+    Statistics statistics;
+    if (numStreams > 1ul) {
+        Search::MultiStreamSearch multiStreamSearch(config);
+        for (s32 s = 0; s < paramNumWarmupSegments(config); ++s) {
+            runLockstepSegments(multiStreamSearch, warmupStatistics);
+        }
+        for (s32 s = 0; s < paramNumSegments(config); ++s) {
+            runLockstepSegments(multiStreamSearch, statistics);
+        }
+    }
+    else {
+        auto search           = std::unique_ptr<Search::SearchAlgorithmV2>(Search::Module::instance().createSearchAlgorithmV2(searchConfig));
+        auto modelCombination = Core::ref(new Speech::ModelCombination(select("model-combination"), search->requiredModelCombination(), search->requiredAcousticModel()));
+        if (not search->setModelCombination(*modelCombination)) {
+            criticalError("Failed to set model combination of search algorithm");
+        }
+
+        for (s32 s = 0; s < paramNumWarmupSegments(config); ++s) {
+            runSegment(*search, warmupStatistics);
+        }
+        for (s32 s = 0; s < paramNumSegments(config); ++s) {
+            runSegment(*search, statistics);
+        }
+    }
+
+    std::ostringstream result;
+    writeJson(result, statistics, searchType, numStreams);
+    log() << "benchmark results:\n"
+          << result.str();
+
+    std::string outputFile = paramOutputFile(config);
+    if (outputFile.empty()) {
+        std::cout << result.str();
+    }
+    else {
+        std::ofstream os(outputFile);
+        if (not os) {
+            criticalError() << "Failed to open output file " << outputFile;
+        }
+        os << result.str();
+    }
+
+    return EXIT_SUCCESS;
+}